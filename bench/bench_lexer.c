@@ -0,0 +1,130 @@
+/*
+ * bench_lexer: lexer throughput per scan kernel.
+ *
+ *   bench_lexer [file.rift] [iterations]
+ *
+ * Without a file a synthetic source is generated. Reports bytes per
+ * cycle (x86-64, TSC) or MB/s for the raw whitespace/identifier kernels
+ * and for a full rift_lexer_tokenize_all pass under each kernel set.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rift/lexer.h"
+#include "rift/scan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+static char *load_source(const char *path, size_t *len) {
+    if (path) {
+        FILE *f = fopen(path, "rb");
+        if (!f) return NULL;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        char *buf = (size > 0) ? (char *)malloc((size_t)size + 1) : NULL;
+        if (buf) {
+            *len = fread(buf, 1, (size_t)size, f);
+            buf[*len] = '\0';
+        }
+        fclose(f);
+        return buf;
+    }
+
+    static const char *lines[] = {
+        "fn compute_checksum(buffer, length) {\n",
+        "    let accumulator = 0;\n",
+        "    while (index < length) { accumulator = accumulator + buffer[index]; }\n",
+        "    print(\"checksum of \\\"buffer\\\" is\", accumulator, 3.14159);\n",
+        "    return accumulator;\n",
+        "}\n\n",
+    };
+    size_t target = 4u << 20, n = 0;
+    char *buf = (char *)malloc(target + 128);
+    if (!buf) return NULL;
+    for (size_t i = 0; n < target; i++) {
+        const char *line = lines[i % (sizeof(lines) / sizeof(lines[0]))];
+        size_t l = strlen(line);
+        memcpy(buf + n, line, l);
+        n += l;
+    }
+    buf[n] = '\0';
+    *len = n;
+    return buf;
+}
+
+static double bench_now(void) {
+#ifdef BENCH_HAS_TSC
+    return (double)__rdtsc();
+#else
+    return rift_time_ms();
+#endif
+}
+
+static void report(const char *kernel, const char *what, double elapsed, size_t bytes) {
+#ifdef BENCH_HAS_TSC
+    printf("  %-8s %-16s %8.3f bytes/cycle\n", kernel, what, (double)bytes / elapsed);
+#else
+    printf("  %-8s %-16s %8.1f MB/s\n", kernel, what, (double)bytes / (elapsed * 1000.0));
+#endif
+}
+
+int main(int argc, char **argv) {
+    size_t len = 0;
+    char *src = load_source(argc > 1 ? argv[1] : NULL, &len);
+    int iterations = argc > 2 ? atoi(argv[2]) : 10;
+    if (!src || iterations <= 0) {
+        fprintf(stderr, "bench_lexer: cannot load input\n");
+        return 1;
+    }
+
+    /* Long single-class runs for the raw kernels */
+    char *spaces = (char *)malloc(len);
+    char *ident = (char *)malloc(len);
+    if (!spaces || !ident) return 1;
+    memset(spaces, ' ', len);
+    memset(ident, 'x', len);
+
+    printf("bench_lexer: %zu bytes, %d iterations, default kernel %s\n",
+           len, iterations, rift_scan_kernel_name());
+
+    static const char *kernels[] = { "scalar", "sse2", "avx2" };
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!rift_scan_select(kernels[k])) continue;
+
+        size_t sink = 0;
+        double t = bench_now();
+        for (int i = 0; i < iterations; i++) sink += rift_scan_whitespace(spaces, 0, len);
+        report(kernels[k], "whitespace run", bench_now() - t, len * (size_t)iterations);
+
+        t = bench_now();
+        for (int i = 0; i < iterations; i++) sink += rift_scan_ident(ident, 0, len);
+        report(kernels[k], "identifier run", bench_now() - t, len * (size_t)iterations);
+
+        t = bench_now();
+        for (int i = 0; i < iterations; i++) sink += rift_scan_count_newlines(src, len);
+        report(kernels[k], "newline count", bench_now() - t, len * (size_t)iterations);
+
+        size_t tokens = 0;
+        t = bench_now();
+        for (int i = 0; i < iterations; i++) {
+            rift_lexer_t *lexer = rift_lexer_create(src, len);
+            rift_token_buffer_t buffer;
+            if (lexer && rift_lexer_tokenize_all(lexer, &buffer)) {
+                tokens = buffer.count;
+                rift_token_buffer_free(&buffer);
+            }
+            rift_lexer_destroy(lexer);
+        }
+        report(kernels[k], "tokenize_all", bench_now() - t, len * (size_t)iterations);
+        if (sink == 0 || tokens == 0) printf("  (no work measured)\n");
+    }
+
+    free(spaces);
+    free(ident);
+    free(src);
+    return 0;
+}
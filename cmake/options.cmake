@@ -3,3 +3,4 @@
 option(RIFT_BUILD_TESTS "Build the RIFT test suite" ON)
 option(RIFT_BUILD_SHARED "Build shared library" ON)
 option(RIFT_BUILD_STATIC "Build static library" ON)
+option(RIFT_BUILD_BENCHMARKS "Build the RIFT benchmarks" OFF)
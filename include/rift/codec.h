@@ -26,8 +26,6 @@ typedef enum rift_cir_kind {
 } rift_cir_kind_t;
 
 #define RIFT_CIR_MAX_STRINGS 256
-#define RIFT_CIR_MAX_NODES   1024
-#define RIFT_CIR_MAX_VARS    64
 
 typedef struct rift_cir_node {
     rift_cir_kind_t kind;
@@ -38,8 +36,9 @@ typedef struct rift_cir_node {
 } rift_cir_node_t;
 
 typedef struct rift_cir_program {
-    rift_cir_node_t nodes[RIFT_CIR_MAX_NODES];
+    rift_cir_node_t *nodes;        /* grows geometrically; no node cap */
     int             node_count;
+    int             node_capacity;
     char            strings[RIFT_CIR_MAX_STRINGS][256];
     int             string_count;
 } rift_cir_program_t;
@@ -51,6 +50,9 @@ typedef struct rift_cir_program {
  * Memory-first ordering: SPAN before ASSIGN
  */
 RIFT_API int rift_link(const char *source, size_t length, rift_cir_program_t *out);
+RIFT_API int rift_cir_program_append(rift_cir_program_t *program,
+                                     const rift_cir_node_t *node);
+RIFT_API void rift_cir_program_free(rift_cir_program_t *program);
 RIFT_API int rift_codec_emit(const rift_cir_program_t *program, const char *target,
                               const char *output_path);
 
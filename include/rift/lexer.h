@@ -10,10 +10,32 @@ extern "C" {
 
 typedef struct rift_lexer rift_lexer_t;
 
+/* Lexer flags */
+#define RIFT_LEXER_ZERO_COPY 0x0001  /* tokens view the source (see rift_token_create_n) */
+
 RIFT_API rift_lexer_t *rift_lexer_create(const char *source, size_t length);
+RIFT_API rift_lexer_t *rift_lexer_create_ex(const char *source, size_t length, uint32_t flags);
 RIFT_API void          rift_lexer_destroy(rift_lexer_t *lexer);
+
+/* Extra keywords (e.g. pattern keywords from macros.rf) on top of the
+ * built-in set; the array and strings must outlive the lexer. */
+RIFT_API int           rift_lexer_set_keywords(rift_lexer_t *lexer,
+                                               const char *const *keywords, size_t count);
+
+/* Copy-mode token values are carved from `arena` (NULL: one allocation
+ * each); they live until the arena is reset or released, and destroying
+ * the token frees nothing. The arena must outlive the tokens. */
+RIFT_API int           rift_lexer_set_arena(rift_lexer_t *lexer, rift_memory_arena_t *arena);
+
+/* Next token; EOF at the end. RIFT_TOKEN_ERROR (no value) when a copy-mode
+ * value cannot be allocated: the token is not consumed. */
 RIFT_API rift_token_t  rift_lexer_next(rift_lexer_t *lexer);
 RIFT_API rift_token_t  rift_lexer_peek(const rift_lexer_t *lexer);
+
+/* Lex everything from the current position into `buffer` (initialized
+ * here, release with rift_token_buffer_free). Returns 0 on allocation
+ * failure or sources over 4 GiB. */
+RIFT_API int           rift_lexer_tokenize_all(rift_lexer_t *lexer, rift_token_buffer_t *buffer);
 RIFT_API int           rift_lexer_eof(const rift_lexer_t *lexer);
 
 #ifdef __cplusplus
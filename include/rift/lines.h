@@ -0,0 +1,48 @@
+#ifndef RIFT_LINES_H
+#define RIFT_LINES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rift/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * RIFT Line Index: byte offset of every line start, built in one memchr
+ * pass. Stages keep plain byte offsets and resolve line/column by binary
+ * search only when a diagnostic needs them. Lines and columns are 1-based,
+ * columns count bytes. The index does not own `source`.
+ *
+ * A line is the bytes up to and including a '\n', or the bytes after the
+ * last '\n'. A trailing '\n' ends the last line and opens no new one, so
+ * "" has no lines, "a\n" and "a" have one, and "a\n\n" has two. '\r' is
+ * ordinary text: CRLF lines keep their '\r'. riftlang's RiftLineIndex
+ * follows the same rule.
+ */
+typedef struct rift_line_index {
+    const char *source;
+    size_t      length;
+    uint32_t   *starts;     /* starts[i] = offset of line i + 1 */
+    size_t      count;      /* lines holding at least one byte; 0 for "" */
+} rift_line_index_t;
+
+/* 0 on allocation failure or sources over 4 GiB */
+RIFT_API int          rift_line_index_build(rift_line_index_t *index, const char *source, size_t length);
+RIFT_API void         rift_line_index_free(rift_line_index_t *index);
+
+/* Line and column of `offset` (clamped to the end of the source, so the
+ * end of "a\n" is line 1, column 3); 1:1 when there are no lines */
+RIFT_API void         rift_line_index_locate(const rift_line_index_t *index, size_t offset,
+                                             uint32_t *line, uint32_t *column);
+
+/* Text of 1-based `line` without its '\n'; NULL if out of range */
+RIFT_API const char  *rift_line_index_line(const rift_line_index_t *index, uint32_t line,
+                                           size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RIFT_LINES_H */
@@ -23,11 +23,37 @@ typedef struct rift_memory_span {
 #define RIFT_MEM_STATIC   0x0001
 #define RIFT_MEM_DYNAMIC  0x0002
 #define RIFT_MEM_READONLY 0x0004
+#define RIFT_MEM_ARENA    0x0008  /* carved from an arena, released with it */
 
 RIFT_API rift_memory_span_t rift_memory_alloc(size_t size, uint32_t alignment);
 RIFT_API void               rift_memory_free(rift_memory_span_t *span);
 RIFT_API int                rift_memory_validate(const rift_memory_span_t *span);
 
+/*
+ * Arena: zeroed, aligned spans bumped out of large chunks and released all
+ * at once. Spans are RIFT_MEM_ARENA, so rift_memory_free leaves them alone;
+ * they stay valid until the arena is reset or released. Requests larger
+ * than a chunk get a chunk of their own. Not thread-safe: one arena per
+ * compile.
+ */
+#define RIFT_MEMORY_ARENA_CHUNK (64 * 1024)
+
+typedef struct rift_memory_chunk rift_memory_chunk_t;
+
+typedef struct rift_memory_arena {
+    rift_memory_chunk_t *chunks;      /* the chunk being filled comes first */
+    size_t               chunk_size;  /* usable bytes per regular chunk */
+} rift_memory_arena_t;
+
+/* chunk_size 0 means RIFT_MEMORY_ARENA_CHUNK; nothing is allocated yet */
+RIFT_API void               rift_memory_arena_init(rift_memory_arena_t *arena, size_t chunk_size);
+/* alignment must be a power of two (0: RIFT_MEMORY_ALIGN_DEFAULT) */
+RIFT_API rift_memory_span_t rift_memory_arena_alloc(rift_memory_arena_t *arena,
+                                                    size_t size, uint32_t alignment);
+/* Drop every span but keep the current chunk for the next compile */
+RIFT_API void               rift_memory_arena_reset(rift_memory_arena_t *arena);
+RIFT_API void               rift_memory_arena_release(rift_memory_arena_t *arena);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,12 +33,18 @@ typedef struct rift_ast_node {
     float                 complexity_score;
     struct rift_ast_node *children;
     struct rift_ast_node *next;
+    uint16_t              memory_flags;   /* RIFT_MEM_ARENA: freed with the arena */
 } rift_ast_node_t;
 
 typedef struct rift_parser rift_parser_t;
 
 RIFT_API rift_parser_t   *rift_parser_create(const rift_token_t *tokens, size_t count);
+RIFT_API rift_parser_t   *rift_parser_create_from_buffer(const rift_token_buffer_t *buffer);
 RIFT_API void             rift_parser_destroy(rift_parser_t *parser);
+
+/* Nodes are carved from `arena` (NULL: one allocation each); rift_ast_free
+ * then skips the tree, which goes when the arena is reset or released. */
+RIFT_API int              rift_parser_set_arena(rift_parser_t *parser, rift_memory_arena_t *arena);
 RIFT_API rift_ast_node_t *rift_parser_parse(rift_parser_t *parser);
 RIFT_API void             rift_ast_free(rift_ast_node_t *node);
 
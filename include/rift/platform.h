@@ -74,6 +74,23 @@ RIFT_API void rift_regex_free(rift_regex_t *rx);
 
 RIFT_API double rift_time_ms(void);
 
+/*
+ * Read-only file contents. Regular files are mmap'd (MADV_SEQUENTIAL) with
+ * no copy; pipes, "-" (stdin) and anything mmap refuses are read() into a
+ * heap buffer. Either way data[size] == '\0'. Truncating a file while it
+ * is mapped faults on access, as with any mapping.
+ */
+typedef struct rift_file_map {
+    const char *data;
+    size_t      size;
+    void       *base;       /* mapping or heap block */
+    size_t      base_size;  /* bytes mapped; 0 for a heap block */
+} rift_file_map_t;
+
+/* 0 on success, -1 with errno set */
+RIFT_API int  rift_file_map(const char *path, rift_file_map_t *map);
+RIFT_API void rift_file_unmap(rift_file_map_t *map);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,7 @@ typedef struct rift_context {
     rift_emitter_t         *emitter;
     rift_bridge_t          *bridge;
     rift_pattern_engine_t  *pattern;
+    rift_memory_arena_t     arena;      /* tokens and AST nodes of a compile */
     rift_error_t            last_error;
     int                     verbose;
     int                     debug;
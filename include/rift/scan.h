@@ -0,0 +1,42 @@
+#ifndef RIFT_SCAN_H
+#define RIFT_SCAN_H
+
+#include <stddef.h>
+#include "rift/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * RIFT Scan Kernels: character-class runs for the lexer.
+ *
+ * Each rift_scan_* returns the index of the first byte in [pos, len)
+ * that ends the run, or len. Kernels never read outside [pos, len).
+ * Classes are ASCII (C locale):
+ *   whitespace  ' ' \t \n \v \f \r
+ *   ident       [A-Za-z0-9_]
+ *   digits      [0-9.]
+ *   string      stops at '"' or '\\'
+ *
+ * On x86-64 with GCC/Clang the AVX2 or SSE2 kernels are picked at first
+ * use from the running CPU; elsewhere the scalar kernels run.
+ */
+
+RIFT_API size_t      rift_scan_whitespace(const char *s, size_t pos, size_t len);
+RIFT_API size_t      rift_scan_ident(const char *s, size_t pos, size_t len);
+RIFT_API size_t      rift_scan_digits(const char *s, size_t pos, size_t len);
+RIFT_API size_t      rift_scan_string(const char *s, size_t pos, size_t len);
+RIFT_API size_t      rift_scan_count_newlines(const char *s, size_t len);
+
+/* Active kernel set: "avx2", "sse2" or "scalar" */
+RIFT_API const char *rift_scan_kernel_name(void);
+
+/* Force a kernel set (tests, benchmarks); 0 if unknown or unsupported here */
+RIFT_API int         rift_scan_select(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RIFT_SCAN_H */
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include "rift/platform.h"
 #include "rift/memory.h"
+#include "rift/lines.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,7 +27,8 @@ typedef enum rift_token_type {
     RIFT_TOKEN_PATTERN_STATIC,   /* R"" - compile-time static string */
     RIFT_TOKEN_PATTERN_DYNAMIC,  /* R'' - runtime dynamic character */
     RIFT_TOKEN_HEXDUMP,          /* Hexdump canonical form */
-    RIFT_TOKEN_UNKNOWN
+    RIFT_TOKEN_UNKNOWN,
+    RIFT_TOKEN_ERROR             /* the lexer could not allocate the value */
 } rift_token_type_t;
 
 /* Token value union */
@@ -52,8 +54,46 @@ typedef struct rift_token {
     uint32_t             column;
 } rift_token_t;
 
+/*
+ * Token buffer: a whole token stream as parallel arrays (struct of arrays).
+ * Values are spans of `source`, which the buffer does not own. Filled by
+ * rift_lexer_tokenize_all; the EOF token is not stored. Tokens carry byte
+ * offsets only: line and column come from `lines` when asked for.
+ */
+typedef struct rift_token_buffer {
+    const char *source;
+    uint8_t    *types;      /* rift_token_type_t */
+    uint32_t   *offsets;    /* byte offset of the value into source */
+    uint32_t   *lengths;
+    uint8_t    *leads;      /* opening delimiter bytes before the value */
+    rift_line_index_t lines;
+    size_t      count;
+    size_t      capacity;
+} rift_token_buffer_t;
+
 RIFT_API rift_token_t  rift_token_create(rift_token_type_t type, const char *value);
 RIFT_API void          rift_token_destroy(rift_token_t *token);
+
+/*
+ * Zero-copy tokens: value.str points at `length` bytes inside a caller-owned
+ * buffer (not NUL-terminated) and the span is RIFT_MEM_STATIC | RIFT_MEM_READONLY,
+ * so destroy releases nothing. Read with rift_token_view; materialize copies
+ * the bytes into an owned, NUL-terminated span when a C string is needed.
+ * materialize_in copies into an arena instead (a NULL arena allocates as
+ * materialize does); destroy then leaves the copy to the arena.
+ */
+RIFT_API rift_token_t  rift_token_create_n(rift_token_type_t type, const char *value, size_t length);
+RIFT_API const char   *rift_token_view(const rift_token_t *token, size_t *length);
+RIFT_API int           rift_token_is_view(const rift_token_t *token);
+RIFT_API int           rift_token_materialize(rift_token_t *token);
+RIFT_API int           rift_token_materialize_in(rift_token_t *token, rift_memory_arena_t *arena);
+
+/* Token `index` of a buffer as a zero-copy view (EOF past the end) */
+RIFT_API rift_token_t  rift_token_buffer_get(const rift_token_buffer_t *buffer, size_t index);
+/* Where token `index` begins, delimiters included (binary search) */
+RIFT_API void          rift_token_buffer_locate(const rift_token_buffer_t *buffer, size_t index,
+                                                uint32_t *line, uint32_t *column);
+RIFT_API void          rift_token_buffer_free(rift_token_buffer_t *buffer);
 RIFT_API int           rift_token_validate(const rift_token_t *token);
 RIFT_API const char   *rift_token_type_name(rift_token_type_t type);
 
@@ -9,12 +9,29 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
+#include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
 #include <errno.h>
 
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+#ifndef _WIN32
+#include <glob.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 /* Platform-specific exports */
 #ifdef _WIN32
 #  ifdef RIFTLANG_OPEN_MAIN
@@ -29,6 +46,10 @@
 
 #include "riftlang.h"
 #include "rift_codec.h"
+#include "rift_cache.h"
+#include "rift_daemon.h"
+#include "rift_rules.h"
+#include "rift_transform_output.h"
 
 /* ============================================================================
  * CLI Configuration & Constants
@@ -38,6 +59,11 @@
 #define RIFT_BUILD_DATE "2026-02-28"
 #define RIFT_MAX_LINE_LENGTH 8192
 #define RIFT_MAX_PATTERNS 256
+#define RIFT_MAX_OUTPUTS 8          /* -o / --targets outputs per invocation */
+#define RIFT_MAX_PATH 256
+#define RIFT_BATCH_MAX_WORKERS 64   /* --jobs upper bound */
+#define RIFT_WATCH_QUIET_MS 2       /* --watch: rebuild once writes pause this long */
+#define RIFT_WATCH_MAX_DELAY_MS 50  /* --watch: ... or once a burst lasts this long */
 
 /* ============================================================================
  * CLI Options Structure
@@ -46,6 +72,10 @@
 typedef struct {
     const char* input_file;         /* Input .rift file */
     const char* output_file;        /* Output file (default: input.c) */
+    const char* output_files[RIFT_MAX_OUTPUTS]; /* Every output, in order */
+    int output_count;               /* > 1: link once, emit all concurrently */
+    const char* targets;            /* --targets list, e.g. "js,py,go" */
+    char target_files[RIFT_MAX_OUTPUTS][RIFT_MAX_PATH]; /* Names --targets derives */
     RiftExecutionMode mode;         /* classical/quantum/hybrid */
     bool verbose;                   /* Verbose output */
     bool compile_only;              /* Compile only, don't link */
@@ -58,8 +88,34 @@ typedef struct {
     bool preserve_comments;         /* Keep comments in output */
     int optimization_level;         /* 0-3 optimization */
     bool quiet;                     /* Suppress non-error output (-q) */
+    const char* rule_image;         /* Precompiled rule image to load */
+    const char* emit_rule_image;    /* Write rule image for mode and exit */
+    const char* cir_cache;          /* CIR cache directory, or NULL */
+    uint64_t cir_cache_limit;       /* Cache size bound in bytes (0 = default) */
+    const char* build_cache;        /* Executable cache directory, or NULL */
+    uint64_t build_cache_limit;     /* Its size bound in bytes (0 = default) */
+    const char* daemon_socket;      /* --daemon: serve requests on this socket */
+    const char* connect_socket;     /* --connect: forward to the daemon here */
+    bool batch;                     /* --batch: every positional is an input */
+    const char** inputs;            /* Positional arguments, in order */
+    int input_count;
+    int jobs;                       /* --batch workers (0 = one per CPU) */
+    bool watch;                     /* --watch: rebuild inputs as they change */
 } RiftCliOptions;
 
+/* ============================================================================
+ * CLI Output
+ * Compile messages go through CLI_OUT / CLI_ERR. A --batch worker points
+ * them at per-file buffers that are replayed in input order; everywhere
+ * else they are stdout and stderr.
+ * ============================================================================ */
+
+static _Thread_local FILE* t_cli_out = NULL;
+static _Thread_local FILE* t_cli_err = NULL;
+
+#define CLI_OUT  (t_cli_out ? t_cli_out : stdout)
+#define CLI_ERR  (t_cli_err ? t_cli_err : stderr)
+
 /* ============================================================================
  * Target Language Selection
  * RiftTargetLanguage is defined in riftlang.h (moved there for codec sharing)
@@ -79,418 +135,26 @@ static RiftTargetLanguage rift_detect_target(const char* filename) {
     return RIFT_TARGET_C;
 }
 
-/* ============================================================================
- * Pattern Transformation Rules
- * ============================================================================ */
-
-typedef struct {
-    const char* name;               /* Rule name for debugging */
-    const char* left_pattern;       /* RIFT regex pattern */
-    const char* right_template;     /* C code template */
-    uint32_t priority;              /* Lower = higher priority */
-    bool right_is_literal;          /* True if template is literal C code */
-    RiftExecutionMode applicable_mode; /* Mode this rule applies to */
-} RiftTransformRule;
-
-/* Predefined transformation rules for RIFT -> C */
-static RiftTransformRule g_transform_rules[] = {
-    /* Governance directives - highest priority */
-    {
-        "govern_classical",
-        "^[[:space:]]*!govern[[:space:]]+classical",
-        "/* RIFT: Classical mode enabled */",
-        1, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "govern_quantum",
-        "^[[:space:]]*!govern[[:space:]]+quantum",
-        "/* RIFT: Quantum mode enabled */",
-        1, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "govern_hybrid",
-        "^[[:space:]]*!govern[[:space:]]+hybrid",
-        "/* RIFT: Hybrid mode enabled */",
-        1, true, RIFT_MODE_HYBRID
-    },
-    
-    /* Memory-first declarations */
-    {
-        "span_fixed",
-        "^[[:space:]]*align[[:space:]]+span<fixed>[[:space:]]*\\{",
-        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_FIXED, ",
-        10, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "span_row",
-        "^[[:space:]]*align[[:space:]]+span<row>[[:space:]]*\\{",
-        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_ROW, ",
-        10, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "span_continuous",
-        "^[[:space:]]*align[[:space:]]+span<continuous>[[:space:]]*\\{",
-        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_CONTINUOUS, ",
-        10, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "span_superposed",
-        "^[[:space:]]*align[[:space:]]+span<superposed>[[:space:]]*\\{",
-        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_SUPERPOSED, ",
-        10, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "span_entangled",
-        "^[[:space:]]*align[[:space:]]+span<entangled>[[:space:]]*\\{",
-        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_ENTANGLED, ",
-        10, true, RIFT_MODE_QUANTUM
-    },
-    
-    /* Type declarations */
-    {
-        "type_def",
-        "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-        "/* RIFT type: \\1 */ typedef struct {",
-        20, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "type_int",
-        "^[[:space:]]*type[[:space:]]+INT[[:space:]]*=[[:space:]]*\\{[^}]*bit_width:[[:space:]]*32",
-        "typedef int32_t RIFT_INT;",
-        21, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "type_float",
-        "^[[:space:]]*type[[:space:]]+FLOAT[[:space:]]*=[[:space:]]*\\{[^}]*bit_width:[[:space:]]*64",
-        "typedef double RIFT_FLOAT;",
-        21, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "type_qint",
-        "^[[:space:]]*type[[:space:]]+QINT[[:space:]]*=",
-        "/* Quantum integer type */ typedef struct { int32_t value; double phase; } RIFT_QINT;",
-        21, true, RIFT_MODE_QUANTUM
-    },
-    
-    /* Classical assignment - immediate binding */
-    {
-        "assign_classical",
-        "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
-        "RIFT_ASSIGN_CLASSICAL(\\1, \\2);",
-        30, true, RIFT_MODE_CLASSICAL
-    },
-    
-    /* Quantum assignment - deferred binding */
-    {
-        "assign_quantum",
-        "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*=:[[:space:]]*([^;]+)",
-        "RIFT_ASSIGN_QUANTUM(\\1, \\2);",
-        30, true, RIFT_MODE_QUANTUM
-    },
-    
-    /* Policy enforcement */
-    {
-        "policy_fn",
-        "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-        "RiftPolicyContext* policy_\\1 = rift_policy_context_create(\"\\1\", threshold, true);",
-        40, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "policy_validate",
-        "^[[:space:]]*validate[[:space:]]*\\(",
-        "rift_policy_validate(policy_matrix, true, true)",
-        41, true, RIFT_MODE_CLASSICAL
-    },
-    
-    /* Quantum operations */
-    {
-        "entangle",
-        "entangle[[:space:]]*\\(([a-zA-Z_]+),[[:space:]]*([a-zA-Z_]+)\\)",
-        "rift_token_entangle(\\1, \\2, 0)",
-        50, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "superpose",
-        "superpose[[:space:]]*\\(([a-zA-Z_]+),[[:space:]]*\\[",
-        "rift_token_superpose(\\1, states, count, NULL)",
-        50, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "collapse",
-        "([a-zA-Z_]+)\\.collapse[[:space:]]*\\(([0-9]+)\\)",
-        "rift_token_collapse(\\1, \\2, policy_ctx)",
-        51, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "measure",
-        "measure[[:space:]]*\\(([a-zA-Z_]+)\\)",
-        "rift_token_measure(\\1, &collapsed_idx, &prob)",
-        51, true, RIFT_MODE_QUANTUM
-    },
-    {
-        "entropy",
-        "calculate_entropy[[:space:]]*\\(([a-zA-Z_]+)\\)",
-        "rift_token_calculate_entropy(\\1)",
-        52, true, RIFT_MODE_QUANTUM
-    },
-    
-    /* Memory structure constructs */
-    {
-        "vector_decl",
-        "^[[:space:]]*vector[[:space:]]+<([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
-        "RiftToken* \\2 = rift_token_create(RIFT_TOKEN_VECTOR, span_\\1);",
-        60, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "array_decl",
-        "^[[:space:]]*array[[:space:]]+<([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
-        "RiftToken* \\2 = rift_token_create(RIFT_TOKEN_ARRAY, span_\\1);",
-        60, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "map_decl",
-        "^[[:space:]]*map[[:space:]]+<([A-Za-z_]+),[[:space:]]*([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
-        "RiftToken* \\3 = rift_token_create(RIFT_TOKEN_MAP, span_\\1_\\2);",
-        60, true, RIFT_MODE_CLASSICAL
-    },
-    
-    /* Control flow */
-    {
-        "if_stmt",
-        "^[[:space:]]*if[[:space:]]*\\(",
-        "if (",
-        100, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "while_stmt",
-        "^[[:space:]]*while[[:space:]]*\\(",
-        "while (",
-        100, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "for_stmt",
-        "^[[:space:]]*for[[:space:]]*\\(",
-        "for (",
-        100, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "block_start",
-        "^[[:space:]]*\\{",
-        "{",
-        200, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "block_end",
-        "^[[:space:]]*\\}",
-        "}",
-        200, true, RIFT_MODE_CLASSICAL
-    },
-    
-    /* Comments - preserve or transform */
-    {
-        "comment_single",
-        "^[[:space:]]*//(.*)$",
-        "/*\\1 */",
-        1000, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "comment_multi_start",
-        "^[[:space:]]*/\\*",
-        "/*",
-        1000, true, RIFT_MODE_CLASSICAL
-    },
-    {
-        "comment_multi_end",
-        "\\*/[[:space:]]*$",
-        "*/",
-        1000, true, RIFT_MODE_CLASSICAL
-    },
-    
-    /* End marker */
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
-/* ============================================================================
- * Language-Specific Transform Rules (non-C targets)
- * ============================================================================ */
-
-/* --- JavaScript / Node.js (node-riftlang) --- */
-static RiftTransformRule g_js_rules[] = {
-    { "js_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
-      "// RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
-    { "js_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
-      "// rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
-    { "js_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
-      "", 11, true, RIFT_MODE_CLASSICAL },
-    { "js_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-      "// type: \\1", 20, true, RIFT_MODE_CLASSICAL },
-    { "js_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
-      "", 21, true, RIFT_MODE_CLASSICAL },
-    { "js_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
-      "let \\1 = \\2;", 30, true, RIFT_MODE_CLASSICAL },
-    { "js_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-      "// policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
-    { "js_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
-      "", 41, true, RIFT_MODE_CLASSICAL },
-    { "js_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
-      "rift.validate('\\1');", 42, true, RIFT_MODE_CLASSICAL },
-    { "js_while",     "^[[:space:]]*while[[:space:]]*\\(",
-      "while (", 100, true, RIFT_MODE_CLASSICAL },
-    { "js_if",        "^[[:space:]]*if[[:space:]]*\\(",
-      "if (", 100, true, RIFT_MODE_CLASSICAL },
-    { "js_for",       "^[[:space:]]*for[[:space:]]*\\(",
-      "for (", 100, true, RIFT_MODE_CLASSICAL },
-    { "js_block_open","^[[:space:]]*\\{",  "{",  200, true, RIFT_MODE_CLASSICAL },
-    { "js_block_close","^[[:space:]]*\\}", "}",  200, true, RIFT_MODE_CLASSICAL },
-    { "js_comment_sl","^[[:space:]]*//(.*)$", "//\\1", 1000, true, RIFT_MODE_CLASSICAL },
-    { "js_comment_ms","^[[:space:]]*/\\*",   "/*",   1000, true, RIFT_MODE_CLASSICAL },
-    { "js_comment_me","\\*/[[:space:]]*$",   "*/",   1000, true, RIFT_MODE_CLASSICAL },
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
-/* --- Python (pyriftlang) --- */
-static RiftTransformRule g_py_rules[] = {
-    { "py_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
-      "# RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
-    { "py_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
-      "# rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
-    { "py_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
-      "", 11, true, RIFT_MODE_CLASSICAL },
-    { "py_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-      "# type: \\1", 20, true, RIFT_MODE_CLASSICAL },
-    { "py_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
-      "", 21, true, RIFT_MODE_CLASSICAL },
-    { "py_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
-      "\\1 = \\2", 30, true, RIFT_MODE_CLASSICAL },
-    { "py_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-      "# policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
-    { "py_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
-      "", 41, true, RIFT_MODE_CLASSICAL },
-    { "py_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
-      "rift.validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
-    { "py_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
-      "while \\1:", 100, true, RIFT_MODE_CLASSICAL },
-    { "py_if",        "^[[:space:]]*if[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
-      "if \\1:", 100, true, RIFT_MODE_CLASSICAL },
-    { "py_block_close","^[[:space:]]*\\}", "", 200, true, RIFT_MODE_CLASSICAL },
-    { "py_comment_sl","^[[:space:]]*//(.*)$", "#\\1", 1000, true, RIFT_MODE_CLASSICAL },
-    { "py_comment_ms","^[[:space:]]*/\\*",    "\"\"\"", 1000, true, RIFT_MODE_CLASSICAL },
-    { "py_comment_me","\\*/[[:space:]]*$",    "\"\"\"", 1000, true, RIFT_MODE_CLASSICAL },
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
-/* --- Go (go-riftlang) --- */
-static RiftTransformRule g_go_rules[] = {
-    { "go_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
-      "// RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
-    { "go_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
-      "// rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
-    { "go_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
-      "", 11, true, RIFT_MODE_CLASSICAL },
-    { "go_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-      "type \\1 struct {", 20, true, RIFT_MODE_CLASSICAL },
-    { "go_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*INT",
-      "\\1 int32", 21, true, RIFT_MODE_CLASSICAL },
-    { "go_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
-      "\\1 := \\2", 30, true, RIFT_MODE_CLASSICAL },
-    { "go_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-      "// policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
-    { "go_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
-      "", 41, true, RIFT_MODE_CLASSICAL },
-    { "go_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
-      "rift.Validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
-    { "go_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
-      "for \\1 {", 100, true, RIFT_MODE_CLASSICAL },
-    { "go_if",        "^[[:space:]]*if[[:space:]]*\\(",
-      "if (", 100, true, RIFT_MODE_CLASSICAL },
-    { "go_for",       "^[[:space:]]*for[[:space:]]*\\(",
-      "for (", 100, true, RIFT_MODE_CLASSICAL },
-    { "go_block_open","^[[:space:]]*\\{",   "{", 200, true, RIFT_MODE_CLASSICAL },
-    { "go_block_close","^[[:space:]]*\\}",  "}", 200, true, RIFT_MODE_CLASSICAL },
-    { "go_comment_sl","^[[:space:]]*//(.*)$","//\\1", 1000, true, RIFT_MODE_CLASSICAL },
-    { "go_comment_ms","^[[:space:]]*/\\*",   "/*",   1000, true, RIFT_MODE_CLASSICAL },
-    { "go_comment_me","\\*/[[:space:]]*$",   "*/",   1000, true, RIFT_MODE_CLASSICAL },
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
-/* --- Lua (lua-riftlang) --- */
-static RiftTransformRule g_lua_rules[] = {
-    { "lua_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
-      "-- RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
-    { "lua_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
-      "-- rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
-    { "lua_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
-      "", 11, true, RIFT_MODE_CLASSICAL },
-    { "lua_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-      "-- type: \\1", 20, true, RIFT_MODE_CLASSICAL },
-    { "lua_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
-      "", 21, true, RIFT_MODE_CLASSICAL },
-    { "lua_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
-      "local \\1 = \\2", 30, true, RIFT_MODE_CLASSICAL },
-    { "lua_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-      "-- policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
-    { "lua_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
-      "", 41, true, RIFT_MODE_CLASSICAL },
-    { "lua_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
-      "rift.validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
-    { "lua_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
-      "while \\1 do", 100, true, RIFT_MODE_CLASSICAL },
-    { "lua_if",        "^[[:space:]]*if[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
-      "if \\1 then", 100, true, RIFT_MODE_CLASSICAL },
-    { "lua_block_open","^[[:space:]]*\\{",  "", 200, true, RIFT_MODE_CLASSICAL },
-    { "lua_block_close","^[[:space:]]*\\}", "end", 200, true, RIFT_MODE_CLASSICAL },
-    { "lua_comment_sl","^[[:space:]]*//(.*)$","--\\1", 1000, true, RIFT_MODE_CLASSICAL },
-    { "lua_comment_ms","^[[:space:]]*/\\*",   "--[[", 1000, true, RIFT_MODE_CLASSICAL },
-    { "lua_comment_me","\\*/[[:space:]]*$",   "]]",   1000, true, RIFT_MODE_CLASSICAL },
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
-/* --- WebAssembly Text (wat2wasm) --- */
-static RiftTransformRule g_wat_rules[] = {
-    { "wat_govern",   "^[[:space:]]*!govern[[:space:]]+[a-z]+",
-      ";; RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
-    { "wat_span",     "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
-      ";; rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
-    { "wat_span_attr","^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
-      "", 11, true, RIFT_MODE_CLASSICAL },
-    { "wat_type_def", "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
-      ";; type: \\1", 20, true, RIFT_MODE_CLASSICAL },
-    { "wat_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
-      "", 21, true, RIFT_MODE_CLASSICAL },
-    { "wat_assign_i", "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([0-9]+)",
-      "(local.set $\\1 (i32.const \\2))", 30, true, RIFT_MODE_CLASSICAL },
-    { "wat_policy",   "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
-      ";; policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
-    { "wat_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
-      "", 41, true, RIFT_MODE_CLASSICAL },
-    { "wat_validate", "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
-      "(call $rift_validate)", 42, true, RIFT_MODE_CLASSICAL },
-    { "wat_while",    "^[[:space:]]*while[[:space:]]*\\([^)]+\\)[[:space:]]*\\{",
-      "(block (loop", 100, true, RIFT_MODE_CLASSICAL },
-    { "wat_block_close","^[[:space:]]*\\}", "))", 200, true, RIFT_MODE_CLASSICAL },
-    { "wat_comment_sl","^[[:space:]]*//(.*)$",";; \\1", 1000, true, RIFT_MODE_CLASSICAL },
-    { "wat_comment_ms","^[[:space:]]*/\\*",   ";; ",   1000, true, RIFT_MODE_CLASSICAL },
-    { "wat_comment_me","\\*/[[:space:]]*$",   "",      1000, true, RIFT_MODE_CLASSICAL },
-    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
-};
-
 /* ============================================================================
  * Command Line Interface
  * ============================================================================ */
 
 static void print_banner(void) {
-    printf("╔══════════════════════════════════════════════════════════════════╗\n");
-    printf("║  RIFTLang Compiler v%-8s - Constitutional Computing      ║\n", RIFT_VERSION);
-    printf("║  Build: %-10s - OBINexus Framework                      ║\n", RIFT_BUILD_DATE);
-    printf("╚══════════════════════════════════════════════════════════════════╝\n");
-    printf("\n");
+    fprintf(CLI_OUT, "╔══════════════════════════════════════════════════════════════════╗\n");
+    fprintf(CLI_OUT, "║  RIFTLang Compiler v%-8s - Constitutional Computing      ║\n", RIFT_VERSION);
+    fprintf(CLI_OUT, "║  Build: %-10s - OBINexus Framework                      ║\n", RIFT_BUILD_DATE);
+    fprintf(CLI_OUT, "╚══════════════════════════════════════════════════════════════════╝\n");
+    fprintf(CLI_OUT, "\n");
 }
 
 static void print_usage(const char* program) {
     print_banner();
     printf("Usage: %s [options] <input.rift>\n", program);
     printf("\nOptions:\n");
-    printf("  -o, --output <file>       Output file (default: input.c)\n");
+    printf("  -o, --output <file>       Output file (default: input.c); repeat\n");
+    printf("                            to emit several targets from one link\n");
+    printf("  --targets <list>          Emit each of js,py,go,lua,wat beside the\n");
+    printf("                            input (or the -o stem) from one link\n");
     printf("  -m, --mode <mode>         Execution mode:\n");
     printf("                            classical | quantum | hybrid (default: classical)\n");
     printf("  -t, --threshold <val>     Policy validation threshold 0.0-1.0 (default: 0.85)\n");
@@ -501,6 +165,27 @@ static void print_usage(const char* program) {
     printf("  --emit-ast-binary         Emit .rift.astb binary file\n");
     printf("  --dry-run                 Parse only, no output generation\n");
     printf("  -O<level>                 Optimization level (0-3, default: 1)\n");
+    printf("  --rule-image <file>       Load precompiled transform rules\n");
+    printf("                            (or set RIFTLANG_RULE_IMAGE)\n");
+    printf("  --emit-rule-image <file>  Write transform rules for --mode and exit\n");
+    printf("  --cir-cache <dir>         Reuse linked CIR across runs and targets\n");
+    printf("                            (or set RIFTLANG_CIR_CACHE)\n");
+    printf("  --cir-cache-limit <MiB>   Evict least recently used entries above\n");
+    printf("                            this size (default: 64)\n");
+    printf("  --build-cache <dir>       Reuse executables built from unchanged C\n");
+    printf("                            (or set RIFTLANG_BUILD_CACHE)\n");
+    printf("  --build-cache-limit <MiB> Build cache size bound (default: 256)\n");
+    printf("  --daemon <socket>         Serve compile requests on a Unix socket\n");
+    printf("                            with the transform rules kept compiled\n");
+    printf("  --connect <socket>        Forward this compile to a daemon (or set\n");
+    printf("                            RIFTLANG_DAEMON); compiles locally if none\n");
+    printf("  --batch                   Compile every input (files, directories of\n");
+    printf("                            .rift files, or quoted globs) in parallel\n");
+    printf("  -j, --jobs <n>            --batch worker threads (default: one per CPU)\n");
+    printf("  --watch                   After building, rebuild each input when it\n");
+    printf("                            is saved, keeping rules and caches loaded;\n");
+    printf("                            with --batch, new .rift files in directory\n");
+    printf("                            inputs are built too (globs: matched once)\n");
     printf("  -v, --verbose             Verbose output\n");
     printf("  -q, --quiet               Suppress non-error output\n");
     printf("  -h, --help                Show this help message\n");
@@ -512,11 +197,100 @@ static void print_usage(const char* program) {
     printf("  %s counter.rift -o counter.go         # Go (go-riftlang)\n", program);
     printf("  %s counter.rift -o counter.lua        # Lua (lua-riftlang)\n", program);
     printf("  %s counter.rift -o counter.wat        # WebAssembly (wat2wasm)\n", program);
+    printf("  %s counter.rift --targets js,py,go,lua,wat\n", program);
+    printf("  %s --batch -c -j8 src/ --targets js,py   # Whole tree, 8 workers\n", program);
+    printf("  %s --watch -c --batch src/ --targets js  # Rebuild on save\n", program);
     printf("  %s -a --emit-ast-json test.rift       # Show AST + emit JSON\n", program);
+    printf("  %s -m hybrid --emit-rule-image hybrid.rimg\n", program);
+    printf("  %s -m hybrid --rule-image hybrid.rimg algo.rift\n", program);
+    printf("  %s --daemon /tmp/riftlang.sock &\n", program);
+    printf("  %s --connect /tmp/riftlang.sock counter.rift -o counter.js\n", program);
     printf("\nOutput target is auto-detected from the output file extension.\n");
     printf("Constitutional Computing: Respect the scope. Respect the architecture.\n");
 }
 
+/**
+ * Turn --targets js,py,... into output files named after the -o stem (at
+ * most one -o) or the input file, replacing any -o given.
+ */
+static bool expand_targets(RiftCliOptions* opts) {
+    if (opts->output_count > 1) {
+        fprintf(CLI_ERR, "Error: --targets takes at most one -o (the output stem)\n");
+        return false;
+    }
+    if (!opts->input_file) {
+        fprintf(CLI_ERR, "Error: --targets requires an input file\n");
+        return false;
+    }
+
+    /* Stem: the path without its extension (a '.' after the last '/') */
+    const char* stem = opts->output_count ? opts->output_files[0] : opts->input_file;
+    size_t stem_len = strlen(stem);
+    const char* dot = strrchr(stem, '.');
+    const char* slash = strrchr(stem, '/');
+    if (dot && (!slash || dot > slash)) stem_len = (size_t)(dot - stem);
+
+    int count = 0;
+    const char* p = opts->targets;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > 0) {
+            if (count == RIFT_MAX_OUTPUTS) {
+                fprintf(CLI_ERR, "Error: At most %d outputs per invocation\n", RIFT_MAX_OUTPUTS);
+                return false;
+            }
+            char* name = opts->target_files[count];
+            int n = snprintf(name, RIFT_MAX_PATH, "%.*s.%.*s", (int)stem_len, stem, (int)len, p);
+            if (n < 0 || n >= RIFT_MAX_PATH) {
+                fprintf(CLI_ERR, "Error: Output name too long for target '%.*s'\n", (int)len, p);
+                return false;
+            }
+            if (rift_detect_target(name) == RIFT_TARGET_C) {
+                fprintf(CLI_ERR, "Error: Unknown target '%.*s' (use js, py, go, lua, wat)\n",
+                    (int)len, p);
+                return false;
+            }
+            opts->output_files[count++] = name;
+        }
+        p += len;
+        if (*p == ',') p++;
+    }
+    if (count == 0) {
+        fprintf(CLI_ERR, "Error: --targets list is empty\n");
+        return false;
+    }
+    opts->output_count = count;
+    opts->output_file = opts->output_files[0];
+    return true;
+}
+
+/**
+ * True if two output paths name one file: the same file if both exist,
+ * else the same name in the same directory however either is spelled.
+ */
+static bool outputs_same_file(const char* a, const char* b) {
+    if (strcmp(a, b) == 0) return true;
+#ifndef _WIN32
+    struct stat sa, sb;
+    if (stat(a, &sa) == 0 && stat(b, &sb) == 0) {
+        return sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+    }
+
+    const char* base_a = strrchr(a, '/');
+    const char* base_b = strrchr(b, '/');
+    if (strcmp(base_a ? base_a + 1 : a, base_b ? base_b + 1 : b) != 0) return false;
+
+    char dir_a[RIFT_MAX_PATH], dir_b[RIFT_MAX_PATH];
+    snprintf(dir_a, sizeof(dir_a), "%.*s", base_a ? (int)(base_a - a) + 1 : 1, base_a ? a : ".");
+    snprintf(dir_b, sizeof(dir_b), "%.*s", base_b ? (int)(base_b - b) + 1 : 1, base_b ? b : ".");
+    return stat(dir_a, &sa) == 0 && stat(dir_b, &sb) == 0 &&
+           sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+#else
+    return false;
+#endif
+}
+
 static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
     memset(opts, 0, sizeof(RiftCliOptions));
     opts->mode = RIFT_MODE_CLASSICAL;
@@ -525,6 +299,7 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
     opts->preserve_comments = true;
 
     int positional_count = 0;
+    int named_outputs = 0;          /* -o given, as opposed to a positional output */
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
@@ -566,7 +341,13 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
         }
         else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
             if (i + 1 < argc) {
-                opts->output_file = argv[++i];
+                if (opts->output_count == RIFT_MAX_OUTPUTS) {
+                    fprintf(stderr, "Error: At most %d outputs per invocation\n", RIFT_MAX_OUTPUTS);
+                    return false;
+                }
+                opts->output_files[opts->output_count++] = argv[++i];
+                opts->output_file = opts->output_files[0];
+                named_outputs++;
             } else {
                 fprintf(stderr, "Error: -o requires an argument\n");
                 return false;
@@ -590,6 +371,114 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
                 return false;
             }
         }
+        else if (strcmp(argv[i], "--rule-image") == 0) {
+            if (i + 1 < argc) {
+                opts->rule_image = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --rule-image requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--emit-rule-image") == 0) {
+            if (i + 1 < argc) {
+                opts->emit_rule_image = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --emit-rule-image requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--targets") == 0) {
+            if (i + 1 < argc) {
+                opts->targets = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --targets requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--cir-cache") == 0) {
+            if (i + 1 < argc) {
+                opts->cir_cache = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --cir-cache requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--cir-cache-limit") == 0) {
+            if (i + 1 < argc) {
+                char* end = NULL;
+                unsigned long long mib = strtoull(argv[++i], &end, 10);
+                if (!end || *end != '\0' || mib == 0 || mib > (UINT64_MAX >> 20)) {
+                    fprintf(stderr, "Error: Invalid cache limit '%s'\n", argv[i]);
+                    return false;
+                }
+                opts->cir_cache_limit = (uint64_t)mib << 20;
+            } else {
+                fprintf(stderr, "Error: --cir-cache-limit requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--build-cache") == 0) {
+            if (i + 1 < argc) {
+                opts->build_cache = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --build-cache requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--build-cache-limit") == 0) {
+            if (i + 1 < argc) {
+                char* end = NULL;
+                unsigned long long mib = strtoull(argv[++i], &end, 10);
+                if (!end || *end != '\0' || mib == 0 || mib > (UINT64_MAX >> 20)) {
+                    fprintf(stderr, "Error: Invalid cache limit '%s'\n", argv[i]);
+                    return false;
+                }
+                opts->build_cache_limit = (uint64_t)mib << 20;
+            } else {
+                fprintf(stderr, "Error: --build-cache-limit requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--daemon") == 0) {
+            if (i + 1 < argc) {
+                opts->daemon_socket = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --daemon requires an argument\n");
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--batch") == 0) {
+            opts->batch = true;
+        }
+        else if (strcmp(argv[i], "--watch") == 0) {
+            opts->watch = true;
+        }
+        else if (strncmp(argv[i], "-j", 2) == 0 || strcmp(argv[i], "--jobs") == 0) {
+            const char* value = NULL;
+            if (argv[i][1] == 'j' && argv[i][2] != '\0') {
+                value = argv[i] + 2;            /* -j8 */
+            } else if (i + 1 < argc) {
+                value = argv[++i];
+            } else {
+                fprintf(stderr, "Error: %s requires an argument\n", argv[i]);
+                return false;
+            }
+            char* end = NULL;
+            long jobs = strtol(value, &end, 10);
+            if (!end || *end != '\0' || jobs < 1 || jobs > RIFT_BATCH_MAX_WORKERS) {
+                fprintf(stderr, "Error: Jobs must be between 1 and %d\n", RIFT_BATCH_MAX_WORKERS);
+                return false;
+            }
+            opts->jobs = (int)jobs;
+        }
+        else if (strcmp(argv[i], "--connect") == 0) {
+            if (i + 1 < argc) {
+                opts->connect_socket = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --connect requires an argument\n");
+                return false;
+            }
+        }
         else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threshold") == 0) {
             if (i + 1 < argc) {
                 opts->policy_threshold = atof(argv[++i]);
@@ -603,9 +492,18 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
             }
         }
         else if (argv[i][0] != '-') {
+            if (!opts->inputs) {
+                opts->inputs = (const char**)calloc((size_t)argc, sizeof(const char*));
+                if (!opts->inputs) {
+                    fprintf(stderr, "Error: Out of memory\n");
+                    return false;
+                }
+            }
+            opts->inputs[opts->input_count++] = argv[i];
             if (positional_count == 0) {
                 opts->input_file = argv[i];
             } else if (positional_count == 1 && !opts->output_file) {
+                opts->output_files[opts->output_count++] = argv[i];
                 opts->output_file = argv[i];
             }
             positional_count++;
@@ -616,11 +514,47 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
         }
     }
     
-    if (!opts->input_file) {
+    if (!opts->rule_image) {
+        opts->rule_image = getenv("RIFTLANG_RULE_IMAGE");
+    }
+    if (!opts->cir_cache) {
+        opts->cir_cache = getenv("RIFTLANG_CIR_CACHE");
+    }
+    if (!opts->build_cache) {
+        opts->build_cache = getenv("RIFTLANG_BUILD_CACHE");
+    }
+    
+    if (!opts->input_file && !opts->emit_rule_image && !opts->daemon_socket) {
         fprintf(stderr, "Error: No input file specified\n");
         return false;
     }
     
+    /* Batch outputs are named per input: beside it, or by --targets */
+    if (opts->batch) {
+        if (named_outputs > 0) {
+            fprintf(stderr, "Error: --batch names outputs after each input; "
+                "use --targets instead of -o\n");
+            return false;
+        }
+        opts->output_count = 0;
+        opts->output_file = NULL;
+        return true;
+    }
+    
+    if (opts->targets && !expand_targets(opts)) {
+        return false;
+    }
+    
+    /* Outputs are written concurrently: two jobs must not share a file */
+    for (int a = 0; a < opts->output_count; a++) {
+        for (int b = a + 1; b < opts->output_count; b++) {
+            if (outputs_same_file(opts->output_files[a], opts->output_files[b])) {
+                fprintf(stderr, "Error: Output '%s' given twice\n", opts->output_files[a]);
+                return false;
+            }
+        }
+    }
+    
     return true;
 }
 
@@ -628,50 +562,22 @@ static bool parse_args(int argc, char* argv[], RiftCliOptions* opts) {
  * File Operations
  * ============================================================================ */
 
-static char* read_file(const char* filename, size_t* size) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s': %s\n", filename, strerror(errno));
-        return NULL;
-    }
-    
-    fseek(file, 0, SEEK_END);
-    *size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    char* content = (char*)malloc(*size + 1);
-    if (!content) {
-        fclose(file);
-        return NULL;
-    }
-    
-    size_t read = fread(content, 1, *size, file);
-    content[read] = '\0';
-    fclose(file);
-    
-    if (read != *size) {
-        fprintf(stderr, "Warning: Read %zu bytes, expected %zu\n", read, *size);
+/* Regular files are mapped rather than copied; see rift_source_file_open */
+static bool read_file(const char* filename, RiftSourceFile* source) {
+    if (!rift_source_file_open(source, filename)) {
+        fprintf(CLI_ERR, "Error: Cannot open file '%s': %s\n", filename, strerror(errno));
+        return false;
     }
-    
-    *size = read;
-    return content;
+    return true;
 }
 
+/* An output already holding content keeps its mtime; see rift_write_if_changed */
 static bool write_file(const char* filename, const char* content, size_t size) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot create file '%s': %s\n", filename, strerror(errno));
-        return false;
-    }
-    
-    size_t written = fwrite(content, 1, size, file);
-    fclose(file);
-    
-    if (written != size) {
-        fprintf(stderr, "Error: Wrote %zu bytes, expected %zu\n", written, size);
+    int error = rift_write_if_changed(filename, content, size, false);
+    if (error) {
+        fprintf(CLI_ERR, "Error: Cannot write file '%s': %s\n", filename, strerror(error));
         return false;
     }
-    
     return true;
 }
 
@@ -684,6 +590,142 @@ static bool file_exists(const char* filename) {
     return false;
 }
 
+/* ============================================================================
+ * Build Identity
+ * Everything besides the generated C that decides what gcc produces, as
+ * one string for the build cache. Files are identified by size, mtime and
+ * inode: reinstalling the compiler or rebuilding the runtime library
+ * changes the identity without hashing either. Headers are resolved the
+ * way gcc searches for them, so a header that starts shadowing another
+ * changes the identity too.
+ * ============================================================================ */
+
+/* Read by gcc or the linker; each changes the output for the same command line */
+static const char* const k_build_env[] = {
+    "CPATH", "C_INCLUDE_PATH", "LIBRARY_PATH", "GCC_EXEC_PREFIX", "COMPILER_PATH", NULL
+};
+
+/* What riftlang.h includes, then what the generated C adds to it */
+static const char* const k_build_headers[] = {
+    "stdint.h", "stdbool.h", "stddef.h", "stdio.h", "stdlib.h", "math.h", NULL
+};
+
+/* Append " label=size:mtime:inode" for path, or " label=-" if absent */
+static bool build_identity_add_file(char* buf, size_t size, const char* label, const char* path) {
+    size_t used = strlen(buf);
+    struct stat st;
+    int n;
+    if (!path || stat(path, &st) != 0) {
+        n = snprintf(buf + used, size - used, " %s=-", label);
+    } else {
+#ifndef _WIN32
+        long long mtime_ns = (long long)st.st_mtim.tv_nsec;
+#else
+        long long mtime_ns = 0;
+#endif
+        n = snprintf(buf + used, size - used, " %s=%lld:%lld.%09lld:%llu", label,
+            (long long)st.st_size, (long long)st.st_mtime, mtime_ns,
+            (unsigned long long)st.st_ino);
+    }
+    return n > 0 && (size_t)n < size - used;
+}
+
+/* The file the first word of cc runs, searched on PATH like the shell does */
+static bool build_resolve_compiler(const char* cc, char* path, size_t size) {
+    size_t len = strcspn(cc, " \t");
+    if (len == 0 || len >= size) return false;
+    if (memchr(cc, '/', len)) {
+        memcpy(path, cc, len);
+        path[len] = '\0';
+        return true;
+    }
+    const char* dirs = getenv("PATH");
+    while (dirs && *dirs) {
+        size_t dir_len = strcspn(dirs, ":");
+        int n = snprintf(path, size, "%.*s/%.*s",
+            (int)dir_len, dir_len ? dirs : ".", (int)len, cc);
+        struct stat st;
+        if (n > 0 && (size_t)n < size && stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            return true;
+        }
+        dirs += dir_len;
+        if (*dirs == ':') dirs++;
+    }
+    return false;
+}
+
+/* name in dir, if it is a regular file there */
+static bool build_find_in(const char* dir, size_t dir_len, const char* name,
+                          char* path, size_t size) {
+    struct stat st;
+    int n = snprintf(path, size, "%.*s/%s", (int)dir_len, dir_len ? dir : ".", name);
+    return n > 0 && (size_t)n < size && stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+/* name along a colon-separated list; an empty entry is the current directory */
+static bool build_find_on(const char* dirs, const char* name, char* path, size_t size) {
+    while (dirs) {
+        size_t dir_len = strcspn(dirs, ":");
+        if (build_find_in(dirs, dir_len, name, path, size)) return true;
+        dirs = dirs[dir_len] ? dirs + dir_len + 1 : NULL;
+    }
+    return false;
+}
+
+/**
+ * The header gcc would open for #include "name" in source (quoted) or
+ * #include <name>: the source's directory (quoted only), -I., CPATH,
+ * C_INCLUDE_PATH, then the system directories. Headers found nowhere on
+ * that list ship with the compiler and change with cc-bin.
+ */
+static bool build_resolve_header(const char* source, bool quoted, const char* name,
+                                 char* path, size_t size) {
+    if (quoted) {
+        const char* slash = strrchr(source, '/');
+        size_t dir_len = slash ? (size_t)(slash - source) : 0;
+        if (build_find_in(slash == source ? "/" : source, slash == source ? 1 : dir_len,
+                          name, path, size)) {
+            return true;
+        }
+    }
+    return build_find_in(".", 1, name, path, size) ||
+           build_find_on(getenv("CPATH"), name, path, size) ||
+           build_find_on(getenv("C_INCLUDE_PATH"), name, path, size) ||
+           build_find_in("/usr/local/include", 18, name, path, size) ||
+           build_find_in("/usr/include", 12, name, path, size);
+}
+
+/* False if the identity did not fit; such a build must not be cached */
+static bool build_cache_identity(const char* cc, const char* flags, const char* source,
+                                 char* buf, size_t size) {
+    int n = snprintf(buf, size, "riftlang=%s cc=%s flags=%s", RIFT_VERSION, cc, flags);
+    if (n <= 0 || (size_t)n >= size) return false;
+
+    for (int i = 0; k_build_env[i]; i++) {
+        const char* value = getenv(k_build_env[i]);
+        if (!value) continue;
+        size_t used = strlen(buf);
+        n = snprintf(buf + used, size - used, " %s=%s", k_build_env[i], value);
+        if (n <= 0 || (size_t)n >= size - used) return false;
+    }
+
+    char path[4096];
+    bool found = build_resolve_compiler(cc, path, sizeof(path));
+    if (!build_identity_add_file(buf, size, "cc-bin", found ? path : NULL)) return false;
+
+    found = build_resolve_header(source, true, "riftlang.h", path, sizeof(path));
+    if (!build_identity_add_file(buf, size, "riftlang.h", found ? path : NULL)) return false;
+    for (int i = 0; k_build_headers[i]; i++) {
+        found = build_resolve_header(source, false, k_build_headers[i], path, sizeof(path));
+        if (!build_identity_add_file(buf, size, k_build_headers[i], found ? path : NULL)) {
+            return false;
+        }
+    }
+
+    return build_identity_add_file(buf, size, "libriftlang.so", "./bin/libriftlang.so") &&
+           build_identity_add_file(buf, size, "libriftlang.a", "./bin/libriftlang.a");
+}
+
 /* ============================================================================
  * Pattern Engine Initialization
  * ============================================================================ */
@@ -691,12 +733,12 @@ static bool file_exists(const char* filename) {
 static RiftPatternEngine* initialize_transform_engine(RiftExecutionMode mode, bool verbose) {
     RiftPatternEngine* engine = rift_pattern_engine_create(mode);
     if (!engine) {
-        fprintf(stderr, "Error: Failed to create pattern engine\n");
+        fprintf(CLI_ERR, "Error: Failed to create pattern engine\n");
         return NULL;
     }
     
     if (verbose) {
-        printf("[RIFTLang] Initializing pattern engine for %s mode\n",
+        fprintf(CLI_OUT, "[RIFTLang] Initializing pattern engine for %s mode\n",
             mode == RIFT_MODE_CLASSICAL ? "classical" :
             mode == RIFT_MODE_QUANTUM ? "quantum" : "hybrid");
     }
@@ -722,103 +764,146 @@ static RiftPatternEngine* initialize_transform_engine(RiftExecutionMode mode, bo
         if (added) {
             rules_added++;
             if (verbose) {
-                printf("[RIFTLang] Registered rule: %s (priority %d)\n", 
+                fprintf(CLI_OUT, "[RIFTLang] Registered rule: %s (priority %d)\n", 
                     rule->name, rule->priority);
             }
         } else {
-            fprintf(stderr, "Warning: Failed to register rule '%s'\n", rule->name);
+            fprintf(CLI_ERR, "Warning: Failed to register rule '%s'\n", rule->name);
         }
     }
     
     if (!rift_pattern_engine_compile(engine)) {
-        fprintf(stderr, "Error: Failed to compile pattern engine\n");
+        fprintf(CLI_ERR, "Error: Failed to compile pattern engine\n");
+        rift_pattern_engine_destroy(engine);
+        return NULL;
+    }
+    
+    /* Rule table is fixed from here on: freeze for lock-free matching */
+    if (!rift_pattern_engine_seal(engine)) {
+        fprintf(CLI_ERR, "Error: Failed to seal pattern engine\n");
         rift_pattern_engine_destroy(engine);
         return NULL;
     }
     
     if (verbose) {
-        printf("[RIFTLang] Pattern engine ready: %d rules active\n", rules_added);
+        fprintf(CLI_OUT, "[RIFTLang] Pattern engine ready: %d rules active\n", rules_added);
     }
     
     return engine;
 }
 
-/* ============================================================================
- * Source Transformation
- * ============================================================================ */
+/**
+ * True if a loaded rule image holds exactly the rules
+ * initialize_transform_engine would register for this mode: same
+ * patterns, priorities and literal flags, in the same order
+ */
+static bool rule_image_is_current(RiftPatternEngine* engine, RiftExecutionMode mode) {
+    if (engine->mode != mode) return false;
+    
+    uint32_t index = 0;
+    for (int i = 0; g_transform_rules[i].name != NULL; i++) {
+        RiftTransformRule* rule = &g_transform_rules[i];
+        if (mode != RIFT_MODE_HYBRID && rule->applicable_mode != mode) {
+            continue;
+        }
+        if (index >= engine->pair_count) return false;
+        RiftBipartitePair* pair = engine->pairs[index++];
+        if (pair->left->priority != rule->priority ||
+            strcmp(pair->left->pattern_str, rule->left_pattern) != 0 ||
+            strcmp(pair->right->pattern_str, rule->right_template) != 0 ||
+            pair->right->is_literal !=
+                rift_pattern_right_is_literal(rule->right_template, rule->right_is_literal)) {
+            return false;
+        }
+    }
+    return index == engine->pair_count;
+}
 
-typedef struct {
-    char* output;
-    size_t output_size;
-    size_t output_capacity;
-    uint32_t lines_processed;
-    uint32_t patterns_matched;
-    uint32_t patterns_failed;
-    double processing_time_ms;
-} TransformResult;
+/* One sealed engine per mode, compiled by --daemon before it serves */
+static RiftPatternEngine* g_resident_engines[3];
 
-static const char* trim_left(const char* s) {
-    while (*s == ' ' || *s == '\t' || *s == '\r') s++;
-    return s;
+/**
+ * The daemon's resident engine for the mode if there is one; else the
+ * engine from the rule image when one is configured and still matches
+ * the built-in rules; otherwise compiled from g_transform_rules.
+ */
+static RiftPatternEngine* load_transform_engine(const RiftCliOptions* opts) {
+    if (g_resident_engines[opts->mode]) {
+        if (opts->verbose) {
+            fprintf(CLI_OUT, "[RIFTLang] Using resident pattern engine: %u rules\n",
+                g_resident_engines[opts->mode]->pair_count);
+        }
+        return g_resident_engines[opts->mode];
+    }
+    if (opts->rule_image) {
+        RiftPatternEngine* engine = rift_pattern_engine_load_image(opts->rule_image);
+        if (engine && rule_image_is_current(engine, opts->mode)) {
+            if (opts->verbose) {
+                fprintf(CLI_OUT, "[RIFTLang] Loaded rule image %s: %u rules\n",
+                    opts->rule_image, engine->pair_count);
+            }
+            return engine;
+        }
+        fprintf(CLI_ERR, "Warning: Rule image '%s' is %s; compiling rules\n",
+            opts->rule_image, engine ? "stale or for another mode" : "unreadable or invalid");
+        rift_pattern_engine_destroy(engine);
+    }
+    return initialize_transform_engine(opts->mode, opts->verbose);
 }
 
-static void trim_right(char* s) {
-    size_t len = strlen(s);
-    while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t' || s[len - 1] == '\r')) {
-        s[--len] = '\0';
+/* Counterpart of load_transform_engine: resident engines outlive a compile */
+static void release_transform_engine(RiftPatternEngine* engine) {
+    for (int mode = 0; mode < 3; mode++) {
+        if (engine == g_resident_engines[mode]) return;
     }
+    rift_pattern_engine_destroy(engine);
 }
 
+/* ============================================================================
+ * Source Transformation
+ * ============================================================================ */
+
 static bool starts_with(const char* s, const char* prefix) {
     return strncmp(s, prefix, strlen(prefix)) == 0;
 }
 
-static bool var_is_declared(char declared[][64], size_t count, const char* var) {
-    for (size_t i = 0; i < count; i++) {
-        if (strcmp(declared[i], var) == 0) {
-            return true;
-        }
+static bool slice_equals(RiftLineSlice s, const char* word) {
+    size_t len = strlen(word);
+    return s.len == len && memcmp(s.ptr, word, len) == 0;
+}
+
+
+/* transform_output_write, reporting failures on the CLI error stream */
+static bool write_transform_output(const char* filename, const TransformOutput* output) {
+    int error = transform_output_write(filename, output);
+    if (error) {
+        fprintf(CLI_ERR, "Error: Cannot write file '%s': %s\n", filename, strerror(error));
+        return false;
     }
-    return false;
+    return true;
 }
 
-static bool transform_append(TransformResult* result, const char* text) {
-    size_t len = strlen(text);
-    
-    if (result->output_size + len + 1 > result->output_capacity) {
-        size_t new_capacity = result->output_capacity == 0 ? 16384 : result->output_capacity * 2;
-        if (new_capacity < result->output_size + len + 1) {
-            new_capacity = result->output_size + len + 1;
-        }
-        
-        char* new_output = (char*)realloc(result->output, new_capacity);
-        if (!new_output) {
-            return false;
-        }
-        
-        result->output = new_output;
-        result->output_capacity = new_capacity;
-    }
-    
-    strcpy(result->output + result->output_size, text);
-    result->output_size += len;
-    
-    return true;
+static void transform_result_free(TransformResult* result) {
+    if (!result) return;
+    transform_output_free(&result->output);
+    free(result);
 }
 
 static TransformResult* transform_source(
     RiftPatternEngine* engine,
-    const char* source,
+    const RiftLineIndex* lines,
     RiftCliOptions* opts
 ) {
     TransformResult* result = (TransformResult*)calloc(1, sizeof(TransformResult));
     if (!result) return NULL;
     
     double start_time = rift_get_time_ms();
+
+    /* Size the first chunk for the whole output: source plus indentation */
+    transform_reserve(&result->output, lines->length + (size_t)lines->count * 8 + 2048);
     
     /* Add header comment */
-    char header[512];
-    snprintf(header, sizeof(header),
+    transform_appendf(result,
         "/* Generated by RIFTLang v%s - %s mode */\n"
         "/* Policy threshold: %.2f | Optimization: O%d */\n"
         "#include \"riftlang.h\"\n"
@@ -831,10 +916,9 @@ static TransformResult* transform_source(
         opts->policy_threshold,
         opts->optimization_level
     );
-    transform_append(result, header);
     
     /* Add policy context initialization */
-    transform_append(result, 
+    TRANSFORM_APPEND_LITERAL(result, 
         "/* Policy governance context */\n"
         "static RiftPolicyContext* g_policy_ctx = NULL;\n"
         "static RiftResultMatrix2x2* g_policy_matrix = NULL;\n\n"
@@ -842,29 +926,26 @@ static TransformResult* transform_source(
         "    g_policy_matrix = rift_result_matrix_create("
     );
     
-    char threshold_str[32];
-    snprintf(threshold_str, sizeof(threshold_str), "%.2f", opts->policy_threshold);
-    transform_append(result, threshold_str);
-    transform_append(result, 
+    transform_appendf(result, "%.2f", opts->policy_threshold);
+    TRANSFORM_APPEND_LITERAL(result, 
         ");\n"
         "    g_policy_ctx = rift_policy_context_create(\"rift_main\", "
     );
-    transform_append(result, threshold_str);
-    transform_append(result, 
+    transform_appendf(result, "%.2f", opts->policy_threshold);
+    TRANSFORM_APPEND_LITERAL(result, 
         ", true);\n"
         "    g_policy_ctx->result_matrix = g_policy_matrix;\n"
         "}\n\n"
     );
 
     /* Emit main() entry point */
-    transform_append(result,
+    TRANSFORM_APPEND_LITERAL(result,
         "int main(int argc, char* argv[]) {\n"
         "    (void)argc; (void)argv;\n"
         "    rift_init_policy();\n\n"
     );
 
-    /* Process line by line */
-    const char* line_start = source;
+    /* Process line by line over the shared index */
     uint32_t line_num = 0;
     bool in_align_span = false;
     bool in_type_block = false;
@@ -872,58 +953,54 @@ static TransformResult* transform_source(
     char span_macro[64] = "RIFT_SPAN_FIXED";
     int span_bytes = 4096;
     char current_type[64] = {0};
-    char declared_vars[256][64] = {{0}};
-    size_t declared_count = 0;
+    RiftStringSet declared_vars;
+    memset(&declared_vars, 0, sizeof(declared_vars));
     
-    while (*line_start) {
-        /* Find end of line */
-        const char* line_end = strchr(line_start, '\n');
-        if (!line_end) line_end = line_start + strlen(line_start);
-        
-        size_t line_len = line_end - line_start;
+    while (line_num < lines->count) {
+        size_t line_len = 0;
+        const char* line_start = riftlang_line_index_get(lines, line_num + 1, &line_len);
         
         /* Extract line (preserve original for comments) */
         char line[RIFT_MAX_LINE_LENGTH];
         if (line_len >= sizeof(line)) line_len = sizeof(line) - 1;
         strncpy(line, line_start, line_len);
         line[line_len] = '\0';
-        trim_right(line);
-        const char* trimmed = trim_left(line);
+
+        /* One classification, shared with the codec linker */
+        RiftLineClass c;
+        RiftLineKind kind = rift_line_classify(line, line_len, &c);
+        const char* trimmed = c.line.ptr;
+        size_t trimmed_len = c.line.len;
+        line_len = (size_t)(trimmed - line) + trimmed_len;
+        line[line_len] = '\0';
         
         line_num++;
         
         /* Skip empty lines but preserve them */
-        bool is_empty = (strspn(trimmed, " \t\r") == strlen(trimmed));
-        if (is_empty) {
-            transform_append(result, "\n");
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
+        if (kind == RIFT_LINE_EMPTY) {
+            TRANSFORM_APPEND_LITERAL(result, "\n");
             continue;
         }
 
         /* Preserve C-style comments as-is */
-        if (starts_with(trimmed, "/*") || starts_with(trimmed, "//")) {
-            transform_append(result, "    ");
-            transform_append(result, trimmed);
-            transform_append(result, "\n");
+        if (kind == RIFT_LINE_COMMENT) {
+            TRANSFORM_APPEND_LITERAL(result, "    ");
+            transform_append(result, trimmed, trimmed_len);
+            TRANSFORM_APPEND_LITERAL(result, "\n");
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Collapse align span block into a complete memory declaration */
-        if (!in_align_span && starts_with(trimmed, "align span<")) {
+        if (!in_align_span && kind == RIFT_LINE_SPAN) {
             in_align_span = true;
             span_bytes = 4096;
-            if (strstr(trimmed, "<fixed>")) strcpy(span_macro, "RIFT_SPAN_FIXED");
-            else if (strstr(trimmed, "<row>")) strcpy(span_macro, "RIFT_SPAN_ROW");
-            else if (strstr(trimmed, "<continuous>")) strcpy(span_macro, "RIFT_SPAN_CONTINUOUS");
-            else if (strstr(trimmed, "<superposed>")) strcpy(span_macro, "RIFT_SPAN_SUPERPOSED");
-            else if (strstr(trimmed, "<entangled>")) strcpy(span_macro, "RIFT_SPAN_ENTANGLED");
-
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
+            if (slice_equals(c.name, "fixed")) strcpy(span_macro, "RIFT_SPAN_FIXED");
+            else if (slice_equals(c.name, "row")) strcpy(span_macro, "RIFT_SPAN_ROW");
+            else if (slice_equals(c.name, "continuous")) strcpy(span_macro, "RIFT_SPAN_CONTINUOUS");
+            else if (slice_equals(c.name, "superposed")) strcpy(span_macro, "RIFT_SPAN_SUPERPOSED");
+            else if (slice_equals(c.name, "entangled")) strcpy(span_macro, "RIFT_SPAN_ENTANGLED");
+
             continue;
         }
 
@@ -933,62 +1010,55 @@ static TransformResult* transform_source(
                 span_bytes = parsed;
             }
             if (starts_with(trimmed, "}")) {
-                char mem_decl[160];
-                snprintf(mem_decl, sizeof(mem_decl), "    RIFT_DECLARE_MEMORY(span, %s, %d);\n", span_macro, span_bytes);
-                transform_append(result, mem_decl);
+                transform_appendf(result, "    RIFT_DECLARE_MEMORY(span, %s, %d);\n",
+                    span_macro, span_bytes);
                 result->patterns_matched++;
                 in_align_span = false;
             }
 
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Convert type blocks to C structs */
-        if (!in_type_block && starts_with(trimmed, "type ") && strchr(trimmed, '=')) {
-            if (sscanf(trimmed, "type %63s =", current_type) == 1) {
-                char* brace = strchr(current_type, '{');
-                if (brace) *brace = '\0';
-                transform_append(result, "    typedef struct {\n");
+        if (!in_type_block && kind == RIFT_LINE_TYPE) {
+            /* The struct tag is the first word of the name, up to any '{' */
+            size_t tn_len = 0;
+            while (tn_len < c.name.len && tn_len < sizeof(current_type) - 1 &&
+                   !isspace((unsigned char)c.name.ptr[tn_len]) && c.name.ptr[tn_len] != '{') {
+                tn_len++;
+            }
+            if (tn_len > 0) {
+                memcpy(current_type, c.name.ptr, tn_len);
+                current_type[tn_len] = '\0';
+                TRANSFORM_APPEND_LITERAL(result, "    typedef struct {\n");
                 in_type_block = true;
                 result->patterns_matched++;
-                line_start = line_end;
-                if (*line_start == '\n') line_start++;
                 continue;
             }
         }
 
         if (in_type_block) {
             if (starts_with(trimmed, "}")) {
-                char type_close[128];
-                snprintf(type_close, sizeof(type_close), "    } %s;\n", current_type);
-                transform_append(result, type_close);
+                transform_appendf(result, "    } %s;\n", current_type);
                 in_type_block = false;
             } else {
                 char field[64] = {0};
                 char rift_type[64] = {0};
                 if (sscanf(trimmed, "%63[^:]: %63[^,]", field, rift_type) == 2) {
                     const char* ctype = strcmp(rift_type, "FLOAT") == 0 ? "double" : "int32_t";
-                    char field_decl[160];
-                    snprintf(field_decl, sizeof(field_decl), "        %s %s;\n", ctype, field);
-                    transform_append(result, field_decl);
+                    transform_appendf(result, "        %s %s;\n", ctype, field);
                 }
             }
 
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Policy block is metadata; keep as comments */
-        if (!in_policy_block && starts_with(trimmed, "policy_fn on ")) {
+        if (!in_policy_block && kind == RIFT_LINE_POLICY) {
             in_policy_block = true;
-            transform_append(result, "    /* policy_fn block omitted in C output */\n");
+            TRANSFORM_APPEND_LITERAL(result, "    /* policy_fn block omitted in C output */\n");
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
@@ -996,102 +1066,88 @@ static TransformResult* transform_source(
             if (starts_with(trimmed, "}")) {
                 in_policy_block = false;
             }
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Handle validation call with initialized matrix variable */
-        if (starts_with(trimmed, "validate(")) {
-            transform_append(result, "    (void)rift_policy_validate(g_policy_matrix, true, true);\n");
+        if (kind == RIFT_LINE_VALIDATE) {
+            TRANSFORM_APPEND_LITERAL(result, "    (void)rift_policy_validate(g_policy_matrix, true, true);\n");
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Preserve control flow / block delimiters */
-        if (starts_with(trimmed, "while ") || starts_with(trimmed, "if ") || starts_with(trimmed, "for ") ||
-            strcmp(trimmed, "{") == 0 || strcmp(trimmed, "}") == 0 || strcmp(trimmed, "}") == 0 ||
-            starts_with(trimmed, "} else")) {
-            transform_append(result, "    ");
-            transform_append(result, trimmed);
-            transform_append(result, "\n");
+        if (kind == RIFT_LINE_WHILE || kind == RIFT_LINE_IF || kind == RIFT_LINE_FOR ||
+            kind == RIFT_LINE_ELSE || kind == RIFT_LINE_BLOCK_OPEN || kind == RIFT_LINE_BLOCK_CLOSE) {
+            TRANSFORM_APPEND_LITERAL(result, "    ");
+            transform_append(result, trimmed, trimmed_len);
+            TRANSFORM_APPEND_LITERAL(result, "\n");
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
 
         /* Convert ':=' assignments to valid C statements with first-use declaration */
-        const char* assign = strstr(trimmed, ":=");
-        if (assign) {
-            char var_name[64] = {0};
-            char expr[512] = {0};
-            size_t var_len = (size_t)(assign - trimmed);
-            if (var_len >= sizeof(var_name)) var_len = sizeof(var_name) - 1;
-            strncpy(var_name, trimmed, var_len);
-            var_name[var_len] = '\0';
-            strncpy(expr, assign + 2, sizeof(expr) - 1);
-            trim_right(var_name);
-            trim_right(expr);
-            const char* expr_trimmed = trim_left(expr);
-
-            char statement[700];
-            if (!var_is_declared(declared_vars, declared_count, var_name) && declared_count < 256) {
-                strcpy(declared_vars[declared_count++], var_name);
-                snprintf(statement, sizeof(statement), "    int %s = %s;\n", var_name, expr_trimmed);
+        if (kind == RIFT_LINE_ASSIGN) {
+            /* Name and expression are views into line, bounded as the
+             * old fixed buffers were */
+            int var_len  = (int)(c.name.len < 63 ? c.name.len : 63);
+            int expr_len = (int)(c.text.len < 511 ? c.text.len : 511);
+
+            /* First assignment declares. If the set cannot grow, the
+             * output would be wrong either way, so fail as the linker does */
+            int added = rift_string_set_insert(&declared_vars, c.name.ptr, (size_t)var_len);
+            if (added < 0) {
+                fprintf(CLI_ERR, "Error: out of memory tracking variables at line %u\n", line_num);
+                result->output.failed = true;
+                break;
+            }
+            if (added) {
+                transform_appendf(result, "    int %.*s = %.*s;\n",
+                    var_len, c.name.ptr, expr_len, c.text.ptr);
             } else {
-                snprintf(statement, sizeof(statement), "    %s = %s;\n", var_name, expr_trimmed);
+                transform_appendf(result, "    %.*s = %.*s;\n",
+                    var_len, c.name.ptr, expr_len, c.text.ptr);
             }
-            transform_append(result, statement);
             result->patterns_matched++;
-            line_start = line_end;
-            if (*line_start == '\n') line_start++;
             continue;
         }
         
         /* Try pattern matching */
         size_t match_len = 0;
         uint32_t priority = 0;
-        char* transformed = rift_pattern_engine_match(engine, line, &match_len, &priority);
+        const char* transformed = rift_pattern_engine_match_scratch(engine, line, &match_len, &priority);
         
         if (transformed) {
             /* Pattern matched - use transformed output */
-            transform_append(result, "    ");  /* Indent */
-            transform_append(result, transformed);
-            transform_append(result, "\n");
+            TRANSFORM_APPEND_LITERAL(result, "    ");  /* Indent */
+            transform_append(result, transformed, match_len);
+            TRANSFORM_APPEND_LITERAL(result, "\n");
             
             result->patterns_matched++;
             
             if (opts->verbose) {
-                printf("[RIFTLang] Line %d: matched (priority %d) -> %s\n", 
+                fprintf(CLI_OUT, "[RIFTLang] Line %d: matched (priority %d) -> %s\n", 
                     line_num, priority, transformed);
             }
-            
-            free(transformed);
         } else {
             /* No pattern match - preserve as comment if not whitespace */
             if (opts->preserve_comments) {
-                transform_append(result, "    // UNMATCHED: ");
-                transform_append(result, line);
-                transform_append(result, "\n");
+                TRANSFORM_APPEND_LITERAL(result, "    // UNMATCHED: ");
+                transform_append(result, line, line_len);
+                TRANSFORM_APPEND_LITERAL(result, "\n");
             }
             
             result->patterns_failed++;
             
             if (opts->verbose) {
-                printf("[RIFTLang] Line %d: unmatched\n", line_num);
+                fprintf(CLI_OUT, "[RIFTLang] Line %d: unmatched\n", line_num);
             }
         }
         
-        /* Move to next line */
-        line_start = line_end;
-        if (*line_start == '\n') line_start++;
     }
 
     /* Close main() with cleanup */
-    transform_append(result,
+    TRANSFORM_APPEND_LITERAL(result,
         "\n"
         "    /* Policy cleanup */\n"
         "    rift_policy_context_destroy(g_policy_ctx);\n"
@@ -1100,6 +1156,7 @@ static TransformResult* transform_source(
         "}\n"
     );
 
+    rift_string_set_free(&declared_vars);
     result->lines_processed = line_num;
     result->processing_time_ms = rift_get_time_ms() - start_time;
 
@@ -1111,17 +1168,14 @@ static TransformResult* transform_source(
  * ============================================================================ */
 
 static bool emit_binding_output(
-    const char* source,
-    size_t source_size,
+    const RiftLineIndex* lines,
     const char* out_filename,
     RiftTargetLanguage target,
     RiftCliOptions* opts
 ) {
-    (void)source_size;
-
     FILE* out = fopen(out_filename, "w");
     if (!out) {
-        fprintf(stderr, "Error: Cannot create '%s': %s\n", out_filename, strerror(errno));
+        fprintf(CLI_ERR, "Error: Cannot create '%s': %s\n", out_filename, strerror(errno));
         return false;
     }
 
@@ -1182,26 +1236,23 @@ static bool emit_binding_output(
     /* State */
     int skip_depth   = 0;
     int indent_level = 0;
-    const char* p = source;
 
-    while (*p) {
+    for (uint32_t line_num = 1; line_num <= lines->count; line_num++) {
         /* Extract one line */
-        const char* nl = strchr(p, '\n');
-        if (!nl) nl = p + strlen(p);
-        size_t len = (size_t)(nl - p);
+        size_t len = 0;
+        const char* p = riftlang_line_index_get(lines, line_num, &len);
 
         char line[RIFT_MAX_LINE_LENGTH];
         if (len >= sizeof(line)) len = sizeof(line) - 1;
         strncpy(line, p, len);
         line[len] = '\0';
 
-        const char* trimmed = trim_left(line);
-        bool is_empty = (*trimmed == '\0');
+        RiftLineClass c;
+        RiftLineKind kind = rift_line_classify(line, len, &c);
+        char* trimmed = (char*)c.line.ptr;
+        trimmed[c.line.len] = '\0';
 
-        p = nl;
-        if (*p == '\n') p++;
-
-        if (is_empty) {
+        if (kind == RIFT_LINE_EMPTY) {
             fprintf(out, "\n");
             continue;
         }
@@ -1215,66 +1266,46 @@ static bool emit_binding_output(
         }
 
         /* Detect multi-line blocks to skip */
-        if (starts_with(trimmed, "align span<")) {
+        if (kind == RIFT_LINE_SPAN) {
             fprintf(out, "%s rift: memory span\n", cpfx);
             if (strstr(trimmed, "{")) skip_depth = 1;
             continue;
         }
-        if (starts_with(trimmed, "type ") && strstr(trimmed, "=")) {
-            char type_name[64] = {0};
-            const char* tn_start = trimmed + 5;
+        if (kind == RIFT_LINE_TYPE) {
             size_t tn_len = 0;
-            while (tn_start[tn_len] && tn_start[tn_len] != ' ' &&
-                   tn_start[tn_len] != '=' && tn_start[tn_len] != '{') {
+            while (tn_len < c.name.len && tn_len < 63 &&
+                   c.name.ptr[tn_len] != ' ' && c.name.ptr[tn_len] != '{') {
                 tn_len++;
             }
-            if (tn_len >= sizeof(type_name)) tn_len = sizeof(type_name) - 1;
-            strncpy(type_name, tn_start, tn_len);
-            fprintf(out, "%s type: %s\n", cpfx, type_name);
+            fprintf(out, "%s type: %.*s\n", cpfx, (int)tn_len, c.name.ptr);
             if (strstr(trimmed, "{")) skip_depth = 1;
             continue;
         }
-        if (starts_with(trimmed, "policy_fn ")) {
+        if (kind == RIFT_LINE_POLICY) {
             fprintf(out, "%s policy omitted\n", cpfx);
             skip_depth = 1;
             continue;
         }
 
         /* Governance directive */
-        if (starts_with(trimmed, "!govern")) {
+        if (kind == RIFT_LINE_GOVERN) {
             fprintf(out, "%s RIFT: %s mode\n", cpfx,
-                strstr(trimmed, "classical") ? "classical" :
-                strstr(trimmed, "quantum")   ? "quantum"   : "hybrid");
+                slice_equals(c.name, "classical") ? "classical" :
+                slice_equals(c.name, "quantum")   ? "quantum"   : "hybrid");
             continue;
         }
 
         /* C-style comments */
-        if (starts_with(trimmed, "/*") || starts_with(trimmed, "//")) {
-            const char* ctext = trimmed + 2;
-            while (*ctext == ' ') ctext++;
-            char ctmp[512];
-            strncpy(ctmp, ctext, sizeof(ctmp) - 1);
-            ctmp[sizeof(ctmp) - 1] = '\0';
-            char* star = strstr(ctmp, "*/");
-            if (star) *star = '\0';
-            trim_right(ctmp);
-            if (*ctmp) fprintf(out, "%s %s\n", cpfx, ctmp);
+        if (kind == RIFT_LINE_COMMENT) {
+            if (c.text.len > 0) fprintf(out, "%s %.*s\n", cpfx, (int)c.text.len, c.text.ptr);
             continue;
         }
 
         /* while loop open (e.g. "while (cond) {") */
-        if (starts_with(trimmed, "while ") || starts_with(trimmed, "while(")) {
-            const char* cs = strchr(trimmed, '(');
+        if (kind == RIFT_LINE_WHILE) {
             char cond[256] = {0};
-            if (cs) {
-                cs++;
-                const char* ce = strrchr(trimmed, ')');
-                if (ce && ce > cs) {
-                    size_t cl = (size_t)(ce - cs);
-                    if (cl >= sizeof(cond)) cl = sizeof(cond) - 1;
-                    strncpy(cond, cs, cl);
-                }
-            }
+            size_t cl = c.text.len < sizeof(cond) - 1 ? c.text.len : sizeof(cond) - 1;
+            memcpy(cond, c.text.ptr, cl);
             switch (target) {
                 case RIFT_TARGET_JS:
                     fprintf(out, "while (%s) {\n", cond);
@@ -1302,13 +1333,13 @@ static bool emit_binding_output(
         }
 
         /* Standalone { */
-        if (strcmp(trimmed, "{") == 0) {
+        if (kind == RIFT_LINE_BLOCK_OPEN) {
             if (target != RIFT_TARGET_PYTHON) indent_level++;
             continue;
         }
 
         /* Standalone } */
-        if (strcmp(trimmed, "}") == 0) {
+        if (kind == RIFT_LINE_BLOCK_CLOSE) {
             if (indent_level > 0) indent_level--;
             switch (target) {
                 case RIFT_TARGET_JS:     fprintf(out, "}\n");     break;
@@ -1322,9 +1353,11 @@ static bool emit_binding_output(
         }
 
         /* validate() call */
-        if (starts_with(trimmed, "validate(")) {
+        if (kind == RIFT_LINE_VALIDATE) {
             char arg[64] = {0};
-            sscanf(trimmed + 9, "%63[^)]", arg);
+            size_t al = 0;
+            while (al < c.text.len && al < sizeof(arg) - 1 && c.text.ptr[al] != ')') al++;
+            memcpy(arg, c.text.ptr, al);
             switch (target) {
                 case RIFT_TARGET_JS:
                     fprintf(out, "rift.validate('%s');\n", arg);
@@ -1347,17 +1380,11 @@ static bool emit_binding_output(
         }
 
         /* := assignment */
-        const char* ceq = strstr(trimmed, ":=");
-        if (ceq) {
+        if (kind == RIFT_LINE_ASSIGN) {
             char var_name[64] = {0};
             char expr[512]    = {0};
-            size_t vlen = (size_t)(ceq - trimmed);
-            if (vlen >= sizeof(var_name)) vlen = sizeof(var_name) - 1;
-            strncpy(var_name, trimmed, vlen);
-            trim_right(var_name);
-            const char* expr_raw = trim_left(ceq + 2);
-            strncpy(expr, expr_raw, sizeof(expr) - 1);
-            trim_right(expr);
+            memcpy(var_name, c.name.ptr, c.name.len < 63 ? c.name.len : 63);
+            memcpy(expr, c.text.ptr, c.text.len < 511 ? c.text.len : 511);
 
             /* Indent for nested context */
             const char* ind = (indent_level > 0) ? "    " : "";
@@ -1403,7 +1430,7 @@ static bool emit_binding_output(
     fclose(out);
 
     if (!opts->quiet) {
-        printf("[RIFTLang] Output written to: %s\n", out_filename);
+        fprintf(CLI_OUT, "[RIFTLang] Output written to: %s\n", out_filename);
     }
 
     const char* run_hint =
@@ -1414,7 +1441,7 @@ static bool emit_binding_output(
         (target == RIFT_TARGET_WAT)    ? "wat2wasm" : "";
 
     if (!opts->quiet && *run_hint) {
-        printf("[RIFTLang] Run with: %s %s\n", run_hint, out_filename);
+        fprintf(CLI_OUT, "[RIFTLang] Run with: %s %s\n", run_hint, out_filename);
     }
 
     return true;
@@ -1424,137 +1451,269 @@ static bool emit_binding_output(
  * Compilation Pipeline
  * ============================================================================ */
 
+/* One codec output: a worker emits the shared program to one file */
+typedef struct {
+    const RiftCIRProgram* prog;     /* Linked once, read-only while emitting */
+    const char* filename;
+    RiftTargetLanguage target;
+    bool ok;
+    int error;                      /* errno of the failed write, 0 if none */
+} RiftEmitJob;
+
+static const char* target_display_name(RiftTargetLanguage target) {
+    return target == RIFT_TARGET_JS     ? "JavaScript" :
+           target == RIFT_TARGET_PYTHON ? "Python"     :
+           target == RIFT_TARGET_GO     ? "Go"         :
+           target == RIFT_TARGET_LUA    ? "Lua"        : "WAT";
+}
+
+static const char* target_run_hint(RiftTargetLanguage target) {
+    return target == RIFT_TARGET_JS     ? "node"    :
+           target == RIFT_TARGET_PYTHON ? "python3" :
+           target == RIFT_TARGET_GO     ? "go run"  :
+           target == RIFT_TARGET_LUA    ? "lua"     : "wat2wasm";
+}
+
+/* Emit into memory so an unchanged output file is left untouched */
+static void* emit_job_run(void* arg) {
+    RiftEmitJob* job = (RiftEmitJob*)arg;
+    RiftEmitSink sink;
+    if (!rift_emit_sink_init_memory(&sink)) {
+        job->error = ENOMEM;
+        return NULL;
+    }
+    if (!rift_codec_emit_sink(job->prog, &sink, job->target)) {
+        job->error = sink.error;
+    } else {
+        job->error = rift_write_if_changed(job->filename, sink.buf, sink.len, false);
+        job->ok = job->error == 0;
+    }
+    rift_emit_sink_free(&sink);
+    return NULL;
+}
+
+/**
+ * Link once (through the CIR cache when configured), then emit every job
+ * from the same program, one worker thread per job beyond the first.
+ */
+static bool emit_codec_outputs(const RiftCliOptions* opts, const RiftLineIndex* lines,
+                               RiftEmitJob* jobs, int job_count) {
+    if (opts->verbose) {
+        for (int i = 0; i < job_count; i++) {
+            if (job_count > 1) {
+                fprintf(CLI_OUT, "[RIFTLang] Target language: %s (link+codec path) -> %s\n",
+                    target_display_name(jobs[i].target), jobs[i].filename);
+            } else {
+                fprintf(CLI_OUT, "[RIFTLang] Target language: %s (link+codec path)\n",
+                    target_display_name(jobs[i].target));
+            }
+        }
+    }
+
+    /* Linking does not depend on the target: reuse a cached program */
+    RiftCIRCache cache;
+    bool use_cache = false;
+    if (opts->cir_cache && *opts->cir_cache) {
+        use_cache = rift_cir_cache_open(&cache, opts->cir_cache, opts->cir_cache_limit);
+        if (!use_cache) {
+            fprintf(CLI_ERR, "Warning: CIR cache '%s' unusable (%s); linking without it\n",
+                opts->cir_cache, strerror(errno));
+        }
+    }
+
+    /* The program borrows the line index, which borrows the source */
+    bool cache_hit = false;
+    RiftCIRProgram* prog = rift_cir_cache_link(use_cache ? &cache : NULL,
+                                               lines, opts->mode, &cache_hit);
+    if (!prog) {
+        fprintf(CLI_ERR, "Error: CIR linker allocation failed\n");
+        return false;
+    }
+    if (use_cache && opts->verbose) {
+        fprintf(CLI_OUT, "[RIFTLang] CIR cache %s: %u nodes\n",
+            cache_hit ? "hit" : "miss", prog->count);
+    }
+    if (!prog->consensus_ok) {
+        fprintf(CLI_ERR, "Error: Consensus validation failed: %s\n", prog->error_msg);
+        rift_cir_program_free(prog);
+        return false;
+    }
+
+    /* Job 0 runs on this thread; a worker that cannot start runs inline */
+    pthread_t workers[RIFT_MAX_OUTPUTS];
+    bool started[RIFT_MAX_OUTPUTS] = { false };
+    for (int i = 0; i < job_count; i++) {
+        jobs[i].prog = prog;
+    }
+    for (int i = 1; i < job_count; i++) {
+        started[i] = pthread_create(&workers[i], NULL, emit_job_run, &jobs[i]) == 0;
+    }
+    emit_job_run(&jobs[0]);
+    for (int i = 1; i < job_count; i++) {
+        if (started[i]) {
+            pthread_join(workers[i], NULL);
+        } else {
+            emit_job_run(&jobs[i]);
+        }
+    }
+    rift_cir_program_free(prog);
+
+    bool ok = true;
+    for (int i = 0; i < job_count; i++) {
+        if (!jobs[i].ok) {
+            if (jobs[i].error) {
+                fprintf(CLI_ERR, "Error: Cannot write '%s': %s\n",
+                    jobs[i].filename, strerror(jobs[i].error));
+            }
+            ok = false;
+        } else if (!opts->quiet) {
+            fprintf(CLI_OUT, "[RIFTLang] Output written to: %s\n", jobs[i].filename);
+            fprintf(CLI_OUT, "[RIFTLang] Run with: %s %s\n",
+                target_run_hint(jobs[i].target), jobs[i].filename);
+        }
+    }
+    return ok;
+}
+
+/* Default C output: the input with its extension swapped for .c */
+static void default_c_output(const char* input, char out[RIFT_MAX_PATH]) {
+    strncpy(out, input, RIFT_MAX_PATH - 1);
+    out[RIFT_MAX_PATH - 1] = '\0';
+    char* dot = strrchr(out, '.');
+    if (dot) {
+        strcpy(dot, ".c");
+    } else {
+        strncat(out, ".c", RIFT_MAX_PATH - strlen(out) - 1);
+    }
+}
+
+/* Executable built from input: its base name without extension, in the cwd */
+static void default_exe_name(const char* input, char out[RIFT_MAX_PATH]) {
+    const char* base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    strncpy(out, base, RIFT_MAX_PATH - 1);
+    out[RIFT_MAX_PATH - 1] = '\0';
+    char* dot = strrchr(out, '.');
+    if (dot) *dot = '\0';
+}
+
 static bool compile_rift_file(RiftCliOptions* opts) {
     if (!opts->quiet) {
-        print_banner();
-        printf("[RIFTLang] Input:  %s\n", opts->input_file);
-        printf("[RIFTLang] Mode:   %s\n", 
+        if (!opts->batch && !opts->watch) print_banner();   /* printed once */
+        fprintf(CLI_OUT, "[RIFTLang] Input:  %s\n", opts->input_file);
+        fprintf(CLI_OUT, "[RIFTLang] Mode:   %s\n", 
             opts->mode == RIFT_MODE_CLASSICAL ? "classical" :
             opts->mode == RIFT_MODE_QUANTUM ? "quantum" : "hybrid");
-        printf("[RIFTLang] Policy: %.0f%% validation threshold\n", opts->policy_threshold * 100);
-        printf("[RIFTLang] Opt:    O%d\n", opts->optimization_level);
-        printf("\n");
+        fprintf(CLI_OUT, "[RIFTLang] Policy: %.0f%% validation threshold\n", opts->policy_threshold * 100);
+        fprintf(CLI_OUT, "[RIFTLang] Opt:    O%d\n", opts->optimization_level);
+        fprintf(CLI_OUT, "\n");
     }
     
     /* Check input file exists */
     if (!file_exists(opts->input_file)) {
-        fprintf(stderr, "Error: Input file not found: %s\n", opts->input_file);
+        fprintf(CLI_ERR, "Error: Input file not found: %s\n", opts->input_file);
         return false;
     }
     
     /* Read input file */
-    size_t source_size = 0;
-    char* source = read_file(opts->input_file, &source_size);
-    if (!source) {
+    RiftSourceFile source;
+    if (!read_file(opts->input_file, &source)) {
         return false;
     }
 
     if (opts->verbose) {
-        printf("[RIFTLang] Read %zu bytes from %s\n", source_size, opts->input_file);
+        fprintf(CLI_OUT, "[RIFTLang] Read %zu bytes from %s (%s)\n", source.size, opts->input_file,
+            source.mapped_size ? "mapped" : "buffered");
+    }
+
+    /* One newline scan, shared by whichever stage runs below */
+    RiftLineIndex lines;
+    if (!riftlang_line_index_build(&lines, source.data, source.size)) {
+        fprintf(CLI_ERR, "Error: Cannot index source lines of %s\n", opts->input_file);
+        rift_source_file_close(&source);
+        return false;
     }
 
     /* Determine output filename early (needed for target detection) */
-    char out_filename[256];
+    char out_filename[RIFT_MAX_PATH];
     out_filename[sizeof(out_filename) - 1] = '\0';
     if (opts->output_file) {
         strncpy(out_filename, opts->output_file, sizeof(out_filename) - 1);
     } else {
-        strncpy(out_filename, opts->input_file, sizeof(out_filename) - 1);
-        char* dot = strrchr(out_filename, '.');
-        if (dot) {
-            strcpy(dot, ".c");
-        } else {
-            strncat(out_filename, ".c", sizeof(out_filename) - strlen(out_filename) - 1);
-        }
+        default_c_output(opts->input_file, out_filename);
     }
 
     /* Detect target language from output extension */
     RiftTargetLanguage target = rift_detect_target(out_filename);
 
-    if (target != RIFT_TARGET_C) {
-        /* Non-C binding path: link → CIR → codec emit (linkable-then-fileformat) */
-        if (opts->verbose) {
-            const char* tname =
-                target == RIFT_TARGET_JS     ? "JavaScript" :
-                target == RIFT_TARGET_PYTHON ? "Python"     :
-                target == RIFT_TARGET_GO     ? "Go"         :
-                target == RIFT_TARGET_LUA    ? "Lua"        : "WAT";
-            printf("[RIFTLang] Target language: %s (link+codec path)\n", tname);
-        }
-        RiftCIRProgram* prog = rift_link(source, opts->mode);
-        free(source);
-        if (!prog) {
-            fprintf(stderr, "Error: CIR linker allocation failed\n");
-            return false;
-        }
-        if (!prog->consensus_ok) {
-            fprintf(stderr, "Error: Consensus validation failed: %s\n", prog->error_msg);
-            rift_cir_program_free(prog);
-            return false;
-        }
-        FILE* out_fp = fopen(out_filename, "w");
-        if (!out_fp) {
-            fprintf(stderr, "Error: Cannot create '%s': %s\n", out_filename, strerror(errno));
-            rift_cir_program_free(prog);
+    /* Several outputs: one link, every codec target emitted concurrently */
+    RiftEmitJob jobs[RIFT_MAX_OUTPUTS];
+    int job_count = opts->output_count > 1 ? opts->output_count : 1;
+    for (int i = 0; i < job_count; i++) {
+        memset(&jobs[i], 0, sizeof(jobs[i]));
+        jobs[i].filename = (job_count > 1) ? opts->output_files[i] : out_filename;
+        jobs[i].target = rift_detect_target(jobs[i].filename);
+        if (job_count > 1 && jobs[i].target == RIFT_TARGET_C) {
+            fprintf(CLI_ERR, "Error: '%s' is a C output; several outputs must all be "
+                "js, py, go, lua or wat\n", jobs[i].filename);
+            riftlang_line_index_free(&lines);
+            rift_source_file_close(&source);
             return false;
         }
-        bool ok = rift_codec_emit(prog, out_fp, target);
-        fclose(out_fp);
-        rift_cir_program_free(prog);
-        if (!opts->quiet && ok) {
-            const char* run_hint =
-                (target == RIFT_TARGET_JS)     ? "node" :
-                (target == RIFT_TARGET_PYTHON) ? "python3" :
-                (target == RIFT_TARGET_GO)     ? "go run" :
-                (target == RIFT_TARGET_LUA)    ? "lua" : "wat2wasm";
-            printf("[RIFTLang] Output written to: %s\n", out_filename);
-            printf("[RIFTLang] Run with: %s %s\n", run_hint, out_filename);
-        }
+    }
+
+    if (job_count > 1 || target != RIFT_TARGET_C) {
+        /* Non-C binding path: link → CIR → codec emit (linkable-then-fileformat) */
+        bool ok = emit_codec_outputs(opts, &lines, jobs, job_count);
+        riftlang_line_index_free(&lines);
+        rift_source_file_close(&source);
         return ok;
     }
 
     /* C target: existing pipeline */
     /* Initialize pattern engine */
-    RiftPatternEngine* engine = initialize_transform_engine(opts->mode, opts->verbose);
+    RiftPatternEngine* engine = load_transform_engine(opts);
     if (!engine) {
-        free(source);
+        riftlang_line_index_free(&lines);
+        rift_source_file_close(&source);
         return false;
     }
 
     /* Transform source to C */
-    TransformResult* result = transform_source(engine, source, opts);
+    TransformResult* result = transform_source(engine, &lines, opts);
 
-    rift_pattern_engine_destroy(engine);
-    free(source);
+    release_transform_engine(engine);
+    riftlang_line_index_free(&lines);
+    rift_source_file_close(&source);
 
-    if (!result || !result->output) {
-        fprintf(stderr, "Error: Transformation failed\n");
+    if (!result || result->output.failed) {
+        fprintf(CLI_ERR, "Error: Transformation failed\n");
+        transform_result_free(result);
         return false;
     }
 
     if (opts->verbose) {
-        printf("\n[RIFTLang] Transformation complete:\n");
-        printf("  Lines processed: %d\n", result->lines_processed);
-        printf("  Patterns matched: %d\n", result->patterns_matched);
-        printf("  Patterns failed: %d\n", result->patterns_failed);
-        printf("  Time: %.2f ms\n", result->processing_time_ms);
-        printf("  Output size: %zu bytes\n", result->output_size);
+        fprintf(CLI_OUT, "\n[RIFTLang] Transformation complete:\n");
+        fprintf(CLI_OUT, "  Lines processed: %d\n", result->lines_processed);
+        fprintf(CLI_OUT, "  Patterns matched: %d\n", result->patterns_matched);
+        fprintf(CLI_OUT, "  Patterns failed: %d\n", result->patterns_failed);
+        fprintf(CLI_OUT, "  Time: %.2f ms\n", result->processing_time_ms);
+        fprintf(CLI_OUT, "  Output size: %zu bytes\n", result->output.size);
     }
     
     /* Write output if not dry run */
     if (!opts->dry_run) {
-        if (!write_file(out_filename, result->output, result->output_size)) {
-            free(result->output);
-            free(result);
+        if (!write_transform_output(out_filename, &result->output)) {
+            transform_result_free(result);
             return false;
         }
         
         if (!opts->quiet) {
-            printf("[RIFTLang] Output written to: %s\n", out_filename);
+            fprintf(CLI_OUT, "[RIFTLang] Output written to: %s\n", out_filename);
         }
     } else {
         if (!opts->quiet) {
-            printf("[RIFTLang] Dry run - no output written\n");
+            fprintf(CLI_OUT, "[RIFTLang] Dry run - no output written\n");
         }
     }
     
@@ -1568,7 +1727,7 @@ static bool compile_rift_file(RiftCliOptions* opts) {
         write_file(ast_filename, ast_stub, strlen(ast_stub));
         
         if (!opts->quiet) {
-            printf("[RIFTLang] AST JSON written to: %s\n", ast_filename);
+            fprintf(CLI_OUT, "[RIFTLang] AST JSON written to: %s\n", ast_filename);
         }
     }
     
@@ -1581,71 +1740,1311 @@ static bool compile_rift_file(RiftCliOptions* opts) {
         write_file(astb_filename, (char*)astb_stub, 8);
         
         if (!opts->quiet) {
-            printf("[RIFTLang] AST binary written to: %s\n", astb_filename);
+            fprintf(CLI_OUT, "[RIFTLang] AST binary written to: %s\n", astb_filename);
         }
     }
     
     /* Show AST if requested */
     if (opts->show_ast) {
-        printf("\n[RIFTLang] AST Representation:\n");
-        printf("--------------------------------\n");
-        printf("Stub AST - full implementation in Phase 2\n");
-        printf("--------------------------------\n");
+        fprintf(CLI_OUT, "\n[RIFTLang] AST Representation:\n");
+        fprintf(CLI_OUT, "--------------------------------\n");
+        fprintf(CLI_OUT, "Stub AST - full implementation in Phase 2\n");
+        fprintf(CLI_OUT, "--------------------------------\n");
     }
     
     /* Show tokens if requested */
     if (opts->show_tokens) {
-        printf("\n[RIFTLang] Token Stream:\n");
-        printf("--------------------------------\n");
-        printf("Stub tokens - full lexer in Phase 2\n");
-        printf("--------------------------------\n");
+        fprintf(CLI_OUT, "\n[RIFTLang] Token Stream:\n");
+        fprintf(CLI_OUT, "--------------------------------\n");
+        fprintf(CLI_OUT, "Stub tokens - full lexer in Phase 2\n");
+        fprintf(CLI_OUT, "--------------------------------\n");
     }
     
     /* Invoke C compiler if not compile-only */
     if (!opts->compile_only && !opts->dry_run) {
-        if (!opts->quiet) {
-            printf("\n[RIFTLang] Invoking C compiler...\n");
-        }
-        
         char compile_cmd[512];
+        char compile_flags[128];
         const char* cc = getenv("CC") ? getenv("CC") : "gcc";
 
-        /* Derive exe name from input file base (strip directory and extension) */
-        char exe_name[256];
-        const char* base = strrchr(opts->input_file, '/');
-        base = base ? base + 1 : opts->input_file;
-        strncpy(exe_name, base, sizeof(exe_name) - 1);
-        exe_name[sizeof(exe_name) - 1] = '\0';
-        char* exe_dot = strrchr(exe_name, '.');
-        if (exe_dot) *exe_dot = '\0';
-
-        snprintf(compile_cmd, sizeof(compile_cmd),
-            "%s -o %s %s -I. -L./bin -lriftlang -O%d -lm -lpthread %s",
+        char exe_name[RIFT_MAX_PATH];
+        default_exe_name(opts->input_file, exe_name);
+
+        /* -v only makes gcc chatty, so it stays out of the build identity */
+        snprintf(compile_flags, sizeof(compile_flags),
+            "-I. -L./bin -lriftlang -O%d -lm -lpthread", opts->optimization_level);
+        int cmd_len = snprintf(compile_cmd, sizeof(compile_cmd),
+            "%s -o %s %s %s %s",
             cc,
             exe_name,
             out_filename,
-            opts->optimization_level,
+            compile_flags,
             opts->verbose ? "-v" : ""
         );
+        if (cmd_len < 0 || (size_t)cmd_len >= sizeof(compile_cmd)) {
+            fprintf(CLI_ERR, "Error: C compiler command for '%s' is too long\n", out_filename);
+            transform_result_free(result);
+            return false;
+        }
 
-        if (opts->verbose) {
-            printf("[RIFTLang] Compile command: %s\n", compile_cmd);
+        /* The generated C is in memory already; joined, it keys the build cache */
+        RiftBuildCache build_cache;
+        bool use_build_cache = false;
+        char identity[4096];
+        char* c_source = NULL;
+        if (opts->build_cache && *opts->build_cache) {
+            use_build_cache = rift_build_cache_open(&build_cache, opts->build_cache,
+                                                    opts->build_cache_limit);
+            if (!use_build_cache) {
+                fprintf(CLI_ERR, "Warning: Build cache '%s' unusable (%s); compiling without it\n",
+                    opts->build_cache, strerror(errno));
+            } else {
+                use_build_cache = build_cache_identity(cc, compile_flags, out_filename,
+                                                       identity, sizeof(identity)) &&
+                                  (c_source = transform_output_join(&result->output)) != NULL;
+            }
         }
 
-        int ret = system(compile_cmd);
-        if (ret != 0) {
-            fprintf(stderr, "Warning: C compiler returned non-zero exit code\n");
-        } else if (!opts->quiet) {
-            printf("[RIFTLang] Compilation successful -> %s\n", exe_name);
+        if (use_build_cache &&
+            rift_build_cache_fetch(&build_cache, c_source, result->output.size,
+                                   identity, exe_name)) {
+            if (!opts->quiet) {
+                fprintf(CLI_OUT, "\n[RIFTLang] Build cache hit -> %s\n", exe_name);
+            }
+        } else {
+            if (!opts->quiet) {
+                fprintf(CLI_OUT, "\n[RIFTLang] Invoking C compiler...\n");
+            }
+            if (opts->verbose) {
+                if (use_build_cache) {
+                    fprintf(CLI_OUT, "[RIFTLang] Build cache miss: %s\n", identity);
+                }
+                fprintf(CLI_OUT, "[RIFTLang] Compile command: %s\n", compile_cmd);
+            }
+
+            int ret = system(compile_cmd);
+            if (ret != 0) {
+                fprintf(CLI_ERR, "Warning: C compiler returned non-zero exit code\n");
+            } else {
+                if (use_build_cache) {
+                    rift_build_cache_store(&build_cache, c_source, result->output.size,
+                                           identity, exe_name);
+                }
+                if (!opts->quiet) {
+                    fprintf(CLI_OUT, "[RIFTLang] Compilation successful -> %s\n", exe_name);
+                }
+            }
         }
+        free(c_source);
     }
     
-    free(result->output);
-    free(result);
+    transform_result_free(result);
     
     return true;
 }
 
+/* ============================================================================
+ * Batch Compilation
+ * ============================================================================ */
+
+/* Inputs after expanding directories and globs, each path owned */
+typedef struct {
+    char** paths;
+    int count;
+    int capacity;
+} RiftBatchInputs;
+
+static bool batch_add_input(RiftBatchInputs* list, const char* path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        char** grown = (char**)realloc(list->paths, (size_t)capacity * sizeof(char*));
+        if (!grown) return false;
+        list->paths = grown;
+        list->capacity = capacity;
+    }
+    char* copy = strdup(path);
+    if (!copy) return false;
+    list->paths[list->count++] = copy;
+    return true;
+}
+
+static void batch_inputs_free(RiftBatchInputs* list) {
+    for (int i = 0; i < list->count; i++) free(list->paths[i]);
+    free(list->paths);
+    memset(list, 0, sizeof(*list));
+}
+
+static int batch_path_compare(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/*
+ * An input's identity and position, for finding repeats. Files that exist
+ * are compared by device and inode, so "a.rift" and "./a.rift" are one
+ * input; anything else by its path.
+ */
+typedef struct {
+    const char* path;
+    int index;
+    bool has_id;
+    dev_t dev;
+    ino_t ino;
+} RiftBatchInput;
+
+#define BATCH_CMP(a, b)  (((a) > (b)) - ((a) < (b)))
+
+static int batch_input_same(const RiftBatchInput* x, const RiftBatchInput* y) {
+    if (x->has_id != y->has_id) return BATCH_CMP(x->has_id, y->has_id);
+    if (!x->has_id) return strcmp(x->path, y->path);
+    if (x->dev != y->dev) return BATCH_CMP(x->dev, y->dev);
+    return BATCH_CMP(x->ino, y->ino);
+}
+
+static int batch_input_compare(const void* a, const void* b) {
+    const RiftBatchInput* x = (const RiftBatchInput*)a;
+    const RiftBatchInput* y = (const RiftBatchInput*)b;
+    int order = batch_input_same(x, y);
+    return order ? order : BATCH_CMP(x->index, y->index);
+}
+
+static bool batch_is_directory(const char* path) {
+    struct stat st;
+#ifdef _WIN32
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#else
+    /* Symlinked directories are not followed: no cycles */
+    return lstat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/* Every .rift file under dir, each directory's entries in sorted order */
+static bool batch_add_directory(RiftBatchInputs* list, const char* dir) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        fprintf(stderr, "Error: Cannot read directory '%s': %s\n", dir, strerror(errno));
+        return false;
+    }
+    RiftBatchInputs entries = {0};
+    size_t dir_len = strlen(dir);
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(handle)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        size_t size = dir_len + strlen(entry->d_name) + 2;
+        char* path = (char*)malloc(size);
+        if (!path) {
+            ok = false;
+            break;
+        }
+        snprintf(path, size, "%s%s%s", dir,
+            dir_len && dir[dir_len - 1] == '/' ? "" : "/", entry->d_name);
+        ok = batch_add_input(&entries, path);
+        free(path);
+    }
+    closedir(handle);
+
+    qsort(entries.paths, (size_t)entries.count, sizeof(char*), batch_path_compare);
+    for (int i = 0; ok && i < entries.count; i++) {
+        const char* path = entries.paths[i];
+        size_t len = strlen(path);
+        if (batch_is_directory(path)) {
+            ok = batch_add_directory(list, path);
+        } else if (len > 5 && strcmp(path + len - 5, ".rift") == 0) {
+            ok = batch_add_input(list, path);
+        }
+    }
+    batch_inputs_free(&entries);
+    return ok;
+}
+
+/* An output path and the input that writes it */
+typedef struct {
+    char name[RIFT_MAX_PATH];
+    int input;
+} RiftBatchOutput;
+
+static int batch_output_compare(const void* a, const void* b) {
+    const RiftBatchOutput* x = (const RiftBatchOutput*)a;
+    const RiftBatchOutput* y = (const RiftBatchOutput*)b;
+    int order = strcmp(x->name, y->name);
+    return order ? order : BATCH_CMP(x->input, y->input);
+}
+
+/*
+ * Distinct inputs can still claim the same outputs: a/x.rift and b/x.rift
+ * both build ./x, and x.rift and x.txt both write x.c (or x.js under
+ * --targets). Their workers would race on those files, so such a batch is
+ * refused before anything is written.
+ */
+static bool batch_check_outputs(const RiftCliOptions* opts, const RiftBatchInputs* list) {
+    bool links = !opts->targets && !opts->compile_only && !opts->dry_run;
+    int per_input = links ? 2 : 1;
+    RiftBatchOutput* outputs = (RiftBatchOutput*)malloc(
+        (size_t)list->count * (size_t)per_input * sizeof(RiftBatchOutput) + 1);
+    if (!outputs) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return false;
+    }
+
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        const char* path = list->paths[i];
+        if (opts->targets) {
+            /* Every target shares the stem, as expand_targets names them */
+            const char* dot = strrchr(path, '.');
+            const char* slash = strrchr(path, '/');
+            size_t stem_len = (dot && (!slash || dot > slash)) ? (size_t)(dot - path)
+                                                               : strlen(path);
+            snprintf(outputs[count].name, RIFT_MAX_PATH, "%.*s.*", (int)stem_len, path);
+        } else {
+            default_c_output(path, outputs[count].name);
+        }
+        outputs[count++].input = i;
+        if (links) {
+            default_exe_name(path, outputs[count].name);
+            outputs[count++].input = i;
+        }
+    }
+
+    qsort(outputs, (size_t)count, sizeof(RiftBatchOutput), batch_output_compare);
+    bool ok = true;
+    for (int i = 1; i < count; i++) {
+        if (strcmp(outputs[i].name, outputs[i - 1].name) == 0 &&
+            outputs[i].input != outputs[i - 1].input) {
+            fprintf(stderr, "Error: '%s' and '%s' would both write '%s'\n",
+                list->paths[outputs[i - 1].input], list->paths[outputs[i].input],
+                outputs[i].name);
+            ok = false;
+        }
+    }
+    free(outputs);
+    return ok;
+}
+
+/**
+ * Expand the positional arguments: a directory contributes its .rift
+ * files, a pattern the shell left unexpanded its sorted matches, anything
+ * else itself. Repeated paths keep their first position only; distinct
+ * inputs whose outputs would collide are an error.
+ */
+static bool batch_collect_inputs(const RiftCliOptions* opts, RiftBatchInputs* list) {
+    memset(list, 0, sizeof(*list));
+    for (int i = 0; i < opts->input_count; i++) {
+        const char* arg = opts->inputs[i];
+        bool ok;
+        if (batch_is_directory(arg)) {
+            ok = batch_add_directory(list, arg);
+        }
+#ifndef _WIN32
+        else if (strpbrk(arg, "*?[") && !file_exists(arg)) {
+            glob_t matches;
+            int rc = glob(arg, 0, NULL, &matches);
+            if (rc != 0) {
+                fprintf(stderr, "Error: No inputs match '%s'\n", arg);
+                if (rc != GLOB_NOMATCH) globfree(&matches);
+                batch_inputs_free(list);
+                return false;
+            }
+            ok = true;
+            for (size_t m = 0; ok && m < matches.gl_pathc; m++) {
+                ok = batch_is_directory(matches.gl_pathv[m])
+                   ? batch_add_directory(list, matches.gl_pathv[m])
+                   : batch_add_input(list, matches.gl_pathv[m]);
+            }
+            globfree(&matches);
+        }
+#endif
+        else {
+            ok = batch_add_input(list, arg);
+        }
+        if (!ok) {
+            if (errno == ENOMEM) fprintf(stderr, "Error: Out of memory\n");
+            batch_inputs_free(list);
+            return false;
+        }
+    }
+
+    /* Drop repeats: two workers must never write the same outputs */
+    RiftBatchInput* order = (RiftBatchInput*)malloc((size_t)list->count * sizeof(RiftBatchInput) + 1);
+    if (!order) {
+        fprintf(stderr, "Error: Out of memory\n");
+        batch_inputs_free(list);
+        return false;
+    }
+    for (int i = 0; i < list->count; i++) {
+        struct stat st;
+        memset(&order[i], 0, sizeof(order[i]));
+        order[i].path = list->paths[i];
+        order[i].index = i;
+#ifndef _WIN32
+        if (stat(list->paths[i], &st) == 0) {
+            order[i].has_id = true;
+            order[i].dev = st.st_dev;
+            order[i].ino = st.st_ino;
+        }
+#else
+        (void)st;   /* no inode numbers: paths only */
+#endif
+    }
+    qsort(order, (size_t)list->count, sizeof(RiftBatchInput), batch_input_compare);
+    /* The first of each run of equal inputs is the earliest: it stays */
+    int first = 0;
+    for (int i = 1; i < list->count; i++) {
+        if (batch_input_same(&order[i], &order[first]) == 0) {
+            free(list->paths[order[i].index]);
+            list->paths[order[i].index] = NULL;
+        } else {
+            first = i;
+        }
+    }
+    free(order);
+    int kept = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->paths[i]) list->paths[kept++] = list->paths[i];
+    }
+    list->count = kept;
+
+    if (!batch_check_outputs(opts, list)) {
+        batch_inputs_free(list);
+        return false;
+    }
+    return true;
+}
+
+/* A file's messages, captured while its worker compiles it */
+typedef struct {
+    FILE*  stream;
+    char*  data;                    /* open_memstream buffer */
+    size_t size;
+} RiftBatchLog;
+
+static bool batch_log_open(RiftBatchLog* log) {
+    memset(log, 0, sizeof(*log));
+#ifdef _WIN32
+    log->stream = tmpfile();
+#else
+    log->stream = open_memstream(&log->data, &log->size);
+#endif
+    return log->stream != NULL;
+}
+
+/* Copy the captured text to dest and release the log */
+static void batch_log_replay(RiftBatchLog* log, FILE* dest) {
+    if (!log->stream) return;
+#ifdef _WIN32
+    char buffer[4096];
+    size_t n;
+    rewind(log->stream);
+    while ((n = fread(buffer, 1, sizeof(buffer), log->stream)) > 0) {
+        fwrite(buffer, 1, n, dest);
+    }
+    fclose(log->stream);
+#else
+    fclose(log->stream);            /* finalizes data and size */
+    fwrite(log->data, 1, log->size, dest);
+    free(log->data);
+#endif
+    memset(log, 0, sizeof(*log));
+}
+
+static void batch_log_discard(RiftBatchLog* log) {
+    if (!log->stream) return;
+    fclose(log->stream);
+#ifndef _WIN32
+    free(log->data);
+#endif
+    memset(log, 0, sizeof(*log));
+}
+
+typedef struct {
+    const char*  input;
+    bool         ok;
+    bool         done;              /* compiled; guarded by print_lock */
+    double       ms;
+    RiftBatchLog out;
+    RiftBatchLog err;
+} RiftBatchFile;
+
+/* A worker's share of the files: it takes from next, thieves from end */
+typedef struct {
+    pthread_mutex_t lock;
+    int next;
+    int end;
+} RiftBatchQueue;
+
+typedef struct {
+    const RiftCliOptions* opts;
+    RiftBatchFile* files;
+    int count;
+    RiftBatchQueue queues[RIFT_BATCH_MAX_WORKERS];
+    int worker_count;
+    pthread_mutex_t print_lock;
+    int print_next;                 /* first file whose log is not yet out */
+} RiftBatch;
+
+typedef struct {
+    RiftBatch* batch;
+    int id;
+} RiftBatchWorker;
+
+static int batch_default_workers(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long n = (long)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > RIFT_BATCH_MAX_WORKERS) n = RIFT_BATCH_MAX_WORKERS;
+    return (int)n;
+}
+
+/**
+ * Next file for worker id: the front of its own queue, else the back half
+ * of the first other queue that still has work. -1 once all are drained.
+ */
+static int batch_next_file(RiftBatch* batch, int id) {
+    RiftBatchQueue* own = &batch->queues[id];
+    for (;;) {
+        pthread_mutex_lock(&own->lock);
+        if (own->next < own->end) {
+            int index = own->next++;
+            pthread_mutex_unlock(&own->lock);
+            return index;
+        }
+        pthread_mutex_unlock(&own->lock);
+
+        bool stole = false;
+        for (int k = 1; k < batch->worker_count && !stole; k++) {
+            RiftBatchQueue* victim = &batch->queues[(id + k) % batch->worker_count];
+            pthread_mutex_lock(&victim->lock);
+            int left = victim->end - victim->next;
+            if (left > 0) {
+                int take = (left + 1) / 2;
+                victim->end -= take;
+                int lo = victim->end;
+                pthread_mutex_unlock(&victim->lock);
+
+                pthread_mutex_lock(&own->lock);
+                own->next = lo;
+                own->end = lo + take;
+                pthread_mutex_unlock(&own->lock);
+                stole = true;
+            } else {
+                pthread_mutex_unlock(&victim->lock);
+            }
+        }
+        if (!stole) return -1;
+    }
+}
+
+static void batch_compile_file(RiftBatch* batch, int index) {
+    RiftBatchFile* file = &batch->files[index];
+    RiftCliOptions opts = *batch->opts;
+    opts.input_file = file->input;
+    opts.inputs = NULL;
+    opts.input_count = 0;
+
+    /* Without a log the messages still appear, just not in order */
+    t_cli_out = batch_log_open(&file->out) ? file->out.stream : NULL;
+    t_cli_err = batch_log_open(&file->err) ? file->err.stream : NULL;
+    double start = rift_get_time_ms();
+    file->ok = (!opts.targets || expand_targets(&opts)) && compile_rift_file(&opts);
+    file->ms = rift_get_time_ms() - start;
+    t_cli_out = NULL;
+    t_cli_err = NULL;
+}
+
+/* Mark a file done and print every finished log that is next in order */
+static void batch_commit(RiftBatch* batch, int index) {
+    pthread_mutex_lock(&batch->print_lock);
+    batch->files[index].done = true;
+    while (batch->print_next < batch->count && batch->files[batch->print_next].done) {
+        RiftBatchFile* file = &batch->files[batch->print_next++];
+        batch_log_replay(&file->out, stdout);
+        fflush(stdout);
+        batch_log_replay(&file->err, stderr);
+    }
+    pthread_mutex_unlock(&batch->print_lock);
+}
+
+static void* batch_worker_run(void* arg) {
+    RiftBatchWorker* worker = (RiftBatchWorker*)arg;
+    int index;
+    while ((index = batch_next_file(worker->batch, worker->id)) >= 0) {
+        batch_compile_file(worker->batch, index);
+        batch_commit(worker->batch, index);
+    }
+    rift_pattern_engine_release_scratch();
+    return NULL;
+}
+
+/**
+ * --batch: compile every input on a bounded work-stealing pool sharing one
+ * sealed pattern engine. Each file's messages are printed in input order
+ * as soon as the files before it are done, then a per-file timing summary.
+ * Returns the exit code: 1 if any file failed.
+ */
+static int run_batch(RiftCliOptions* opts) {
+    RiftBatchInputs inputs;
+    if (!batch_collect_inputs(opts, &inputs)) return 1;
+    if (inputs.count == 0) {
+        fprintf(stderr, "Error: No .rift inputs found\n");
+        batch_inputs_free(&inputs);
+        return 1;
+    }
+
+    RiftBatch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.opts = opts;
+    batch.count = inputs.count;
+    batch.files = (RiftBatchFile*)calloc((size_t)inputs.count, sizeof(RiftBatchFile));
+    if (!batch.files) {
+        fprintf(stderr, "Error: Out of memory\n");
+        batch_inputs_free(&inputs);
+        return 1;
+    }
+    for (int i = 0; i < inputs.count; i++) {
+        batch.files[i].input = inputs.paths[i];
+    }
+
+    /* C outputs share one engine; it is sealed, so matching is lock-free */
+    RiftPatternEngine* engine = NULL;
+    if (!opts->targets && !g_resident_engines[opts->mode]) {
+        engine = load_transform_engine(opts);
+        if (!engine) {
+            free(batch.files);
+            batch_inputs_free(&inputs);
+            return 1;
+        }
+        g_resident_engines[opts->mode] = engine;
+    }
+
+    int workers = opts->jobs ? opts->jobs : batch_default_workers();
+    if (workers > batch.count) workers = batch.count;
+    batch.worker_count = workers;
+    pthread_mutex_init(&batch.print_lock, NULL);
+    for (int w = 0; w < workers; w++) {
+        pthread_mutex_init(&batch.queues[w].lock, NULL);
+        batch.queues[w].next = (int)((long long)batch.count * w / workers);
+        batch.queues[w].end = (int)((long long)batch.count * (w + 1) / workers);
+    }
+
+    if (!opts->quiet) {
+        print_banner();
+        printf("[RIFTLang] Batch:  %d files, %d workers\n\n", batch.count, workers);
+        fflush(stdout);
+    }
+
+    /* Worker 0 is this thread; one that cannot start leaves its files to thieves */
+    double start = rift_get_time_ms();
+    RiftBatchWorker slots[RIFT_BATCH_MAX_WORKERS];
+    pthread_t threads[RIFT_BATCH_MAX_WORKERS];
+    bool started[RIFT_BATCH_MAX_WORKERS] = { false };
+    for (int w = 0; w < workers; w++) {
+        slots[w].batch = &batch;
+        slots[w].id = w;
+    }
+    for (int w = 1; w < workers; w++) {
+        started[w] = pthread_create(&threads[w], NULL, batch_worker_run, &slots[w]) == 0;
+    }
+    batch_worker_run(&slots[0]);
+    for (int w = 1; w < workers; w++) {
+        if (started[w]) pthread_join(threads[w], NULL);
+    }
+    double wall_ms = rift_get_time_ms() - start;
+
+    int failed = 0;
+    for (int i = 0; i < batch.count; i++) {
+        if (!batch.files[i].ok) failed++;
+    }
+    if (!opts->quiet) {
+        printf("\n[RIFTLang] Batch summary:\n");
+        for (int i = 0; i < batch.count; i++) {
+            printf("  %-6s %9.2f ms  %s\n", batch.files[i].ok ? "ok" : "FAILED",
+                batch.files[i].ms, batch.files[i].input);
+        }
+        printf("[RIFTLang] %d ok, %d failed, %.2f ms wall\n",
+            batch.count - failed, failed, wall_ms);
+    } else if (failed) {
+        fprintf(stderr, "Error: %d of %d files failed\n", failed, batch.count);
+    }
+
+    for (int w = 0; w < workers; w++) {
+        pthread_mutex_destroy(&batch.queues[w].lock);
+    }
+    pthread_mutex_destroy(&batch.print_lock);
+    if (engine) {
+        g_resident_engines[opts->mode] = NULL;
+        rift_pattern_engine_destroy(engine);
+    }
+    free(batch.files);
+    batch_inputs_free(&inputs);
+    return failed ? 1 : 0;
+}
+
+/* ============================================================================
+ * Watch Mode
+ * ============================================================================ */
+
+#ifdef __linux__
+static volatile sig_atomic_t g_watch_stop = 0;
+
+static void watch_stop_handler(int sig) {
+    (void)sig;
+    g_watch_stop = 1;
+}
+
+/* A watched input: the directory watch it belongs to and its name there */
+typedef struct {
+    const char* path;
+    const char* name;               /* points into path */
+    int         wd;
+    bool        dirty;
+} RiftWatchInput;
+
+/* A directory given to --watch --batch, or one below it */
+typedef struct {
+    char* path;
+    int   wd;
+} RiftWatchDir;
+
+/**
+ * Everything a watch loop tracks. inputs[i].path points into
+ * list->paths[i]; new .rift files seen in a watched directory wait in
+ * created until the burst settles and they are adopted.
+ */
+typedef struct {
+    int             fd;
+    RiftBatchInputs* list;
+    RiftWatchInput* inputs;
+    int             input_capacity;
+    RiftWatchDir*   dirs;
+    int             dir_count;
+    int             dir_capacity;
+    RiftBatchInputs created;
+} RiftWatchState;
+
+/* One mask for every watch: a second add on a directory replaces the first */
+#define RIFT_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+/**
+ * Watch the directory holding path rather than path itself: editors that
+ * save by renaming a new file over the old one would end a file watch.
+ * inotify hands back the same descriptor for a directory watched twice.
+ */
+static int watch_add_directory(int fd, const char* path) {
+    const char* slash = strrchr(path, '/');
+    char dir[4096];
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == path) {
+        strcpy(dir, "/");
+    } else {
+        size_t len = (size_t)(slash - path);
+        if (len >= sizeof(dir)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+    return inotify_add_watch(fd, dir, RIFT_WATCH_MASK);
+}
+
+static const RiftWatchDir* watch_find_dir(const RiftWatchState* w, int wd) {
+    for (int i = 0; i < w->dir_count; i++) {
+        if (w->dirs[i].wd == wd) return &w->dirs[i];
+    }
+    return NULL;
+}
+
+/* dir and every directory below it, so .rift files created later are seen */
+static bool watch_add_tree(RiftWatchState* w, const char* dir) {
+    int wd = inotify_add_watch(w->fd, dir, RIFT_WATCH_MASK);
+    if (wd < 0) {
+        fprintf(stderr, "Error: Cannot watch '%s': %s\n", dir, strerror(errno));
+        return false;
+    }
+    if (watch_find_dir(w, wd)) return true;     /* already walked */
+    if (w->dir_count == w->dir_capacity) {
+        int capacity = w->dir_capacity ? w->dir_capacity * 2 : 16;
+        RiftWatchDir* grown = (RiftWatchDir*)realloc(w->dirs, (size_t)capacity * sizeof(RiftWatchDir));
+        if (!grown) return false;
+        w->dirs = grown;
+        w->dir_capacity = capacity;
+    }
+    char* copy = strdup(dir);
+    if (!copy) return false;
+    w->dirs[w->dir_count].path = copy;
+    w->dirs[w->dir_count].wd = wd;
+    w->dir_count++;
+
+    /* Same walk as batch_add_directory, directories only */
+    DIR* handle = opendir(dir);
+    if (!handle) return true;       /* gone again: nothing below to watch */
+    size_t dir_len = strlen(dir);
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(handle)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char path[4096];
+        int n = snprintf(path, sizeof(path), "%s%s%s", dir,
+            dir_len && dir[dir_len - 1] == '/' ? "" : "/", entry->d_name);
+        if (n > 0 && (size_t)n < sizeof(path) && batch_is_directory(path)) {
+            ok = watch_add_tree(w, path);
+        }
+    }
+    closedir(handle);
+    return ok;
+}
+
+static bool watch_add_input(RiftWatchState* w, int index) {
+    if (index >= w->input_capacity) {
+        int capacity = w->input_capacity ? w->input_capacity * 2 : 64;
+        while (capacity <= index) capacity *= 2;
+        RiftWatchInput* grown = (RiftWatchInput*)realloc(w->inputs,
+            (size_t)capacity * sizeof(RiftWatchInput));
+        if (!grown) return false;
+        w->inputs = grown;
+        w->input_capacity = capacity;
+    }
+    const char* path = w->list->paths[index];
+    const char* slash = strrchr(path, '/');
+    RiftWatchInput* input = &w->inputs[index];
+    input->path = path;
+    input->name = slash ? slash + 1 : path;
+    input->dirty = false;
+    input->wd = watch_add_directory(w->fd, path);
+    if (input->wd < 0) {
+        fprintf(stderr, "Error: Cannot watch '%s': %s\n", path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/* Drain pending events, marking the inputs they name; returns how many */
+static int watch_read_events(RiftWatchState* w) {
+    char buffer[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    RiftWatchInput* inputs = w->inputs;
+    int count = w->list->count;
+    int marked = 0;
+    for (;;) {
+        ssize_t len = read(w->fd, buffer, sizeof(buffer));
+        if (len <= 0) break;        /* EAGAIN: drained */
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                /* Events were lost: rebuild everything to be safe */
+                for (int i = 0; i < count; i++) inputs[i].dirty = true;
+                marked += count;
+                continue;
+            }
+            if (ev->len == 0) continue;
+
+            /* Events in a directory input's tree can name new inputs */
+            const RiftWatchDir* dir = watch_find_dir(w, ev->wd);
+            char path[4096];
+            if (dir) {
+                size_t dir_len = strlen(dir->path);
+                int n = snprintf(path, sizeof(path), "%s%s%s", dir->path,
+                    dir_len && dir->path[dir_len - 1] == '/' ? "" : "/", ev->name);
+                if (n < 0 || (size_t)n >= sizeof(path)) dir = NULL;
+            }
+            if (ev->mask & IN_ISDIR) {
+                /* A new directory under a watched one: watch it and take
+                 * the .rift files already written into it */
+                if (dir && (ev->mask & (IN_CREATE | IN_MOVED_TO)) && watch_add_tree(w, path)) {
+                    int before = w->created.count;
+                    if (batch_add_directory(&w->created, path)) {
+                        marked += w->created.count - before;
+                    }
+                }
+                continue;
+            }
+            if (!(ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) continue;
+
+            bool known = false;
+            for (int i = 0; i < count; i++) {
+                if (inputs[i].wd == ev->wd && strcmp(inputs[i].name, ev->name) == 0) {
+                    inputs[i].dirty = true;
+                    known = true;
+                    marked++;
+                }
+            }
+            size_t name_len = strlen(ev->name);
+            if (!known && dir && name_len > 5 && strcmp(ev->name + name_len - 5, ".rift") == 0 &&
+                batch_add_input(&w->created, path)) {
+                marked++;
+            }
+        }
+    }
+    return marked;
+}
+
+/**
+ * Make the .rift files that appeared in watched directories inputs of
+ * their own. One whose outputs would collide with an existing input's is
+ * reported and left out, as batch_check_outputs refuses it up front.
+ */
+static void watch_adopt_created(RiftWatchState* w, const RiftCliOptions* opts) {
+    RiftBatchInputs* list = w->list;
+    for (int c = 0; c < w->created.count; c++) {
+        const char* path = w->created.paths[c];
+        bool known = false;
+        for (int i = 0; i < list->count && !known; i++) {
+            known = strcmp(list->paths[i], path) == 0;
+        }
+        if (known || !file_exists(path)) continue;
+        if (!batch_add_input(list, path)) {
+            fprintf(stderr, "Error: Out of memory\n");
+            break;
+        }
+        int index = list->count - 1;
+        if (!batch_check_outputs(opts, list) || !watch_add_input(w, index)) {
+            free(list->paths[index]);
+            list->count--;
+            continue;
+        }
+        w->inputs[index].dirty = true;
+        if (!opts->quiet) {
+            printf("[RIFTLang] Watching new file %s\n", path);
+            fflush(stdout);
+        }
+    }
+    batch_inputs_free(&w->created);
+}
+
+/**
+ * Rebuild one input. Its messages are captured and only shown if it
+ * fails (or with -v); a success is one line with its latency.
+ */
+static bool watch_rebuild(const RiftCliOptions* base, const char* path, double event_ms) {
+    RiftCliOptions opts = *base;
+    opts.input_file = path;
+    opts.inputs = NULL;
+    opts.input_count = 0;
+
+    RiftBatchLog out, err;
+    t_cli_out = batch_log_open(&out) ? out.stream : NULL;
+    t_cli_err = batch_log_open(&err) ? err.stream : NULL;
+    double start = rift_get_time_ms();
+    bool ok = (!opts.batch || !opts.targets || expand_targets(&opts)) && compile_rift_file(&opts);
+    double end = rift_get_time_ms();
+    t_cli_out = NULL;
+    t_cli_err = NULL;
+
+    if (!ok || opts.verbose) {
+        batch_log_replay(&out, stdout);
+        fflush(stdout);
+        batch_log_replay(&err, stderr);
+    } else {
+        batch_log_discard(&out);
+        batch_log_discard(&err);
+    }
+    if (!ok) {
+        fprintf(stderr, "[RIFTLang] Rebuild FAILED: %s\n", path);
+    } else if (!opts.quiet) {
+        printf("[RIFTLang] Rebuilt %s in %.2f ms (%.2f ms after save)\n",
+            path, end - start, end - event_ms);
+        fflush(stdout);
+    }
+    return ok;
+}
+
+/**
+ * --watch: build as usual, then rebuild inputs whenever they are written.
+ * The pattern engine stays resident and the caches stay open between
+ * rebuilds. A burst of writes (several files saved at once, or an editor
+ * writing in pieces) is collected until it pauses for RIFT_WATCH_QUIET_MS
+ * and each changed file is then rebuilt once. Under --batch, directory
+ * arguments are watched as trees: a .rift file created in one later is
+ * added to the set and built. Runs until SIGINT or SIGTERM.
+ */
+static int run_watch(RiftCliOptions* opts) {
+    /* Same shared engine as --batch, kept for every rebuild */
+    RiftPatternEngine* engine = NULL;
+    if (!opts->targets && !g_resident_engines[opts->mode]) {
+        engine = load_transform_engine(opts);
+        if (!engine) return 1;
+        g_resident_engines[opts->mode] = engine;
+    }
+
+    RiftBatchInputs list;
+    memset(&list, 0, sizeof(list));
+    RiftWatchState w;
+    memset(&w, 0, sizeof(w));
+    w.list = &list;
+    int status = 1;
+    w.fd = -1;
+    if (!(opts->batch ? batch_collect_inputs(opts, &list)
+                      : batch_add_input(&list, opts->input_file))) {
+        goto done;
+    }
+
+    w.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w.fd < 0) {
+        fprintf(stderr, "Error: Cannot start watching: %s\n", strerror(errno));
+        goto done;
+    }
+    for (int i = 0; i < list.count; i++) {
+        if (!watch_add_input(&w, i)) goto done;
+    }
+    if (opts->batch) {
+        for (int i = 0; i < opts->input_count; i++) {
+            if (batch_is_directory(opts->inputs[i]) && !watch_add_tree(&w, opts->inputs[i])) {
+                goto done;
+            }
+        }
+    }
+
+    /* Initial build: the whole set, exactly as without --watch */
+    if (opts->batch) {
+        run_batch(opts);
+    } else {
+        if (!opts->quiet) print_banner();
+        compile_rift_file(opts);
+    }
+
+    /* No SA_RESTART: a stop signal must interrupt poll() */
+    struct sigaction stop;
+    memset(&stop, 0, sizeof(stop));
+    stop.sa_handler = watch_stop_handler;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+
+    if (!opts->quiet) {
+        printf("\n[RIFTLang] Watching %d file%s (Ctrl-C to stop)\n",
+            list.count, list.count == 1 ? "" : "s");
+        fflush(stdout);
+    }
+
+    struct pollfd pfd = { .fd = w.fd, .events = POLLIN, .revents = 0 };
+    while (!g_watch_stop) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: Watch failed: %s\n", strerror(errno));
+            goto done;
+        }
+        double event_ms = rift_get_time_ms();
+        if (watch_read_events(&w) == 0) continue;
+
+        /* Debounce: wait for the burst to settle, but not forever */
+        while (!g_watch_stop && rift_get_time_ms() - event_ms < RIFT_WATCH_MAX_DELAY_MS &&
+               poll(&pfd, 1, RIFT_WATCH_QUIET_MS) > 0) {
+            watch_read_events(&w);
+        }
+        if (g_watch_stop) break;
+
+        watch_adopt_created(&w, opts);
+        for (int i = 0; i < list.count; i++) {
+            if (!w.inputs[i].dirty) continue;
+            w.inputs[i].dirty = false;
+            watch_rebuild(opts, w.inputs[i].path, event_ms);
+        }
+    }
+    if (!opts->quiet) {
+        printf("[RIFTLang] Watch stopped\n");
+    }
+    status = 0;
+
+done:
+    if (w.fd >= 0) close(w.fd);
+    free(w.inputs);
+    for (int i = 0; i < w.dir_count; i++) free(w.dirs[i].path);
+    free(w.dirs);
+    batch_inputs_free(&w.created);
+    batch_inputs_free(&list);
+    if (engine) {
+        g_resident_engines[opts->mode] = NULL;
+        rift_pattern_engine_destroy(engine);
+    }
+    return status;
+}
+
+#else /* !__linux__ */
+
+static int run_watch(RiftCliOptions* opts) {
+    (void)opts;
+    fprintf(stderr, "Error: --watch needs inotify (Linux)\n");
+    return 1;
+}
+
+#endif /* __linux__ */
+
+/**
+ * Run one parsed command line: the rule-image build step or a compile.
+ * Returns the process exit code.
+ */
+static int run_invocation(RiftCliOptions* opts) {
+    /* Build-step mode: precompile the rule table, no input needed */
+    if (opts->emit_rule_image) {
+        RiftPatternEngine* engine = initialize_transform_engine(opts->mode, opts->verbose);
+        bool saved = engine && rift_pattern_engine_save_image(engine, opts->emit_rule_image);
+        if (engine && !saved) {
+            fprintf(stderr, "Error: Cannot write rule image '%s': %s\n",
+                opts->emit_rule_image, strerror(errno));
+        }
+        if (saved && !opts->quiet) {
+            printf("[RIFTLang] Rule image written to: %s (%u rules)\n",
+                opts->emit_rule_image, engine->pair_count);
+        }
+        rift_pattern_engine_destroy(engine);
+        return saved ? 0 : 1;
+    }
+    
+    if (opts->watch) {
+        return run_watch(opts);
+    }
+    
+    if (opts->batch) {
+        return run_batch(opts);
+    }
+    
+    if (!compile_rift_file(opts)) {
+        return 1;
+    }
+    
+    if (!opts->quiet) {
+        printf("\n[RIFTLang] Done.\n");
+    }
+    
+    return 0;
+}
+
+/* ============================================================================
+ * Compile Daemon
+ * ============================================================================ */
+
+/* Environment a forwarded compile reads; nothing else crosses the socket */
+static const char* const k_daemon_env[] = {
+    "CC", "PATH", "RIFTLANG_RULE_IMAGE", "RIFTLANG_CIR_CACHE", "RIFTLANG_BUILD_CACHE", NULL
+};
+
+static bool daemon_env_forwarded(const char* entry) {
+    const char* eq = strchr(entry, '=');
+    if (!eq) return false;
+    for (int i = 0; k_daemon_env[i]; i++) {
+        size_t len = strlen(k_daemon_env[i]);
+        if ((size_t)(eq - entry) == len && strncmp(entry, k_daemon_env[i], len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifndef _WIN32
+extern char** environ;
+
+static volatile sig_atomic_t g_daemon_stop = 0;
+
+static void daemon_stop_handler(int sig) {
+    (void)sig;
+    g_daemon_stop = 1;
+}
+
+/**
+ * One request, in a worker forked per connection: adopt the client's
+ * output streams, working directory and environment, run its command line
+ * as main would, then report the exit code.
+ */
+static int serve_daemon_request(int conn) {
+    signal(SIGCHLD, SIG_DFL);   /* system() must be able to reap gcc */
+    signal(SIGPIPE, SIG_DFL);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    RiftDaemonRequest req;
+    if (!rift_daemon_recv_request(conn, &req)) {
+        /* A client that hung up (or a daemon probing the socket) is not news */
+        if (errno != ECONNRESET) {
+            fprintf(stderr, "Warning: Dropped daemon request: %s\n", strerror(errno));
+        }
+        return 1;
+    }
+    if (req.out_fd >= 0) dup2(req.out_fd, STDOUT_FILENO);
+    if (req.err_fd >= 0) dup2(req.err_fd, STDERR_FILENO);
+
+    int status = 1;
+    if (chdir(req.cwd) != 0) {
+        fprintf(stderr, "Error: Cannot enter '%s': %s\n", req.cwd, strerror(errno));
+    } else {
+        for (int i = 0; k_daemon_env[i]; i++) {
+            unsetenv(k_daemon_env[i]);
+        }
+        /* The payload outlives the worker's use of the environment */
+        for (int i = 0; i < req.envc; i++) {
+            if (daemon_env_forwarded(req.env[i])) putenv(req.env[i]);
+        }
+        RiftCliOptions opts;
+        if (!parse_args(req.argc, req.argv, &opts)) {
+            print_usage(req.argv[0]);
+        } else if (opts.daemon_socket) {
+            fprintf(stderr, "Error: --daemon cannot be sent to a daemon\n");
+        } else {
+            status = run_invocation(&opts);
+        }
+    }
+
+    /* Everything printed must reach the client before it sees the status */
+    fflush(stdout);
+    fflush(stderr);
+    rift_daemon_send_status(conn, status);
+    rift_daemon_request_free(&req);
+    return 0;
+}
+
+/**
+ * --daemon: compile the rules for every mode once, then fork a worker per
+ * connection. Workers inherit the sealed engines, so a request pays for
+ * neither process startup nor rule compilation, and a crashing compile
+ * takes down only its own worker. Runs until SIGINT or SIGTERM.
+ */
+static int run_daemon(const RiftCliOptions* opts) {
+    for (int mode = 0; mode < 3; mode++) {
+        g_resident_engines[mode] = initialize_transform_engine((RiftExecutionMode)mode,
+                                                               opts->verbose);
+        if (!g_resident_engines[mode]) {
+            for (int m = 0; m < mode; m++) {
+                rift_pattern_engine_destroy(g_resident_engines[m]);
+                g_resident_engines[m] = NULL;
+            }
+            return 1;
+        }
+    }
+
+    int listen_fd = rift_daemon_listen(opts->daemon_socket);
+    if (listen_fd < 0) {
+        fprintf(stderr, "Error: Cannot listen on '%s': %s\n",
+            opts->daemon_socket, strerror(errno));
+        for (int mode = 0; mode < 3; mode++) {
+            rift_pattern_engine_destroy(g_resident_engines[mode]);
+            g_resident_engines[mode] = NULL;
+        }
+        return 1;
+    }
+
+    /* No SA_RESTART: a stop signal must interrupt accept() */
+    struct sigaction stop;
+    memset(&stop, 0, sizeof(stop));
+    stop.sa_handler = daemon_stop_handler;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGCHLD, SIG_IGN);   /* workers are reaped by the kernel */
+
+    if (!opts->quiet) {
+        printf("[RIFTLang] Daemon listening on %s (pid %ld)\n",
+            opts->daemon_socket, (long)getpid());
+    }
+
+    while (!g_daemon_stop) {
+        /* A worker must not inherit (and repeat) buffered daemon output */
+        fflush(stdout);
+        fflush(stderr);
+
+        int conn = accept(listen_fd, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            fprintf(stderr, "Error: accept on '%s' failed: %s\n",
+                opts->daemon_socket, strerror(errno));
+            break;
+        }
+        if (!rift_daemon_peer_is_owner(conn)) {
+            close(conn);
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listen_fd);
+            int rc = serve_daemon_request(conn);
+            close(conn);
+            _exit(rc);
+        }
+        if (pid < 0) {
+            fprintf(stderr, "Warning: Cannot start worker: %s\n", strerror(errno));
+        }
+        close(conn);
+    }
+
+    close(listen_fd);
+    unlink(opts->daemon_socket);
+    for (int mode = 0; mode < 3; mode++) {
+        rift_pattern_engine_destroy(g_resident_engines[mode]);
+        g_resident_engines[mode] = NULL;
+    }
+    if (!opts->quiet) {
+        printf("[RIFTLang] Daemon stopped\n");
+    }
+    return 0;
+}
+
+/**
+ * Thin client: send this command line, minus --connect, to the daemon and
+ * wait for its exit code. Returns false (errno set) only if the daemon
+ * never took the request, so the caller can still compile locally.
+ */
+static bool forward_to_daemon(const char* path, int argc, char* argv[], int* status) {
+    int sock = rift_daemon_connect(path);
+    if (sock < 0) return false;
+
+    char** args = (char**)malloc((size_t)argc * sizeof(char*));
+    int arg_count = 0;
+    for (int i = 0; args && i < argc; i++) {
+        if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+            i++;
+            continue;
+        }
+        args[arg_count++] = argv[i];
+    }
+
+    char* env[8];
+    int env_count = 0;
+    for (char** e = environ; *e && env_count < (int)(sizeof(env) / sizeof(env[0])); e++) {
+        if (daemon_env_forwarded(*e)) env[env_count++] = *e;
+    }
+
+    char cwd[4096];
+    bool sent = args && getcwd(cwd, sizeof(cwd)) &&
+                rift_daemon_send_request(sock, cwd, arg_count, args, env_count, env,
+                                         STDOUT_FILENO, STDERR_FILENO);
+    int saved = errno;
+    free(args);
+    if (!sent) {
+        close(sock);
+        errno = saved;
+        return false;
+    }
+
+    if (!rift_daemon_recv_status(sock, status)) {
+        fprintf(stderr, "Error: Daemon at '%s' dropped the request: %s\n",
+            path, strerror(errno));
+        *status = 1;
+    }
+    close(sock);
+    return true;
+}
+
+#else /* _WIN32 */
+
+static int run_daemon(const RiftCliOptions* opts) {
+    (void)opts;
+    fprintf(stderr, "Error: --daemon needs Unix domain sockets\n");
+    return 1;
+}
+
+static bool forward_to_daemon(const char* path, int argc, char* argv[], int* status) {
+    (void)path; (void)argc; (void)argv; (void)status;
+    errno = ENOSYS;
+    return false;
+}
+
+#endif /* _WIN32 */
+
 /* ============================================================================
  * Main Entry Point
  * ============================================================================ */
@@ -1657,17 +3056,26 @@ int main(int argc, char* argv[]) {
     
     if (!parse_args(argc, argv, &opts)) {
         print_usage(argv[0]);
+        free(opts.inputs);
         return 1;
     }
     
-    if (!compile_rift_file(&opts)) {
-        return 1;
-    }
-    
-    if (!opts.quiet) {
-        printf("\n[RIFTLang] Done.\n");
+    int status;
+    const char* daemon = opts.connect_socket ? opts.connect_socket : getenv("RIFTLANG_DAEMON");
+    if (opts.daemon_socket) {
+        status = run_daemon(&opts);
+    } else if (!opts.watch && daemon && *daemon &&
+               forward_to_daemon(daemon, argc, argv, &status)) {
+        /* Thin client: a running daemon compiled this command line warm */
+    } else {
+        if (opts.connect_socket) {
+            fprintf(stderr, "Warning: No daemon at '%s' (%s); compiling locally\n",
+                daemon, strerror(errno));
+        }
+        status = run_invocation(&opts);
     }
     
-    return 0;
+    free(opts.inputs);
+    return status;
 }
 #endif /* RIFTLANG_OPEN_MAIN */
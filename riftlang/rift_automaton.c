@@ -0,0 +1,1291 @@
+/**
+ * @file rift_automaton.c
+ * @brief RIFTLang Multi-Pattern Automaton — Implementation
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * Build pipeline (runs once, from rift_pattern_engine_compile):
+ *   1. Parse each left pattern (POSIX ERE subset) into a small AST.
+ *   2. Emit a Thompson NFA fragment per pattern, terminated by a MATCH
+ *      (or end-of-line MATCH for a trailing '$') marker.
+ *   3. Join all fragments under a search hub that re-enters every
+ *      unanchored pattern at each input byte.
+ *   4. Refine the byte alphabet into equivalence classes and run an
+ *      eager subset construction into a flat transition table.
+ *
+ * Scans are pure table walks: no allocation, no locking, no regexec().
+ */
+
+#include "rift_automaton.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * Internal limits
+ * ============================================================================ */
+
+#define RA_MAX_DEPTH        128         /* nesting depth of ( ) groups */
+#define RA_MAX_REPEAT       32          /* largest {m,n} bound expanded */
+#define RA_MAX_NFA_STATES   (1u << 20)  /* NFA budget across all patterns */
+#define RA_NONE             UINT32_MAX
+
+/* Per-state rank slots in RiftAutomaton.rank / list_off */
+#define RA_SLOT_ACCEPT      0   /* pattern matched at this position */
+#define RA_SLOT_EOS         1   /* pattern matches if input ends here */
+#define RA_SLOT_NL          2   /* pattern matches if next byte is '\n' */
+#define RA_SLOTS            3
+
+/* ============================================================================
+ * Automaton layout
+ * ============================================================================ */
+
+struct RiftAutomaton {
+    uint32_t  pattern_count;
+    uint32_t  state_count;          /* includes dead state 0 */
+    uint32_t  class_count;
+    uint32_t  start;
+    uint32_t  list_total;
+    uint32_t  fallback_count;
+    uint8_t   class_map[256];
+
+    uint32_t* trans;                /* state_count * class_count */
+    uint32_t* rank;                 /* state_count * RA_SLOTS, best rank or RA_NONE */
+    uint32_t* list_off;             /* state_count * RA_SLOTS + 1 */
+    uint32_t* lists;                /* pattern indices, list_total */
+    uint32_t* rank_index;           /* rank → pattern index */
+    uint32_t* pattern_rank;         /* pattern index → rank, RA_NONE if not covered */
+    uint32_t* fallbacks;            /* uncovered pattern indices */
+};
+
+/* ============================================================================
+ * Byte sets
+ * ============================================================================ */
+
+typedef struct { uint64_t w[4]; } RaByteSet;
+
+static void bs_add(RaByteSet* s, unsigned c) {
+    s->w[c >> 6] |= (uint64_t)1 << (c & 63);
+}
+
+static void bs_del(RaByteSet* s, unsigned c) {
+    s->w[c >> 6] &= ~((uint64_t)1 << (c & 63));
+}
+
+static bool bs_has(const RaByteSet* s, unsigned c) {
+    return (s->w[c >> 6] >> (c & 63)) & 1;
+}
+
+static void bs_add_range(RaByteSet* s, unsigned lo, unsigned hi) {
+    for (unsigned c = lo; c <= hi; c++) bs_add(s, c);
+}
+
+/** Add a POSIX [:name:] class (C locale). Returns false if unknown. */
+static bool bs_add_class(RaByteSet* s, const char* name, size_t len) {
+#define RA_CLASS_IS(lit) (len == sizeof(lit) - 1 && memcmp(name, lit, len) == 0)
+    if (RA_CLASS_IS("alpha")) {
+        bs_add_range(s, 'a', 'z'); bs_add_range(s, 'A', 'Z');
+    } else if (RA_CLASS_IS("digit")) {
+        bs_add_range(s, '0', '9');
+    } else if (RA_CLASS_IS("alnum")) {
+        bs_add_range(s, 'a', 'z'); bs_add_range(s, 'A', 'Z'); bs_add_range(s, '0', '9');
+    } else if (RA_CLASS_IS("upper")) {
+        bs_add_range(s, 'A', 'Z');
+    } else if (RA_CLASS_IS("lower")) {
+        bs_add_range(s, 'a', 'z');
+    } else if (RA_CLASS_IS("space")) {
+        bs_add_range(s, '\t', '\r'); bs_add(s, ' ');
+    } else if (RA_CLASS_IS("blank")) {
+        bs_add(s, '\t'); bs_add(s, ' ');
+    } else if (RA_CLASS_IS("punct")) {
+        bs_add_range(s, 33, 47); bs_add_range(s, 58, 64);
+        bs_add_range(s, 91, 96); bs_add_range(s, 123, 126);
+    } else if (RA_CLASS_IS("print")) {
+        bs_add_range(s, 32, 126);
+    } else if (RA_CLASS_IS("graph")) {
+        bs_add_range(s, 33, 126);
+    } else if (RA_CLASS_IS("cntrl")) {
+        bs_add_range(s, 0, 31); bs_add(s, 127);
+    } else if (RA_CLASS_IS("xdigit")) {
+        bs_add_range(s, '0', '9'); bs_add_range(s, 'a', 'f'); bs_add_range(s, 'A', 'F');
+    } else {
+        return false;
+    }
+    return true;
+#undef RA_CLASS_IS
+}
+
+/* ============================================================================
+ * Builder state
+ * ============================================================================ */
+
+typedef enum {
+    AST_SET = 0,    /* one byte from sets[set] */
+    AST_EMPTY,      /* matches the empty string */
+    AST_CAT,        /* a then b */
+    AST_ALT,        /* a or b */
+    AST_REPEAT      /* a{min,max}, max < 0 → unbounded */
+} RaAstKind;
+
+typedef struct {
+    uint8_t  kind;
+    int32_t  a, b;
+    uint32_t set;
+    int32_t  min, max;
+} RaAstNode;
+
+typedef enum {
+    NS_SET = 0,     /* consume byte in sets[arg] → out */
+    NS_SPLIT,       /* ε → out, out1 */
+    NS_EPS,         /* ε → out */
+    NS_FORK,        /* ε → fork_edges[arg .. arg+out) */
+    NS_MATCH,       /* pattern arg matched */
+    NS_EOL          /* pattern arg matches at end of line */
+} RaNfaKind;
+
+typedef struct {
+    uint8_t  kind;
+    uint32_t out, out1;
+    uint32_t arg;
+    uint32_t owner;                 /* pattern index, RA_NONE for hub states */
+} RaNfaState;
+
+/** NFA fragment: start state plus a list of dangling out slots. */
+typedef struct {
+    uint32_t start;
+    uint32_t head, tail;            /* slot + 1, 0 = empty */
+} RaFrag;
+
+typedef struct {
+    /* Shared byte sets (drive class refinement) */
+    RaByteSet*  sets;
+    uint32_t    set_count, set_cap;
+
+    /* Per-pattern AST scratch */
+    RaAstNode*  ast;
+    uint32_t    ast_count, ast_cap;
+    const char* p;
+    const char* end;
+    bool        newline_sensitive;
+    bool        failed;
+
+    /* Combined NFA */
+    RaNfaState* nfa;
+    uint32_t    nfa_count, nfa_cap;
+    uint32_t    owner;              /* pattern being compiled */
+    uint32_t*   fork_edges;
+    uint32_t    fork_count, fork_cap;
+} RaBuilder;
+
+static bool ra_grow(void** buf, uint32_t* cap, uint32_t need, size_t elem) {
+    if (need <= *cap) return true;
+    uint32_t new_cap = *cap ? *cap : 16;
+    while (new_cap < need) {
+        if (new_cap > UINT32_MAX / 2) return false;
+        new_cap *= 2;
+    }
+    void* grown = realloc(*buf, (size_t)new_cap * elem);
+    if (!grown) return false;
+    *buf = grown;
+    *cap = new_cap;
+    return true;
+}
+
+static uint32_t ra_add_set(RaBuilder* b, const RaByteSet* set) {
+    if (!ra_grow((void**)&b->sets, &b->set_cap, b->set_count + 1, sizeof(RaByteSet))) {
+        b->failed = true;
+        return 0;
+    }
+    b->sets[b->set_count] = *set;
+    return b->set_count++;
+}
+
+/* ============================================================================
+ * ERE parser → AST
+ * ============================================================================ */
+
+static int32_t ast_add(RaBuilder* b, uint8_t kind, int32_t x, int32_t y) {
+    if (b->failed) return -1;
+    if (!ra_grow((void**)&b->ast, &b->ast_cap, b->ast_count + 1, sizeof(RaAstNode))) {
+        b->failed = true;
+        return -1;
+    }
+    RaAstNode* n = &b->ast[b->ast_count];
+    memset(n, 0, sizeof(*n));
+    n->kind = kind;
+    n->a = x;
+    n->b = y;
+    return (int32_t)b->ast_count++;
+}
+
+static int32_t ast_set(RaBuilder* b, const RaByteSet* set) {
+    uint32_t s = ra_add_set(b, set);
+    int32_t n = ast_add(b, AST_SET, -1, -1);
+    if (n >= 0) b->ast[n].set = s;
+    return n;
+}
+
+static int32_t ast_byte(RaBuilder* b, unsigned char c) {
+    RaByteSet set = {{0}};
+    bs_add(&set, c);
+    return ast_set(b, &set);
+}
+
+static int32_t parse_alt(RaBuilder* b, int depth);
+
+static int32_t parse_bracket(RaBuilder* b) {
+    RaByteSet set = {{0}};
+    bool negate = false;
+    bool first = true;
+
+    b->p++;                                     /* '[' */
+    if (b->p < b->end && *b->p == '^') {
+        negate = true;
+        b->p++;
+    }
+    for (;;) {
+        if (b->p >= b->end) { b->failed = true; return -1; }
+        unsigned char c = (unsigned char)*b->p;
+        if (c == ']' && !first) { b->p++; break; }
+        first = false;
+
+        if (c == '[' && b->p + 1 < b->end &&
+            (b->p[1] == ':' || b->p[1] == '=' || b->p[1] == '.')) {
+            if (b->p[1] != ':') { b->failed = true; return -1; }
+            const char* name = b->p + 2;
+            const char* q = name;
+            while (q + 1 < b->end && !(q[0] == ':' && q[1] == ']')) q++;
+            if (q + 1 >= b->end || !bs_add_class(&set, name, (size_t)(q - name))) {
+                b->failed = true;
+                return -1;
+            }
+            b->p = q + 2;
+            continue;
+        }
+
+        b->p++;
+        if (b->p + 1 < b->end && *b->p == '-' && b->p[1] != ']') {
+            unsigned char hi = (unsigned char)b->p[1];
+            if (hi == '[' || hi < c) { b->failed = true; return -1; }
+            bs_add_range(&set, c, hi);
+            b->p += 2;
+        } else {
+            bs_add(&set, c);
+        }
+    }
+
+    if (negate) {
+        for (int i = 0; i < 4; i++) set.w[i] = ~set.w[i];
+        if (b->newline_sensitive) bs_del(&set, '\n');
+    }
+    bs_del(&set, 0);
+    return ast_set(b, &set);
+}
+
+static int32_t parse_atom(RaBuilder* b, int depth) {
+    unsigned char c = (unsigned char)*b->p;
+    switch (c) {
+    case '(': {
+        if (depth >= RA_MAX_DEPTH) { b->failed = true; return -1; }
+        b->p++;
+        int32_t inner = parse_alt(b, depth + 1);
+        if (b->failed || b->p >= b->end || *b->p != ')') { b->failed = true; return -1; }
+        b->p++;
+        return inner;
+    }
+    case '[':
+        return parse_bracket(b);
+    case '.': {
+        RaByteSet set = {{0}};
+        bs_add_range(&set, 1, 255);
+        if (b->newline_sensitive) bs_del(&set, '\n');
+        b->p++;
+        return ast_set(b, &set);
+    }
+    case '\\': {
+        if (b->p + 1 >= b->end) { b->failed = true; return -1; }
+        unsigned char e = (unsigned char)b->p[1];
+        /* \1..\9 back-references and GNU \w \b \< escapes are not regular */
+        if ((e >= '0' && e <= '9') || (e >= 'a' && e <= 'z') || (e >= 'A' && e <= 'Z')) {
+            b->failed = true;
+            return -1;
+        }
+        b->p += 2;
+        return ast_byte(b, e);
+    }
+    case '^': case '$':                         /* interior anchors */
+    case '*': case '+': case '?': case '{':     /* dangling operators */
+        b->failed = true;
+        return -1;
+    default:
+        b->p++;
+        return ast_byte(b, c);
+    }
+}
+
+static bool parse_count(RaBuilder* b, int32_t* out) {
+    int32_t v = 0;
+    const char* digits = b->p;
+    while (b->p < b->end && *b->p >= '0' && *b->p <= '9') {
+        v = v * 10 + (*b->p - '0');
+        if (v > RA_MAX_REPEAT) return false;
+        b->p++;
+    }
+    *out = v;
+    return b->p > digits;
+}
+
+static int32_t parse_repeat(RaBuilder* b, int depth) {
+    int32_t atom = parse_atom(b, depth);
+    while (!b->failed && b->p < b->end) {
+        int32_t min, max;
+        char c = *b->p;
+        if (c == '*')      { min = 0; max = -1; b->p++; }
+        else if (c == '+') { min = 1; max = -1; b->p++; }
+        else if (c == '?') { min = 0; max = 1;  b->p++; }
+        else if (c == '{') {
+            b->p++;
+            if (!parse_count(b, &min)) { b->failed = true; return -1; }
+            max = min;
+            if (b->p < b->end && *b->p == ',') {
+                b->p++;
+                max = -1;
+                if (b->p < b->end && *b->p != '}' && !parse_count(b, &max)) {
+                    b->failed = true;
+                    return -1;
+                }
+            }
+            if (b->p >= b->end || *b->p != '}' || (max >= 0 && max < min)) {
+                b->failed = true;
+                return -1;
+            }
+            b->p++;
+        } else {
+            break;
+        }
+        atom = ast_add(b, AST_REPEAT, atom, -1);
+        if (atom < 0) return -1;
+        b->ast[atom].min = min;
+        b->ast[atom].max = max;
+    }
+    return atom;
+}
+
+static int32_t parse_cat(RaBuilder* b, int depth) {
+    int32_t result = -1;
+    while (!b->failed && b->p < b->end && *b->p != '|' && *b->p != ')') {
+        int32_t r = parse_repeat(b, depth);
+        if (b->failed) return -1;
+        result = (result < 0) ? r : ast_add(b, AST_CAT, result, r);
+    }
+    return (result < 0) ? ast_add(b, AST_EMPTY, -1, -1) : result;
+}
+
+static int32_t parse_alt(RaBuilder* b, int depth) {
+    int32_t left = parse_cat(b, depth);
+    while (!b->failed && b->p < b->end && *b->p == '|') {
+        b->p++;
+        int32_t right = parse_cat(b, depth);
+        left = ast_add(b, AST_ALT, left, right);
+    }
+    return left;
+}
+
+/* ============================================================================
+ * AST → Thompson NFA
+ * ============================================================================ */
+
+static uint32_t nfa_add(RaBuilder* b, uint8_t kind, uint32_t out, uint32_t out1, uint32_t arg) {
+    if (b->failed) return 0;
+    if (b->nfa_count >= RA_MAX_NFA_STATES ||
+        !ra_grow((void**)&b->nfa, &b->nfa_cap, b->nfa_count + 1, sizeof(RaNfaState))) {
+        b->failed = true;
+        return 0;
+    }
+    RaNfaState* s = &b->nfa[b->nfa_count];
+    s->kind = kind;
+    s->out = out;
+    s->out1 = out1;
+    s->arg = arg;
+    s->owner = b->owner;
+    return b->nfa_count++;
+}
+
+static uint32_t* nfa_slot(RaBuilder* b, uint32_t slot) {
+    RaNfaState* s = &b->nfa[slot >> 1];
+    return (slot & 1) ? &s->out1 : &s->out;
+}
+
+/** Point every dangling slot in list `head` at `target`. */
+static void frag_patch(RaBuilder* b, uint32_t head, uint32_t target) {
+    while (head) {
+        uint32_t* p = nfa_slot(b, head - 1);
+        head = *p;
+        *p = target;
+    }
+}
+
+/** Append list (head, tail) to f's dangling list. */
+static void frag_append(RaBuilder* b, RaFrag* f, uint32_t head, uint32_t tail) {
+    if (!head) return;
+    if (!f->head) {
+        f->head = head;
+    } else {
+        *nfa_slot(b, f->tail - 1) = head;
+    }
+    f->tail = tail;
+}
+
+/** Fragment of a single state whose `which` out slot dangles. */
+static RaFrag frag_single(uint32_t state, uint32_t which) {
+    RaFrag f;
+    f.start = state;
+    f.head = f.tail = state * 2 + which + 1;
+    return f;
+}
+
+static bool nfa_compile(RaBuilder* b, int32_t n, RaFrag* out);
+
+/** Sequence f then g (g may be empty, signalled by has_g == false). */
+static void frag_concat(RaBuilder* b, RaFrag* f, bool* has_f, const RaFrag* g) {
+    if (!*has_f) {
+        *f = *g;
+        *has_f = true;
+        return;
+    }
+    frag_patch(b, f->head, g->start);
+    f->head = g->head;
+    f->tail = g->tail;
+}
+
+static bool nfa_compile_repeat(RaBuilder* b, const RaAstNode* node, RaFrag* out) {
+    RaFrag result = {0, 0, 0};
+    bool has_result = false;
+    int32_t child = node->a;
+    int32_t min = node->min;
+    int32_t max = node->max;
+
+    if (max < 0) {
+        /* a{min,} → a{min-1} a+  (or a* when min == 0) */
+        for (int32_t i = 0; i + 1 < min; i++) {
+            RaFrag f;
+            if (!nfa_compile(b, child, &f)) return false;
+            frag_concat(b, &result, &has_result, &f);
+        }
+        RaFrag f;
+        if (!nfa_compile(b, child, &f)) return false;
+        uint32_t split = nfa_add(b, NS_SPLIT, f.start, 0, 0);
+        if (b->failed) return false;
+        frag_patch(b, f.head, split);
+        RaFrag loop = frag_single(split, 1);
+        if (min > 0) loop.start = f.start;
+        frag_concat(b, &result, &has_result, &loop);
+    } else {
+        for (int32_t i = 0; i < min; i++) {
+            RaFrag f;
+            if (!nfa_compile(b, child, &f)) return false;
+            frag_concat(b, &result, &has_result, &f);
+        }
+        for (int32_t i = min; i < max; i++) {
+            RaFrag f;
+            if (!nfa_compile(b, child, &f)) return false;
+            uint32_t split = nfa_add(b, NS_SPLIT, f.start, 0, 0);
+            if (b->failed) return false;
+            RaFrag opt = frag_single(split, 1);
+            frag_append(b, &opt, f.head, f.tail);
+            frag_concat(b, &result, &has_result, &opt);
+        }
+        if (!has_result) {
+            uint32_t eps = nfa_add(b, NS_EPS, 0, 0, 0);
+            if (b->failed) return false;
+            result = frag_single(eps, 0);
+        }
+    }
+    *out = result;
+    return true;
+}
+
+static bool nfa_compile(RaBuilder* b, int32_t n, RaFrag* out) {
+    if (b->failed || n < 0) return false;
+    RaAstNode node = b->ast[n];
+
+    switch (node.kind) {
+    case AST_SET: {
+        uint32_t s = nfa_add(b, NS_SET, 0, 0, node.set);
+        *out = frag_single(s, 0);
+        break;
+    }
+    case AST_EMPTY: {
+        uint32_t s = nfa_add(b, NS_EPS, 0, 0, 0);
+        *out = frag_single(s, 0);
+        break;
+    }
+    case AST_CAT: {
+        RaFrag fa, fb;
+        if (!nfa_compile(b, node.a, &fa) || !nfa_compile(b, node.b, &fb)) return false;
+        frag_patch(b, fa.head, fb.start);
+        out->start = fa.start;
+        out->head = fb.head;
+        out->tail = fb.tail;
+        break;
+    }
+    case AST_ALT: {
+        RaFrag fa, fb;
+        if (!nfa_compile(b, node.a, &fa) || !nfa_compile(b, node.b, &fb)) return false;
+        uint32_t s = nfa_add(b, NS_SPLIT, fa.start, fb.start, 0);
+        out->start = s;
+        out->head = fa.head;
+        out->tail = fa.tail;
+        frag_append(b, out, fb.head, fb.tail);
+        break;
+    }
+    case AST_REPEAT:
+        return nfa_compile_repeat(b, &node, out);
+    default:
+        b->failed = true;
+    }
+    return !b->failed;
+}
+
+/**
+ * Compile one pattern into the shared NFA. Returns its start state, or
+ * RA_NONE if the pattern uses constructs the automaton does not model.
+ * *bol is set when the pattern is anchored with a leading '^'.
+ */
+static uint32_t nfa_add_pattern(RaBuilder* b, const RiftAutomatonInput* in,
+                                uint32_t index, bool* bol) {
+    const char* s = in->pattern;
+    size_t len = strlen(s);
+    bool eol = false;
+
+    *bol = false;
+    if (len > 0 && s[0] == '^') {
+        *bol = true;
+        s++;
+        len--;
+    }
+    if (len > 0 && s[len - 1] == '$') {
+        size_t slashes = 0;
+        while (slashes + 1 < len && s[len - 2 - slashes] == '\\') slashes++;
+        if ((slashes & 1) == 0) {
+            eol = true;
+            len--;
+        }
+    }
+
+    uint32_t saved_nfa = b->nfa_count;
+    uint32_t saved_sets = b->set_count;
+    b->ast_count = 0;
+    b->p = s;
+    b->end = s + len;
+    b->newline_sensitive = in->newline_sensitive;
+    b->failed = false;
+    b->owner = index;
+
+    int32_t root = parse_alt(b, 0);
+    /* A leading ^ / trailing $ only binds the outer alternative */
+    if (!b->failed && (b->p != b->end || ((*bol || eol) && b->ast[root].kind == AST_ALT))) {
+        b->failed = true;
+    }
+
+    RaFrag frag;
+    if (!b->failed && nfa_compile(b, root, &frag)) {
+        uint32_t fin = nfa_add(b, eol ? NS_EOL : NS_MATCH, 0, 0, index);
+        if (!b->failed) {
+            frag_patch(b, frag.head, fin);
+            b->owner = RA_NONE;
+            return frag.start;
+        }
+    }
+
+    b->nfa_count = saved_nfa;
+    b->set_count = saved_sets;
+    b->failed = false;
+    b->owner = RA_NONE;
+    return RA_NONE;
+}
+
+static uint32_t nfa_add_fork(RaBuilder* b, const uint32_t* targets, uint32_t n) {
+    if (!ra_grow((void**)&b->fork_edges, &b->fork_cap, b->fork_count + n, sizeof(uint32_t))) {
+        b->failed = true;
+        return 0;
+    }
+    uint32_t off = b->fork_count;
+    if (n) memcpy(b->fork_edges + off, targets, n * sizeof(uint32_t));
+    b->fork_count += n;
+    return nfa_add(b, NS_FORK, n, 0, off);
+}
+
+/* ============================================================================
+ * Subset construction
+ * ============================================================================ */
+
+typedef struct {
+    RaBuilder*  b;
+    uint32_t    class_count;
+    uint8_t     class_map[256];
+    uint8_t     class_rep[256];
+    uint32_t*   set_classes;        /* per byte set: offset into class_lists */
+    uint32_t*   class_lists;        /* concatenated, per set: n then n classes */
+
+    /* ε-closure scratch */
+    uint32_t*   mark;
+    uint32_t    generation;
+    uint32_t*   stack;
+    uint32_t*   closure;
+    uint32_t    closure_len;
+
+    /* DFA states: sorted NFA lists in pool */
+    uint32_t*   pool;
+    uint32_t    pool_len, pool_cap;
+    uint32_t*   dstate_off;
+    uint32_t*   dstate_len;
+    uint64_t*   dstate_hash;
+    uint32_t    dstate_count, dstate_cap;
+    uint32_t*   trans;
+    uint32_t    trans_cap;
+    uint32_t*   table;              /* open addressing: dstate + 1 */
+    uint32_t    table_size;
+    uint32_t    max_states;
+
+    /* Patterns already matched in the state being expanded */
+    uint32_t*   done;
+    uint32_t    done_generation;
+    uint32_t    pattern_count;
+} RaDfaBuilder;
+
+static int cmp_u32(const void* x, const void* y) {
+    uint32_t a = *(const uint32_t*)x, c = *(const uint32_t*)y;
+    return (a > c) - (a < c);
+}
+
+/** Compute the sorted ε-closure of seeds into d->closure (important states only). */
+static void dfa_closure(RaDfaBuilder* d, const uint32_t* seeds, uint32_t n) {
+    RaBuilder* b = d->b;
+    uint32_t sp = 0;
+
+    if (++d->generation == 0) {
+        memset(d->mark, 0, b->nfa_count * sizeof(uint32_t));
+        d->generation = 1;
+    }
+    d->closure_len = 0;
+    for (uint32_t i = 0; i < n; i++) d->stack[sp++] = seeds[i];
+
+    while (sp) {
+        uint32_t s = d->stack[--sp];
+        if (d->mark[s] == d->generation) continue;
+        d->mark[s] = d->generation;
+        const RaNfaState* st = &b->nfa[s];
+        switch (st->kind) {
+        case NS_SPLIT:
+            d->stack[sp++] = st->out1;
+            d->stack[sp++] = st->out;
+            break;
+        case NS_EPS:
+            d->stack[sp++] = st->out;
+            break;
+        case NS_FORK:
+            for (uint32_t k = 0; k < st->out; k++) {
+                d->stack[sp++] = b->fork_edges[st->arg + k];
+            }
+            break;
+        default:
+            d->closure[d->closure_len++] = s;
+            break;
+        }
+    }
+    qsort(d->closure, d->closure_len, sizeof(uint32_t), cmp_u32);
+}
+
+static uint64_t dfa_hash(const uint32_t* v, uint32_t n) {
+    uint64_t h = 1469598103934665603ULL;
+    for (uint32_t i = 0; i < n; i++) {
+        h ^= v[i];
+        h *= 1099511628211ULL;
+    }
+    return h ^ n;
+}
+
+static bool dfa_rehash(RaDfaBuilder* d, uint32_t new_size) {
+    uint32_t* table = (uint32_t*)calloc(new_size, sizeof(uint32_t));
+    if (!table) return false;
+    for (uint32_t i = 0; i < d->dstate_count; i++) {
+        uint32_t h = (uint32_t)d->dstate_hash[i] & (new_size - 1);
+        while (table[h]) h = (h + 1) & (new_size - 1);
+        table[h] = i + 1;
+    }
+    free(d->table);
+    d->table = table;
+    d->table_size = new_size;
+    return true;
+}
+
+/** Find or create the DFA state for d->closure. Returns RA_NONE on failure. */
+static uint32_t dfa_intern(RaDfaBuilder* d) {
+    uint64_t hash = dfa_hash(d->closure, d->closure_len);
+    uint32_t h = (uint32_t)hash & (d->table_size - 1);
+    while (d->table[h]) {
+        uint32_t id = d->table[h] - 1;
+        if (d->dstate_hash[id] == hash && d->dstate_len[id] == d->closure_len &&
+            memcmp(d->pool + d->dstate_off[id], d->closure,
+                   d->closure_len * sizeof(uint32_t)) == 0) {
+            return id;
+        }
+        h = (h + 1) & (d->table_size - 1);
+    }
+
+    if (d->dstate_count >= d->max_states) return RA_NONE;
+    uint32_t id = d->dstate_count;
+    uint32_t cap = d->dstate_cap;
+    if (!ra_grow((void**)&d->dstate_off, &cap, id + 1, sizeof(uint32_t))) return RA_NONE;
+    cap = d->dstate_cap;
+    if (!ra_grow((void**)&d->dstate_len, &cap, id + 1, sizeof(uint32_t))) return RA_NONE;
+    cap = d->dstate_cap;
+    if (!ra_grow((void**)&d->dstate_hash, &cap, id + 1, sizeof(uint64_t))) return RA_NONE;
+    d->dstate_cap = cap;
+    if (!ra_grow((void**)&d->pool, &d->pool_cap, d->pool_len + d->closure_len + 1,
+                 sizeof(uint32_t))) {
+        return RA_NONE;
+    }
+    if (!ra_grow((void**)&d->trans, &d->trans_cap, (id + 1) * d->class_count,
+                 sizeof(uint32_t))) {
+        return RA_NONE;
+    }
+
+    memcpy(d->pool + d->pool_len, d->closure, d->closure_len * sizeof(uint32_t));
+    d->dstate_off[id] = d->pool_len;
+    d->dstate_len[id] = d->closure_len;
+    d->dstate_hash[id] = hash;
+    d->pool_len += d->closure_len;
+    memset(d->trans + (size_t)id * d->class_count, 0, d->class_count * sizeof(uint32_t));
+    d->table[h] = id + 1;
+    d->dstate_count++;
+
+    if (d->dstate_count * 2 > d->table_size && !dfa_rehash(d, d->table_size * 2)) {
+        return RA_NONE;
+    }
+    return id;
+}
+
+/** Split the byte alphabet into classes no byte set can tell apart. */
+static bool dfa_classes(RaDfaBuilder* d) {
+    RaBuilder* b = d->b;
+    uint32_t count = 1;
+
+    memset(d->class_map, 0, sizeof(d->class_map));
+    for (uint32_t s = 0; s < b->set_count; s++) {
+        uint16_t in_id[256], out_id[256];
+        uint32_t next = 0;
+        memset(in_id, 0xFF, sizeof(in_id));
+        memset(out_id, 0xFF, sizeof(out_id));
+        for (unsigned c = 0; c < 256; c++) {
+            uint16_t* slot = bs_has(&b->sets[s], c) ? &in_id[d->class_map[c]]
+                                                    : &out_id[d->class_map[c]];
+            if (*slot == 0xFFFF) *slot = (uint16_t)next++;
+            d->class_map[c] = (uint8_t)*slot;
+        }
+        count = next;
+    }
+    d->class_count = count;
+    for (int c = 255; c >= 0; c--) d->class_rep[d->class_map[c]] = (uint8_t)c;
+
+    /* Per set: which classes it contains */
+    d->set_classes = (uint32_t*)malloc((b->set_count + 1) * sizeof(uint32_t));
+    d->class_lists = (uint32_t*)malloc(((size_t)b->set_count * (count + 1) + 1) * sizeof(uint32_t));
+    if (!d->set_classes || !d->class_lists) return false;
+    uint32_t off = 0;
+    for (uint32_t s = 0; s < b->set_count; s++) {
+        d->set_classes[s] = off;
+        uint32_t n_off = off++;
+        uint32_t n = 0;
+        for (uint32_t k = 0; k < count; k++) {
+            if (bs_has(&b->sets[s], d->class_rep[k])) {
+                d->class_lists[off++] = k;
+                n++;
+            }
+        }
+        d->class_lists[n_off] = n;
+    }
+    return true;
+}
+
+static void dfa_builder_free(RaDfaBuilder* d) {
+    free(d->set_classes);
+    free(d->class_lists);
+    free(d->mark);
+    free(d->stack);
+    free(d->closure);
+    free(d->pool);
+    free(d->dstate_off);
+    free(d->dstate_len);
+    free(d->dstate_hash);
+    free(d->trans);
+    free(d->table);
+    free(d->done);
+}
+
+/** Breadth-first subset construction from NFA state `start`. */
+static bool dfa_construct(RaDfaBuilder* d, uint32_t nfa_start, uint32_t* dfa_start) {
+    RaBuilder* b = d->b;
+    size_t n = b->nfa_count;
+    uint32_t* seeds = NULL;
+    uint32_t seeds_cap = 0;
+    uint32_t* bucket = NULL;
+    bool ok = false;
+
+    d->mark = (uint32_t*)calloc(n, sizeof(uint32_t));
+    d->stack = (uint32_t*)malloc((3 * n + b->fork_count + 1) * sizeof(uint32_t));
+    d->closure = (uint32_t*)malloc((n + 1) * sizeof(uint32_t));
+    d->table_size = 1024;
+    d->table = (uint32_t*)calloc(d->table_size, sizeof(uint32_t));
+    d->done = (uint32_t*)calloc(d->pattern_count + 1, sizeof(uint32_t));
+    bucket = (uint32_t*)malloc((d->class_count + 1) * sizeof(uint32_t));
+    if (!d->mark || !d->stack || !d->closure || !d->table || !d->done || !bucket) goto done;
+
+    /* State 0: dead (empty set) */
+    d->closure_len = 0;
+    if (dfa_intern(d) != 0) goto done;
+
+    dfa_closure(d, &nfa_start, 1);
+    *dfa_start = dfa_intern(d);
+    if (*dfa_start == RA_NONE) goto done;
+
+    for (uint32_t id = 1; id < d->dstate_count; id++) {
+        const uint32_t* set = d->pool + d->dstate_off[id];
+        uint32_t len = d->dstate_len[id];
+
+        /* A pattern that matched here is decided for the rest of the scan:
+         * dropping its live threads keeps trailing loops such as [^;]+
+         * from multiplying the state count. */
+        d->done_generation++;
+        for (uint32_t k = 0; k < len; k++) {
+            const RaNfaState* st = &b->nfa[set[k]];
+            if (st->kind == NS_MATCH) d->done[st->arg] = d->done_generation;
+        }
+
+        /* Bucket successor states by byte class (counting sort) */
+        memset(bucket, 0, (d->class_count + 1) * sizeof(uint32_t));
+        for (uint32_t k = 0; k < len; k++) {
+            const RaNfaState* st = &b->nfa[set[k]];
+            if (st->kind != NS_SET) continue;
+            if (st->owner != RA_NONE && d->done[st->owner] == d->done_generation) continue;
+            const uint32_t* cls = d->class_lists + d->set_classes[st->arg];
+            for (uint32_t j = 1; j <= cls[0]; j++) bucket[cls[j] + 1]++;
+        }
+        for (uint32_t c = 0; c < d->class_count; c++) bucket[c + 1] += bucket[c];
+        if (!ra_grow((void**)&seeds, &seeds_cap, bucket[d->class_count] + 1, sizeof(uint32_t))) {
+            goto done;
+        }
+        for (uint32_t k = 0; k < len; k++) {
+            const RaNfaState* st = &b->nfa[set[k]];
+            if (st->kind != NS_SET) continue;
+            if (st->owner != RA_NONE && d->done[st->owner] == d->done_generation) continue;
+            const uint32_t* cls = d->class_lists + d->set_classes[st->arg];
+            for (uint32_t j = 1; j <= cls[0]; j++) seeds[bucket[cls[j]]++] = st->out;
+        }
+
+        /* bucket[c] now holds the end of class c's seeds */
+        uint32_t from = 0;
+        for (uint32_t c = 0; c < d->class_count; c++) {
+            uint32_t target = 0;
+            if (bucket[c] > from) {
+                dfa_closure(d, seeds + from, bucket[c] - from);
+                target = dfa_intern(d);
+                if (target == RA_NONE) goto done;
+            }
+            d->trans[(size_t)id * d->class_count + c] = target;
+            from = bucket[c];
+        }
+    }
+    ok = true;
+
+done:
+    free(seeds);
+    free(bucket);
+    return ok;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t priority;
+    uint32_t index;
+} RaRankKey;
+
+static int cmp_rank(const void* x, const void* y) {
+    const RaRankKey* a = (const RaRankKey*)x;
+    const RaRankKey* c = (const RaRankKey*)y;
+    if (a->priority != c->priority) return (a->priority > c->priority) - (a->priority < c->priority);
+    return (a->index < c->index) - (a->index > c->index);   /* later pair first */
+}
+
+/** Pack builder output into a single RiftAutomaton allocation. */
+static RiftAutomaton* ra_pack(RaDfaBuilder* d, const RiftAutomatonInput* inputs,
+                              uint32_t count, const uint32_t* pattern_rank,
+                              const uint32_t* rank_index, uint32_t dfa_start) {
+    RaBuilder* b = d->b;
+    uint32_t states = d->dstate_count;
+    uint32_t list_total = 0;
+    uint32_t fallback_count = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (pattern_rank[i] == RA_NONE) fallback_count++;
+    }
+    for (uint32_t i = 0; i < d->pool_len; i++) {
+        const RaNfaState* st = &b->nfa[d->pool[i]];
+        if (st->kind == NS_MATCH) list_total++;
+        if (st->kind == NS_EOL) list_total += inputs[st->arg].newline_sensitive ? 2 : 1;
+    }
+
+    size_t words = (size_t)states * d->class_count       /* trans */
+                 + (size_t)states * RA_SLOTS              /* rank */
+                 + (size_t)states * RA_SLOTS + 1          /* list_off */
+                 + list_total                             /* lists */
+                 + (size_t)count * 2                      /* rank_index, pattern_rank */
+                 + fallback_count;
+    RiftAutomaton* a = (RiftAutomaton*)calloc(1, sizeof(RiftAutomaton) + words * sizeof(uint32_t));
+    if (!a) return NULL;
+
+    uint32_t* w = (uint32_t*)(a + 1);
+    a->trans = w;        w += (size_t)states * d->class_count;
+    a->rank = w;         w += (size_t)states * RA_SLOTS;
+    a->list_off = w;     w += (size_t)states * RA_SLOTS + 1;
+    a->lists = w;        w += list_total;
+    a->rank_index = w;   w += count;
+    a->pattern_rank = w; w += count;
+    a->fallbacks = w;
+
+    a->pattern_count = count;
+    a->state_count = states;
+    a->class_count = d->class_count;
+    a->start = dfa_start;
+    a->list_total = list_total;
+    a->fallback_count = fallback_count;
+    memcpy(a->class_map, d->class_map, sizeof(a->class_map));
+    memcpy(a->trans, d->trans, (size_t)states * d->class_count * sizeof(uint32_t));
+    memcpy(a->rank_index, rank_index, count * sizeof(uint32_t));
+    memcpy(a->pattern_rank, pattern_rank, count * sizeof(uint32_t));
+    for (uint32_t i = 0, f = 0; i < count; i++) {
+        if (pattern_rank[i] == RA_NONE) a->fallbacks[f++] = i;
+    }
+
+    uint32_t pos = 0;
+    for (uint32_t s = 0; s < states; s++) {
+        const uint32_t* set = d->pool + d->dstate_off[s];
+        uint32_t len = d->dstate_len[s];
+        for (uint32_t slot = 0; slot < RA_SLOTS; slot++) {
+            uint32_t best = RA_NONE;
+            a->list_off[s * RA_SLOTS + slot] = pos;
+            for (uint32_t k = 0; k < len; k++) {
+                const RaNfaState* st = &b->nfa[set[k]];
+                bool hit = (slot == RA_SLOT_ACCEPT && st->kind == NS_MATCH) ||
+                           (slot == RA_SLOT_EOS && st->kind == NS_EOL) ||
+                           (slot == RA_SLOT_NL && st->kind == NS_EOL &&
+                            inputs[st->arg].newline_sensitive);
+                if (!hit) continue;
+                a->lists[pos++] = st->arg;
+                if (pattern_rank[st->arg] < best) best = pattern_rank[st->arg];
+            }
+            a->rank[s * RA_SLOTS + slot] = best;
+        }
+    }
+    a->list_off[states * RA_SLOTS] = pos;
+    return a;
+}
+
+RiftAutomaton* rift_automaton_build(const RiftAutomatonInput* inputs,
+                                    uint32_t count, uint32_t max_states) {
+    if (!inputs && count) return NULL;
+
+    RaBuilder b;
+    RaDfaBuilder d;
+    RiftAutomaton* result = NULL;
+    memset(&b, 0, sizeof(b));
+    memset(&d, 0, sizeof(d));
+    d.b = &b;
+    d.pattern_count = count;
+    b.owner = RA_NONE;
+    d.max_states = max_states ? max_states : RIFT_AUTOMATON_MAX_STATES;
+
+    uint32_t* starts = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    uint32_t* hub = (uint32_t*)malloc((count + 3) * sizeof(uint32_t));
+    uint32_t* nl_hub = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    uint32_t* top = (uint32_t*)calloc(count + 2, sizeof(uint32_t));
+    uint32_t* pattern_rank = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    uint32_t* rank_index = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    RaRankKey* keys = (RaRankKey*)malloc((count + 1) * sizeof(RaRankKey));
+    bool* bol = (bool*)malloc((count + 1) * sizeof(bool));
+    if (!starts || !hub || !nl_hub || !top || !pattern_rank || !rank_index || !keys || !bol) {
+        goto cleanup;
+    }
+
+    /* 1-2: per-pattern fragments */
+    for (uint32_t i = 0; i < count; i++) {
+        starts[i] = inputs[i].pattern ? nfa_add_pattern(&b, &inputs[i], i, &bol[i]) : RA_NONE;
+    }
+
+    /* 3: search hub — re-enter unanchored patterns at every byte and
+     * REG_NEWLINE-anchored patterns after every '\n' */
+    uint32_t n_hub = 0, n_nl = 0, n_top = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (starts[i] == RA_NONE) continue;
+        if (!bol[i]) {
+            hub[n_hub++] = starts[i];
+        } else {
+            top[n_top++] = starts[i];
+            if (inputs[i].newline_sensitive) nl_hub[n_nl++] = starts[i];
+        }
+    }
+    if (n_hub || n_nl) {
+        RaByteSet any = {{0}}, nl = {{0}};
+        bs_add_range(&any, 1, 255);
+        bs_add(&nl, '\n');
+        uint32_t any_state = nfa_add(&b, NS_SET, 0, 0, ra_add_set(&b, &any));
+        hub[n_hub++] = any_state;
+        if (n_nl) {
+            uint32_t nl_fork = nfa_add_fork(&b, nl_hub, n_nl);
+            hub[n_hub++] = nfa_add(&b, NS_SET, nl_fork, 0, ra_add_set(&b, &nl));
+        }
+        uint32_t hub_fork = nfa_add_fork(&b, hub, n_hub);
+        if (b.failed) goto cleanup;
+        b.nfa[any_state].out = hub_fork;
+        top[n_top++] = hub_fork;
+    }
+    uint32_t root = nfa_add_fork(&b, top, n_top);
+    if (b.failed) goto cleanup;
+
+    /* Priority ranks: (priority asc, index desc) */
+    for (uint32_t i = 0; i < count; i++) {
+        keys[i].priority = inputs[i].priority;
+        keys[i].index = i;
+    }
+    qsort(keys, count, sizeof(RaRankKey), cmp_rank);
+    for (uint32_t r = 0; r < count; r++) {
+        rank_index[r] = keys[r].index;
+        pattern_rank[keys[r].index] = (starts[keys[r].index] == RA_NONE) ? RA_NONE : r;
+    }
+
+    /* 4: classes + subset construction */
+    uint32_t dfa_start;
+    if (!dfa_classes(&d) || !dfa_construct(&d, root, &dfa_start)) goto cleanup;
+    result = ra_pack(&d, inputs, count, pattern_rank, rank_index, dfa_start);
+
+cleanup:
+    dfa_builder_free(&d);
+    free(b.sets);
+    free(b.ast);
+    free(b.nfa);
+    free(b.fork_edges);
+    free(starts);
+    free(hub);
+    free(nl_hub);
+    free(top);
+    free(pattern_rank);
+    free(rank_index);
+    free(keys);
+    free(bol);
+    return result;
+}
+
+void rift_automaton_free(RiftAutomaton* automaton) {
+    free(automaton);
+}
+
+bool rift_automaton_covers(const RiftAutomaton* automaton, uint32_t index) {
+    return automaton && index < automaton->pattern_count &&
+           automaton->pattern_rank[index] != RA_NONE;
+}
+
+const uint32_t* rift_automaton_fallbacks(const RiftAutomaton* automaton, uint32_t* count) {
+    if (!automaton) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    if (count) *count = automaton->fallback_count;
+    return automaton->fallbacks;
+}
+
+uint32_t rift_automaton_best(const RiftAutomaton* automaton, const char* input) {
+    if (!automaton || !input) return RIFT_AUTOMATON_NO_MATCH;
+
+    const uint32_t* trans = automaton->trans;
+    const uint32_t* rank = automaton->rank;
+    const uint8_t* class_map = automaton->class_map;
+    uint32_t classes = automaton->class_count;
+    uint32_t s = automaton->start;
+    uint32_t best = rank[s * RA_SLOTS + RA_SLOT_ACCEPT];
+
+    for (const unsigned char* p = (const unsigned char*)input; *p && best; p++) {
+        if (*p == '\n' && rank[s * RA_SLOTS + RA_SLOT_NL] < best) {
+            best = rank[s * RA_SLOTS + RA_SLOT_NL];
+        }
+        s = trans[(size_t)s * classes + class_map[*p]];
+        if (s == 0) goto done;
+        if (rank[s * RA_SLOTS + RA_SLOT_ACCEPT] < best) {
+            best = rank[s * RA_SLOTS + RA_SLOT_ACCEPT];
+        }
+    }
+    if (rank[s * RA_SLOTS + RA_SLOT_EOS] < best) {
+        best = rank[s * RA_SLOTS + RA_SLOT_EOS];
+    }
+
+done:
+    return (best == RA_NONE) ? RIFT_AUTOMATON_NO_MATCH : automaton->rank_index[best];
+}
+
+static uint32_t ra_mark(const RiftAutomaton* a, uint32_t s, uint32_t slot, uint64_t* bits) {
+    uint32_t marked = 0;
+    uint32_t from = a->list_off[s * RA_SLOTS + slot];
+    uint32_t to = a->list_off[s * RA_SLOTS + slot + 1];
+    for (uint32_t k = from; k < to; k++) {
+        uint32_t idx = a->lists[k];
+        uint64_t bit = (uint64_t)1 << (idx & 63);
+        if (!(bits[idx >> 6] & bit)) {
+            bits[idx >> 6] |= bit;
+            marked++;
+        }
+    }
+    return marked;
+}
+
+uint32_t rift_automaton_collect(const RiftAutomaton* automaton, const char* input,
+                                uint64_t* bits) {
+    if (!automaton || !input || !bits) return 0;
+
+    const uint32_t* trans = automaton->trans;
+    const uint32_t* rank = automaton->rank;
+    uint32_t classes = automaton->class_count;
+    uint32_t s = automaton->start;
+    uint32_t marked = 0;
+
+    if (rank[s * RA_SLOTS + RA_SLOT_ACCEPT] != RA_NONE) {
+        marked += ra_mark(automaton, s, RA_SLOT_ACCEPT, bits);
+    }
+    for (const unsigned char* p = (const unsigned char*)input; *p; p++) {
+        if (*p == '\n' && rank[s * RA_SLOTS + RA_SLOT_NL] != RA_NONE) {
+            marked += ra_mark(automaton, s, RA_SLOT_NL, bits);
+        }
+        s = trans[(size_t)s * classes + automaton->class_map[*p]];
+        if (s == 0) return marked;
+        if (rank[s * RA_SLOTS + RA_SLOT_ACCEPT] != RA_NONE) {
+            marked += ra_mark(automaton, s, RA_SLOT_ACCEPT, bits);
+        }
+    }
+    if (rank[s * RA_SLOTS + RA_SLOT_EOS] != RA_NONE) {
+        marked += ra_mark(automaton, s, RA_SLOT_EOS, bits);
+    }
+    return marked;
+}
+
+uint32_t rift_automaton_state_count(const RiftAutomaton* automaton) {
+    return automaton ? automaton->state_count : 0;
+}
+
+/* ============================================================================
+ * Serialization
+ * ============================================================================ */
+
+#define RA_IMAGE_HEADER_WORDS   6
+
+/* Table words following the header and class map, in layout order */
+static size_t ra_table_words(uint32_t pattern_count, uint32_t states, uint32_t classes,
+                             uint32_t list_total, uint32_t fallback_count) {
+    return (size_t)states * classes
+         + (size_t)states * RA_SLOTS
+         + (size_t)states * RA_SLOTS + 1
+         + list_total
+         + (size_t)pattern_count * 2
+         + fallback_count;
+}
+
+size_t rift_automaton_serialize(const RiftAutomaton* automaton, void* out, size_t out_size) {
+    if (!automaton) return 0;
+
+    const RiftAutomaton* a = automaton;
+    size_t words = ra_table_words(a->pattern_count, a->state_count, a->class_count,
+                                  a->list_total, a->fallback_count);
+    size_t size = RA_IMAGE_HEADER_WORDS * sizeof(uint32_t) + sizeof(a->class_map)
+                + words * sizeof(uint32_t);
+    if (!out || out_size < size) return size;
+
+    uint32_t header[RA_IMAGE_HEADER_WORDS] = {
+        a->pattern_count, a->state_count, a->class_count,
+        a->start, a->list_total, a->fallback_count
+    };
+    uint8_t* p = (uint8_t*)out;
+    memcpy(p, header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, a->class_map, sizeof(a->class_map));
+    p += sizeof(a->class_map);
+    /* ra_pack lays every table out back to back after the struct */
+    memcpy(p, a->trans, words * sizeof(uint32_t));
+    return size;
+}
+
+static bool ra_check_range(const uint32_t* v, size_t n, uint32_t limit, bool allow_none) {
+    for (size_t i = 0; i < n; i++) {
+        if (v[i] >= limit && !(allow_none && v[i] == RA_NONE)) return false;
+    }
+    return true;
+}
+
+RiftAutomaton* rift_automaton_from_image(const void* data, size_t size,
+                                         uint32_t pattern_count) {
+    const size_t fixed = RA_IMAGE_HEADER_WORDS * sizeof(uint32_t) + 256;
+    if (!data || ((uintptr_t)data & 3) || size < fixed) return NULL;
+
+    uint32_t header[RA_IMAGE_HEADER_WORDS];
+    memcpy(header, data, sizeof(header));
+    uint32_t count = header[0], states = header[1], classes = header[2];
+    uint32_t start = header[3], list_total = header[4], fallback_count = header[5];
+
+    if (count != pattern_count || states == 0 || states > RIFT_AUTOMATON_MAX_STATES ||
+        classes == 0 || classes > 256 || start >= states || fallback_count > count ||
+        (size_t)list_total > (size_t)states * RA_SLOTS * ((size_t)count + 1)) {
+        return NULL;
+    }
+    size_t words = ra_table_words(count, states, classes, list_total, fallback_count);
+    if (size != fixed + words * sizeof(uint32_t)) return NULL;
+
+    RiftAutomaton* a = (RiftAutomaton*)calloc(1, sizeof(RiftAutomaton));
+    if (!a) return NULL;
+
+    a->pattern_count = count;
+    a->state_count = states;
+    a->class_count = classes;
+    a->start = start;
+    a->list_total = list_total;
+    a->fallback_count = fallback_count;
+    memcpy(a->class_map, (const uint8_t*)data + RA_IMAGE_HEADER_WORDS * sizeof(uint32_t),
+           sizeof(a->class_map));
+
+    uint32_t* w = (uint32_t*)((uint8_t*)data + fixed);
+    a->trans = w;        w += (size_t)states * classes;
+    a->rank = w;         w += (size_t)states * RA_SLOTS;
+    a->list_off = w;     w += (size_t)states * RA_SLOTS + 1;
+    a->lists = w;        w += list_total;
+    a->rank_index = w;   w += count;
+    a->pattern_rank = w; w += count;
+    a->fallbacks = w;
+
+    bool ok = true;
+    for (unsigned c = 0; c < 256 && ok; c++) {
+        ok = a->class_map[c] < classes;
+    }
+    ok = ok && ra_check_range(a->trans, (size_t)states * classes, states, false)
+            && ra_check_range(a->rank, (size_t)states * RA_SLOTS, count, true)
+            && ra_check_range(a->lists, list_total, count, false)
+            && ra_check_range(a->rank_index, count, count, false)
+            && ra_check_range(a->pattern_rank, count, count, true)
+            && ra_check_range(a->fallbacks, fallback_count, count, false);
+    for (size_t i = 0; ok && i < (size_t)states * RA_SLOTS; i++) {
+        ok = a->list_off[i] <= a->list_off[i + 1];
+    }
+    ok = ok && a->list_off[0] == 0 && a->list_off[(size_t)states * RA_SLOTS] == list_total;
+
+    if (!ok) {
+        free(a);
+        return NULL;
+    }
+    return a;
+}
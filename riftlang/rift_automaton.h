@@ -0,0 +1,122 @@
+/**
+ * @file rift_automaton.h
+ * @brief RIFTLang Multi-Pattern Automaton — single-pass left-pattern dispatch
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * The pattern engine used to run regexec() once per bipartite pair for
+ * every input line, so matching cost grew linearly with the rule table.
+ * This module compiles every left (input) pattern of an engine into one
+ * deterministic automaton:
+ *
+ *   left patterns (POSIX ERE)
+ *     │  parse → Thompson NFA per pattern, joined under a shared search loop
+ *     ▼  subset construction over byte equivalence classes
+ *   RiftAutomaton — flat DFA transition table
+ *     │  one forward pass per input line
+ *     ▼
+ *   best-priority pair index  /  set of all matching pairs
+ *
+ * Only "does pattern i match somewhere in the input" is decided here;
+ * capture offsets are still produced by POSIX regexec() on the single
+ * winning pair so submatch semantics stay exactly those of regcomp().
+ *
+ * Patterns using constructs the automaton does not model (back-references,
+ * interior anchors, collating elements, very large intervals) are reported
+ * as not covered and the engine evaluates them with regexec() as before.
+ */
+
+#ifndef RIFT_AUTOMATON_H
+#define RIFT_AUTOMATON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define RIFT_AUTOMATON_MAX_STATES   8192        /* DFA build budget */
+#define RIFT_AUTOMATON_NO_MATCH     UINT32_MAX  /* "no pattern matched" */
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+typedef struct RiftAutomaton RiftAutomaton;
+
+/**
+ * RiftAutomatonInput — one left pattern as registered with the engine.
+ * Index in the input array is the pair index reported back by the scans.
+ */
+typedef struct {
+    const char* pattern;            /* POSIX extended regex */
+    uint32_t    priority;           /* Lower = higher priority */
+    bool        newline_sensitive;  /* Compiled with REG_NEWLINE */
+} RiftAutomatonInput;
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/**
+ * rift_automaton_build — compile all patterns into a single DFA.
+ *
+ * Ties between equal priorities resolve to the pattern with the higher
+ * index, matching the engine's historical "later pair wins" behaviour.
+ *
+ * Returns NULL on allocation failure or when the DFA would exceed
+ * max_states; callers then fall back to per-pattern regexec().
+ */
+RiftAutomaton* rift_automaton_build(const RiftAutomatonInput* inputs,
+                                    uint32_t count, uint32_t max_states);
+
+void rift_automaton_free(RiftAutomaton* automaton);
+
+/** True if pattern `index` is decided by the DFA (false → use regexec). */
+bool rift_automaton_covers(const RiftAutomaton* automaton, uint32_t index);
+
+/** Pattern indices not covered by the DFA, in ascending order. */
+const uint32_t* rift_automaton_fallbacks(const RiftAutomaton* automaton,
+                                         uint32_t* count);
+
+/**
+ * rift_automaton_best — one pass, best covered pattern matching `input`.
+ * Returns the pattern index, or RIFT_AUTOMATON_NO_MATCH.
+ */
+uint32_t rift_automaton_best(const RiftAutomaton* automaton, const char* input);
+
+/**
+ * rift_automaton_collect — one pass, mark every covered pattern that
+ * matches `input` in `bits` (one bit per pattern index, caller-zeroed,
+ * (count + 63) / 64 words). Returns the number of patterns marked.
+ */
+uint32_t rift_automaton_collect(const RiftAutomaton* automaton,
+                                const char* input, uint64_t* bits);
+
+uint32_t rift_automaton_state_count(const RiftAutomaton* automaton);
+
+/* ============================================================================
+ * Serialization
+ * ============================================================================ */
+
+/**
+ * rift_automaton_serialize — write the packed tables to `out`.
+ * Returns the image size in bytes; with out == NULL (or out_size too
+ * small) nothing is written, so a first call sizes the buffer.
+ * Images are host-endian; the embedding container records byte order.
+ */
+size_t rift_automaton_serialize(const RiftAutomaton* automaton,
+                                void* out, size_t out_size);
+
+/**
+ * rift_automaton_from_image — view a serialized automaton in place.
+ * `data` must be 4-byte aligned and outlive the returned automaton (an
+ * mmap'd rule image, typically); nothing is copied. Every index in the
+ * tables is bounds-checked, so a corrupt image yields NULL rather than
+ * an out-of-range read during matching. Release with rift_automaton_free.
+ */
+RiftAutomaton* rift_automaton_from_image(const void* data, size_t size,
+                                         uint32_t pattern_count);
+
+#endif /* RIFT_AUTOMATON_H */
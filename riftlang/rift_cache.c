@@ -0,0 +1,756 @@
+/**
+ * @file rift_cache.c
+ * @brief RIFTLang On-Disk CIR Cache — Implementation
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * See rift_cache.h for the design. An entry is:
+ *
+ *   RiftCIRCacheHeader | nodes[node_count] | strings[strings_size] | source
+ *
+ * The source copy makes a hit exact: the key only picks the file, the
+ * loader still compares the bytes, so a key collision is just a miss.
+ * Build cache entries follow the same rule:
+ *
+ *   RiftBuildCacheHeader | identity | source | executable
+ */
+
+#include "rift_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/* ============================================================================
+ * Entry Format
+ * ============================================================================ */
+
+#define RIFT_CIR_CACHE_MAGIC        "RIFTCIRC"
+#define RIFT_CIR_CACHE_BYTE_ORDER   0x01020304u
+#define RIFT_CIR_CACHE_SUFFIX       ".cir"
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;           /* RIFT_CIR_CACHE_VERSION */
+    uint32_t linker_version;    /* RIFT_CIR_LINKER_VERSION */
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t node_size;         /* sizeof(RiftCIRNode) of the writer */
+    uint32_t request_mode;      /* mode passed to the linker */
+    uint32_t program_mode;      /* prog->mode after !govern */
+    uint32_t node_count;
+    uint32_t strings_size;
+    uint32_t reserved;
+    uint64_t source_size;
+    uint64_t checksum;          /* over nodes and strings */
+} RiftCIRCacheHeader;
+
+#define RIFT_BUILD_CACHE_MAGIC      "RIFTBLDC"
+#define RIFT_BUILD_CACHE_SUFFIX     ".bin"
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;           /* RIFT_BUILD_CACHE_VERSION */
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t identity_size;
+    uint64_t source_size;
+    uint64_t artifact_size;
+    uint64_t checksum;          /* over the executable */
+} RiftBuildCacheHeader;
+
+/* ============================================================================
+ * Hashing
+ * ============================================================================ */
+
+/** Word-at-a-time FNV variant; chain calls by passing the previous result. */
+static uint64_t cir_cache_hash(const uint8_t* data, size_t size, uint64_t hash) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash ^ (uint64_t)size;
+}
+
+uint64_t rift_cir_cache_key(const char* source, size_t length, RiftExecutionMode mode) {
+    uint64_t seed = 0xcbf29ce484222325ULL ^
+                    ((uint64_t)RIFT_CIR_LINKER_VERSION << 32) ^
+                    ((uint64_t)mode << 56);
+    uint64_t key = cir_cache_hash((const uint8_t*)source, length, seed);
+    /* Final avalanche so nearby sources land on unrelated file names */
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static uint64_t cir_cache_checksum(const RiftCIRNode* nodes, uint32_t count,
+                                   const char* strings, uint32_t strings_size) {
+    uint64_t hash = cir_cache_hash((const uint8_t*)nodes, (size_t)count * sizeof(RiftCIRNode),
+                                   0xcbf29ce484222325ULL);
+    return cir_cache_hash((const uint8_t*)strings, strings_size, hash);
+}
+
+/* ============================================================================
+ * Directory
+ * ============================================================================ */
+
+static bool cir_cache_entry_path(const RiftCIRCache* cache, uint64_t key,
+                                 char* path, size_t path_size) {
+    int n = snprintf(path, path_size, "%s/%016" PRIx64 RIFT_CIR_CACHE_SUFFIX, cache->dir, key);
+    return n > 0 && (size_t)n < path_size;
+}
+
+/* Copy dir (trailing slashes dropped) into out and create it, mkdir -p style */
+static bool cache_dir_open(char out[RIFT_CIR_CACHE_MAX_PATH], const char* dir) {
+    if (!dir || !*dir) {
+        errno = EINVAL;
+        return false;
+    }
+#ifdef _WIN32
+    (void)out;
+    errno = ENOSYS;
+    return false;
+#else
+    size_t len = strlen(dir);
+    while (len > 1 && dir[len - 1] == '/') len--;
+    /* Leave room for "/<16 hex>.<suffix>.XXXXXX" */
+    if (len + 48 >= RIFT_CIR_CACHE_MAX_PATH) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    memset(out, 0, RIFT_CIR_CACHE_MAX_PATH);
+    memcpy(out, dir, len);
+
+    /* mkdir -p: create each missing component in turn */
+    for (size_t i = 1; i <= len; i++) {
+        if (i < len && out[i] != '/') continue;
+        char saved = out[i];
+        out[i] = '\0';
+        int rc = mkdir(out, 0777);
+        out[i] = saved;
+        if (rc != 0 && errno != EEXIST) return false;
+    }
+
+    struct stat st;
+    if (stat(out, &st) != 0) return false;
+    if (!S_ISDIR(st.st_mode)) {
+        errno = ENOTDIR;
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool rift_cir_cache_open(RiftCIRCache* cache, const char* dir, uint64_t limit_bytes) {
+    if (!cache) {
+        errno = EINVAL;
+        return false;
+    }
+    memset(cache, 0, sizeof(*cache));
+    cache->limit_bytes = limit_bytes ? limit_bytes : RIFT_CIR_CACHE_DEFAULT_LIMIT;
+    return cache_dir_open(cache->dir, dir);
+}
+
+#ifndef _WIN32
+typedef struct {
+    char            name[32];
+    struct timespec mtime;
+    uint64_t        size;
+} RiftCacheEntry;
+
+static int cache_entry_older(const void* a, const void* b) {
+    const struct timespec* ta = &((const RiftCacheEntry*)a)->mtime;
+    const struct timespec* tb = &((const RiftCacheEntry*)b)->mtime;
+    if (ta->tv_sec != tb->tv_sec) return ta->tv_sec < tb->tv_sec ? -1 : 1;
+    if (ta->tv_nsec != tb->tv_nsec) return ta->tv_nsec < tb->tv_nsec ? -1 : 1;
+    return 0;
+}
+
+/**
+ * Delete least recently used entries named *suffix until they fit in
+ * limit bytes. keep (a file name) is never deleted: it is the entry just
+ * written. Entries of the other cache kind sharing the directory are left
+ * alone.
+ */
+static void cache_evict(const char* cache_dir, uint64_t limit, const char* suffix,
+                        const char* keep) {
+    DIR* dir = opendir(cache_dir);
+    if (!dir) return;
+
+    RiftCacheEntry* entries = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+    struct dirent* de;
+    while ((de = readdir(dir)) != NULL) {
+        size_t name_len = strlen(de->d_name);
+        size_t suffix_len = strlen(suffix);
+        if (name_len <= suffix_len || name_len >= sizeof(entries[0].name) ||
+            strcmp(de->d_name + name_len - suffix_len, suffix) != 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir), de->d_name, &st, 0) != 0 || !S_ISREG(st.st_mode)) continue;
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 64;
+            RiftCacheEntry* block = (RiftCacheEntry*)realloc(entries, grown * sizeof(*entries));
+            if (!block) break;
+            entries = block;
+            capacity = grown;
+        }
+        memcpy(entries[count].name, de->d_name, name_len + 1);
+        entries[count].mtime = st.st_mtim;
+        entries[count].size = (uint64_t)st.st_size;
+        total += (uint64_t)st.st_size;
+        count++;
+    }
+
+    if (total > limit) {
+        qsort(entries, count, sizeof(*entries), cache_entry_older);
+        for (size_t i = 0; i < count && total > limit; i++) {
+            if (strcmp(entries[i].name, keep) == 0) continue;
+            if (unlinkat(dirfd(dir), entries[i].name, 0) == 0) {
+                total -= entries[i].size;
+            }
+        }
+    }
+
+    free(entries);
+    closedir(dir);
+}
+
+/**
+ * Create and open a fresh temporary file beside path. tmp_path gets its
+ * name. mkstemp picks a name no other writer holds, threads of this
+ * process included. Returns the fd, or -1 with errno set.
+ */
+static int cache_open_temp(const char* path, char* tmp_path, size_t size) {
+    int n = snprintf(tmp_path, size, "%s.XXXXXX", path);
+    if (n <= 0 || (size_t)n >= size) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = mkstemp(tmp_path);
+    /* mkstemp creates 0600; entries are read back as ordinary files */
+    if (fd >= 0) fchmod(fd, 0644);
+    return fd;
+}
+#endif
+
+/* ============================================================================
+ * Load
+ * ============================================================================ */
+
+/**
+ * True if the mapped entry is intact and was linked from exactly this
+ * source in this mode by this linker.
+ */
+static bool cir_cache_validate(const uint8_t* data, size_t size,
+                               const RiftLineIndex* lines, RiftExecutionMode mode) {
+    RiftCIRCacheHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, RIFT_CIR_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RIFT_CIR_CACHE_VERSION ||
+        header.linker_version != RIFT_CIR_LINKER_VERSION ||
+        header.byte_order != RIFT_CIR_CACHE_BYTE_ORDER ||
+        header.header_size != sizeof(header) ||
+        header.node_size != sizeof(RiftCIRNode) ||
+        header.request_mode != (uint32_t)mode ||
+        header.program_mode > RIFT_MODE_HYBRID ||
+        header.source_size != (uint64_t)lines->length) {
+        return false;
+    }
+
+    uint64_t strings_off = sizeof(header) + (uint64_t)header.node_count * sizeof(RiftCIRNode);
+    uint64_t source_off = strings_off + header.strings_size;
+    if (source_off + header.source_size != size || header.strings_size == 0) {
+        return false;
+    }
+    const char* strings = (const char*)data + strings_off;
+    if (strings[0] != '\0' || strings[header.strings_size - 1] != '\0') return false;
+
+    if (memcmp(data + source_off, lines->source, lines->length) != 0) return false;
+
+    return cir_cache_checksum((const RiftCIRNode*)(data + sizeof(header)), header.node_count,
+                              strings, header.strings_size) == header.checksum;
+}
+
+static RiftCIRProgram* cir_cache_load_key(const RiftCIRCache* cache, const RiftLineIndex* lines,
+                                          RiftExecutionMode mode, uint64_t key) {
+#ifdef _WIN32
+    (void)cache; (void)lines; (void)mode; (void)key;
+    return NULL;
+#else
+    char path[RIFT_CIR_CACHE_MAX_PATH];
+    if (!cir_cache_entry_path(cache, key, path, sizeof(path))) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RiftCIRCacheHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    RiftCIRProgram* prog = NULL;
+    if (cir_cache_validate((const uint8_t*)map, size, lines, mode)) {
+        prog = (RiftCIRProgram*)calloc(1, sizeof(RiftCIRProgram));
+    }
+    if (!prog) {
+        munmap(map, size);
+        return NULL;
+    }
+
+    RiftCIRCacheHeader header;
+    memcpy(&header, map, sizeof(header));
+    prog->nodes            = (RiftCIRNode*)((uint8_t*)map + sizeof(header));
+    prog->count            = header.node_count;
+    prog->capacity         = header.node_count;
+    prog->strings          = (char*)map + sizeof(header) + (size_t)header.node_count * sizeof(RiftCIRNode);
+    prog->strings_size     = header.strings_size;
+    prog->strings_capacity = header.strings_size;
+    prog->mode             = (RiftExecutionMode)header.program_mode;
+    prog->consensus_ok     = true;
+    prog->lines            = *lines;
+    prog->image            = map;
+    prog->image_size       = size;
+
+    /* A hit makes the entry the most recently used */
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return prog;
+#endif
+}
+
+RiftCIRProgram* rift_cir_cache_load(const RiftCIRCache* cache,
+                                    const RiftLineIndex* lines,
+                                    RiftExecutionMode mode) {
+    if (!cache || !lines || !lines->source) return NULL;
+    return cir_cache_load_key(cache, lines, mode,
+                              rift_cir_cache_key(lines->source, lines->length, mode));
+}
+
+/* ============================================================================
+ * Store
+ * ============================================================================ */
+
+static bool cir_cache_store_key(const RiftCIRCache* cache, const RiftLineIndex* lines,
+                                RiftExecutionMode mode, const RiftCIRProgram* prog,
+                                uint64_t key) {
+#ifdef _WIN32
+    (void)cache; (void)lines; (void)mode; (void)prog; (void)key;
+    return false;
+#else
+    if (!prog->consensus_ok || prog->out_of_memory || !prog->strings) return false;
+
+    char path[RIFT_CIR_CACHE_MAX_PATH];
+    char tmp_path[RIFT_CIR_CACHE_MAX_PATH];
+    if (!cir_cache_entry_path(cache, key, path, sizeof(path))) return false;
+
+    RiftCIRCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RIFT_CIR_CACHE_MAGIC, sizeof(header.magic));
+    header.version        = RIFT_CIR_CACHE_VERSION;
+    header.linker_version = RIFT_CIR_LINKER_VERSION;
+    header.byte_order     = RIFT_CIR_CACHE_BYTE_ORDER;
+    header.header_size    = sizeof(header);
+    header.node_size      = sizeof(RiftCIRNode);
+    header.request_mode   = (uint32_t)mode;
+    header.program_mode   = (uint32_t)prog->mode;
+    header.node_count     = prog->count;
+    header.strings_size   = prog->strings_size;
+    header.source_size    = lines->length;
+    header.checksum       = cir_cache_checksum(prog->nodes, prog->count,
+                                               prog->strings, prog->strings_size);
+
+    /* Write beside the entry and rename so readers never map a partial one */
+    int fd = cache_open_temp(path, tmp_path, sizeof(tmp_path));
+    if (fd < 0) return false;
+    FILE* file = fdopen(fd, "wb");
+    if (!file) {
+        close(fd);
+        remove(tmp_path);
+        return false;
+    }
+    size_t nodes_size = (size_t)prog->count * sizeof(RiftCIRNode);
+    bool ok = fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+              (nodes_size == 0 || fwrite(prog->nodes, 1, nodes_size, file) == nodes_size) &&
+              fwrite(prog->strings, 1, prog->strings_size, file) == prog->strings_size &&
+              fwrite(lines->source, 1, lines->length, file) == lines->length;
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) {
+        remove(tmp_path);
+        return false;
+    }
+
+    cache_evict(cache->dir, cache->limit_bytes, RIFT_CIR_CACHE_SUFFIX, strrchr(path, '/') + 1);
+    return true;
+#endif
+}
+
+bool rift_cir_cache_store(const RiftCIRCache* cache,
+                          const RiftLineIndex* lines,
+                          RiftExecutionMode mode,
+                          const RiftCIRProgram* prog) {
+    if (!cache || !lines || !lines->source || !prog) return false;
+    return cir_cache_store_key(cache, lines, mode, prog,
+                               rift_cir_cache_key(lines->source, lines->length, mode));
+}
+
+RiftCIRProgram* rift_cir_cache_link(const RiftCIRCache* cache,
+                                    const RiftLineIndex* lines,
+                                    RiftExecutionMode mode,
+                                    bool* hit) {
+    if (hit) *hit = false;
+    if (!lines || !lines->source) return NULL;
+    if (!cache) return rift_link_lines(lines, mode);
+
+    uint64_t key = rift_cir_cache_key(lines->source, lines->length, mode);
+    RiftCIRProgram* prog = cir_cache_load_key(cache, lines, mode, key);
+    if (prog) {
+        if (hit) *hit = true;
+        return prog;
+    }
+
+    prog = rift_link_lines(lines, mode);
+    if (prog) cir_cache_store_key(cache, lines, mode, prog, key);
+    return prog;
+}
+
+/* ============================================================================
+ * Build Cache
+ * ============================================================================ */
+
+bool rift_build_cache_open(RiftBuildCache* cache, const char* dir, uint64_t limit_bytes) {
+    if (!cache) {
+        errno = EINVAL;
+        return false;
+    }
+    memset(cache, 0, sizeof(*cache));
+    cache->limit_bytes = limit_bytes ? limit_bytes : RIFT_BUILD_CACHE_DEFAULT_LIMIT;
+    return cache_dir_open(cache->dir, dir);
+}
+
+uint64_t rift_build_cache_key(const char* source, size_t length, const char* identity) {
+    uint64_t seed = 0xcbf29ce484222325ULL ^ ((uint64_t)RIFT_BUILD_CACHE_VERSION << 32);
+    uint64_t key = cir_cache_hash((const uint8_t*)identity, strlen(identity), seed);
+    key = cir_cache_hash((const uint8_t*)source, length, key);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static bool build_cache_entry_path(const RiftBuildCache* cache, uint64_t key,
+                                   char* path, size_t path_size) {
+    int n = snprintf(path, path_size, "%s/%016" PRIx64 RIFT_BUILD_CACHE_SUFFIX, cache->dir, key);
+    return n > 0 && (size_t)n < path_size;
+}
+
+/**
+ * The executable inside a mapped entry, or NULL unless the entry is intact
+ * and was built from exactly this source and identity.
+ */
+static const uint8_t* build_cache_validate(const uint8_t* data, size_t size,
+                                           const char* source, size_t length,
+                                           const char* identity, size_t* artifact_size) {
+    RiftBuildCacheHeader header;
+    if (size < sizeof(header)) return NULL;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, RIFT_BUILD_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RIFT_BUILD_CACHE_VERSION ||
+        header.byte_order != RIFT_CIR_CACHE_BYTE_ORDER ||
+        header.header_size != sizeof(header)) {
+        return NULL;
+    }
+
+    size_t identity_size = strlen(identity);
+    if (header.identity_size != identity_size || header.source_size != length) return NULL;
+    size_t body = size - sizeof(header);
+    if (identity_size > body || length > body - identity_size ||
+        header.artifact_size != body - identity_size - length) {
+        return NULL;
+    }
+
+    const uint8_t* p = data + sizeof(header);
+    if (memcmp(p, identity, identity_size) != 0) return NULL;
+    p += identity_size;
+    if (memcmp(p, source, length) != 0) return NULL;
+    p += length;
+
+    if (cir_cache_hash(p, (size_t)header.artifact_size, 0xcbf29ce484222325ULL) != header.checksum) {
+        return NULL;
+    }
+    *artifact_size = (size_t)header.artifact_size;
+    return p;
+}
+
+bool rift_build_cache_fetch(const RiftBuildCache* cache,
+                            const char* source, size_t length,
+                            const char* identity, const char* dest) {
+#ifdef _WIN32
+    (void)cache; (void)source; (void)length; (void)identity; (void)dest;
+    return false;
+#else
+    if (!cache || !source || !identity || !dest) return false;
+
+    char path[RIFT_CIR_CACHE_MAX_PATH];
+    if (!build_cache_entry_path(cache, rift_build_cache_key(source, length, identity),
+                                path, sizeof(path))) {
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RiftBuildCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    size_t artifact_size = 0;
+    const uint8_t* artifact = build_cache_validate((const uint8_t*)map, size, source, length,
+                                                   identity, &artifact_size);
+    bool ok = artifact && rift_write_if_changed(dest, artifact, artifact_size, true) == 0;
+    munmap(map, size);
+
+    /* A hit makes the entry the most recently used */
+    if (ok) utimensat(AT_FDCWD, path, NULL, 0);
+    return ok;
+#endif
+}
+
+bool rift_build_cache_store(const RiftBuildCache* cache,
+                            const char* source, size_t length,
+                            const char* identity, const char* artifact) {
+#ifdef _WIN32
+    (void)cache; (void)source; (void)length; (void)identity; (void)artifact;
+    return false;
+#else
+    if (!cache || !source || !identity || !artifact) return false;
+
+    char path[RIFT_CIR_CACHE_MAX_PATH];
+    char tmp_path[RIFT_CIR_CACHE_MAX_PATH];
+    if (!build_cache_entry_path(cache, rift_build_cache_key(source, length, identity),
+                                path, sizeof(path))) {
+        return false;
+    }
+
+    /* Map the freshly built executable rather than copying it through a buffer */
+    int fd = open(artifact, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    size_t artifact_size = (size_t)st.st_size;
+    void* map = mmap(NULL, artifact_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    RiftBuildCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RIFT_BUILD_CACHE_MAGIC, sizeof(header.magic));
+    header.version       = RIFT_BUILD_CACHE_VERSION;
+    header.byte_order    = RIFT_CIR_CACHE_BYTE_ORDER;
+    header.header_size   = sizeof(header);
+    header.identity_size = (uint32_t)strlen(identity);
+    header.source_size   = length;
+    header.artifact_size = artifact_size;
+    header.checksum      = cir_cache_hash((const uint8_t*)map, artifact_size,
+                                          0xcbf29ce484222325ULL);
+
+    int tmp_fd = cache_open_temp(path, tmp_path, sizeof(tmp_path));
+    FILE* file = tmp_fd >= 0 ? fdopen(tmp_fd, "wb") : NULL;
+    if (!file && tmp_fd >= 0) {
+        close(tmp_fd);
+        remove(tmp_path);
+    }
+    bool ok = file != NULL;
+    if (file) {
+        ok = fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+             fwrite(identity, 1, header.identity_size, file) == header.identity_size &&
+             fwrite(source, 1, length, file) == length &&
+             fwrite(map, 1, artifact_size, file) == artifact_size;
+        ok = (fclose(file) == 0) && ok;
+        ok = ok && rename(tmp_path, path) == 0;
+        if (!ok) remove(tmp_path);
+    }
+    munmap(map, artifact_size);
+    if (!ok) return false;
+
+    cache_evict(cache->dir, cache->limit_bytes, RIFT_BUILD_CACHE_SUFFIX, strrchr(path, '/') + 1);
+    return true;
+#endif
+}
+
+/* ============================================================================
+ * Output Files
+ * ============================================================================ */
+
+#define RIFT_WRITE_IOV_BATCH  64     /* segments per writev, well under IOV_MAX */
+
+#ifndef _WIN32
+/**
+ * True if path is a regular file holding exactly the segments' bytes.
+ * Devices and pipes are never compared: reading them may block or never
+ * end.
+ */
+static bool file_has_content(const char* path, const RiftEmitSegment* segments, int count,
+                             size_t size, bool executable) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size != size) {
+        return false;
+    }
+    if (executable && (st.st_mode & 0111) == 0) return false;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    char buf[16 * 1024];
+    bool same = true;
+    for (int i = 0; same && i < count; i++) {
+        const char* expected = segments[i].data;
+        size_t offset = 0;
+        while (same && offset < segments[i].len) {
+            size_t left = segments[i].len - offset;
+            size_t want = left < sizeof(buf) ? left : sizeof(buf);
+            same = fread(buf, 1, want, file) == want && memcmp(buf, expected + offset, want) == 0;
+            offset += want;
+        }
+    }
+    fclose(file);
+    return same;
+}
+
+static atomic_uint g_write_temp_seq;
+
+/**
+ * Create path.<pid>.<n>.tmp exclusively with mode (under the umask). The
+ * sequence number keeps threads of one process apart; a name left over
+ * from a crashed run is skipped. Returns the fd, or -1 with errno set.
+ */
+static int output_open_temp(const char* path, char* tmp_path, size_t size, mode_t mode) {
+    for (;;) {
+        unsigned seq = atomic_fetch_add_explicit(&g_write_temp_seq, 1, memory_order_relaxed);
+        int n = snprintf(tmp_path, size, "%s.%ld.%u.tmp", path, (long)getpid(), seq);
+        if (n <= 0 || (size_t)n >= size) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        int fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, mode);
+        if (fd >= 0 || errno != EEXIST) return fd;
+    }
+}
+
+/* writev every segment to fd, resuming after short writes; 0 or errno */
+static int write_segments_fd(int fd, const RiftEmitSegment* segments, int count) {
+    struct iovec iov[RIFT_WRITE_IOV_BATCH];
+    int next = 0;               /* first segment not yet queued */
+    size_t skip = 0;            /* bytes of segments[next] already written */
+    while (next < count) {
+        int n = 0;
+        for (int i = next; i < count && n < RIFT_WRITE_IOV_BATCH; i++) {
+            size_t offset = i == next ? skip : 0;
+            iov[n].iov_base = (void*)(segments[i].data + offset);
+            iov[n].iov_len = segments[i].len - offset;
+            n++;
+        }
+        ssize_t written = writev(fd, iov, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        /* Advance past what was written, possibly mid-segment */
+        size_t left = (size_t)written;
+        while (next < count && left >= segments[next].len - skip) {
+            left -= segments[next].len - skip;
+            skip = 0;
+            next++;
+        }
+        skip += left;
+    }
+    return 0;
+}
+#endif
+
+int rift_write_segments_if_changed(const char* path, const RiftEmitSegment* segments,
+                                   int count, bool executable) {
+    if (!path || count < 0 || (!segments && count > 0)) return EINVAL;
+    size_t size = 0;
+    for (int i = 0; i < count; i++) {
+        if (!segments[i].data && segments[i].len > 0) return EINVAL;
+        size += segments[i].len;
+    }
+
+#ifndef _WIN32
+    if (file_has_content(path, segments, count, size, executable)) return 0;
+
+    /*
+     * An executable is written beside path and renamed into place, with
+     * 0777 under the umask (the mode a linker gives it); anything else is
+     * rewritten in place like fopen "wb" would.
+     */
+    char tmp_path[RIFT_CIR_CACHE_MAX_PATH + 32];
+    int fd = executable ? output_open_temp(path, tmp_path, sizeof(tmp_path), 0777)
+                        : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return errno;
+    int error = write_segments_fd(fd, segments, count);
+    if (close(fd) != 0 && !error) error = errno;
+    if (executable) {
+        if (!error && rename(tmp_path, path) != 0) error = errno;
+        if (error) remove(tmp_path);
+    }
+    return error;
+#else
+    (void)executable;
+    FILE* file = fopen(path, "wb");
+    if (!file) return errno;
+    int error = 0;
+    for (int i = 0; !error && i < count; i++) {
+        errno = 0;
+        if (fwrite(segments[i].data, 1, segments[i].len, file) != segments[i].len) {
+            error = errno ? errno : EIO;
+        }
+    }
+    if (fclose(file) != 0 && !error) error = errno;
+    return error;
+#endif
+}
+
+int rift_write_if_changed(const char* path, const void* data, size_t size, bool executable) {
+    if (!data && size > 0) return EINVAL;
+    RiftEmitSegment segment = { (const char*)data, size };
+    return rift_write_segments_if_changed(path, &segment, 1, executable);
+}
@@ -0,0 +1,179 @@
+/**
+ * @file rift_cache.h
+ * @brief RIFTLang On-Disk CIR and Build Caches
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * Linking depends only on the source bytes, the execution mode and the
+ * linker itself, never on the output target. The cache keeps each linked
+ * RiftCIRProgram on disk under a key derived from those three, so emitting
+ * one source to several targets links it once:
+ *
+ *   RIFT source ──hash──▶ <dir>/<key>.cir ──mmap──▶ RiftCIRProgram
+ *                              ▲
+ *                              └── rift_codec_link on a miss, then stored
+ *
+ * Entry layout: header | nodes | string arena. A hit is one mmap; the
+ * loaded program's nodes and strings point straight into the mapping.
+ * Only programs that passed consensus are stored.
+ *
+ * The directory is bounded in size; storing an entry evicts the least
+ * recently used ones (a hit refreshes the entry's mtime). Entries are
+ * written to a uniquely named temporary file (mkstemp) and renamed, so
+ * concurrent writers (other processes, or other threads of this one)
+ * never share a temporary, and readers never map a partial entry.
+ *
+ * The build cache does the same for the gcc step of the C target. An
+ * executable is stored under the generated C and an identity string naming
+ * everything else that shapes it (compiler, flags, runtime library), so an
+ * unchanged program is copied out of the cache instead of recompiled:
+ *
+ *   generated C + identity ──hash──▶ <dir>/<key>.bin ──copy──▶ executable
+ *                                         ▲
+ *                                         └── gcc on a miss, then stored
+ *
+ * Both caches may share a directory; each evicts only its own entries.
+ *
+ * POSIX only: on Windows rift_cir_cache_open and rift_build_cache_open
+ * fail and callers proceed as if the cache were absent.
+ */
+
+#ifndef RIFT_CACHE_H
+#define RIFT_CACHE_H
+
+#include "rift_codec.h"   /* RiftCIRProgram, RiftLineIndex */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define RIFT_CIR_CACHE_VERSION        1     /* entry format revision */
+#define RIFT_CIR_CACHE_DEFAULT_LIMIT  (64u * 1024u * 1024u)   /* bytes */
+#define RIFT_CIR_CACHE_MAX_PATH       1024
+
+#define RIFT_BUILD_CACHE_VERSION        1
+#define RIFT_BUILD_CACHE_DEFAULT_LIMIT  (256u * 1024u * 1024u)   /* bytes */
+
+/* ============================================================================
+ * Cache Handle
+ * ============================================================================ */
+
+/**
+ * RiftCIRCache — a cache directory and its size bound. Plain value, no
+ * resources held; safe to share between threads.
+ */
+typedef struct {
+    char     dir[RIFT_CIR_CACHE_MAX_PATH];
+    uint64_t limit_bytes;   /* evict down to this after each store */
+} RiftCIRCache;
+
+/** RiftBuildCache — like RiftCIRCache, for compiled executables. */
+typedef struct {
+    char     dir[RIFT_CIR_CACHE_MAX_PATH];
+    uint64_t limit_bytes;
+} RiftBuildCache;
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/**
+ * rift_cir_cache_open — use dir as a cache bounded to limit_bytes
+ * (0 = RIFT_CIR_CACHE_DEFAULT_LIMIT), creating the directory if needed.
+ * Returns false (errno set) if dir is unusable.
+ */
+bool rift_cir_cache_open(RiftCIRCache* cache, const char* dir, uint64_t limit_bytes);
+
+/**
+ * rift_cir_cache_key — 64-bit key of a link request: source bytes,
+ * requested mode and RIFT_CIR_LINKER_VERSION.
+ */
+uint64_t rift_cir_cache_key(const char* source, size_t length, RiftExecutionMode mode);
+
+/**
+ * rift_cir_cache_load — the cached program for lines' source in mode, or
+ * NULL on a miss (absent, stale, corrupt or unmappable entry).
+ *
+ * The program is read-only and borrows the line index exactly as
+ * rift_link_lines does. Free it with rift_cir_program_free.
+ */
+RiftCIRProgram* rift_cir_cache_load(const RiftCIRCache* cache,
+                                    const RiftLineIndex* lines,
+                                    RiftExecutionMode mode);
+
+/**
+ * rift_cir_cache_store — write prog (linked from lines in mode) to the
+ * cache, then evict least recently used entries over the limit.
+ * Programs without consensus_ok are not stored. Returns true if stored.
+ */
+bool rift_cir_cache_store(const RiftCIRCache* cache,
+                          const RiftLineIndex* lines,
+                          RiftExecutionMode mode,
+                          const RiftCIRProgram* prog);
+
+/**
+ * rift_cir_cache_link — load from the cache, or rift_link_lines and
+ * store on a miss. *hit (optional) reports which happened.
+ */
+RiftCIRProgram* rift_cir_cache_link(const RiftCIRCache* cache,
+                                    const RiftLineIndex* lines,
+                                    RiftExecutionMode mode,
+                                    bool* hit);
+
+/* ============================================================================
+ * Build Cache
+ * ============================================================================ */
+
+/**
+ * rift_build_cache_open — use dir as a build cache bounded to limit_bytes
+ * (0 = RIFT_BUILD_CACHE_DEFAULT_LIMIT), creating the directory if needed.
+ */
+bool rift_build_cache_open(RiftBuildCache* cache, const char* dir, uint64_t limit_bytes);
+
+/**
+ * rift_build_cache_key — 64-bit key of a build: the generated source and
+ * identity, a string naming the compiler, flags and runtime library.
+ */
+uint64_t rift_build_cache_key(const char* source, size_t length, const char* identity);
+
+/**
+ * rift_build_cache_fetch — on a hit, make dest the cached executable and
+ * return true. Entries keep a copy of source and identity, so a key
+ * collision is a miss. dest is not rewritten if it already matches.
+ */
+bool rift_build_cache_fetch(const RiftBuildCache* cache,
+                            const char* source, size_t length,
+                            const char* identity, const char* dest);
+
+/**
+ * rift_build_cache_store — store the executable at artifact as the build
+ * of source under identity, then evict least recently used entries over
+ * the limit. Returns true if stored.
+ */
+bool rift_build_cache_store(const RiftBuildCache* cache,
+                            const char* source, size_t length,
+                            const char* identity, const char* artifact);
+
+/* ============================================================================
+ * Output Files
+ * ============================================================================ */
+
+/**
+ * rift_write_if_changed — make path hold exactly data[0..size), leaving it
+ * untouched (mtime included) if it already does, so tools keyed on mtime
+ * see no change. An executable is written beside path and renamed into
+ * place, which also works while the old one is running. Returns 0 or an
+ * errno value.
+ */
+int rift_write_if_changed(const char* path, const void* data, size_t size, bool executable);
+
+/**
+ * rift_write_segments_if_changed — rift_write_if_changed for output held
+ * in pieces: the file holds the segments back to back, written with
+ * writev instead of being joined first.
+ */
+int rift_write_segments_if_changed(const char* path, const RiftEmitSegment* segments,
+                                   int count, bool executable);
+
+#endif /* RIFT_CACHE_H */
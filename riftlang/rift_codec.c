@@ -4,8 +4,8 @@
  * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
  *
  * Implements two-phase codec:
- *   Phase 1 — rift_link():        RIFT source → RiftCIRProgram (Canonical IR)
- *   Phase 2 — rift_codec_emit():  RiftCIRProgram → target language text
+ *   Phase 1 — rift_codec_link():       RIFT source → RiftCIRProgram (Canonical IR)
+ *   Phase 2 — rift_codec_emit_file():  RiftCIRProgram → target language text
  *
  * Rifter's Way: forward-only, single-pass, memory-first, no recursion.
  * No NSIGII code. No libpolycall code.
@@ -16,96 +16,369 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <limits.h>
+
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define fileno _fileno
+#else
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 /* ============================================================================
  * Internal string utilities (linker-local, not exported)
+ *
+ * The linker never copies a source line: it works on (pointer, length)
+ * views into the line index's source. Views are not NUL-terminated.
  * ============================================================================ */
 
-static const char* cir_trim_left(const char* s) {
-    while (*s && isspace((unsigned char)*s)) s++;
+typedef RiftLineSlice RiftCIRSlice;
+
+static RiftCIRSlice cir_slice(const char* ptr, size_t len) {
+    RiftCIRSlice s = { ptr, len };
     return s;
 }
 
-static void cir_trim_right(char* s) {
-    size_t len = strlen(s);
-    while (len > 0 && isspace((unsigned char)s[len - 1])) {
-        s[--len] = '\0';
+/** isspace() in the C locale, without a ctype table lookup per byte. */
+static bool cir_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static RiftCIRSlice cir_trim_left(RiftCIRSlice s) {
+    while (s.len > 0 && cir_is_space(*s.ptr)) { s.ptr++; s.len--; }
+    return s;
+}
+
+static RiftCIRSlice cir_trim_right(RiftCIRSlice s) {
+    while (s.len > 0 && cir_is_space(s.ptr[s.len - 1])) s.len--;
+    return s;
+}
+
+/** The part of s before / from p, where p points into s. */
+static RiftCIRSlice cir_before(RiftCIRSlice s, const char* p) {
+    return cir_slice(s.ptr, (size_t)(p - s.ptr));
+}
+
+static RiftCIRSlice cir_from(RiftCIRSlice s, const char* p) {
+    return cir_slice(p, s.len - (size_t)(p - s.ptr));
+}
+
+static bool cir_starts_with(RiftCIRSlice s, const char* prefix) {
+    size_t n = strlen(prefix);
+    return s.len >= n && memcmp(s.ptr, prefix, n) == 0;
+}
+
+static bool cir_equals(RiftCIRSlice s, const char* text) {
+    return s.len == strlen(text) && memcmp(s.ptr, text, s.len) == 0;
+}
+
+static const char* cir_find_char(RiftCIRSlice s, char c) {
+    return s.len ? (const char*)memchr(s.ptr, c, s.len) : NULL;
+}
+
+static const char* cir_find_last_char(RiftCIRSlice s, char c) {
+    for (size_t i = s.len; i > 0; i--) {
+        if (s.ptr[i - 1] == c) return s.ptr + i - 1;
     }
+    return NULL;
 }
 
-static bool cir_starts_with(const char* s, const char* prefix) {
-    return strncmp(s, prefix, strlen(prefix)) == 0;
+/** First occurrence of needle in s, or NULL. */
+static const char* cir_find(RiftCIRSlice s, const char* needle) {
+    size_t n = strlen(needle);
+    while (s.len >= n) {
+        const char* hit = (const char*)memchr(s.ptr, needle[0], s.len - n + 1);
+        if (!hit) return NULL;
+        if (memcmp(hit, needle, n) == 0) return hit;
+        s = cir_from(s, hit + 1);
+    }
+    return NULL;
 }
 
-/** Copy at most (dest_size-1) chars, always NUL-terminate. */
-static void cir_safe_copy(char* dest, const char* src, size_t dest_size) {
-    if (!dest || !src || dest_size == 0) return;
-    strncpy(dest, src, dest_size - 1);
-    dest[dest_size - 1] = '\0';
+/** Leading decimal integer, as atoi() would read it, bounded by the view. */
+static int cir_parse_int(RiftCIRSlice s) {
+    s = cir_trim_left(s);
+    bool negative = false;
+    if (s.len > 0 && (*s.ptr == '-' || *s.ptr == '+')) {
+        negative = (*s.ptr == '-');
+        s.ptr++; s.len--;
+    }
+    long value = 0;
+    while (s.len > 0 && isdigit((unsigned char)*s.ptr) && value <= INT_MAX) {
+        value = value * 10 + (*s.ptr - '0');
+        s.ptr++; s.len--;
+    }
+    if (value > INT_MAX) value = INT_MAX;
+    return (int)(negative ? -value : value);
+}
+
+/* ============================================================================
+ * Line Classification
+ * ============================================================================ */
+
+typedef struct {
+    const char* prefix;
+    uint8_t     len;
+    uint8_t     kind;           /* RiftLineKind */
+    bool        exact;          /* the whole line, not a prefix */
+} RiftLineRule;
+
+#define LINE_RULE(prefix, kind, exact) { prefix, sizeof(prefix) - 1, kind, exact }
+#define LINE_RULE_END                  { NULL, 0, RIFT_LINE_OTHER, false }
+
+/* Keyword rules in groups sharing a first byte, each group ending in
+ * LINE_RULE_END; k_line_group maps a byte to its group (0: none). */
+static const RiftLineRule k_line_rules[] = {
+    LINE_RULE_END,
+    /*  1 */ LINE_RULE("//",           RIFT_LINE_COMMENT,     false),
+             LINE_RULE("/*",           RIFT_LINE_COMMENT,     false),
+             LINE_RULE_END,
+    /*  4 */ LINE_RULE("!govern",      RIFT_LINE_GOVERN,      false),
+             LINE_RULE_END,
+    /*  6 */ LINE_RULE("align span<",  RIFT_LINE_SPAN,        false),
+             LINE_RULE_END,
+    /*  8 */ LINE_RULE("type ",        RIFT_LINE_TYPE,        false),
+             LINE_RULE_END,
+    /* 10 */ LINE_RULE("policy_fn on", RIFT_LINE_POLICY,      false),
+             LINE_RULE_END,
+    /* 12 */ LINE_RULE("while ",       RIFT_LINE_WHILE,       false),
+             LINE_RULE("while(",       RIFT_LINE_WHILE,       false),
+             LINE_RULE_END,
+    /* 15 */ LINE_RULE("if ",          RIFT_LINE_IF,          false),
+             LINE_RULE("if(",          RIFT_LINE_IF,          false),
+             LINE_RULE_END,
+    /* 18 */ LINE_RULE("for ",         RIFT_LINE_FOR,         false),
+             LINE_RULE("for(",         RIFT_LINE_FOR,         false),
+             LINE_RULE_END,
+    /* 21 */ LINE_RULE("}",            RIFT_LINE_BLOCK_CLOSE, true),
+             LINE_RULE("} else",       RIFT_LINE_ELSE,        false),
+             LINE_RULE_END,
+    /* 24 */ LINE_RULE("{",            RIFT_LINE_BLOCK_OPEN,  true),
+             LINE_RULE_END,
+    /* 26 */ LINE_RULE("validate(",    RIFT_LINE_VALIDATE,    false),
+             LINE_RULE_END,
+};
+
+static const uint8_t k_line_group[256] = {
+    ['/'] = 1,  ['!'] = 4,  ['a'] = 6,  ['t'] = 8,  ['p'] = 10, ['w'] = 12,
+    ['i'] = 15, ['f'] = 18, ['}'] = 21, ['{'] = 24, ['v'] = 26,
+};
+
+/** Content between first '(' and last ')' on the line. */
+static RiftCIRSlice line_parens(RiftCIRSlice line) {
+    const char* open = cir_find_char(line, '(');
+    if (!open) return line;
+    RiftCIRSlice inner = cir_from(line, open + 1);
+    const char* close = cir_find_last_char(inner, ')');
+    if (!close || close == inner.ptr) return inner;
+    return cir_before(inner, close);
+}
+
+/* Fill in the fields of a matched rule; false if the line does not
+ * qualify after all (a "type" line without '=') */
+static bool line_extract(RiftLineClass* out, const RiftLineRule* rule) {
+    RiftCIRSlice line = out->line;
+    RiftCIRSlice after = cir_from(line, line.ptr + rule->len);
+
+    switch ((RiftLineKind)rule->kind) {
+    case RIFT_LINE_COMMENT: {
+        RiftCIRSlice body = cir_trim_left(after);
+        const char* end = line.ptr[1] == '*' ? cir_find(body, "*/") : NULL;
+        if (end) {
+            out->rest = cir_trim_left(cir_from(body, end + 2));
+            body = cir_before(body, end);
+        }
+        out->text = cir_trim_right(body);
+        return true;
+    }
+    case RIFT_LINE_GOVERN: {
+        /* The mode word ends at a space or a trailing comment */
+        RiftCIRSlice m = cir_trim_left(after);
+        for (size_t i = 0; i < m.len; i++) {
+            if (m.ptr[i] == ' ' || m.ptr[i] == '/') {
+                m.len = i;
+                break;
+            }
+        }
+        out->name = cir_trim_right(m);
+        return true;
+    }
+    case RIFT_LINE_SPAN: {
+        const char* close = cir_find_char(after, '>');
+        out->name = close ? cir_before(after, close) : cir_slice("fixed", 5);
+        return true;
+    }
+    case RIFT_LINE_TYPE: {
+        const char* eq = cir_find_char(after, '=');
+        if (!eq) return false;
+        out->name = cir_trim_left(cir_trim_right(cir_before(after, eq)));
+        out->closes = cir_find_char(after, '}') != NULL;
+        return true;
+    }
+    case RIFT_LINE_POLICY: {
+        out->closes = cir_find_char(after, '}') != NULL;
+        RiftCIRSlice name = cir_trim_left(after);
+        const char* brace = cir_find_char(name, '{');
+        if (brace) name = cir_before(name, brace);
+        out->name = cir_trim_right(name);
+        return true;
+    }
+    case RIFT_LINE_WHILE:
+    case RIFT_LINE_IF:
+    case RIFT_LINE_FOR:
+    case RIFT_LINE_VALIDATE:
+        out->text = line_parens(line);
+        return true;
+    default:
+        return true;
+    }
 }
 
-/** Returns true if name already in vars[0..count-1]. */
-static bool cir_var_seen(char vars[][RIFT_CIR_MAX_STR], uint32_t count,
-                          const char* name) {
-    for (uint32_t i = 0; i < count; i++) {
-        if (strcmp(vars[i], name) == 0) return true;
+RiftLineKind rift_line_classify(const char* line, size_t len, RiftLineClass* out) {
+    memset(out, 0, sizeof(*out));
+    RiftCIRSlice s = cir_trim_left(cir_trim_right(cir_slice(line ? line : "", line ? len : 0)));
+    out->line = s;
+    if (s.len == 0) return out->kind = RIFT_LINE_EMPTY;
+
+    /* Keywords: only the rules for this first byte are tried, and the
+     * group already matched that byte */
+    for (const RiftLineRule* rule = &k_line_rules[k_line_group[(unsigned char)s.ptr[0]]];
+         rule->prefix; rule++) {
+        if (rule->exact ? s.len != rule->len : s.len < rule->len) continue;
+        size_t i = 1;
+        while (i < rule->len && s.ptr[i] == rule->prefix[i]) i++;
+        if (i == rule->len && line_extract(out, rule)) return out->kind = (RiftLineKind)rule->kind;
+    }
+
+    /* ":=" may follow any leading byte */
+    const char* op = cir_find(s, ":=");
+    if (op) {
+        out->name = cir_trim_right(cir_before(s, op));
+        RiftCIRSlice expr = cir_trim_left(cir_from(s, op + 2));
+        const char* cmt = cir_find(expr, "/*");
+        if (cmt) expr = cir_before(expr, cmt);
+        cmt = cir_find(expr, "//");
+        if (cmt) expr = cir_before(expr, cmt);
+        out->text = cir_trim_right(expr);
+        return out->kind = RIFT_LINE_ASSIGN;
     }
-    return false;
+    return out->kind = RIFT_LINE_OTHER;
 }
 
-/** Extract content between first '(' and last ')' on the line. */
-static void cir_extract_parens(const char* line, char* out, size_t out_size) {
-    const char* open = strchr(line, '(');
-    if (!open) { cir_safe_copy(out, line, out_size); return; }
-    open++;
-    const char* close = strrchr(line, ')');
-    if (!close || close <= open) { cir_safe_copy(out, open, out_size); return; }
-    size_t len = (size_t)(close - open);
-    if (len >= out_size) len = out_size - 1;
-    memcpy(out, open, len);
-    out[len] = '\0';
+/* ============================================================================
+ * String arena
+ * ============================================================================ */
+
+/**
+ * Append s (plus a NUL) to the program's arena and return its offset. On
+ * allocation failure returns 0 (the empty string) and sets
+ * prog->out_of_memory.
+ */
+static RiftCIRStr cir_store(RiftCIRProgram* prog, RiftCIRSlice s) {
+    size_t len = s.len;
+    if (len == 0) return 0;
+
+    uint64_t need = (uint64_t)prog->strings_size + len + 1;
+    if (need > UINT32_MAX) {
+        prog->out_of_memory = true;
+        return 0;
+    }
+    if (need > prog->strings_capacity) {
+        uint64_t capacity = prog->strings_capacity ? prog->strings_capacity : 1024;
+        while (capacity < need) capacity *= 2;
+        if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+        char* grown = (char*)realloc(prog->strings, (size_t)capacity);
+        if (!grown) {
+            prog->out_of_memory = true;
+            return 0;
+        }
+        prog->strings = grown;
+        prog->strings_capacity = (uint32_t)capacity;
+    }
+
+    RiftCIRStr off = prog->strings_size;
+    memcpy(prog->strings + off, s.ptr, len);
+    prog->strings[off + len] = '\0';
+    prog->strings_size = (uint32_t)need;
+    return off;
 }
 
-/** Extract span kind from "align span<kind>" line. */
-static void cir_extract_span_kind(const char* line, char* out, size_t out_size) {
-    const char* open = strchr(line, '<');
-    if (!open) { cir_safe_copy(out, "fixed", out_size); return; }
-    open++;
-    const char* close = strchr(open, '>');
-    if (!close) { cir_safe_copy(out, "fixed", out_size); return; }
-    size_t len = (size_t)(close - open);
-    if (len >= out_size) len = out_size - 1;
-    memcpy(out, open, len);
-    out[len] = '\0';
+/* ============================================================================
+ * Growable storage
+ * ============================================================================ */
+
+/**
+ * Grow *items (of item_size bytes) to hold at least need entries, doubling.
+ * Returns false, leaving the array untouched, if that is impossible.
+ */
+static bool cir_reserve(void** items, uint32_t* capacity, uint32_t need, size_t item_size) {
+    if (need <= *capacity) return true;
+    uint64_t grown = *capacity ? *capacity : 64;
+    while (grown < need) grown *= 2;
+    if (grown > UINT32_MAX) grown = UINT32_MAX;
+    if (grown > SIZE_MAX / item_size) return false;
+    void* block = realloc(*items, (size_t)grown * item_size);
+    if (!block) return false;
+    *items = block;
+    *capacity = (uint32_t)grown;
+    return true;
 }
 
-/* Strip line and block comment prefixes, write inner text to out. */
-static void cir_strip_comment_prefix(const char* line, char* out, size_t out_size) {
-    const char* s = line;
-    if (cir_starts_with(s, "//")) {
-        s += 2;
-    } else if (cir_starts_with(s, "/*")) {
-        s += 2;
-        const char* end = strstr(s, "*/");
-        if (end) s = end + 2;
+/**
+ * Append a node (amortized O(1)). On failure the node is not added and
+ * prog->out_of_memory is set, so rift_codec_link reports the truncation.
+ */
+static void cir_commit(RiftCIRProgram* prog, const RiftCIRNode* node) {
+    if (prog->count == UINT32_MAX ||
+        !cir_reserve((void**)&prog->nodes, &prog->capacity, prog->count + 1, sizeof(*node))) {
+        prog->out_of_memory = true;
+        return;
     }
-    s = cir_trim_left(s);
-    cir_safe_copy(out, s, out_size);
-    cir_trim_right(out);
+    prog->nodes[prog->count++] = *node;
 }
 
 /* ============================================================================
  * Phase 1 — Linker
  * ============================================================================ */
 
-RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
+RiftCIRProgram* rift_codec_link(const char* source, RiftExecutionMode mode) {
     if (!source) return NULL;
 
+    RiftLineIndex lines;
+    if (!riftlang_line_index_build(&lines, source, strlen(source))) return NULL;
+
+    RiftCIRProgram* prog = rift_link_lines(&lines, mode);
+    if (!prog) {
+        riftlang_line_index_free(&lines);
+        return NULL;
+    }
+    prog->owns_lines = true;
+    return prog;
+}
+
+RiftCIRProgram* rift_link_lines(const RiftLineIndex* lines, RiftExecutionMode mode) {
+    if (!lines || !lines->source) return NULL;
+
     RiftCIRProgram* prog = (RiftCIRProgram*)calloc(1, sizeof(RiftCIRProgram));
     if (!prog) return NULL;
 
     prog->mode         = mode;
     prog->consensus_ok = false;
+    prog->lines        = *lines;
+
+    /* Arena offset 0 is the shared empty string */
+    prog->strings = (char*)malloc(1024);
+    if (!prog->strings) {
+        free(prog);
+        return NULL;
+    }
+    prog->strings[0]       = '\0';
+    prog->strings_size     = 1;
+    prog->strings_capacity = 1024;
 
     /* Linker state */
     bool seen_span        = false;
@@ -113,7 +386,6 @@ RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
     bool in_type_block    = false;
     bool in_policy_block  = false;
     int  block_depth      = 0;     /* tracks { depth inside while/if */
-    uint32_t line_num     = 0;
 
     /* Pending multi-line nodes — accumulated before commit */
     RiftCIRNode pending;
@@ -121,51 +393,32 @@ RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
     int pending_field_count = 0;   /* fields collected so far in type block */
 
     /* Variable tracking for is_first_use */
-    char declared_vars[RIFT_CIR_MAX_VARS][RIFT_CIR_MAX_STR];
-    uint32_t var_count = 0;
-
-    /* Helper macro: commit a node if there is room */
-#define COMMIT(node_ptr) do { \
-    if (prog->count < RIFT_CIR_MAX_NODES) { \
-        prog->nodes[prog->count++] = *(node_ptr); \
-    } \
-} while (0)
-
-    /* Walk source line by line */
-    const char* p = source;
-    while (*p) {
-        /* Find end of line */
-        const char* eol = strchr(p, '\n');
-        size_t line_len = eol ? (size_t)(eol - p) : strlen(p);
+    RiftStringSet declared_vars;
+    memset(&declared_vars, 0, sizeof(declared_vars));
 
-        line_num++;
+    /* Walk the indexed lines; nodes keep the line's byte offset */
+    for (uint32_t line_num = 1; line_num <= lines->count; line_num++) {
+        size_t line_len = 0;
+        const char* p = riftlang_line_index_get(lines, line_num, &line_len);
+        uint32_t line_offset = (uint32_t)(p - lines->source);
 
-        /* Copy line to a mutable buffer */
-        char line_buf[4096];
-        size_t copy_len = line_len < sizeof(line_buf) - 1 ? line_len : sizeof(line_buf) - 1;
-        memcpy(line_buf, p, copy_len);
-        line_buf[copy_len] = '\0';
-        cir_trim_right(line_buf);
-
-        const char* trimmed = cir_trim_left(line_buf);
-
-        /* Advance source pointer */
-        p = eol ? eol + 1 : p + strlen(p);
+        /* View of the line without surrounding whitespace — no copy */
+        RiftCIRSlice trimmed = cir_trim_left(cir_trim_right(cir_slice(p, line_len)));
 
         /* Skip empty lines */
-        if (!*trimmed) continue;
+        if (trimmed.len == 0) continue;
 
         /* ------------------------------------------------------------------ */
         /* Inside SPAN block accumulation                                       */
         /* ------------------------------------------------------------------ */
         if (in_span_block) {
             if (cir_starts_with(trimmed, "bytes:")) {
-                pending.span_bytes = atoi(cir_trim_left(trimmed + 6));
+                pending.span_bytes = cir_parse_int(cir_from(trimmed, trimmed.ptr + 6));
             }
-            if (strchr(trimmed, '}')) {
+            if (cir_find_char(trimmed, '}')) {
                 /* Commit the SPAN node */
-                pending.source_line = line_num;
-                COMMIT(&pending);
+                pending.source_offset = line_offset;
+                cir_commit(prog, &pending);
                 seen_span     = true;
                 in_span_block = false;
                 memset(&pending, 0, sizeof(pending));
@@ -177,7 +430,7 @@ RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
         /* Inside TYPE block accumulation                                       */
         /* ------------------------------------------------------------------ */
         if (in_type_block) {
-            if (strchr(trimmed, '}')) {
+            if (cir_find_char(trimmed, '}')) {
                 /* Mark the previous field as last (if any) */
                 if (prog->count > 0 && pending_field_count > 0) {
                     /* Walk back to find the last CIR_TYPE_FIELD */
@@ -194,28 +447,20 @@ RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
                 memset(&pending, 0, sizeof(pending));
             } else {
                 /* Parse "field_name: FIELD_TYPE" */
-                const char* colon = strchr(trimmed, ':');
+                const char* colon = cir_find_char(trimmed, ':');
                 if (colon) {
                     RiftCIRNode field;
                     memset(&field, 0, sizeof(field));
                     field.kind        = CIR_TYPE_FIELD;
-                    field.source_line = line_num;
-                    size_t name_len   = (size_t)(colon - trimmed);
-                    if (name_len >= RIFT_CIR_MAX_STR) name_len = RIFT_CIR_MAX_STR - 1;
-                    char fname[RIFT_CIR_MAX_STR];
-                    memcpy(fname, trimmed, name_len);
-                    fname[name_len] = '\0';
-                    cir_trim_right(fname);
-                    cir_safe_copy(field.field_name, fname, sizeof(field.field_name));
-                    const char* ftype = cir_trim_left(colon + 1);
+                    field.source_offset = line_offset;
+                    RiftCIRSlice fname = cir_before(trimmed, colon);
+                    field.field_name = cir_store(prog, cir_trim_right(fname));
                     /* strip trailing comma */
-                    char ftbuf[32];
-                    cir_safe_copy(ftbuf, ftype, sizeof(ftbuf));
-                    cir_trim_right(ftbuf);
-                    size_t ftlen = strlen(ftbuf);
-                    if (ftlen > 0 && ftbuf[ftlen - 1] == ',') ftbuf[ftlen - 1] = '\0';
-                    cir_safe_copy(field.field_type, ftbuf, sizeof(field.field_type));
-                    COMMIT(&field);
+                    RiftCIRSlice ftype = cir_trim_left(cir_from(trimmed, colon + 1));
+                    ftype = cir_trim_right(ftype);
+                    if (ftype.len > 0 && ftype.ptr[ftype.len - 1] == ',') ftype.len--;
+                    field.field_type = cir_store(prog, ftype);
+                    cir_commit(prog, &field);
                     pending_field_count++;
                 }
             }
@@ -226,202 +471,155 @@ RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode) {
         /* Inside POLICY block — consume body, do not emit                     */
         /* ------------------------------------------------------------------ */
         if (in_policy_block) {
-            if (strchr(trimmed, '}')) {
+            if (cir_find_char(trimmed, '}')) {
                 in_policy_block = false;
             }
             continue;
         }
 
         /* ================================================================== */
-        /* Normal line classification                                          */
+        /* Statement line — one classification, fields are views.            */
+        /* for and else have no CIR kind of their own: they stay UNKNOWN.     */
         /* ================================================================== */
 
+        RiftLineClass c;
+        rift_line_classify(trimmed.ptr, trimmed.len, &c);
+
         RiftCIRNode node;
         memset(&node, 0, sizeof(node));
-        node.source_line = line_num;
+        node.source_offset = line_offset;
 
-        /* -- COMMENT -------------------------------------------------------- */
-        if (cir_starts_with(trimmed, "//") || cir_starts_with(trimmed, "/*")) {
+        switch (c.kind) {
+        case RIFT_LINE_COMMENT:
+            /* -- COMMENT: a block comment keeps what follows its close ----- */
             node.kind = CIR_COMMENT;
-            cir_strip_comment_prefix(trimmed, node.text, sizeof(node.text));
-            COMMIT(&node);
+            node.text = cir_store(prog, cir_trim_right(c.rest.ptr ? c.rest : c.text));
+            cir_commit(prog, &node);
             continue;
-        }
 
-        /* -- GOVERN --------------------------------------------------------- */
-        if (cir_starts_with(trimmed, "!govern")) {
+        case RIFT_LINE_GOVERN: {
+            /* -- GOVERN ----------------------------------------------------- */
             node.kind = CIR_GOVERN;
-            const char* m = cir_trim_left(trimmed + 7);
-            /* strip trailing comment */
-            char mbuf[32];
-            cir_safe_copy(mbuf, m, sizeof(mbuf));
-            char* space = strchr(mbuf, ' ');
-            if (space) *space = '\0';
-            char* slash = strchr(mbuf, '/');
-            if (slash) *slash = '\0';
-            cir_trim_right(mbuf);
-            cir_safe_copy(node.mode, mbuf, sizeof(node.mode));
+            RiftCIRSlice m = cir_trim_right(c.name);
+            node.mode = cir_store(prog, m);
             /* update program mode */
-            if (strcmp(mbuf, "quantum") == 0) prog->mode = RIFT_MODE_QUANTUM;
-            else if (strcmp(mbuf, "hybrid") == 0) prog->mode = RIFT_MODE_HYBRID;
+            if (cir_equals(m, "quantum")) prog->mode = RIFT_MODE_QUANTUM;
+            else if (cir_equals(m, "hybrid")) prog->mode = RIFT_MODE_HYBRID;
             else prog->mode = RIFT_MODE_CLASSICAL;
-            COMMIT(&node);
+            cir_commit(prog, &node);
             continue;
         }
 
-        /* -- SPAN block start ----------------------------------------------- */
-        if (cir_starts_with(trimmed, "align span<")) {
+        case RIFT_LINE_SPAN:
+            /* -- SPAN block start ------------------------------------------- */
             memset(&pending, 0, sizeof(pending));
             pending.kind = CIR_SPAN;
-            cir_extract_span_kind(trimmed, pending.span_kind, sizeof(pending.span_kind));
+            pending.span_kind = cir_store(prog, c.name);
             pending.span_bytes = 4096;  /* default */
             in_span_block = true;
             continue;
-        }
 
-        /* -- TYPE block start ----------------------------------------------- */
-        if (cir_starts_with(trimmed, "type ") && strchr(trimmed, '=')) {
+        case RIFT_LINE_TYPE:
+            /* -- TYPE block start ------------------------------------------- */
             /* Consensus check: span must be declared first */
             if (!seen_span) {
                 snprintf(prog->error_msg, sizeof(prog->error_msg),
                     "line %u: type declaration before span (violates memory-first ordering)", line_num);
+                rift_string_set_free(&declared_vars);
                 return prog;
             }
             node.kind = CIR_TYPE_DEF;
-            /* parse "type Name = {" */
-            const char* name_start = trimmed + 5;  /* skip "type " */
-            const char* eq = strchr(name_start, '=');
-            size_t name_len = (size_t)(eq - name_start);
-            char tbuf[RIFT_CIR_MAX_STR];
-            if (name_len >= sizeof(tbuf)) name_len = sizeof(tbuf) - 1;
-            memcpy(tbuf, name_start, name_len);
-            tbuf[name_len] = '\0';
-            cir_trim_right(tbuf);
-            cir_safe_copy(node.type_name, tbuf, sizeof(node.type_name));
-            COMMIT(&node);
-            in_type_block       = true;
-            pending_field_count = 0;
+            node.type_name = cir_store(prog, cir_trim_right(c.name));
+            cir_commit(prog, &node);
             /* if { is on same line, check for } too */
-            if (strchr(trimmed, '}')) {
-                in_type_block = false;
-            }
+            in_type_block       = !c.closes;
+            pending_field_count = 0;
             continue;
-        }
 
-        /* -- POLICY block --------------------------------------------------- */
-        if (cir_starts_with(trimmed, "policy_fn on")) {
+        case RIFT_LINE_POLICY:
+            /* -- POLICY block ----------------------------------------------- */
             node.kind = CIR_POLICY;
-            const char* pname = cir_trim_left(trimmed + 12);  /* skip "policy_fn on" */
-            char pbuf[RIFT_CIR_MAX_STR];
-            cir_safe_copy(pbuf, pname, sizeof(pbuf));
-            /* strip " {" and beyond */
-            char* brace = strchr(pbuf, '{');
-            if (brace) *brace = '\0';
-            cir_trim_right(pbuf);
-            cir_safe_copy(node.policy_name, pbuf, sizeof(node.policy_name));
-            COMMIT(&node);
-            if (!strchr(trimmed, '}')) {
+            node.policy_name = cir_store(prog, cir_trim_right(c.name));
+            cir_commit(prog, &node);
+            if (!c.closes) {
                 in_policy_block = true;
             }
             continue;
-        }
-
-        /* -- WHILE ---------------------------------------------------------- */
-        if (cir_starts_with(trimmed, "while ") || cir_starts_with(trimmed, "while(")) {
-            node.kind = CIR_WHILE;
-            cir_extract_parens(trimmed, node.condition, sizeof(node.condition));
-            COMMIT(&node);
-            /* absorb the { if present on this line */
-            block_depth++;
-            continue;
-        }
 
-        /* -- IF ------------------------------------------------------------- */
-        if (cir_starts_with(trimmed, "if ") || cir_starts_with(trimmed, "if(")) {
-            node.kind = CIR_IF;
-            cir_extract_parens(trimmed, node.condition, sizeof(node.condition));
-            COMMIT(&node);
+        case RIFT_LINE_WHILE:
+        case RIFT_LINE_IF:
+            /* -- WHILE / IF: the opening { is absorbed ---------------------- */
+            node.kind = c.kind == RIFT_LINE_WHILE ? CIR_WHILE : CIR_IF;
+            node.condition = cir_store(prog, c.text);
+            cir_commit(prog, &node);
             block_depth++;
             continue;
-        }
 
-        /* -- BLOCK CLOSE ---------------------------------------------------- */
-        if (strcmp(trimmed, "}") == 0) {
+        case RIFT_LINE_BLOCK_CLOSE:
+            /* -- BLOCK CLOSE ------------------------------------------------ */
             if (block_depth > 0) {
                 node.kind = CIR_BLOCK_CLOSE;
-                COMMIT(&node);
+                cir_commit(prog, &node);
                 block_depth--;
             }
             /* top-level } (e.g. stray) — ignore */
             continue;
-        }
 
-        /* -- VALIDATE ------------------------------------------------------- */
-        if (cir_starts_with(trimmed, "validate(")) {
+        case RIFT_LINE_VALIDATE: {
+            /* -- VALIDATE --------------------------------------------------- */
             node.kind = CIR_VALIDATE;
-            cir_extract_parens(trimmed, node.validate_arg, sizeof(node.validate_arg));
-            /* strip trailing ) if extract_parens left it (shouldn't, but guard) */
-            size_t alen = strlen(node.validate_arg);
-            if (alen > 0 && node.validate_arg[alen - 1] == ')') {
-                node.validate_arg[alen - 1] = '\0';
-            }
-            COMMIT(&node);
+            RiftCIRSlice arg = c.text;
+            /* strip trailing ) if the parentheses did not pair up */
+            if (arg.len > 0 && arg.ptr[arg.len - 1] == ')') arg.len--;
+            node.validate_arg = cir_store(prog, arg);
+            cir_commit(prog, &node);
             continue;
         }
 
-        /* -- ASSIGN (:=) ---------------------------------------------------- */
-        if (strstr(trimmed, ":=")) {
+        case RIFT_LINE_BLOCK_OPEN:
+            /* -- LONE OPEN BRACE: absorbed by while/if, else a deeper block - */
+            block_depth++;
+            continue;
+
+        case RIFT_LINE_ASSIGN: {
+            /* -- ASSIGN (:=) ------------------------------------------------ */
             /* Consensus check: span must precede any assignment */
             if (!seen_span) {
                 snprintf(prog->error_msg, sizeof(prog->error_msg),
                     "line %u: assignment before span declaration (violates memory-first ordering)", line_num);
+                rift_string_set_free(&declared_vars);
                 return prog;
             }
             node.kind = CIR_ASSIGN;
-            const char* op = strstr(trimmed, ":=");
-            size_t vlen    = (size_t)(op - trimmed);
-            char vbuf[RIFT_CIR_MAX_STR];
-            if (vlen >= sizeof(vbuf)) vlen = sizeof(vbuf) - 1;
-            memcpy(vbuf, trimmed, vlen);
-            vbuf[vlen] = '\0';
-            cir_trim_right(vbuf);
-            cir_safe_copy(node.var_name, vbuf, sizeof(node.var_name));
-
-            const char* expr_start = cir_trim_left(op + 2);
-            char ebuf[RIFT_CIR_MAX_STR];
-            cir_safe_copy(ebuf, expr_start, sizeof(ebuf));
-            /* strip trailing comment */
-            char* cmt = strstr(ebuf, "/*");
-            if (cmt) { *cmt = '\0'; cir_trim_right(ebuf); }
-            cmt = strstr(ebuf, "//");
-            if (cmt) { *cmt = '\0'; cir_trim_right(ebuf); }
-            cir_safe_copy(node.expr, ebuf, sizeof(node.expr));
+            RiftCIRSlice var = cir_trim_right(c.name);
+            node.var_name = cir_store(prog, var);
+            node.expr = cir_store(prog, c.text);
 
             /* is_first_use: true if this name not yet seen */
-            node.is_first_use = !cir_var_seen(declared_vars, var_count, node.var_name);
-            if (node.is_first_use && var_count < RIFT_CIR_MAX_VARS) {
-                cir_safe_copy(declared_vars[var_count], node.var_name, RIFT_CIR_MAX_STR);
-                var_count++;
-            }
-            COMMIT(&node);
+            int added = rift_string_set_insert(&declared_vars, var.ptr, var.len);
+            if (added < 0) prog->out_of_memory = true;
+            node.is_first_use = (added != 0);
+            cir_commit(prog, &node);
             continue;
         }
 
-        /* -- LONE OPEN BRACE ------------------------------------------------ */
-        if (strcmp(trimmed, "{") == 0) {
-            /* Absorbed by while/if above; standalone { = deeper block */
-            block_depth++;
-            continue;
+        default:
+            break;
         }
 
         /* -- UNKNOWN -------------------------------------------------------- */
         node.kind = CIR_UNKNOWN;
-        cir_safe_copy(node.text, trimmed, sizeof(node.text));
-        COMMIT(&node);
+        node.text = cir_store(prog, trimmed);
+        cir_commit(prog, &node);
     }
 
-#undef COMMIT
+    rift_string_set_free(&declared_vars);
 
+    if (prog->out_of_memory) {
+        snprintf(prog->error_msg, sizeof(prog->error_msg),
+            "out of memory: CIR truncated after %u nodes", prog->count);
+        return prog;
+    }
     prog->consensus_ok = true;
     return prog;
 }
@@ -442,6 +640,231 @@ static const char* cir_go_type(const char* rift_type) {
  * Phase 2 — Codec Emission
  * ============================================================================ */
 
+/* ----------------------------------------------------------------------------
+ * Emission sink
+ * ---------------------------------------------------------------------------- */
+
+bool rift_emit_sink_init_fd(RiftEmitSink* sink, int fd) {
+    memset(sink, 0, sizeof(*sink));
+    sink->fd = fd;
+    sink->buf = (char*)malloc(RIFT_EMIT_SINK_BUFFER);
+    if (!sink->buf) {
+        sink->failed = true;
+        sink->error = ENOMEM;
+        return false;
+    }
+    sink->capacity = RIFT_EMIT_SINK_BUFFER;
+    return true;
+}
+
+bool rift_emit_sink_init_memory(RiftEmitSink* sink) {
+    memset(sink, 0, sizeof(*sink));
+    sink->fd = RIFT_EMIT_SINK_MEMORY;
+    /* One byte held back for detach's NUL */
+    sink->buf = (char*)malloc(4096);
+    if (!sink->buf) {
+        sink->failed = true;
+        sink->error = ENOMEM;
+        return false;
+    }
+    sink->capacity = 4096 - 1;
+    return true;
+}
+
+static void sink_fail(RiftEmitSink* sink, int error) {
+    if (!sink->failed) sink->error = error;
+    sink->failed = true;
+    /* Later puts take the slow path and are dropped there */
+    sink->len = sink->capacity;
+}
+
+/* Close the buffered span into a segment so a reference can follow it */
+static void sink_seal_pending(RiftEmitSink* sink) {
+    if (sink->len > sink->pending) {
+        sink->segments[sink->segment_count].data = sink->buf + sink->pending;
+        sink->segments[sink->segment_count].len  = sink->len - sink->pending;
+        sink->segment_count++;
+        sink->pending = sink->len;
+    }
+}
+
+bool rift_emit_sink_flush(RiftEmitSink* sink) {
+    if (sink->failed) return false;
+    if (sink->fd == RIFT_EMIT_SINK_MEMORY) return true;
+    sink_seal_pending(sink);
+
+#ifdef _WIN32
+    for (int i = 0; i < sink->segment_count; i++) {
+        const char* p = sink->segments[i].data;
+        size_t left = sink->segments[i].len;
+        while (left > 0) {
+            int n = _write(sink->fd, p, left > INT_MAX ? INT_MAX : (unsigned)left);
+            if (n <= 0) {
+                sink_fail(sink, errno);
+                return false;
+            }
+            p += n;
+            left -= (size_t)n;
+        }
+    }
+#else
+    struct iovec iov[RIFT_EMIT_SINK_SEGMENTS];
+    int first = 0;
+    for (int i = 0; i < sink->segment_count; i++) {
+        iov[i].iov_base = (void*)sink->segments[i].data;
+        iov[i].iov_len  = sink->segments[i].len;
+    }
+    /* One writev per flush; loop only for short writes and EINTR */
+    while (first < sink->segment_count) {
+        ssize_t n = writev(sink->fd, iov + first, sink->segment_count - first);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            sink_fail(sink, errno);
+            return false;
+        }
+        size_t done = (size_t)n;
+        while (first < sink->segment_count && done >= iov[first].iov_len) {
+            done -= iov[first].iov_len;
+            first++;
+        }
+        if (first < sink->segment_count) {
+            iov[first].iov_base = (char*)iov[first].iov_base + done;
+            iov[first].iov_len -= done;
+        }
+    }
+#endif
+
+    sink->len = 0;
+    sink->pending = 0;
+    sink->segment_count = 0;
+    return true;
+}
+
+void rift_emit_sink_put_slow(RiftEmitSink* sink, const char* data, size_t len) {
+    if (sink->failed) return;
+
+    if (sink->fd == RIFT_EMIT_SINK_MEMORY) {
+        size_t need = sink->len + len;
+        if (need < sink->len || need >= SIZE_MAX / 2) {
+            sink_fail(sink, ENOMEM);
+            return;
+        }
+        size_t capacity = sink->capacity + 1;
+        while (capacity < need + 1) capacity *= 2;
+        char* grown = (char*)realloc(sink->buf, capacity);
+        if (!grown) {
+            sink_fail(sink, ENOMEM);
+            return;
+        }
+        sink->buf = grown;
+        sink->capacity = capacity - 1;
+        memcpy(sink->buf + sink->len, data, len);
+        sink->len += len;
+        return;
+    }
+
+    if (!rift_emit_sink_flush(sink)) return;
+    if (len <= sink->capacity) {
+        memcpy(sink->buf, data, len);
+        sink->len = len;
+    } else {
+        /* Larger than the whole buffer: write it where it is */
+        sink->segments[0].data = data;
+        sink->segments[0].len  = len;
+        sink->segment_count = 1;
+        rift_emit_sink_flush(sink);
+    }
+}
+
+void rift_emit_sink_put_ref(RiftEmitSink* sink, const char* data, size_t len) {
+    if (sink->fd == RIFT_EMIT_SINK_MEMORY || sink->failed) {
+        rift_emit_sink_put(sink, data, len);
+        return;
+    }
+    /* Room for the buffered span plus this reference */
+    if (sink->segment_count + 2 > RIFT_EMIT_SINK_SEGMENTS && !rift_emit_sink_flush(sink)) {
+        return;
+    }
+    sink_seal_pending(sink);
+    sink->segments[sink->segment_count].data = data;
+    sink->segments[sink->segment_count].len  = len;
+    sink->segment_count++;
+}
+
+char* rift_emit_sink_detach(RiftEmitSink* sink, size_t* len) {
+    if (sink->fd != RIFT_EMIT_SINK_MEMORY || sink->failed || !sink->buf) return NULL;
+    char* out = sink->buf;
+    out[sink->len] = '\0';
+    if (len) *len = sink->len;
+    sink->buf = NULL;
+    sink->len = 0;
+    sink->capacity = 0;
+    return out;
+}
+
+bool rift_emit_sink_reset(RiftEmitSink* sink) {
+    if (sink->fd != RIFT_EMIT_SINK_MEMORY) return false;
+    if (!sink->buf) return rift_emit_sink_init_memory(sink);
+    sink->len = sink->pending = 0;
+    sink->segment_count = 0;
+    sink->failed = false;
+    sink->error = 0;
+    return true;
+}
+
+void rift_emit_sink_free(RiftEmitSink* sink) {
+    if (!sink) return;
+    free(sink->buf);
+    sink->buf = NULL;
+    sink->len = sink->capacity = sink->pending = 0;
+    sink->segment_count = 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * Sink formatting — no printf on the emission path
+ * ---------------------------------------------------------------------------- */
+
+/* String literal: length known at compile time */
+#define SINK_LIT(sink, lit)  rift_emit_sink_put((sink), (lit), sizeof(lit) - 1)
+/* Static template text: joins the next writev by reference */
+#define SINK_REF(sink, lit)  rift_emit_sink_put_ref((sink), (lit), sizeof(lit) - 1)
+
+static void sink_str(RiftEmitSink* sink, const char* s) {
+    rift_emit_sink_put(sink, s, strlen(s));
+}
+
+static void sink_long(RiftEmitSink* sink, long value) {
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    unsigned long u = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (value < 0) *--p = '-';
+    rift_emit_sink_put(sink, p, (size_t)(digits + sizeof(digits) - p));
+}
+
+/* Indentation tables: Go indents with tabs (at most 15), the rest with
+ * four spaces per level (at most 63 columns) */
+static const char k_indent_tabs[]   = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+static const char k_indent_spaces[] =
+    "                                                               ";
+
+static void sink_indent(RiftEmitSink* sink, bool is_go, int levels) {
+    if (is_go) {
+        size_t tabs = levels < 15 ? (size_t)levels : 15;
+        rift_emit_sink_put(sink, k_indent_tabs, tabs);
+    } else {
+        size_t spaces = levels < 16 ? (size_t)levels * 4 : 63;
+        rift_emit_sink_put(sink, k_indent_spaces, spaces);
+    }
+}
+
+/* ============================================================================
+ * Phase 2 — Target emitters
+ * ============================================================================ */
+
 /* Per-target comment prefix */
 static const char* cir_comment_prefix(RiftTargetLanguage t) {
     switch (t) {
@@ -455,47 +878,49 @@ static const char* cir_comment_prefix(RiftTargetLanguage t) {
 }
 
 /* Emit file header */
-static void codec_emit_header(FILE* out, RiftTargetLanguage target, const char* mode_str) {
+static void codec_emit_header(RiftEmitSink* out, RiftTargetLanguage target, const char* mode_str) {
     switch (target) {
         case RIFT_TARGET_JS:
-            fprintf(out,
+            SINK_REF(out,
                 "'use strict';\n"
-                "/* Generated by RIFTLang v1.0.0 - %s mode */\n"
-                "const rift = require('./bindings/node-riftlang/rift_binding.cjs');\n\n",
-                mode_str);
+                "/* Generated by RIFTLang v1.0.0 - ");
+            sink_str(out, mode_str);
+            SINK_REF(out, " mode */\n"
+                "const rift = require('./bindings/node-riftlang/rift_binding.cjs');\n\n");
             break;
         case RIFT_TARGET_PYTHON:
-            fprintf(out,
+            SINK_REF(out,
                 "# -*- coding: utf-8 -*-\n"
-                "# Generated by RIFTLang v1.0.0 - %s mode\n"
+                "# Generated by RIFTLang v1.0.0 - ");
+            sink_str(out, mode_str);
+            SINK_REF(out, " mode\n"
                 "import sys, os\n"
                 "sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),\n"
                 "                'bindings', 'pyriftlang'))\n"
-                "import rift_binding as rift\n\n",
-                mode_str);
+                "import rift_binding as rift\n\n");
             break;
         case RIFT_TARGET_GO:
-            fprintf(out,
-                "// Generated by RIFTLang v1.0.0 - %s mode\n"
+            SINK_REF(out, "// Generated by RIFTLang v1.0.0 - ");
+            sink_str(out, mode_str);
+            SINK_REF(out, " mode\n"
                 "package main\n\n"
                 "import \"fmt\"\n\n"
-                "func main() {\n",
-                mode_str);
+                "func main() {\n");
             break;
         case RIFT_TARGET_LUA:
-            fprintf(out,
-                "-- Generated by RIFTLang v1.0.0 - %s mode\n"
-                "local rift = dofile('bindings/lua-riftlang/rift_binding.lua')\n\n",
-                mode_str);
+            SINK_REF(out, "-- Generated by RIFTLang v1.0.0 - ");
+            sink_str(out, mode_str);
+            SINK_REF(out, " mode\n"
+                "local rift = dofile('bindings/lua-riftlang/rift_binding.lua')\n\n");
             break;
         case RIFT_TARGET_WAT:
-            fprintf(out,
-                ";; Generated by RIFTLang v1.0.0 - %s mode\n"
+            SINK_REF(out, ";; Generated by RIFTLang v1.0.0 - ");
+            sink_str(out, mode_str);
+            SINK_REF(out, " mode\n"
                 "(module\n"
                 "  (import \"rift\" \"validate\" (func $rift_validate (param i32) (result i32)))\n"
                 "  (memory (export \"memory\") 1)\n"
-                "  (func $main (export \"main\")\n",
-                mode_str);
+                "  (func $main (export \"main\")\n");
             break;
         default:
             break;
@@ -503,21 +928,24 @@ static void codec_emit_header(FILE* out, RiftTargetLanguage target, const char*
 }
 
 /* Emit file footer */
-static void codec_emit_footer(FILE* out, RiftTargetLanguage target) {
+static void codec_emit_footer(RiftEmitSink* out, RiftTargetLanguage target) {
     switch (target) {
         case RIFT_TARGET_GO:
-            fprintf(out, "\t_ = fmt.Sprintf  // suppress unused import\n}\n");
+            SINK_REF(out, "\t_ = fmt.Sprintf  // suppress unused import\n}\n");
             break;
         case RIFT_TARGET_WAT:
-            fprintf(out, "  )\n)\n");
+            SINK_REF(out, "  )\n)\n");
             break;
         default:
             break;
     }
 }
 
+/* String field of the node `n` being emitted, from its program's arena */
+#define CIR_TEXT(field) rift_cir_str(prog, n->field)
+
 /* WAT: two-pass local declarations then body */
-static void codec_emit_wat(FILE* out, RiftCIRProgram* prog) {
+static void codec_emit_wat(RiftEmitSink* out, const RiftCIRProgram* prog) {
     const char* mode_str =
         prog->mode == RIFT_MODE_QUANTUM ? "quantum" :
         prog->mode == RIFT_MODE_HYBRID  ? "hybrid"  : "classical";
@@ -526,26 +954,35 @@ static void codec_emit_wat(FILE* out, RiftCIRProgram* prog) {
 
     /* Pass 1: emit (local ...) declarations for all first-use assigns */
     for (uint32_t i = 0; i < prog->count; i++) {
-        RiftCIRNode* n = &prog->nodes[i];
+        const RiftCIRNode* n = &prog->nodes[i];
         if (n->kind == CIR_ASSIGN && n->is_first_use) {
-            fprintf(out, "    (local $%s i32)\n", n->var_name);
+            SINK_LIT(out, "    (local $");
+            sink_str(out, CIR_TEXT(var_name));
+            SINK_LIT(out, " i32)\n");
         }
     }
 
     /* Pass 2: emit body nodes */
     int depth = 0;
     for (uint32_t i = 0; i < prog->count; i++) {
-        RiftCIRNode* n = &prog->nodes[i];
+        const RiftCIRNode* n = &prog->nodes[i];
         switch (n->kind) {
             case CIR_GOVERN:
-                fprintf(out, "    ;; RIFT: %s mode\n", n->mode);
+                SINK_LIT(out, "    ;; RIFT: ");
+                sink_str(out, CIR_TEXT(mode));
+                SINK_LIT(out, " mode\n");
                 break;
             case CIR_SPAN:
-                fprintf(out, "    ;; rift: memory span (%s, %d bytes)\n",
-                    n->span_kind, n->span_bytes);
+                SINK_LIT(out, "    ;; rift: memory span (");
+                sink_str(out, CIR_TEXT(span_kind));
+                SINK_LIT(out, ", ");
+                sink_long(out, n->span_bytes);
+                SINK_LIT(out, " bytes)\n");
                 break;
             case CIR_TYPE_DEF:
-                fprintf(out, "    ;; type: %s\n", n->type_name);
+                SINK_LIT(out, "    ;; type: ");
+                sink_str(out, CIR_TEXT(type_name));
+                SINK_LIT(out, "\n");
                 break;
             case CIR_TYPE_FIELD:
                 break;  /* suppress in WAT */
@@ -554,41 +991,55 @@ static void codec_emit_wat(FILE* out, RiftCIRProgram* prog) {
                 /* try to parse expr as integer constant */
                 {
                     char* endp;
-                    long val = strtol(n->expr, &endp, 10);
+                    long val = strtol(CIR_TEXT(expr), &endp, 10);
                     if (*endp == '\0' || isspace((unsigned char)*endp)) {
                         /* numeric literal */
-                        fprintf(out, "    (local.set $%s (i32.const %ld))\n",
-                            n->var_name, val);
+                        SINK_LIT(out, "    (local.set $");
+                        sink_str(out, CIR_TEXT(var_name));
+                        SINK_LIT(out, " (i32.const ");
+                        sink_long(out, val);
+                        SINK_LIT(out, "))\n");
                     } else {
                         /* expression reference — simplified: emit as comment + set 0 */
-                        fprintf(out, "    ;; expr: %s = %s\n", n->var_name, n->expr);
-                        fprintf(out, "    (local.set $%s (i32.const 0))\n", n->var_name);
+                        SINK_LIT(out, "    ;; expr: ");
+                        sink_str(out, CIR_TEXT(var_name));
+                        SINK_LIT(out, " = ");
+                        sink_str(out, CIR_TEXT(expr));
+                        SINK_LIT(out, "\n    (local.set $");
+                        sink_str(out, CIR_TEXT(var_name));
+                        SINK_LIT(out, " (i32.const 0))\n");
                     }
                 }
                 break;
             case CIR_POLICY:
-                fprintf(out, "    ;; policy: %s\n", n->policy_name);
+                SINK_LIT(out, "    ;; policy: ");
+                sink_str(out, CIR_TEXT(policy_name));
+                SINK_LIT(out, "\n");
                 break;
             case CIR_WHILE:
-                fprintf(out, "    (block\n    (loop\n");
+                SINK_LIT(out, "    (block\n    (loop\n");
                 depth++;
                 break;
             case CIR_IF:
-                fprintf(out, "    (if (then\n");
+                SINK_LIT(out, "    (if (then\n");
                 depth++;
                 break;
             case CIR_BLOCK_CLOSE:
                 if (depth > 0) depth--;
-                fprintf(out, "    ))\n");
+                SINK_LIT(out, "    ))\n");
                 break;
             case CIR_VALIDATE:
-                fprintf(out, "    (call $rift_validate (local.get $%s))\n",
-                    n->validate_arg);
+                SINK_LIT(out, "    (call $rift_validate (local.get $");
+                sink_str(out, CIR_TEXT(validate_arg));
+                SINK_LIT(out, "))\n");
                 break;
             case CIR_COMMENT:
             case CIR_UNKNOWN:
-                if (*n->text)
-                    fprintf(out, "    ;; %s\n", n->text);
+                if (CIR_TEXT(text)[0]) {
+                    SINK_LIT(out, "    ;; ");
+                    sink_str(out, CIR_TEXT(text));
+                    SINK_LIT(out, "\n");
+                }
                 break;
         }
     }
@@ -597,119 +1048,143 @@ static void codec_emit_wat(FILE* out, RiftCIRProgram* prog) {
 }
 
 /* Emit one node for JS / Python / Go / Lua */
-static void codec_emit_node(FILE* out, RiftTargetLanguage target,
-                             RiftCIRNode* n, int* indent_depth) {
+static void codec_emit_node(RiftEmitSink* out, RiftTargetLanguage target,
+                             const RiftCIRProgram* prog, const RiftCIRNode* n,
+                             int* indent_depth) {
     const char* cpfx = cir_comment_prefix(target);
     bool is_python   = (target == RIFT_TARGET_PYTHON);
     bool is_go       = (target == RIFT_TARGET_GO);
     bool is_lua      = (target == RIFT_TARGET_LUA);
     bool is_js       = (target == RIFT_TARGET_JS);
+    /* Statements exist only for these; any other target gets comments */
+    bool has_syntax  = is_python || is_go || is_lua || is_js;
 
-    /* Compute indentation prefix for body lines.
+    /* Indentation levels for body lines.
      * Go:     1 tab per depth level (already inside func main at depth 0)
      * JS/Lua: 4 spaces per depth level
      * Python: 4 spaces per depth level (used for structural indentation) */
-    char indent_str[64] = "";
-    {
-        int depth = *indent_depth;
-        if (depth > 0 || is_go) {
-            /* Go needs 1 base tab for func main body, plus depth tabs */
-            int levels = is_go ? (depth + 1) : depth;
-            if (is_go) {
-                int tabs = levels < 15 ? levels : 15;
-                memset(indent_str, '\t', (size_t)tabs);
-                indent_str[tabs] = '\0';
-            } else {
-                int spaces = levels * 4;
-                if (spaces > (int)(sizeof(indent_str) - 1))
-                    spaces = (int)(sizeof(indent_str) - 1);
-                memset(indent_str, ' ', (size_t)spaces);
-                indent_str[spaces] = '\0';
-            }
-        }
-    }
+    int levels = is_go ? *indent_depth + 1 : *indent_depth;
 
     switch (n->kind) {
 
         /* -- GOVERN --------------------------------------------------------- */
         case CIR_GOVERN:
-            fprintf(out, "%s%s RIFT: %s mode\n", indent_str, cpfx, n->mode);
+            sink_indent(out, is_go, levels);
+            sink_str(out, cpfx);
+            SINK_LIT(out, " RIFT: ");
+            sink_str(out, CIR_TEXT(mode));
+            SINK_LIT(out, " mode\n");
             break;
 
         /* -- SPAN ----------------------------------------------------------- */
         case CIR_SPAN:
-            fprintf(out, "%s%s rift: memory span (%s, %d bytes)\n",
-                indent_str, cpfx, n->span_kind, n->span_bytes);
+            sink_indent(out, is_go, levels);
+            sink_str(out, cpfx);
+            SINK_LIT(out, " rift: memory span (");
+            sink_str(out, CIR_TEXT(span_kind));
+            SINK_LIT(out, ", ");
+            sink_long(out, n->span_bytes);
+            SINK_LIT(out, " bytes)\n");
             break;
 
         /* -- TYPE DEF ------------------------------------------------------- */
         case CIR_TYPE_DEF:
+            sink_indent(out, is_go, levels);
             if (is_go) {
-                fprintf(out, "%stype %s struct {\n", indent_str, n->type_name);
+                SINK_LIT(out, "type ");
+                sink_str(out, CIR_TEXT(type_name));
+                SINK_LIT(out, " struct {\n");
             } else {
-                fprintf(out, "%s%s type: %s\n", indent_str, cpfx, n->type_name);
+                sink_str(out, cpfx);
+                SINK_LIT(out, " type: ");
+                sink_str(out, CIR_TEXT(type_name));
+                SINK_LIT(out, "\n");
             }
             break;
 
         /* -- TYPE FIELD ----------------------------------------------------- */
         case CIR_TYPE_FIELD:
             if (is_go) {
-                fprintf(out, "%s\t%s %s\n", indent_str, n->field_name, cir_go_type(n->field_type));
-                if (n->is_last_field) fprintf(out, "%s}\n\n", indent_str);
+                sink_indent(out, is_go, levels);
+                SINK_LIT(out, "\t");
+                sink_str(out, CIR_TEXT(field_name));
+                SINK_LIT(out, " ");
+                sink_str(out, cir_go_type(CIR_TEXT(field_type)));
+                SINK_LIT(out, "\n");
+                if (n->is_last_field) {
+                    sink_indent(out, is_go, levels);
+                    SINK_LIT(out, "}\n\n");
+                }
             }
             /* suppress for JS, Python, Lua */
             break;
 
         /* -- ASSIGN --------------------------------------------------------- */
         case CIR_ASSIGN:
-            if (is_python || is_lua) {
-                if (is_lua && n->is_first_use)
-                    fprintf(out, "%slocal %s = %s\n", indent_str, n->var_name, n->expr);
-                else
-                    fprintf(out, "%s%s = %s\n", indent_str, n->var_name, n->expr);
-            } else if (is_js) {
-                if (n->is_first_use)
-                    fprintf(out, "%slet %s = %s;\n", indent_str, n->var_name, n->expr);
-                else
-                    fprintf(out, "%s%s = %s;\n", indent_str, n->var_name, n->expr);
-            } else if (is_go) {
-                if (n->is_first_use)
-                    fprintf(out, "%s%s := %s\n", indent_str, n->var_name, n->expr);
-                else
-                    fprintf(out, "%s%s = %s\n", indent_str, n->var_name, n->expr);
-            }
+            if (!has_syntax) break;
+            sink_indent(out, is_go, levels);
+            if (n->is_first_use && is_lua)     SINK_LIT(out, "local ");
+            else if (n->is_first_use && is_js) SINK_LIT(out, "let ");
+            sink_str(out, CIR_TEXT(var_name));
+            if (n->is_first_use && is_go) SINK_LIT(out, " := ");
+            else                          SINK_LIT(out, " = ");
+            sink_str(out, CIR_TEXT(expr));
+            if (is_js) SINK_LIT(out, ";\n");
+            else       SINK_LIT(out, "\n");
             break;
 
         /* -- POLICY --------------------------------------------------------- */
         case CIR_POLICY:
-            fprintf(out, "%s%s policy: %s\n", indent_str, cpfx, n->policy_name);
+            sink_indent(out, is_go, levels);
+            sink_str(out, cpfx);
+            SINK_LIT(out, " policy: ");
+            sink_str(out, CIR_TEXT(policy_name));
+            SINK_LIT(out, "\n");
             break;
 
         /* -- WHILE ---------------------------------------------------------- */
         case CIR_WHILE:
             /* emit at current indent, then increase depth for body */
+            if (has_syntax) sink_indent(out, is_go, levels);
             if (is_python) {
-                fprintf(out, "%swhile %s:\n", indent_str, n->condition);
+                SINK_LIT(out, "while ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, ":\n");
             } else if (is_js) {
-                fprintf(out, "%swhile (%s) {\n", indent_str, n->condition);
+                SINK_LIT(out, "while (");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, ") {\n");
             } else if (is_go) {
-                fprintf(out, "%sfor %s {\n", indent_str, n->condition);
+                SINK_LIT(out, "for ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, " {\n");
             } else if (is_lua) {
-                fprintf(out, "%swhile %s do\n", indent_str, n->condition);
+                SINK_LIT(out, "while ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, " do\n");
             }
             (*indent_depth)++;
             break;
 
         /* -- IF ------------------------------------------------------------- */
         case CIR_IF:
+            if (has_syntax) sink_indent(out, is_go, levels);
             if (is_python) {
-                fprintf(out, "%sif %s:\n", indent_str, n->condition);
+                SINK_LIT(out, "if ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, ":\n");
             } else if (is_js) {
-                fprintf(out, "%sif (%s) {\n", indent_str, n->condition);
+                SINK_LIT(out, "if (");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, ") {\n");
             } else if (is_go) {
-                fprintf(out, "%sif %s {\n", indent_str, n->condition);
+                SINK_LIT(out, "if ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, " {\n");
             } else if (is_lua) {
-                fprintf(out, "%sif %s then\n", indent_str, n->condition);
+                SINK_LIT(out, "if ");
+                sink_str(out, CIR_TEXT(condition));
+                SINK_LIT(out, " then\n");
             }
             (*indent_depth)++;
             break;
@@ -717,55 +1192,57 @@ static void codec_emit_node(FILE* out, RiftTargetLanguage target,
         /* -- BLOCK CLOSE ---------------------------------------------------- */
         case CIR_BLOCK_CLOSE:
             if (*indent_depth > 0) (*indent_depth)--;
-            /* recalculate indent for the closing brace */
-            {
-                char close_indent[64] = "";
-                int d = *indent_depth;
-                if (is_go) {
-                    int tabs = (d + 1) < 15 ? (d + 1) : 15;
-                    memset(close_indent, '\t', (size_t)tabs);
-                    close_indent[tabs] = '\0';
-                } else if (!is_python) {
-                    int spaces = d * 4;
-                    if (spaces > (int)(sizeof(close_indent) - 1)) spaces = (int)(sizeof(close_indent) - 1);
-                    memset(close_indent, ' ', (size_t)spaces);
-                    close_indent[spaces] = '\0';
-                }
-                if (is_python) {
-                    /* no explicit close — indentation handles it */
-                } else if (is_js || is_go) {
-                    fprintf(out, "%s}\n", close_indent);
+            /* closing line sits at the restored depth */
+            if (is_python) {
+                /* no explicit close — indentation handles it */
+            } else if (has_syntax) {
+                sink_indent(out, is_go, is_go ? *indent_depth + 1 : *indent_depth);
+                if (is_js || is_go) {
+                    SINK_LIT(out, "}\n");
                 } else if (is_lua) {
-                    fprintf(out, "%send\n", close_indent);
+                    SINK_LIT(out, "end\n");
                 }
             }
             break;
 
         /* -- VALIDATE ------------------------------------------------------- */
         case CIR_VALIDATE:
+            if (has_syntax) sink_indent(out, is_go, levels);
             if (is_python || is_lua) {
-                fprintf(out, "%srift.validate(%s)\n", indent_str, n->validate_arg);
+                SINK_LIT(out, "rift.validate(");
+                sink_str(out, CIR_TEXT(validate_arg));
+                SINK_LIT(out, ")\n");
             } else if (is_js) {
-                fprintf(out, "%srift.validate('%s');\n", indent_str, n->validate_arg);
+                SINK_LIT(out, "rift.validate('");
+                sink_str(out, CIR_TEXT(validate_arg));
+                SINK_LIT(out, "');\n");
             } else if (is_go) {
                 /* Go binding: emit as fmt.Printf until go-riftlang is imported */
-                fprintf(out, "%sfmt.Printf(\"rift.validate: %%v\\n\", %s)\n",
-                    indent_str, n->validate_arg);
+                SINK_LIT(out, "fmt.Printf(\"rift.validate: %v\\n\", ");
+                sink_str(out, CIR_TEXT(validate_arg));
+                SINK_LIT(out, ")\n");
             }
             break;
 
         /* -- COMMENT / UNKNOWN --------------------------------------------- */
         case CIR_COMMENT:
         case CIR_UNKNOWN:
-            if (*n->text) {
-                fprintf(out, "%s%s %s\n", indent_str, cpfx, n->text);
+            if (CIR_TEXT(text)[0]) {
+                sink_indent(out, is_go, levels);
+                sink_str(out, cpfx);
+                SINK_LIT(out, " ");
+                sink_str(out, CIR_TEXT(text));
+                SINK_LIT(out, "\n");
             }
             break;
     }
 }
 
-bool rift_codec_emit(RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target) {
-    if (!prog || !out) return false;
+#undef CIR_TEXT
+
+bool rift_codec_emit_sink(const RiftCIRProgram* prog, RiftEmitSink* sink,
+                          RiftTargetLanguage target) {
+    if (!prog || !sink) return false;
 
     if (!prog->consensus_ok) {
         fprintf(stderr, "[rift_codec] consensus failed: %s\n", prog->error_msg);
@@ -774,8 +1251,8 @@ bool rift_codec_emit(RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target)
 
     /* WAT has its own two-pass emitter */
     if (target == RIFT_TARGET_WAT) {
-        codec_emit_wat(out, prog);
-        return true;
+        codec_emit_wat(sink, prog);
+        return !sink->failed;
     }
 
     /* Mode string */
@@ -783,21 +1260,60 @@ bool rift_codec_emit(RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target)
         prog->mode == RIFT_MODE_QUANTUM ? "quantum" :
         prog->mode == RIFT_MODE_HYBRID  ? "hybrid"  : "classical";
 
-    codec_emit_header(out, target, mode_str);
+    codec_emit_header(sink, target, mode_str);
 
     int indent_depth = 0;
     for (uint32_t i = 0; i < prog->count; i++) {
-        codec_emit_node(out, target, &prog->nodes[i], &indent_depth);
+        codec_emit_node(sink, target, prog, &prog->nodes[i], &indent_depth);
     }
 
-    codec_emit_footer(out, target);
-    return true;
+    codec_emit_footer(sink, target);
+    return !sink->failed;
+}
+
+bool rift_codec_emit_file(const RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target) {
+    if (!prog || !out) return false;
+
+    RiftEmitSink sink;
+    int fd = (fflush(out) == 0) ? fileno(out) : -1;
+    bool ok;
+    if (fd >= 0) {
+        ok = rift_emit_sink_init_fd(&sink, fd) &&
+             rift_codec_emit_sink(prog, &sink, target) &&
+             rift_emit_sink_flush(&sink);
+    } else {
+        /* No descriptor behind out (e.g. a memory stream): hand it the text */
+        ok = rift_emit_sink_init_memory(&sink) &&
+             rift_codec_emit_sink(prog, &sink, target) &&
+             fwrite(sink.buf, 1, sink.len, out) == sink.len;
+        if (!ok && !sink.failed) sink.error = errno;
+    }
+    if (!ok && sink.error) errno = sink.error;
+    rift_emit_sink_free(&sink);
+    return ok;
 }
 
 /* ============================================================================
  * Cleanup
  * ============================================================================ */
 
+uint32_t rift_cir_node_line(const RiftCIRProgram* prog, const RiftCIRNode* node) {
+    if (!prog || !node) return 0;
+    return riftlang_line_index_line_of(&prog->lines, node->source_offset);
+}
+
 void rift_cir_program_free(RiftCIRProgram* prog) {
+    if (!prog) return;
+    if (prog->owns_lines) riftlang_line_index_free(&prog->lines);
+#ifndef _WIN32
+    if (prog->image) {
+        /* Loaded from the CIR cache: nodes and strings live in the mapping */
+        munmap(prog->image, prog->image_size);
+        free(prog);
+        return;
+    }
+#endif
+    free(prog->nodes);
+    free(prog->strings);
     free(prog);
 }
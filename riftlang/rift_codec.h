@@ -7,18 +7,18 @@
  *
  *   RIFT source
  *     │
- *     ▼  Phase 1: LINK  (rift_link)
+ *     ▼  Phase 1: LINK  (rift_codec_link)
  *   RiftCIRProgram  — Canonical Intermediate Representation
  *     │  consensus_ok: SPAN → TYPE → ASSIGN ordering enforced
  *     │  "you can't send a message before you know where you are"
- *     ▼  Phase 2: CODEC  (rift_codec_emit)
+ *     ▼  Phase 2: CODEC  (rift_codec_emit_file)
  *   Target file  — JS / Python / Go / Lua / WAT
  *     pure language-specific emission, no C headers
  *
  * Rifter's Way principles applied:
  *   - Forward-only, single-pass linker (no backtracking)
  *   - Memory-first ordering enforced (CIR_SPAN before CIR_ASSIGN)
- *   - Fixed-size flat node array (memory declared before population)
+ *   - Flat node array, grown geometrically (no node limit)
  *   - No NSIGII code, no libpolycall code
  */
 
@@ -29,14 +29,15 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 /* ============================================================================
  * Constants
  * ============================================================================ */
 
-#define RIFT_CIR_MAX_STR    256
-#define RIFT_CIR_MAX_NODES  1024
-#define RIFT_CIR_MAX_VARS   64
+/* Bump whenever rift_codec_link can produce different CIR for the same source;
+ * cached programs (rift_cache.h) from other linker versions are ignored. */
+#define RIFT_CIR_LINKER_VERSION  4
 
 /* ============================================================================
  * Canonical IR Node Kind
@@ -66,46 +67,45 @@ typedef enum {
  * ============================================================================ */
 
 /**
- * RiftCIRNode — one resolved RIFT construct.
- * Fields used depend on kind; unused fields are zero-initialized.
+ * RiftCIRStr — offset of a NUL-terminated string in the program's string
+ * arena (RiftCIRProgram.strings). Offset 0 is always "".
  */
-typedef struct {
-    RiftCIRKind kind;
-    uint32_t    source_line;
-
-    /* CIR_GOVERN */
-    char mode[32];
-
-    /* CIR_SPAN */
-    char span_kind[32];
-    int  span_bytes;
-
-    /* CIR_TYPE_DEF */
-    char type_name[RIFT_CIR_MAX_STR];
-
-    /* CIR_TYPE_FIELD */
-    char field_name[RIFT_CIR_MAX_STR];
-    char field_type[32];
-    bool is_last_field;       /* true → close struct brace after this field (Go) */
+typedef uint32_t RiftCIRStr;
 
-    /* CIR_ASSIGN */
-    char var_name[RIFT_CIR_MAX_STR];
-    char expr[RIFT_CIR_MAX_STR];
-    bool is_first_use;        /* true → declaration occurrence (let/local/var decl) */
-
-    /* CIR_WHILE / CIR_IF */
-    char condition[RIFT_CIR_MAX_STR];
-
-    /* CIR_VALIDATE */
-    char validate_arg[RIFT_CIR_MAX_STR];
-
-    /* CIR_POLICY */
-    char policy_name[RIFT_CIR_MAX_STR];
+/**
+ * RiftCIRNode — one resolved RIFT construct, 20 bytes.
+ *
+ * Each kind uses at most two strings, so the string fields share two
+ * slots; read them with rift_cir_str(prog, node->field). Unused fields
+ * are zero (the empty string).
+ */
+typedef struct {
+    uint8_t     kind;           /* RiftCIRKind */
+    bool        is_first_use;   /* CIR_ASSIGN: declaration occurrence (let/local/var decl) */
+    bool        is_last_field;  /* CIR_TYPE_FIELD: close struct brace after this field (Go) */
+    uint32_t    source_offset;  /* byte offset of the source line; see rift_cir_node_line */
 
-    /* CIR_COMMENT / CIR_UNKNOWN */
-    char text[RIFT_CIR_MAX_STR];
+    union {
+        RiftCIRStr mode;          /* CIR_GOVERN                  */
+        RiftCIRStr span_kind;     /* CIR_SPAN                    */
+        RiftCIRStr type_name;     /* CIR_TYPE_DEF                */
+        RiftCIRStr field_name;    /* CIR_TYPE_FIELD              */
+        RiftCIRStr var_name;      /* CIR_ASSIGN                  */
+        RiftCIRStr condition;     /* CIR_WHILE / CIR_IF          */
+        RiftCIRStr validate_arg;  /* CIR_VALIDATE                */
+        RiftCIRStr policy_name;   /* CIR_POLICY                  */
+        RiftCIRStr text;          /* CIR_COMMENT / CIR_UNKNOWN   */
+    };
+    union {
+        RiftCIRStr field_type;    /* CIR_TYPE_FIELD              */
+        RiftCIRStr expr;          /* CIR_ASSIGN                  */
+    };
+    int32_t     span_bytes;     /* CIR_SPAN */
 } RiftCIRNode;
 
+/* Cache entries store nodes verbatim (see rift_cache.h) */
+_Static_assert(sizeof(RiftCIRNode) == 20, "RiftCIRNode must stay 20 bytes");
+
 /* ============================================================================
  * Canonical IR Program
  * ============================================================================ */
@@ -113,24 +113,98 @@ typedef struct {
 /**
  * RiftCIRProgram — flat ordered array of resolved CIR nodes.
  *
- * Memory is declared upfront (fixed-size array) before any node is
- * populated — reflecting the Rifter's Way memory-first principle.
+ * Nodes and their strings live in storage owned by the program that grows
+ * geometrically, so any source links in one pass with amortized O(1)
+ * appends. Nothing is dropped silently: if storage cannot grow, linking
+ * fails with error_msg set.
  * consensus_ok is set only after the entire source has been validated.
  */
 typedef struct {
-    RiftCIRNode       nodes[RIFT_CIR_MAX_NODES];
+    RiftCIRNode*      nodes;
     uint32_t          count;
+    uint32_t          capacity;
+    char*             strings;       /* string arena; strings[0] == '\0' */
+    uint32_t          strings_size;
+    uint32_t          strings_capacity;
+    bool              out_of_memory; /* storage could not grow; link reports it */
     RiftExecutionMode mode;          /* from !govern directive, or default CLASSICAL */
     bool              consensus_ok;  /* SPAN→TYPE→ASSIGN ordering passed */
     char              error_msg[256];
+    RiftLineIndex     lines;         /* resolves node offsets to line numbers */
+    bool              owns_lines;    /* built by rift_codec_link, freed with the program */
+    void*             image;         /* cache entry mapping backing nodes/strings, or NULL */
+    size_t            image_size;
 } RiftCIRProgram;
 
+/* ============================================================================
+ * Line Classification
+ * ============================================================================ */
+
+/** RiftLineSlice — a view into a source line; not NUL-terminated. */
+typedef struct {
+    const char* ptr;
+    size_t      len;
+} RiftLineSlice;
+
+/**
+ * RiftLineKind — what a RIFT source line opens or states. Shared by the
+ * linker and the C transform, so every path reads the language the same
+ * way. The body of a span, type or policy block is field lines, not
+ * statements; a caller tracking block state need not classify them.
+ */
+typedef enum {
+    RIFT_LINE_EMPTY = 0,
+    RIFT_LINE_COMMENT,      /* line or block comment                 */
+    RIFT_LINE_GOVERN,       /* !govern mode                          */
+    RIFT_LINE_SPAN,         /* align span<kind> {                    */
+    RIFT_LINE_TYPE,         /* type Name = {                         */
+    RIFT_LINE_POLICY,       /* policy_fn on name {                   */
+    RIFT_LINE_WHILE,        /* while (cond) {                        */
+    RIFT_LINE_IF,           /* if (cond) {                           */
+    RIFT_LINE_FOR,          /* for (...) {                           */
+    RIFT_LINE_ELSE,         /* } else ...                            */
+    RIFT_LINE_BLOCK_OPEN,   /* {  alone                              */
+    RIFT_LINE_BLOCK_CLOSE,  /* }  alone                              */
+    RIFT_LINE_VALIDATE,     /* validate(arg)                         */
+    RIFT_LINE_ASSIGN,       /* name := expr                          */
+    RIFT_LINE_OTHER         /* anything else: left to pattern rules  */
+} RiftLineKind;
+
+/**
+ * RiftLineClass — a classified line and the fields its kind carries, as
+ * views into the line. Fields a kind does not use are empty.
+ *
+ *   name   GOVERN mode word, SPAN kind ("fixed" if none), TYPE name,
+ *          POLICY name, ASSIGN variable
+ *   text   COMMENT body, WHILE/IF/FOR condition (inside the outer
+ *          parentheses), VALIDATE argument, ASSIGN expression with any
+ *          trailing comment removed
+ *   rest   COMMENT: what follows a closing star-slash (ptr is NULL if the
+ *          comment does not close on this line)
+ */
+typedef struct {
+    RiftLineKind  kind;
+    RiftLineSlice line;         /* the line without surrounding whitespace */
+    RiftLineSlice name;
+    RiftLineSlice text;
+    RiftLineSlice rest;
+    bool          closes;       /* TYPE, POLICY: '}' ends the block on this line */
+} RiftLineClass;
+
+/**
+ * rift_line_classify — classify line[0..len) in one pass: a table lookup
+ * on the first significant byte picks the few keyword rules that can
+ * apply, then the matching rule extracts its fields. A line no keyword
+ * claims is an ASSIGN if it contains ":=", else OTHER. Returns out->kind.
+ */
+RiftLineKind rift_line_classify(const char* line, size_t len, RiftLineClass* out);
+
 /* ============================================================================
  * Public API
  * ============================================================================ */
 
 /**
- * rift_link — Phase 1: parse RIFT source into CIR with consensus validation.
+ * rift_codec_link — Phase 1: parse RIFT source into CIR with consensus validation.
  *
  * Single-pass, forward-only. Enforces:
  *   - CIR_SPAN must appear before any CIR_ASSIGN
@@ -146,20 +220,131 @@ typedef struct {
  * @param source  NUL-terminated RIFT source text
  * @param mode    Execution mode (used as default if !govern is absent)
  */
-RiftCIRProgram* rift_link(const char* source, RiftExecutionMode mode);
+RiftCIRProgram* rift_codec_link(const char* source, RiftExecutionMode mode);
+
+/**
+ * rift_link_lines — rift_codec_link over a line index the caller already built,
+ * so the stages of one compile share a single newline scan.
+ *
+ * The program borrows the index: it must outlive the program.
+ */
+RiftCIRProgram* rift_link_lines(const RiftLineIndex* lines, RiftExecutionMode mode);
+
+/**
+ * rift_cir_str — a node string field as a C string (never NULL).
+ */
+static inline const char* rift_cir_str(const RiftCIRProgram* prog, RiftCIRStr str) {
+    return (prog->strings && str < prog->strings_size) ? prog->strings + str : "";
+}
+
+/**
+ * rift_cir_node_line — 1-based source line of a node (binary search over
+ * the program's line index). Returns 0 for NULL arguments.
+ */
+uint32_t rift_cir_node_line(const RiftCIRProgram* prog, const RiftCIRNode* node);
+
+/* ============================================================================
+ * Emission Sink
+ * ============================================================================ */
+
+#define RIFT_EMIT_SINK_BUFFER    (64 * 1024)  /* fd sink: bytes buffered per flush */
+#define RIFT_EMIT_SINK_SEGMENTS  16           /* fd sink: iovecs per writev */
+#define RIFT_EMIT_SINK_MEMORY    (-1)         /* fd value of an in-memory sink */
+
+/** RiftEmitSegment — a span of output awaiting the next writev. */
+typedef struct {
+    const char* data;
+    size_t      len;
+} RiftEmitSegment;
 
 /**
- * rift_codec_emit — Phase 2: emit CIR program as target language text.
+ * RiftEmitSink — where the codec writes.
+ *
+ * An fd sink collects output in one userspace buffer and drains it with a
+ * single writev per flush; long-lived text (header templates) joins the
+ * writev by reference instead of being copied. A memory sink grows its
+ * buffer instead of flushing, for embedders that want the text without
+ * a FILE*. Errors are sticky: after a failed write or allocation every
+ * put is a no-op and flush returns false.
+ */
+typedef struct {
+    char*           buf;
+    size_t          len;            /* bytes in buf */
+    size_t          capacity;
+    size_t          pending;        /* buf[pending..len) not yet a segment */
+    RiftEmitSegment segments[RIFT_EMIT_SINK_SEGMENTS];
+    int             segment_count;
+    int             fd;             /* RIFT_EMIT_SINK_MEMORY: grow, never flush */
+    bool            failed;
+    int             error;          /* errno of the first failure */
+} RiftEmitSink;
+
+/** rift_emit_sink_init_fd — buffered sink over an open file descriptor. */
+bool rift_emit_sink_init_fd(RiftEmitSink* sink, int fd);
+
+/** rift_emit_sink_init_memory — sink that accumulates output in memory. */
+bool rift_emit_sink_init_memory(RiftEmitSink* sink);
+
+/** rift_emit_sink_put_slow — put() when data does not fit the buffer. */
+void rift_emit_sink_put_slow(RiftEmitSink* sink, const char* data, size_t len);
+
+/** rift_emit_sink_put — copy len bytes into the sink. */
+static inline void rift_emit_sink_put(RiftEmitSink* sink, const char* data, size_t len) {
+    if (len <= sink->capacity - sink->len) {
+        memcpy(sink->buf + sink->len, data, len);
+        sink->len += len;
+    } else {
+        rift_emit_sink_put_slow(sink, data, len);
+    }
+}
+
+/**
+ * rift_emit_sink_put_ref — like put, but an fd sink writes data in place
+ * at the next flush; data must stay valid until then.
+ */
+void rift_emit_sink_put_ref(RiftEmitSink* sink, const char* data, size_t len);
+
+/** rift_emit_sink_flush — write everything buffered (no-op for memory). */
+bool rift_emit_sink_flush(RiftEmitSink* sink);
+
+/**
+ * rift_emit_sink_detach — a memory sink's output as a NUL-terminated heap
+ * string (caller frees); the sink is left empty. NULL if it failed.
+ */
+char* rift_emit_sink_detach(RiftEmitSink* sink, size_t* len);
+
+/**
+ * rift_emit_sink_reset — empty a memory sink for reuse, keeping its buffer
+ * (or allocating a fresh one after detach) and clearing any failure.
+ */
+bool rift_emit_sink_reset(RiftEmitSink* sink);
+
+/** rift_emit_sink_free — release the buffer without flushing. */
+void rift_emit_sink_free(RiftEmitSink* sink);
+
+/**
+ * rift_codec_emit_sink — Phase 2 into a sink. The sink is not flushed.
+ * Returns false if consensus failed or the sink has failed.
+ */
+bool rift_codec_emit_sink(const RiftCIRProgram* prog, RiftEmitSink* sink,
+                          RiftTargetLanguage target);
+
+/**
+ * rift_codec_emit_file — Phase 2: emit CIR program as target language text.
  *
  * Checks consensus_ok first; returns false if consensus failed.
  * Writes file header, then walks nodes in order emitting language-specific
  * text, then writes file footer.
  *
+ * out is flushed, then written through an fd sink on its descriptor (or
+ * through a memory sink and fwrite if it has none). Returns false, with
+ * errno set, if writing fails.
+ *
  * @param prog    Linked CIR program (must have consensus_ok == true)
  * @param out     Open FILE* for writing
  * @param target  Target language
  */
-bool rift_codec_emit(RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target);
+bool rift_codec_emit_file(const RiftCIRProgram* prog, FILE* out, RiftTargetLanguage target);
 
 /**
  * rift_cir_program_free — release heap-allocated RiftCIRProgram.
@@ -0,0 +1,150 @@
+/**
+ * @file rift_compile.c
+ * @brief RIFTLang In-Memory Compile API — Implementation
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * See rift_compile.h. One compile is a line index, one rift_link_lines and
+ * one rift_codec_emit_sink into the compiler's memory sink; nothing here
+ * opens a file or writes to stdout/stderr.
+ */
+
+#include "rift_compile.h"
+#include "rift_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A compiler keeps its output buffer between calls unless it grew past
+ * this; one huge request should not pin its buffer for the process life. */
+#define RIFT_COMPILE_RETAIN_BYTES  (1024u * 1024u)
+
+struct RiftCompiler {
+    RiftEmitSink sink;          /* memory sink, reused across compiles */
+    char         error[320];    /* status name + linker error_msg */
+};
+
+/* ============================================================================
+ * Compiler Lifetime
+ * ============================================================================ */
+
+RIFT_API RiftCompiler* RIFT_CALL rift_compiler_create(void) {
+    RiftCompiler* compiler = (RiftCompiler*)calloc(1, sizeof(RiftCompiler));
+    if (!compiler) return NULL;
+    if (!rift_emit_sink_init_memory(&compiler->sink)) {
+        free(compiler);
+        return NULL;
+    }
+    return compiler;
+}
+
+RIFT_API void RIFT_CALL rift_compiler_destroy(RiftCompiler* compiler) {
+    if (!compiler) return;
+    rift_emit_sink_free(&compiler->sink);
+    free(compiler);
+}
+
+/* ============================================================================
+ * Compile
+ * ============================================================================ */
+
+static RiftCompileStatus compile_fail(RiftCompiler* compiler, RiftCompileStatus status,
+                                      const char* detail) {
+    snprintf(compiler->error, sizeof(compiler->error), "%s%s%s",
+             rift_compile_status_string(status),
+             detail && detail[0] ? ": " : "", detail ? detail : "");
+    return status;
+}
+
+RIFT_API RiftCompileStatus RIFT_CALL rift_compile_buffer(
+    RiftCompiler* compiler,
+    const char* source,
+    size_t length,
+    RiftExecutionMode mode,
+    RiftTargetLanguage target,
+    uint32_t flags,
+    RiftCompileOutput* out
+) {
+    if (out) memset(out, 0, sizeof(*out));
+    if (!compiler) return RIFT_COMPILE_INVALID_ARGUMENT;
+    compiler->error[0] = '\0';
+
+    if (!out || (!source && length > 0)) {
+        return compile_fail(compiler, RIFT_COMPILE_INVALID_ARGUMENT, "NULL source or output");
+    }
+    if (mode != RIFT_MODE_CLASSICAL && mode != RIFT_MODE_QUANTUM && mode != RIFT_MODE_HYBRID) {
+        return compile_fail(compiler, RIFT_COMPILE_INVALID_ARGUMENT, "unknown execution mode");
+    }
+    if (target == RIFT_TARGET_C) {
+        return compile_fail(compiler, RIFT_COMPILE_UNSUPPORTED_TARGET,
+                            "C output is produced by the transform pipeline");
+    }
+    if (target != RIFT_TARGET_JS && target != RIFT_TARGET_GO && target != RIFT_TARGET_LUA &&
+        target != RIFT_TARGET_PYTHON && target != RIFT_TARGET_WAT) {
+        return compile_fail(compiler, RIFT_COMPILE_INVALID_ARGUMENT, "unknown target");
+    }
+
+    /* Phase 1: link */
+    RiftLineIndex lines;
+    if (!riftlang_line_index_build(&lines, source ? source : "", length)) {
+        return length > UINT32_MAX
+            ? compile_fail(compiler, RIFT_COMPILE_INVALID_ARGUMENT, "source over 4 GiB")
+            : compile_fail(compiler, RIFT_COMPILE_OUT_OF_MEMORY, "line index");
+    }
+    RiftCIRProgram* prog = rift_link_lines(&lines, mode);
+    if (!prog) {
+        riftlang_line_index_free(&lines);
+        return compile_fail(compiler, RIFT_COMPILE_OUT_OF_MEMORY, "linker");
+    }
+    if (!prog->consensus_ok) {
+        RiftCompileStatus status = prog->out_of_memory ? RIFT_COMPILE_OUT_OF_MEMORY
+                                                       : RIFT_COMPILE_CONSENSUS_FAILED;
+        compile_fail(compiler, status, prog->error_msg);
+        rift_cir_program_free(prog);
+        riftlang_line_index_free(&lines);
+        return status;
+    }
+
+    /* Phase 2: emit into the reused sink */
+    RiftEmitSink* sink = &compiler->sink;
+    if (sink->capacity > RIFT_COMPILE_RETAIN_BYTES) rift_emit_sink_free(sink);
+    bool ok = rift_emit_sink_reset(sink) && rift_codec_emit_sink(prog, sink, target);
+
+    out->node_count = prog->count;
+    out->mode       = prog->mode;
+    rift_cir_program_free(prog);
+    riftlang_line_index_free(&lines);
+
+    if (!ok) {
+        memset(out, 0, sizeof(*out));
+        return compile_fail(compiler, RIFT_COMPILE_OUT_OF_MEMORY, "output buffer");
+    }
+
+    if (flags & RIFT_COMPILE_CALLER_OWNS) {
+        /* Hand the buffer over; the next compile allocates a fresh one */
+        out->data = rift_emit_sink_detach(sink, &out->size);
+    } else {
+        sink->buf[sink->len] = '\0';    /* capacity holds a byte back for this */
+        out->data = sink->buf;
+        out->size = sink->len;
+    }
+    return RIFT_COMPILE_OK;
+}
+
+/* ============================================================================
+ * Diagnostics
+ * ============================================================================ */
+
+RIFT_API const char* RIFT_CALL rift_compiler_error(const RiftCompiler* compiler) {
+    return compiler ? compiler->error : "";
+}
+
+RIFT_API const char* RIFT_CALL rift_compile_status_string(RiftCompileStatus status) {
+    switch (status) {
+        case RIFT_COMPILE_OK:                 return "ok";
+        case RIFT_COMPILE_INVALID_ARGUMENT:   return "invalid argument";
+        case RIFT_COMPILE_OUT_OF_MEMORY:      return "out of memory";
+        case RIFT_COMPILE_CONSENSUS_FAILED:   return "consensus failed";
+        case RIFT_COMPILE_UNSUPPORTED_TARGET: return "unsupported target";
+    }
+    return "unknown status";
+}
@@ -0,0 +1,120 @@
+/**
+ * @file rift_compile.h
+ * @brief RIFTLang In-Memory Compile API
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * Drives the codec pipeline from a source buffer to emitted text without
+ * touching the filesystem, for services that translate RIFT per request:
+ *
+ *   source buffer ──index──▶ rift_link_lines ──▶ rift_codec_emit_sink
+ *                                                   │ memory sink
+ *                                                   ▼
+ *                                     RiftCompileOutput (data, size)
+ *
+ * A RiftCompiler holds everything a compile needs between calls (the
+ * output buffer and the last error), so a warm compiler makes no
+ * allocation for output that fits its buffer. There is no global state:
+ * compilers are independent, but one compiler must not be used by two
+ * threads at once — give each worker its own.
+ *
+ * Targets: JS, Python, Go, Lua and WAT. The C target is rejected with
+ * RIFT_COMPILE_UNSUPPORTED_TARGET; C output comes from the transform
+ * pipeline in main.c, which compiles through gcc and the filesystem.
+ */
+
+#ifndef RIFT_COMPILE_H
+#define RIFT_COMPILE_H
+
+#include "riftlang.h"   /* RiftExecutionMode, RiftTargetLanguage */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+/** RiftCompileStatus — result of rift_compile_buffer. */
+typedef enum {
+    RIFT_COMPILE_OK = 0,
+    RIFT_COMPILE_INVALID_ARGUMENT,      /* NULL pointer, bad mode or target */
+    RIFT_COMPILE_OUT_OF_MEMORY,
+    RIFT_COMPILE_CONSENSUS_FAILED,      /* source rejected by the linker */
+    RIFT_COMPILE_UNSUPPORTED_TARGET     /* RIFT_TARGET_C */
+} RiftCompileStatus;
+
+/* rift_compile_buffer flags */
+#define RIFT_COMPILE_CALLER_OWNS   0x1u  /* output is malloc'd; caller frees data */
+
+/**
+ * RiftCompileOutput — emitted text, NUL-terminated (size excludes the NUL).
+ *
+ * Without RIFT_COMPILE_CALLER_OWNS, data belongs to the compiler and stays
+ * valid until its next compile or rift_compiler_destroy. With it, data is
+ * the caller's to free().
+ */
+typedef struct {
+    const char*       data;
+    size_t            size;
+    uint32_t          node_count;   /* CIR nodes linked */
+    RiftExecutionMode mode;         /* effective mode (a !govern directive wins) */
+} RiftCompileOutput;
+
+/** RiftCompiler — opaque, reusable compile state. */
+typedef struct RiftCompiler RiftCompiler;
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/**
+ * Create a compiler. Returns NULL on allocation failure.
+ */
+RIFT_API RiftCompiler* RIFT_CALL rift_compiler_create(void);
+
+/**
+ * Destroy a compiler and any output it still owns.
+ */
+RIFT_API void RIFT_CALL rift_compiler_destroy(
+    RiftCompiler* compiler
+);
+
+/**
+ * Link and emit source[0..length) in one call. The source need not be
+ * NUL-terminated and is only read during the call.
+ *
+ * On success *out describes the output; on failure *out is zeroed and
+ * rift_compiler_error says why.
+ */
+RIFT_API RiftCompileStatus RIFT_CALL rift_compile_buffer(
+    RiftCompiler* compiler,
+    const char* source,
+    size_t length,
+    RiftExecutionMode mode,         /* default if the source has no !govern */
+    RiftTargetLanguage target,
+    uint32_t flags,                 /* RIFT_COMPILE_* */
+    RiftCompileOutput* out
+);
+
+/**
+ * Message for the compiler's last failure ("" after a success).
+ */
+RIFT_API const char* RIFT_CALL rift_compiler_error(
+    const RiftCompiler* compiler
+);
+
+/**
+ * Static name of a status, e.g. "consensus failed".
+ */
+RIFT_API const char* RIFT_CALL rift_compile_status_string(
+    RiftCompileStatus status
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RIFT_COMPILE_H */
@@ -0,0 +1,433 @@
+/**
+ * @file rift_daemon.c
+ * @brief RIFTLang Compile Daemon — Unix Socket Protocol Implementation
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * See rift_daemon.h for the frame layout. The serve loop itself lives in
+ * main.c, next to the compile pipeline it runs; this file only moves
+ * frames and descriptors across the socket.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE     /* struct ucred */
+#endif
+
+#include "rift_daemon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  /* no SIGPIPE suppression per call; callers ignore it */
+#endif
+
+#ifndef _WIN32
+
+/* ============================================================================
+ * Socket Setup
+ * ============================================================================ */
+
+static bool daemon_socket_address(const char* path, struct sockaddr_un* addr) {
+    if (!path || !*path) {
+        errno = EINVAL;
+        return false;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    size_t len = strlen(path);
+    if (len >= sizeof(addr->sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    memcpy(addr->sun_path, path, len + 1);
+    return true;
+}
+
+int rift_daemon_connect(const char* path) {
+    struct sockaddr_un addr;
+    if (!daemon_socket_address(path, &addr)) return -1;
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
+    }
+    return sock;
+}
+
+int rift_daemon_listen(const char* path) {
+    struct sockaddr_un addr;
+    if (!daemon_socket_address(path, &addr)) return -1;
+
+    /* A socket file nobody answers on is left over from a dead daemon */
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            errno = EEXIST;
+            return -1;
+        }
+        int probe = rift_daemon_connect(path);
+        if (probe >= 0) {
+            close(probe);
+            errno = EADDRINUSE;
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+
+    /* Owner-only from the moment the file exists */
+    mode_t old_mask = umask(0077);
+    int rc = bind(sock, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old_mask);
+    if (rc != 0 || listen(sock, SOMAXCONN) != 0) {
+        int saved = errno;
+        close(sock);
+        if (rc == 0) unlink(path);
+        errno = saved;
+        return -1;
+    }
+    return sock;
+}
+
+bool rift_daemon_peer_is_owner(int sock) {
+#if defined(__linux__)
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+    return cred.uid == geteuid();
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(sock, &uid, &gid) != 0) return false;
+    return uid == geteuid();
+#else
+    (void)sock;
+    return true;
+#endif
+}
+
+/* ============================================================================
+ * Frame I/O
+ * ============================================================================ */
+
+static bool daemon_send_all(int sock, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(sock, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool daemon_recv_all(int sock, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(sock, data, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;     /* peer closed mid-frame */
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void daemon_frame_init(RiftDaemonFrame* frame, RiftDaemonFrameKind kind, uint32_t size) {
+    memcpy(frame->magic, RIFT_DAEMON_MAGIC, sizeof(frame->magic));
+    frame->version = RIFT_DAEMON_PROTOCOL;
+    frame->kind = (uint16_t)kind;
+    frame->size = size;
+}
+
+static bool daemon_frame_valid(const RiftDaemonFrame* frame, RiftDaemonFrameKind kind) {
+    if (memcmp(frame->magic, RIFT_DAEMON_MAGIC, sizeof(frame->magic)) != 0 ||
+        frame->version != RIFT_DAEMON_PROTOCOL ||
+        frame->kind != (uint16_t)kind ||
+        frame->size > RIFT_DAEMON_MAX_PAYLOAD) {
+        errno = EPROTO;
+        return false;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Requests
+ * ============================================================================ */
+
+bool rift_daemon_send_request(int sock, const char* cwd,
+                              int argc, char* const argv[],
+                              int envc, char* const env[],
+                              int out_fd, int err_fd) {
+    if (!cwd || argc < 1 || envc < 0 || out_fd < 0 || err_fd < 0) {
+        errno = EINVAL;
+        return false;
+    }
+
+    /* frame | argc | envc | cwd\0 argv...\0 env...\0 */
+    size_t size = sizeof(RiftDaemonFrame) + 2 * sizeof(uint32_t) + strlen(cwd) + 1;
+    for (int i = 0; i < argc; i++) size += strlen(argv[i]) + 1;
+    for (int i = 0; i < envc; i++) size += strlen(env[i]) + 1;
+    if (size - sizeof(RiftDaemonFrame) > RIFT_DAEMON_MAX_PAYLOAD) {
+        errno = E2BIG;
+        return false;
+    }
+
+    char* message = (char*)malloc(size);
+    if (!message) return false;
+    RiftDaemonFrame frame;
+    daemon_frame_init(&frame, RIFT_DAEMON_REQUEST, (uint32_t)(size - sizeof(frame)));
+    memcpy(message, &frame, sizeof(frame));
+    char* p = message + sizeof(frame);
+    uint32_t counts[2] = { (uint32_t)argc, (uint32_t)envc };
+    memcpy(p, counts, sizeof(counts));
+    p += sizeof(counts);
+    size_t len = strlen(cwd) + 1;
+    memcpy(p, cwd, len);
+    p += len;
+    for (int i = 0; i < argc; i++) {
+        len = strlen(argv[i]) + 1;
+        memcpy(p, argv[i], len);
+        p += len;
+    }
+    for (int i = 0; i < envc; i++) {
+        len = strlen(env[i]) + 1;
+        memcpy(p, env[i], len);
+        p += len;
+    }
+
+    /* The descriptors ride on the first byte; the rest is a plain stream */
+    int fds[2] = { out_fd, err_fd };
+    union {
+        char buf[CMSG_SPACE(sizeof(fds))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = { message, size };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    bool ok = sent >= 0 && daemon_send_all(sock, message + sent, size - (size_t)sent);
+
+    int saved = errno;
+    free(message);
+    errno = saved;
+    return ok;
+}
+
+/* Read the frame header, keeping any descriptors that arrive with it */
+static bool daemon_recv_header(int sock, RiftDaemonFrame* frame, int fds[2]) {
+    char* data = (char*)frame;
+    size_t got = 0;
+    while (got < sizeof(*frame)) {
+        union {
+            char buf[CMSG_SPACE(2 * sizeof(int))];
+            struct cmsghdr align;
+        } control;
+        struct iovec iov = { data + got, sizeof(*frame) - got };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t n = recvmsg(sock, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return false;
+        }
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; i++) {
+                int fd;
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd));
+                if (i < 2 && fds[i] < 0) fds[i] = fd;
+                else close(fd);
+            }
+        }
+        if (msg.msg_flags & MSG_CTRUNC) {
+            errno = EPROTO;
+            return false;
+        }
+        got += (size_t)n;
+    }
+    return true;
+}
+
+/* Split the payload into cwd, argv and env; false if it is malformed */
+static bool daemon_parse_request(RiftDaemonRequest* req, size_t size) {
+    uint32_t counts[2];
+    if (size < sizeof(counts)) return false;
+    memcpy(counts, req->payload, sizeof(counts));
+    /* Every string takes at least its NUL */
+    size_t strings = (size_t)counts[0] + counts[1] + 1;
+    if (counts[0] < 1 || strings > size - sizeof(counts)) return false;
+
+    req->argv = (char**)calloc((size_t)counts[0] + counts[1] + 2, sizeof(char*));
+    if (!req->argv) return false;
+    req->argc = (int)counts[0];
+    req->envc = (int)counts[1];
+    req->env = req->argv + req->argc + 1;
+
+    char* p = req->payload + sizeof(counts);
+    char* end = req->payload + size;
+    for (size_t i = 0; i < strings; i++) {
+        char* nul = (char*)memchr(p, '\0', (size_t)(end - p));
+        if (!nul) return false;
+        if (i == 0) req->cwd = p;
+        else if (i <= (size_t)req->argc) req->argv[i - 1] = p;
+        else req->env[i - 1 - (size_t)req->argc] = p;
+        p = nul + 1;
+    }
+    return p == end;
+}
+
+bool rift_daemon_recv_request(int sock, RiftDaemonRequest* req) {
+    memset(req, 0, sizeof(*req));
+    req->out_fd = req->err_fd = -1;
+
+    RiftDaemonFrame frame;
+    int fds[2] = { -1, -1 };
+    bool ok = daemon_recv_header(sock, &frame, fds) &&
+              daemon_frame_valid(&frame, RIFT_DAEMON_REQUEST);
+    req->out_fd = fds[0];
+    req->err_fd = fds[1];
+    if (!ok) {
+        rift_daemon_request_free(req);
+        return false;
+    }
+
+    /* One spare byte keeps a truncated last string inside the buffer */
+    req->payload = (char*)malloc((size_t)frame.size + 1);
+    if (!req->payload || !daemon_recv_all(sock, req->payload, frame.size)) {
+        rift_daemon_request_free(req);
+        return false;
+    }
+    req->payload[frame.size] = '\0';
+    if (!daemon_parse_request(req, frame.size)) {
+        rift_daemon_request_free(req);
+        errno = EPROTO;
+        return false;
+    }
+    return true;
+}
+
+void rift_daemon_request_free(RiftDaemonRequest* req) {
+    if (!req) return;
+    if (req->out_fd >= 0) close(req->out_fd);
+    if (req->err_fd >= 0) close(req->err_fd);
+    free(req->argv);
+    free(req->payload);
+    memset(req, 0, sizeof(*req));
+    req->out_fd = req->err_fd = -1;
+}
+
+/* ============================================================================
+ * Status
+ * ============================================================================ */
+
+bool rift_daemon_send_status(int sock, int status) {
+    char message[sizeof(RiftDaemonFrame) + sizeof(int32_t)];
+    RiftDaemonFrame frame;
+    daemon_frame_init(&frame, RIFT_DAEMON_STATUS, sizeof(int32_t));
+    int32_t code = (int32_t)status;
+    memcpy(message, &frame, sizeof(frame));
+    memcpy(message + sizeof(frame), &code, sizeof(code));
+    return daemon_send_all(sock, message, sizeof(message));
+}
+
+bool rift_daemon_recv_status(int sock, int* status) {
+    RiftDaemonFrame frame;
+    int32_t code;
+    if (!daemon_recv_all(sock, (char*)&frame, sizeof(frame)) ||
+        !daemon_frame_valid(&frame, RIFT_DAEMON_STATUS)) {
+        return false;
+    }
+    if (frame.size != sizeof(code)) {
+        errno = EPROTO;
+        return false;
+    }
+    if (!daemon_recv_all(sock, (char*)&code, sizeof(code))) return false;
+    *status = (int)code;
+    return true;
+}
+
+#else /* _WIN32 */
+
+int rift_daemon_listen(const char* path) { (void)path; errno = ENOSYS; return -1; }
+int rift_daemon_connect(const char* path) { (void)path; errno = ENOSYS; return -1; }
+bool rift_daemon_peer_is_owner(int sock) { (void)sock; return false; }
+
+bool rift_daemon_send_request(int sock, const char* cwd,
+                              int argc, char* const argv[],
+                              int envc, char* const env[],
+                              int out_fd, int err_fd) {
+    (void)sock; (void)cwd; (void)argc; (void)argv;
+    (void)envc; (void)env; (void)out_fd; (void)err_fd;
+    errno = ENOSYS;
+    return false;
+}
+
+bool rift_daemon_recv_request(int sock, RiftDaemonRequest* req) {
+    (void)sock;
+    memset(req, 0, sizeof(*req));
+    req->out_fd = req->err_fd = -1;
+    errno = ENOSYS;
+    return false;
+}
+
+void rift_daemon_request_free(RiftDaemonRequest* req) { (void)req; }
+
+bool rift_daemon_send_status(int sock, int status) {
+    (void)sock; (void)status;
+    errno = ENOSYS;
+    return false;
+}
+
+bool rift_daemon_recv_status(int sock, int* status) {
+    (void)sock; (void)status;
+    errno = ENOSYS;
+    return false;
+}
+
+#endif /* _WIN32 */
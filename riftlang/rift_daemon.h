@@ -0,0 +1,120 @@
+/**
+ * @file rift_daemon.h
+ * @brief RIFTLang Compile Daemon — Unix Socket Protocol
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * `riftlang --daemon <socket>` compiles the transform rules for every mode
+ * once and then serves compile requests; `riftlang --connect <socket> ...`
+ * (or RIFTLANG_DAEMON) forwards its own command line instead of running it:
+ *
+ *   client ──request: cwd, argv, env, stdout+stderr fds──▶ daemon
+ *                                                            │ fork
+ *                                                            ▼
+ *   client ◀────────────── status: exit code ─────────── worker
+ *
+ * The worker writes straight to the client's stdout and stderr (passed
+ * with SCM_RIGHTS), so output is exactly what a local run would print.
+ *
+ * Every message is one frame, header then payload, in host byte order
+ * (both ends are on the same machine):
+ *
+ *   RiftDaemonFrame { "RFTD", version, kind, size } | payload[size]
+ *
+ *   REQUEST payload:  uint32 argc | uint32 envc | cwd\0 argv[0]\0 ... env[0]\0 ...
+ *   STATUS  payload:  int32 exit code
+ *
+ * POSIX only: on Windows every call fails with errno = ENOSYS.
+ */
+
+#ifndef RIFT_DAEMON_H
+#define RIFT_DAEMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define RIFT_DAEMON_MAGIC         "RFTD"
+#define RIFT_DAEMON_PROTOCOL      1
+#define RIFT_DAEMON_MAX_PAYLOAD   (1u << 20)   /* largest request accepted */
+
+/* ============================================================================
+ * Frames
+ * ============================================================================ */
+
+typedef enum {
+    RIFT_DAEMON_REQUEST = 1,
+    RIFT_DAEMON_STATUS  = 2
+} RiftDaemonFrameKind;
+
+typedef struct {
+    char     magic[4];          /* RIFT_DAEMON_MAGIC, no NUL */
+    uint16_t version;           /* RIFT_DAEMON_PROTOCOL */
+    uint16_t kind;              /* RiftDaemonFrameKind */
+    uint32_t size;              /* payload bytes that follow */
+} RiftDaemonFrame;
+
+/**
+ * RiftDaemonRequest — a received compile request. Every string points
+ * into payload; the descriptors are the client's stdout and stderr, or -1
+ * if it sent none.
+ */
+typedef struct {
+    char*        payload;
+    const char*  cwd;
+    int          argc;
+    char**       argv;          /* argc entries, NULL-terminated */
+    int          envc;
+    char**       env;           /* "NAME=value" entries */
+    int          out_fd;
+    int          err_fd;
+} RiftDaemonRequest;
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/**
+ * rift_daemon_listen — bind a listening socket at path, readable by the
+ * owner only. A stale socket file is replaced; a live daemon already on
+ * path fails with EADDRINUSE. Returns the descriptor, or -1 (errno set).
+ */
+int rift_daemon_listen(const char* path);
+
+/** rift_daemon_connect — connect to the daemon at path; -1 (errno set). */
+int rift_daemon_connect(const char* path);
+
+/**
+ * rift_daemon_peer_is_owner — true if the peer on sock runs as this
+ * process's user. Where the platform cannot tell, the owner-only socket
+ * mode is the only guard and this returns true.
+ */
+bool rift_daemon_peer_is_owner(int sock);
+
+/**
+ * rift_daemon_send_request — send one REQUEST frame, passing out_fd and
+ * err_fd (both >= 0) along with it.
+ */
+bool rift_daemon_send_request(int sock, const char* cwd,
+                              int argc, char* const argv[],
+                              int envc, char* const env[],
+                              int out_fd, int err_fd);
+
+/**
+ * rift_daemon_recv_request — read and validate one REQUEST frame. On
+ * success free req with rift_daemon_request_free.
+ */
+bool rift_daemon_recv_request(int sock, RiftDaemonRequest* req);
+
+/** rift_daemon_request_free — release the payload and close passed fds. */
+void rift_daemon_request_free(RiftDaemonRequest* req);
+
+/** rift_daemon_send_status — send one STATUS frame. */
+bool rift_daemon_send_status(int sock, int status);
+
+/** rift_daemon_recv_status — wait for the STATUS frame. */
+bool rift_daemon_recv_status(int sock, int* status);
+
+#endif /* RIFT_DAEMON_H */
@@ -0,0 +1,414 @@
+/**
+ * @file rift_rules.h
+ * @brief RIFTLang Built-in Transform Rule Tables
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * The rule tables the CLI registers with the pattern engine, one per
+ * target. Kept in a header so the tests can run every table through both
+ * matching paths (automaton and per-pair regexec) and compare them.
+ * Include from exactly one translation unit per program.
+ */
+
+#ifndef RIFT_RULES_H
+#define RIFT_RULES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "riftlang.h"
+
+/* ============================================================================
+ * Pattern Transformation Rules
+ * ============================================================================ */
+
+typedef struct {
+    const char* name;               /* Rule name for debugging */
+    const char* left_pattern;       /* RIFT regex pattern */
+    const char* right_template;     /* C code template */
+    uint32_t priority;              /* Lower = higher priority */
+    bool right_is_literal;          /* True if template is literal C code */
+    RiftExecutionMode applicable_mode; /* Mode this rule applies to */
+} RiftTransformRule;
+
+/* Predefined transformation rules for RIFT -> C */
+static RiftTransformRule g_transform_rules[] = {
+    /* Governance directives - highest priority */
+    {
+        "govern_classical",
+        "^[[:space:]]*!govern[[:space:]]+classical",
+        "/* RIFT: Classical mode enabled */",
+        1, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "govern_quantum",
+        "^[[:space:]]*!govern[[:space:]]+quantum",
+        "/* RIFT: Quantum mode enabled */",
+        1, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "govern_hybrid",
+        "^[[:space:]]*!govern[[:space:]]+hybrid",
+        "/* RIFT: Hybrid mode enabled */",
+        1, true, RIFT_MODE_HYBRID
+    },
+    
+    /* Memory-first declarations */
+    {
+        "span_fixed",
+        "^[[:space:]]*align[[:space:]]+span<fixed>[[:space:]]*\\{",
+        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_FIXED, ",
+        10, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "span_row",
+        "^[[:space:]]*align[[:space:]]+span<row>[[:space:]]*\\{",
+        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_ROW, ",
+        10, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "span_continuous",
+        "^[[:space:]]*align[[:space:]]+span<continuous>[[:space:]]*\\{",
+        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_CONTINUOUS, ",
+        10, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "span_superposed",
+        "^[[:space:]]*align[[:space:]]+span<superposed>[[:space:]]*\\{",
+        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_SUPERPOSED, ",
+        10, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "span_entangled",
+        "^[[:space:]]*align[[:space:]]+span<entangled>[[:space:]]*\\{",
+        "RIFT_DECLARE_MEMORY(span, RIFT_SPAN_ENTANGLED, ",
+        10, true, RIFT_MODE_QUANTUM
+    },
+    
+    /* Type declarations */
+    {
+        "type_def",
+        "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+        "/* RIFT type: \\1 */ typedef struct {",
+        20, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "type_int",
+        "^[[:space:]]*type[[:space:]]+INT[[:space:]]*=[[:space:]]*\\{[^}]*bit_width:[[:space:]]*32",
+        "typedef int32_t RIFT_INT;",
+        21, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "type_float",
+        "^[[:space:]]*type[[:space:]]+FLOAT[[:space:]]*=[[:space:]]*\\{[^}]*bit_width:[[:space:]]*64",
+        "typedef double RIFT_FLOAT;",
+        21, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "type_qint",
+        "^[[:space:]]*type[[:space:]]+QINT[[:space:]]*=",
+        "/* Quantum integer type */ typedef struct { int32_t value; double phase; } RIFT_QINT;",
+        21, true, RIFT_MODE_QUANTUM
+    },
+    
+    /* Classical assignment - immediate binding */
+    {
+        "assign_classical",
+        "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
+        "RIFT_ASSIGN_CLASSICAL(\\1, \\2);",
+        30, true, RIFT_MODE_CLASSICAL
+    },
+    
+    /* Quantum assignment - deferred binding */
+    {
+        "assign_quantum",
+        "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*=:[[:space:]]*([^;]+)",
+        "RIFT_ASSIGN_QUANTUM(\\1, \\2);",
+        30, true, RIFT_MODE_QUANTUM
+    },
+    
+    /* Policy enforcement */
+    {
+        "policy_fn",
+        "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+        "RiftPolicyContext* policy_\\1 = rift_policy_context_create(\"\\1\", threshold, true);",
+        40, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "policy_validate",
+        "^[[:space:]]*validate[[:space:]]*\\(",
+        "rift_policy_validate(policy_matrix, true, true)",
+        41, true, RIFT_MODE_CLASSICAL
+    },
+    
+    /* Quantum operations */
+    {
+        "entangle",
+        "entangle[[:space:]]*\\(([a-zA-Z_]+),[[:space:]]*([a-zA-Z_]+)\\)",
+        "rift_token_entangle(\\1, \\2, 0)",
+        50, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "superpose",
+        "superpose[[:space:]]*\\(([a-zA-Z_]+),[[:space:]]*\\[",
+        "rift_token_superpose(\\1, states, count, NULL)",
+        50, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "collapse",
+        "([a-zA-Z_]+)\\.collapse[[:space:]]*\\(([0-9]+)\\)",
+        "rift_token_collapse(\\1, \\2, policy_ctx)",
+        51, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "measure",
+        "measure[[:space:]]*\\(([a-zA-Z_]+)\\)",
+        "rift_token_measure(\\1, &collapsed_idx, &prob)",
+        51, true, RIFT_MODE_QUANTUM
+    },
+    {
+        "entropy",
+        "calculate_entropy[[:space:]]*\\(([a-zA-Z_]+)\\)",
+        "rift_token_calculate_entropy(\\1)",
+        52, true, RIFT_MODE_QUANTUM
+    },
+    
+    /* Memory structure constructs */
+    {
+        "vector_decl",
+        "^[[:space:]]*vector[[:space:]]+<([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
+        "RiftToken* \\2 = rift_token_create(RIFT_TOKEN_VECTOR, span_\\1);",
+        60, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "array_decl",
+        "^[[:space:]]*array[[:space:]]+<([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
+        "RiftToken* \\2 = rift_token_create(RIFT_TOKEN_ARRAY, span_\\1);",
+        60, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "map_decl",
+        "^[[:space:]]*map[[:space:]]+<([A-Za-z_]+),[[:space:]]*([A-Za-z_]+)>[[:space:]]+([a-zA-Z_]+)",
+        "RiftToken* \\3 = rift_token_create(RIFT_TOKEN_MAP, span_\\1_\\2);",
+        60, true, RIFT_MODE_CLASSICAL
+    },
+    
+    /* Control flow */
+    {
+        "if_stmt",
+        "^[[:space:]]*if[[:space:]]*\\(",
+        "if (",
+        100, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "while_stmt",
+        "^[[:space:]]*while[[:space:]]*\\(",
+        "while (",
+        100, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "for_stmt",
+        "^[[:space:]]*for[[:space:]]*\\(",
+        "for (",
+        100, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "block_start",
+        "^[[:space:]]*\\{",
+        "{",
+        200, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "block_end",
+        "^[[:space:]]*\\}",
+        "}",
+        200, true, RIFT_MODE_CLASSICAL
+    },
+    
+    /* Comments - preserve or transform */
+    {
+        "comment_single",
+        "^[[:space:]]*//(.*)$",
+        "/*\\1 */",
+        1000, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "comment_multi_start",
+        "^[[:space:]]*/\\*",
+        "/*",
+        1000, true, RIFT_MODE_CLASSICAL
+    },
+    {
+        "comment_multi_end",
+        "\\*/[[:space:]]*$",
+        "*/",
+        1000, true, RIFT_MODE_CLASSICAL
+    },
+    
+    /* End marker */
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+/* ============================================================================
+ * Language-Specific Transform Rules (non-C targets)
+ * ============================================================================ */
+
+/* --- JavaScript / Node.js (node-riftlang) --- */
+static RiftTransformRule g_js_rules[] = {
+    { "js_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
+      "// RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
+    { "js_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
+      "// rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
+    { "js_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
+      "", 11, true, RIFT_MODE_CLASSICAL },
+    { "js_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+      "// type: \\1", 20, true, RIFT_MODE_CLASSICAL },
+    { "js_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
+      "", 21, true, RIFT_MODE_CLASSICAL },
+    { "js_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
+      "let \\1 = \\2;", 30, true, RIFT_MODE_CLASSICAL },
+    { "js_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+      "// policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
+    { "js_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
+      "", 41, true, RIFT_MODE_CLASSICAL },
+    { "js_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
+      "rift.validate('\\1');", 42, true, RIFT_MODE_CLASSICAL },
+    { "js_while",     "^[[:space:]]*while[[:space:]]*\\(",
+      "while (", 100, true, RIFT_MODE_CLASSICAL },
+    { "js_if",        "^[[:space:]]*if[[:space:]]*\\(",
+      "if (", 100, true, RIFT_MODE_CLASSICAL },
+    { "js_for",       "^[[:space:]]*for[[:space:]]*\\(",
+      "for (", 100, true, RIFT_MODE_CLASSICAL },
+    { "js_block_open","^[[:space:]]*\\{",  "{",  200, true, RIFT_MODE_CLASSICAL },
+    { "js_block_close","^[[:space:]]*\\}", "}",  200, true, RIFT_MODE_CLASSICAL },
+    { "js_comment_sl","^[[:space:]]*//(.*)$", "//\\1", 1000, true, RIFT_MODE_CLASSICAL },
+    { "js_comment_ms","^[[:space:]]*/\\*",   "/*",   1000, true, RIFT_MODE_CLASSICAL },
+    { "js_comment_me","\\*/[[:space:]]*$",   "*/",   1000, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+/* --- Python (pyriftlang) --- */
+static RiftTransformRule g_py_rules[] = {
+    { "py_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
+      "# RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
+    { "py_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
+      "# rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
+    { "py_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
+      "", 11, true, RIFT_MODE_CLASSICAL },
+    { "py_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+      "# type: \\1", 20, true, RIFT_MODE_CLASSICAL },
+    { "py_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
+      "", 21, true, RIFT_MODE_CLASSICAL },
+    { "py_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
+      "\\1 = \\2", 30, true, RIFT_MODE_CLASSICAL },
+    { "py_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+      "# policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
+    { "py_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
+      "", 41, true, RIFT_MODE_CLASSICAL },
+    { "py_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
+      "rift.validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
+    { "py_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
+      "while \\1:", 100, true, RIFT_MODE_CLASSICAL },
+    { "py_if",        "^[[:space:]]*if[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
+      "if \\1:", 100, true, RIFT_MODE_CLASSICAL },
+    { "py_block_close","^[[:space:]]*\\}", "", 200, true, RIFT_MODE_CLASSICAL },
+    { "py_comment_sl","^[[:space:]]*//(.*)$", "#\\1", 1000, true, RIFT_MODE_CLASSICAL },
+    { "py_comment_ms","^[[:space:]]*/\\*",    "\"\"\"", 1000, true, RIFT_MODE_CLASSICAL },
+    { "py_comment_me","\\*/[[:space:]]*$",    "\"\"\"", 1000, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+/* --- Go (go-riftlang) --- */
+static RiftTransformRule g_go_rules[] = {
+    { "go_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
+      "// RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
+    { "go_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
+      "// rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
+    { "go_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
+      "", 11, true, RIFT_MODE_CLASSICAL },
+    { "go_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+      "type \\1 struct {", 20, true, RIFT_MODE_CLASSICAL },
+    { "go_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*INT",
+      "\\1 int32", 21, true, RIFT_MODE_CLASSICAL },
+    { "go_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
+      "\\1 := \\2", 30, true, RIFT_MODE_CLASSICAL },
+    { "go_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+      "// policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
+    { "go_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
+      "", 41, true, RIFT_MODE_CLASSICAL },
+    { "go_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
+      "rift.Validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
+    { "go_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
+      "for \\1 {", 100, true, RIFT_MODE_CLASSICAL },
+    { "go_if",        "^[[:space:]]*if[[:space:]]*\\(",
+      "if (", 100, true, RIFT_MODE_CLASSICAL },
+    { "go_for",       "^[[:space:]]*for[[:space:]]*\\(",
+      "for (", 100, true, RIFT_MODE_CLASSICAL },
+    { "go_block_open","^[[:space:]]*\\{",   "{", 200, true, RIFT_MODE_CLASSICAL },
+    { "go_block_close","^[[:space:]]*\\}",  "}", 200, true, RIFT_MODE_CLASSICAL },
+    { "go_comment_sl","^[[:space:]]*//(.*)$","//\\1", 1000, true, RIFT_MODE_CLASSICAL },
+    { "go_comment_ms","^[[:space:]]*/\\*",   "/*",   1000, true, RIFT_MODE_CLASSICAL },
+    { "go_comment_me","\\*/[[:space:]]*$",   "*/",   1000, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+/* --- Lua (lua-riftlang) --- */
+static RiftTransformRule g_lua_rules[] = {
+    { "lua_govern",    "^[[:space:]]*!govern[[:space:]]+[a-z]+",
+      "-- RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
+    { "lua_span",      "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
+      "-- rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
+    { "lua_span_attr", "^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
+      "", 11, true, RIFT_MODE_CLASSICAL },
+    { "lua_type_def",  "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+      "-- type: \\1", 20, true, RIFT_MODE_CLASSICAL },
+    { "lua_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
+      "", 21, true, RIFT_MODE_CLASSICAL },
+    { "lua_assign",    "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([^;]+)",
+      "local \\1 = \\2", 30, true, RIFT_MODE_CLASSICAL },
+    { "lua_policy",    "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+      "-- policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
+    { "lua_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
+      "", 41, true, RIFT_MODE_CLASSICAL },
+    { "lua_validate",  "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
+      "rift.validate(\\1)", 42, true, RIFT_MODE_CLASSICAL },
+    { "lua_while",     "^[[:space:]]*while[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
+      "while \\1 do", 100, true, RIFT_MODE_CLASSICAL },
+    { "lua_if",        "^[[:space:]]*if[[:space:]]*\\(([^)]+)\\)[[:space:]]*\\{",
+      "if \\1 then", 100, true, RIFT_MODE_CLASSICAL },
+    { "lua_block_open","^[[:space:]]*\\{",  "", 200, true, RIFT_MODE_CLASSICAL },
+    { "lua_block_close","^[[:space:]]*\\}", "end", 200, true, RIFT_MODE_CLASSICAL },
+    { "lua_comment_sl","^[[:space:]]*//(.*)$","--\\1", 1000, true, RIFT_MODE_CLASSICAL },
+    { "lua_comment_ms","^[[:space:]]*/\\*",   "--[[", 1000, true, RIFT_MODE_CLASSICAL },
+    { "lua_comment_me","\\*/[[:space:]]*$",   "]]",   1000, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+/* --- WebAssembly Text (wat2wasm) --- */
+static RiftTransformRule g_wat_rules[] = {
+    { "wat_govern",   "^[[:space:]]*!govern[[:space:]]+[a-z]+",
+      ";; RIFT: classical mode", 1, true, RIFT_MODE_CLASSICAL },
+    { "wat_span",     "^[[:space:]]*align[[:space:]]+span<[a-z]+>",
+      ";; rift: memory span", 10, true, RIFT_MODE_CLASSICAL },
+    { "wat_span_attr","^[[:space:]]*(bytes|type):[[:space:]]*[^,}]+",
+      "", 11, true, RIFT_MODE_CLASSICAL },
+    { "wat_type_def", "^[[:space:]]*type[[:space:]]+([A-Za-z_][A-Za-z0-9_]*)[[:space:]]*=",
+      ";; type: \\1", 20, true, RIFT_MODE_CLASSICAL },
+    { "wat_type_field","^[[:space:]]*([a-z_]+):[[:space:]]*[A-Z]+",
+      "", 21, true, RIFT_MODE_CLASSICAL },
+    { "wat_assign_i", "([a-zA-Z_][a-zA-Z0-9_]*)[[:space:]]*:=[[:space:]]*([0-9]+)",
+      "(local.set $\\1 (i32.const \\2))", 30, true, RIFT_MODE_CLASSICAL },
+    { "wat_policy",   "^[[:space:]]*policy_fn[[:space:]]+on[[:space:]]+([a-z_]+)",
+      ";; policy: \\1", 40, true, RIFT_MODE_CLASSICAL },
+    { "wat_policy_attr","^[[:space:]]*(default_access|reassert_lock):[[:space:]]*[^\n]+",
+      "", 41, true, RIFT_MODE_CLASSICAL },
+    { "wat_validate", "^[[:space:]]*validate[[:space:]]*\\(([^)]+)\\)",
+      "(call $rift_validate)", 42, true, RIFT_MODE_CLASSICAL },
+    { "wat_while",    "^[[:space:]]*while[[:space:]]*\\([^)]+\\)[[:space:]]*\\{",
+      "(block (loop", 100, true, RIFT_MODE_CLASSICAL },
+    { "wat_block_close","^[[:space:]]*\\}", "))", 200, true, RIFT_MODE_CLASSICAL },
+    { "wat_comment_sl","^[[:space:]]*//(.*)$",";; \\1", 1000, true, RIFT_MODE_CLASSICAL },
+    { "wat_comment_ms","^[[:space:]]*/\\*",   ";; ",   1000, true, RIFT_MODE_CLASSICAL },
+    { "wat_comment_me","\\*/[[:space:]]*$",   "",      1000, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+#endif /* RIFT_RULES_H */
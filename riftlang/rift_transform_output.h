@@ -0,0 +1,166 @@
+/**
+ * @file rift_transform_output.h
+ * @brief RIFTLang Transform Output Builder
+ * @author Nnamdi Michael Okpala — OBINexus Constitutional Computing
+ *
+ * The chunk list transform_source() appends generated C to, and the
+ * writer that hands the chunks to rift_write_segments_if_changed. Kept in
+ * a header so the tests can drive the builder directly.
+ * Include from exactly one translation unit per program.
+ */
+
+#ifndef RIFT_TRANSFORM_OUTPUT_H
+#define RIFT_TRANSFORM_OUTPUT_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "rift_cache.h"
+
+#define RIFT_TRANSFORM_CHUNK (64 * 1024)   /* smallest chunk after the first */
+
+/* A chunk of generated C; its bytes never move once written */
+typedef struct TransformChunk {
+    struct TransformChunk* next;
+    size_t len;
+    size_t capacity;
+    char data[];
+} TransformChunk;
+
+/**
+ * Generated C as a list of chunks. Appending fills the last chunk or
+ * starts a new one, so nothing already written is copied again, and the
+ * chunks go to the output file as one writev.
+ */
+typedef struct {
+    TransformChunk* head;
+    TransformChunk* tail;
+    size_t size;                    /* bytes over all chunks */
+    int chunk_count;
+    bool failed;                    /* an allocation failed: output incomplete */
+} TransformOutput;
+
+typedef struct {
+    TransformOutput output;
+    uint32_t lines_processed;
+    uint32_t patterns_matched;
+    uint32_t patterns_failed;
+    double processing_time_ms;
+} TransformResult;
+
+/* Make room for need bytes at the end of the last chunk */
+static inline bool transform_reserve(TransformOutput* out, size_t need) {
+    if (out->failed) return false;
+    if (out->tail && out->tail->capacity - out->tail->len >= need) return true;
+
+    size_t capacity = need > RIFT_TRANSFORM_CHUNK ? need : RIFT_TRANSFORM_CHUNK;
+    if (capacity > SIZE_MAX - sizeof(TransformChunk)) {
+        out->failed = true;
+        return false;
+    }
+    TransformChunk* chunk = (TransformChunk*)malloc(sizeof(TransformChunk) + capacity);
+    if (!chunk) {
+        out->failed = true;
+        return false;
+    }
+    chunk->next = NULL;
+    chunk->len = 0;
+    chunk->capacity = capacity;
+    if (out->tail) {
+        out->tail->next = chunk;
+    } else {
+        out->head = chunk;
+    }
+    out->tail = chunk;
+    out->chunk_count++;
+    return true;
+}
+
+static inline void transform_output_free(TransformOutput* out) {
+    TransformChunk* chunk = out->head;
+    while (chunk) {
+        TransformChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    memset(out, 0, sizeof(*out));
+}
+
+static inline void transform_append(TransformResult* result, const char* text, size_t len) {
+    TransformOutput* out = &result->output;
+    if (!transform_reserve(out, len)) return;
+    memcpy(out->tail->data + out->tail->len, text, len);
+    out->tail->len += len;
+    out->size += len;
+}
+
+#define TRANSFORM_APPEND_LITERAL(result, text) \
+    transform_append((result), (text), sizeof(text) - 1)
+
+/* printf straight into the last chunk; a line that does not fit starts a new one */
+static inline void transform_appendf(TransformResult* result, const char* fmt, ...) {
+    TransformOutput* out = &result->output;
+    if (out->failed) return;
+
+    va_list args;
+    va_start(args, fmt);
+    size_t room = out->tail ? out->tail->capacity - out->tail->len : 0;
+    int n = vsnprintf(room ? out->tail->data + out->tail->len : NULL, room, fmt, args);
+    va_end(args);
+    if (n < 0) return;
+
+    if ((size_t)n >= room) {
+        /* The NUL needs a byte too; it is overwritten by the next append */
+        if (!transform_reserve(out, (size_t)n + 1)) return;
+        va_start(args, fmt);
+        vsnprintf(out->tail->data + out->tail->len, (size_t)n + 1, fmt, args);
+        va_end(args);
+    }
+    out->tail->len += (size_t)n;
+    out->size += (size_t)n;
+}
+
+/* The chunks as segments for rift_write_segments_if_changed (caller frees) */
+static inline RiftEmitSegment* transform_output_segments(const TransformOutput* out) {
+    RiftEmitSegment* segments =
+        (RiftEmitSegment*)malloc(((size_t)out->chunk_count + 1) * sizeof(RiftEmitSegment));
+    if (!segments) return NULL;
+    int i = 0;
+    for (const TransformChunk* chunk = out->head; chunk; chunk = chunk->next) {
+        segments[i].data = chunk->data;
+        segments[i].len = chunk->len;
+        i++;
+    }
+    return segments;
+}
+
+/* One contiguous copy, for consumers that need the bytes together (caller frees) */
+static inline char* transform_output_join(const TransformOutput* out) {
+    char* joined = (char*)malloc(out->size + 1);
+    if (!joined) return NULL;
+    size_t offset = 0;
+    for (const TransformChunk* chunk = out->head; chunk; chunk = chunk->next) {
+        memcpy(joined + offset, chunk->data, chunk->len);
+        offset += chunk->len;
+    }
+    joined[offset] = '\0';
+    return joined;
+}
+
+/* One writev of every chunk, skipped if the file already holds them.
+ * 0 or an errno value; ENOMEM for output whose building failed. */
+static inline int transform_output_write(const char* filename, const TransformOutput* output) {
+    if (output->failed) return ENOMEM;
+    RiftEmitSegment* segments = transform_output_segments(output);
+    int error = segments
+        ? rift_write_segments_if_changed(filename, segments, output->chunk_count, false)
+        : ENOMEM;
+    free(segments);
+    return error;
+}
+
+#endif /* RIFT_TRANSFORM_OUTPUT_H */
@@ -8,6 +8,7 @@
  */
 
 #include "riftlang.h"
+#include "rift_automaton.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +16,14 @@
 #include <errno.h>
 #include <time.h>
 #include <math.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /* ============================================================================
  * Internal Utilities & Memory Management
@@ -91,6 +100,77 @@ static bool rift_regex_match_simple(regex_t* regex, const char* input) {
     return rift_regex_match(regex, input, NULL, 0);
 }
 
+/**
+ * Bitmask of capture references ($N or \N, N = 0-9) in a right template
+ */
+static uint32_t rift_template_refs(const char* template) {
+    uint32_t refs = 0;
+    for (const char* t = template; *t; t++) {
+        if ((*t == '$' || *t == '\\') && t[1] >= '0' && t[1] <= '9') {
+            refs |= 1u << (t[1] - '0');
+            t++;
+        }
+    }
+    return refs;
+}
+
+/**
+ * True if a right template has regex syntax (otherwise it is always literal)
+ */
+static bool rift_template_looks_like_regex(const char* template) {
+    return strpbrk(template, "([*+?|") != NULL;
+}
+
+/**
+ * Append piece to a bounded output buffer, tracking the untruncated length
+ */
+static void rift_template_put(char* out, size_t out_size, size_t* len,
+                              const char* piece, size_t piece_len) {
+    if (piece_len && *len + 1 < out_size) {
+        size_t room = out_size - 1 - *len;
+        memcpy(out + *len, piece, piece_len < room ? piece_len : room);
+    }
+    *len += piece_len;
+}
+
+/**
+ * Expand capture references in template against input.
+ * Writes at most out_size - 1 bytes plus a NUL (when out_size > 0) and
+ * returns the full expanded length. Unset groups expand to nothing.
+ */
+static size_t rift_template_expand(
+    const char* template,
+    const char* input,
+    const regmatch_t* captures,
+    char* out,
+    size_t out_size
+) {
+    size_t len = 0;
+    const char* t = template;
+    
+    while (*t) {
+        /* Literal run up to the next reference */
+        const char* run = t;
+        while (*t && !((*t == '$' || *t == '\\') && t[1] >= '0' && t[1] <= '9')) t++;
+        rift_template_put(out, out_size, &len, run, (size_t)(t - run));
+        if (!*t) break;
+        
+        /* Reference: $N or \N */
+        int group = t[1] - '0';
+        t += 2;
+        if (captures && captures[group].rm_so >= 0 &&
+            captures[group].rm_eo >= captures[group].rm_so) {
+            rift_template_put(out, out_size, &len, input + captures[group].rm_so,
+                              (size_t)(captures[group].rm_eo - captures[group].rm_so));
+        }
+    }
+    
+    if (out_size > 0) {
+        out[len < out_size ? len : out_size - 1] = '\0';
+    }
+    return len;
+}
+
 /* ============================================================================
  * Token Lifecycle Implementation
  * ============================================================================ */
@@ -414,6 +494,159 @@ RIFT_API uint32_t rift_span_get_default_alignment(RiftSpanType type, RiftExecuti
  * Polar Bipartite Pattern Matching Engine
  * ============================================================================ */
 
+/* Per-thread metric slots for sealed engines. Threads are spread across
+ * slots by a process-wide sequence number; slots are cache-line sized so
+ * concurrent matchers never write the same line. */
+#define RIFT_COUNTER_SLOTS      64
+#define RIFT_CACHE_LINE         64
+
+typedef struct {
+    _Atomic uint64_t matches;
+    _Atomic uint64_t failures;
+    _Atomic uint64_t elapsed_ns;
+    uint8_t pad[RIFT_CACHE_LINE - 3 * sizeof(uint64_t)];
+} RiftCounterSlot;
+
+struct RiftMatchCounters {
+    void* block;                    /* Raw allocation */
+    RiftCounterSlot* slots;         /* Cache-line aligned view into block */
+};
+
+static _Atomic uint32_t g_rift_thread_seq = 0;
+static _Thread_local uint32_t t_rift_counter_slot = UINT32_MAX;
+
+/**
+ * Counter slot for the calling thread
+ */
+static RiftCounterSlot* rift_counter_slot(RiftPatternEngine* engine) {
+    if (t_rift_counter_slot == UINT32_MAX) {
+        t_rift_counter_slot = atomic_fetch_add_explicit(&g_rift_thread_seq, 1,
+            memory_order_relaxed) % RIFT_COUNTER_SLOTS;
+    }
+    return &engine->counters->slots[t_rift_counter_slot];
+}
+
+/**
+ * Record one match attempt. Unsealed engines update the shared totals
+ * (caller holds the engine lock); sealed engines touch only the calling
+ * thread's slot.
+ */
+static void rift_pattern_engine_record(RiftPatternEngine* engine, bool matched, double elapsed_ms) {
+    if (engine->sealed) {
+        RiftCounterSlot* slot = rift_counter_slot(engine);
+        atomic_fetch_add_explicit(matched ? &slot->matches : &slot->failures, 1,
+            memory_order_relaxed);
+        atomic_fetch_add_explicit(&slot->elapsed_ns,
+            (uint64_t)(elapsed_ms * 1000000.0), memory_order_relaxed);
+        return;
+    }
+    
+    if (matched) {
+        engine->total_matches++;
+    } else {
+        engine->total_failures++;
+    }
+    /* Running average */
+    double total_time = engine->average_match_time_ms * (engine->total_matches + engine->total_failures - 1) + elapsed_ms;
+    engine->average_match_time_ms = total_time / (engine->total_matches + engine->total_failures);
+}
+
+/**
+ * Take the engine lock for a read path; sealed engines need none
+ */
+static bool rift_pattern_engine_read_lock(RiftPatternEngine* engine) {
+    if (engine->sealed || !engine->lock_ctx || !engine->lock_ctx->initialized) {
+        return false;
+    }
+    pthread_mutex_lock(&engine->lock_ctx->mutex);
+    return true;
+}
+
+static void rift_pattern_engine_read_unlock(RiftPatternEngine* engine, bool locked) {
+    if (locked) {
+        pthread_mutex_unlock(&engine->lock_ctx->mutex);
+    }
+}
+
+/* Rule image layout:
+ *
+ *   header (64 bytes) | pair entries | string pool | automaton tables
+ *
+ * Everything is host-endian; the byte-order marker rejects images built
+ * on a machine of the other endianness. The checksum covers every byte
+ * after the header.
+ */
+
+#define RIFT_IMAGE_MAGIC            "RIFTRIMG"
+#define RIFT_IMAGE_BYTE_ORDER       0x01020304u
+#define RIFT_IMAGE_HAS_AUTOMATON    0x01u       /* header flags */
+#define RIFT_IMAGE_RIGHT_LITERAL    0x01u       /* entry flags */
+
+/* Lazy left-regex state per pair */
+#define RIFT_IMAGE_REGEX_PENDING    0
+#define RIFT_IMAGE_REGEX_READY      1
+#define RIFT_IMAGE_REGEX_FAILED     2
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t mode;
+    uint32_t pair_count;
+    uint32_t flags;
+    uint32_t pairs_off;
+    uint32_t strings_off;
+    uint32_t strings_size;
+    uint32_t automaton_off;
+    uint32_t automaton_size;
+    uint32_t reserved;
+    uint64_t checksum;
+} RiftRuleImageHeader;
+
+typedef struct {
+    uint32_t priority;
+    uint32_t left_off;              /* Into the string pool */
+    uint32_t right_off;
+    uint32_t flags;
+} RiftRuleImageEntry;
+
+struct RiftRuleImage {
+    void* data;                     /* Mapped (or read) image bytes */
+    size_t size;
+    bool mapped;                    /* munmap vs free */
+    _Atomic uint8_t* regex_state;   /* Per pair: RIFT_IMAGE_REGEX_* */
+};
+
+static uint64_t rift_image_checksum(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash ^ (uint64_t)size;
+}
+
+static void rift_rule_image_release(struct RiftRuleImage* image) {
+    if (!image) return;
+#ifndef _WIN32
+    if (image->mapped) {
+        munmap(image->data, image->size);
+    } else
+#endif
+    {
+        rift_free(image->data);
+    }
+    rift_free((void*)image->regex_state);
+    rift_free(image);
+}
+
 RIFT_API RiftPatternEngine* rift_pattern_engine_create(RiftExecutionMode mode) {
     RiftPatternEngine* engine = (RiftPatternEngine*)rift_malloc(sizeof(RiftPatternEngine));
     if (!engine) return NULL;
@@ -427,6 +660,10 @@ RIFT_API RiftPatternEngine* rift_pattern_engine_create(RiftExecutionMode mode) {
     engine->compiled_cache = NULL;
     engine->cache_patterns = NULL;
     engine->cache_size = 0;
+    engine->automaton = NULL;
+    engine->sealed = false;
+    engine->counters = NULL;
+    engine->image = NULL;
     
     /* Set mode */
     engine->mode = mode;
@@ -461,14 +698,18 @@ RIFT_API void rift_pattern_engine_destroy(RiftPatternEngine* engine) {
         if (pair) {
             /* Clean up left pattern */
             if (pair->left) {
-                regfree(&pair->left->compiled_regex);
+                /* Image engines compile left regexes on demand */
+                if (!engine->image || (engine->image->regex_state &&
+                    engine->image->regex_state[i] == RIFT_IMAGE_REGEX_READY)) {
+                    regfree(&pair->left->compiled_regex);
+                }
                 rift_free(pair->left->pattern_str);
                 rift_free(pair->left);
             }
             
             /* Clean up right pattern */
             if (pair->right) {
-                if (!pair->right->is_literal) {
+                if (!pair->right->is_literal && !engine->image) {
                     regfree(&pair->right->compiled_regex);
                 }
                 rift_free(pair->right->pattern_str);
@@ -493,6 +734,12 @@ RIFT_API void rift_pattern_engine_destroy(RiftPatternEngine* engine) {
     }
     rift_free(engine->compiled_cache);
     rift_free(engine->cache_patterns);
+    rift_automaton_free(engine->automaton);
+    if (engine->counters) {
+        rift_free(engine->counters->block);
+        rift_free(engine->counters);
+    }
+    rift_rule_image_release(engine->image);
     
     /* Unlock and clean up lock context */
     if (engine->lock_ctx && engine->lock_ctx->initialized) {
@@ -518,6 +765,14 @@ RIFT_API bool rift_pattern_engine_add_pair(
         pthread_mutex_lock(&engine->lock_ctx->mutex);
     }
     
+    /* Sealed pair table is immutable */
+    if (engine->sealed) {
+        if (engine->lock_ctx && engine->lock_ctx->initialized) {
+            pthread_mutex_unlock(&engine->lock_ctx->mutex);
+        }
+        return false;
+    }
+    
     /* Expand capacity if needed */
     if (engine->pair_count >= engine->capacity) {
         uint32_t new_capacity = engine->capacity == 0 ? 16 : engine->capacity * 2;
@@ -578,13 +833,12 @@ RIFT_API bool rift_pattern_engine_add_pair(
     right->priority = priority;
     right->anchored = false;
     right->is_literal = right_is_literal;
+    right->capture_refs = rift_template_refs(right_pattern);
     
     /* Compile right regex only if it's not a literal */
     if (!right_is_literal) {
         /* Check if it looks like a regex */
-        if (strchr(right_pattern, '(') || strchr(right_pattern, '[') || 
-            strchr(right_pattern, '*') || strchr(right_pattern, '+') ||
-            strchr(right_pattern, '?') || strchr(right_pattern, '|')) {
+        if (rift_template_looks_like_regex(right_pattern)) {
             if (!rift_regex_compile(&right->compiled_regex, right_pattern, false, true)) {
                 /* Compilation failed, but we can still use as literal */
                 right->is_literal = true;
@@ -623,6 +877,10 @@ RIFT_API bool rift_pattern_engine_add_pair(
     
     engine->pairs[engine->pair_count++] = pair;
     
+    /* Automaton no longer covers every pair; matching falls back until recompiled */
+    rift_automaton_free(engine->automaton);
+    engine->automaton = NULL;
+    
     if (engine->lock_ctx && engine->lock_ctx->initialized) {
         pthread_mutex_unlock(&engine->lock_ctx->mutex);
     }
@@ -630,16 +888,68 @@ RIFT_API bool rift_pattern_engine_add_pair(
     return true;
 }
 
+RIFT_API bool rift_pattern_right_is_literal(const char* right_pattern, bool right_is_literal) {
+    if (!right_pattern || right_is_literal || !rift_template_looks_like_regex(right_pattern)) {
+        return true;
+    }
+    regex_t regex;
+    if (!rift_regex_compile(&regex, right_pattern, false, true)) {
+        return true;
+    }
+    regfree(&regex);
+    return false;
+}
+
+/**
+ * Build the multi-pattern automaton over all left patterns.
+ * Caller holds the engine lock. Leaves engine->automaton NULL when the
+ * DFA cannot be built, in which case matching runs regexec() per pair.
+ */
+static void rift_pattern_engine_build_automaton(RiftPatternEngine* engine) {
+    rift_automaton_free(engine->automaton);
+    engine->automaton = NULL;
+    
+#ifdef RIFT_USE_SIMPLE_MATCH
+    /* Substring stub semantics: patterns are not regular expressions */
+    return;
+#else
+    /* Byte-class DFA mirrors regcomp() only in single-byte locales */
+    if (MB_CUR_MAX != 1 || engine->pair_count == 0) return;
+    
+    RiftAutomatonInput* inputs = (RiftAutomatonInput*)rift_malloc(
+        engine->pair_count * sizeof(RiftAutomatonInput));
+    if (!inputs) return;
+    
+    for (uint32_t i = 0; i < engine->pair_count; i++) {
+        RiftPattern* left = engine->pairs[i]->left;
+        inputs[i].pattern = left->pattern_str;
+        inputs[i].priority = left->priority;
+        inputs[i].newline_sensitive = left->anchored;   /* REG_NEWLINE, see rift_regex_compile */
+    }
+    engine->automaton = rift_automaton_build(inputs, engine->pair_count,
+                                             RIFT_AUTOMATON_MAX_STATES);
+    rift_free(inputs);
+#endif
+}
+
 RIFT_API bool rift_pattern_engine_compile(RiftPatternEngine* engine) {
     if (!engine) return false;
     
-    /* All patterns already compiled during add_pair */
-    /* This function validates the engine state */
+    /* Left regexes are compiled during add_pair; this validates the
+     * engine state and folds every left pattern into one automaton */
     
     if (engine->lock_ctx && engine->lock_ctx->initialized) {
         pthread_mutex_lock(&engine->lock_ctx->mutex);
     }
     
+    /* Sealed engines were compiled before freezing */
+    if (engine->sealed) {
+        if (engine->lock_ctx && engine->lock_ctx->initialized) {
+            pthread_mutex_unlock(&engine->lock_ctx->mutex);
+        }
+        return true;
+    }
+    
     /* Validate all pairs have compiled left patterns */
     for (uint32_t i = 0; i < engine->pair_count; i++) {
         RiftBipartitePair* pair = engine->pairs[i];
@@ -658,6 +968,8 @@ RIFT_API bool rift_pattern_engine_compile(RiftPatternEngine* engine) {
         }
     }
     
+    rift_pattern_engine_build_automaton(engine);
+    
     if (engine->lock_ctx && engine->lock_ctx->initialized) {
         pthread_mutex_unlock(&engine->lock_ctx->mutex);
     }
@@ -665,90 +977,556 @@ RIFT_API bool rift_pattern_engine_compile(RiftPatternEngine* engine) {
     return true;
 }
 
-RIFT_API char* rift_pattern_engine_match(
-    RiftPatternEngine* engine,
-    const char* input,
-    size_t* output_len,
-    uint32_t* matched_priority
-) {
-    if (!engine || !input || !output_len) {
-        if (output_len) *output_len = 0;
-        return NULL;
+RIFT_API bool rift_pattern_engine_seal(RiftPatternEngine* engine) {
+    if (!engine) return false;
+    
+    if (engine->lock_ctx && engine->lock_ctx->initialized) {
+        pthread_mutex_lock(&engine->lock_ctx->mutex);
     }
     
-    double start_time = rift_get_time_ms();
+    bool ok = true;
+    if (!engine->sealed) {
+        struct RiftMatchCounters* counters = (struct RiftMatchCounters*)rift_malloc(
+            sizeof(struct RiftMatchCounters));
+        void* block = rift_malloc((RIFT_COUNTER_SLOTS + 1) * sizeof(RiftCounterSlot));
+        if (!counters || !block) {
+            rift_free(counters);
+            rift_free(block);
+            ok = false;
+        } else {
+            uintptr_t aligned = ((uintptr_t)block + RIFT_CACHE_LINE - 1) &
+                                ~(uintptr_t)(RIFT_CACHE_LINE - 1);
+            counters->block = block;
+            counters->slots = (RiftCounterSlot*)aligned;
+            engine->counters = counters;
+            
+            /* Sealing implies a compiled matcher */
+            if (!engine->automaton) {
+                rift_pattern_engine_build_automaton(engine);
+            }
+            engine->sealed = true;
+        }
+    }
     
-    /* Lock engine for thread-safe matching */
     if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_lock(&engine->lock_ctx->mutex);
+        pthread_mutex_unlock(&engine->lock_ctx->mutex);
     }
     
-    /* Search for matching pattern (respecting priority) */
-    RiftBipartitePair* matched_pair = NULL;
-    uint32_t best_priority = UINT32_MAX;
-    regmatch_t matches[10]; /* Capture groups */
+    return ok;
+}
+
+RIFT_API bool rift_pattern_engine_is_sealed(const RiftPatternEngine* engine) {
+    return engine && engine->sealed;
+}
+
+/* ============================================================================
+ * Rule Images
+ * ============================================================================ */
+
+/**
+ * Map the whole file read-only; falls back to reading it into memory
+ * where mmap is unavailable or fails.
+ */
+static bool rift_rule_image_open(struct RiftRuleImage* image, const char* path) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    image->size = (size_t)st.st_size;
+    void* map = mmap(NULL, image->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map != MAP_FAILED) {
+        image->data = map;
+        image->mapped = true;
+        return true;
+    }
+#endif
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length <= 0) {
+        fclose(file);
+        return false;
+    }
+    image->size = (size_t)length;
+    image->data = malloc(image->size);
+    bool ok = image->data && fread(image->data, 1, image->size, file) == image->size;
+    fclose(file);
+    return ok;
+}
+
+/**
+ * Structural checks on the container; the automaton validates its own tables
+ */
+static bool rift_rule_image_validate(const uint8_t* data, size_t size) {
+    RiftRuleImageHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    
+    if (memcmp(header.magic, RIFT_IMAGE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RIFT_RULE_IMAGE_VERSION ||
+        header.byte_order != RIFT_IMAGE_BYTE_ORDER ||
+        header.header_size != sizeof(header) ||
+        header.mode > RIFT_MODE_HYBRID) {
+        return false;
+    }
     
+    uint64_t pairs_end = (uint64_t)header.pairs_off +
+                         (uint64_t)header.pair_count * sizeof(RiftRuleImageEntry);
+    uint64_t strings_end = (uint64_t)header.strings_off + header.strings_size;
+    uint64_t automaton_end = (uint64_t)header.automaton_off + header.automaton_size;
+    if (header.pairs_off != sizeof(header) || pairs_end > header.strings_off ||
+        strings_end > header.automaton_off || automaton_end != size ||
+        (header.automaton_off & 3) || header.strings_size == 0 ||
+        data[header.strings_off + header.strings_size - 1] != '\0') {
+        return false;
+    }
+    if (!(header.flags & RIFT_IMAGE_HAS_AUTOMATON) && header.automaton_size != 0) {
+        return false;
+    }
+    
+    if (rift_image_checksum(data + sizeof(header), size - sizeof(header)) != header.checksum) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < header.pair_count; i++) {
+        RiftRuleImageEntry entry;
+        memcpy(&entry, data + header.pairs_off + (size_t)i * sizeof(entry), sizeof(entry));
+        if (entry.left_off >= header.strings_size || entry.right_off >= header.strings_size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RIFT_API bool rift_pattern_engine_save_image(RiftPatternEngine* engine, const char* path) {
+    if (!engine || !path) return false;
+    
+    if (engine->lock_ctx && engine->lock_ctx->initialized) {
+        pthread_mutex_lock(&engine->lock_ctx->mutex);
+    }
+    
+    /* Layout: header | entries | strings (padded to 4) | automaton */
+    size_t strings_size = 0;
     for (uint32_t i = 0; i < engine->pair_count; i++) {
-        RiftBipartitePair* pair = engine->pairs[i];
-        if (!pair || !pair->left) continue;
+        strings_size += strlen(engine->pairs[i]->left->pattern_str) + 1;
+        strings_size += strlen(engine->pairs[i]->right->pattern_str) + 1;
+    }
+    if (strings_size == 0) strings_size = 1;
+    
+    size_t pairs_off = sizeof(RiftRuleImageHeader);
+    size_t strings_off = pairs_off + (size_t)engine->pair_count * sizeof(RiftRuleImageEntry);
+    size_t automaton_off = (strings_off + strings_size + 3) & ~(size_t)3;
+    size_t automaton_size = rift_automaton_serialize(engine->automaton, NULL, 0);
+    size_t total = automaton_off + automaton_size;
+    
+    bool ok = false;
+    uint8_t* buffer = (total <= UINT32_MAX) ? (uint8_t*)rift_malloc(total) : NULL;
+    if (buffer) {
+        RiftRuleImageHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RIFT_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = RIFT_RULE_IMAGE_VERSION;
+        header.byte_order = RIFT_IMAGE_BYTE_ORDER;
+        header.header_size = sizeof(header);
+        header.mode = (uint32_t)engine->mode;
+        header.pair_count = engine->pair_count;
+        header.flags = engine->automaton ? RIFT_IMAGE_HAS_AUTOMATON : 0;
+        header.pairs_off = (uint32_t)pairs_off;
+        header.strings_off = (uint32_t)strings_off;
+        header.strings_size = (uint32_t)strings_size;
+        header.automaton_off = (uint32_t)automaton_off;
+        header.automaton_size = (uint32_t)automaton_size;
+        
+        size_t pos = 0;
+        char* strings = (char*)buffer + strings_off;
+        for (uint32_t i = 0; i < engine->pair_count; i++) {
+            RiftBipartitePair* pair = engine->pairs[i];
+            RiftRuleImageEntry entry;
+            entry.priority = pair->left->priority;
+            entry.left_off = (uint32_t)pos;
+            size_t len = strlen(pair->left->pattern_str) + 1;
+            memcpy(strings + pos, pair->left->pattern_str, len);
+            pos += len;
+            entry.right_off = (uint32_t)pos;
+            len = strlen(pair->right->pattern_str) + 1;
+            memcpy(strings + pos, pair->right->pattern_str, len);
+            pos += len;
+            entry.flags = pair->right->is_literal ? RIFT_IMAGE_RIGHT_LITERAL : 0;
+            memcpy(buffer + pairs_off + (size_t)i * sizeof(entry), &entry, sizeof(entry));
+        }
+        rift_automaton_serialize(engine->automaton, buffer + automaton_off, automaton_size);
         
-        /* Check priority - lower number = higher priority */
-        if (pair->left->priority > best_priority) continue;
+        header.checksum = rift_image_checksum(buffer + sizeof(header), total - sizeof(header));
+        memcpy(buffer, &header, sizeof(header));
         
-        /* Try to match input against left pattern */
-        if (rift_regex_match(&pair->left->compiled_regex, input, matches, 10)) {
-            matched_pair = pair;
-            best_priority = pair->left->priority;
-            if (matched_priority) {
-                *matched_priority = best_priority;
+        /* Write beside the target and rename so readers never map a partial image */
+        size_t path_len = strlen(path);
+        char* tmp_path = (char*)rift_malloc(path_len + 5);
+        if (tmp_path) {
+            memcpy(tmp_path, path, path_len);
+            memcpy(tmp_path + path_len, ".tmp", 5);
+            FILE* file = fopen(tmp_path, "wb");
+            if (file) {
+                ok = fwrite(buffer, 1, total, file) == total;
+                ok = (fclose(file) == 0) && ok;
+#ifdef _WIN32
+                if (ok) remove(path);
+#endif
+                ok = ok && rename(tmp_path, path) == 0;
+                if (!ok) remove(tmp_path);
             }
-            /* Continue searching for higher priority match */
+            rift_free(tmp_path);
         }
+        rift_free(buffer);
     }
     
-    /* Generate output from right pattern */
-    char* output = NULL;
-    if (matched_pair && matched_pair->right) {
-        const char* template = matched_pair->right->pattern_str;
-        size_t template_len = strlen(template);
+    if (engine->lock_ctx && engine->lock_ctx->initialized) {
+        pthread_mutex_unlock(&engine->lock_ctx->mutex);
+    }
+    
+    return ok;
+}
+
+RIFT_API RiftPatternEngine* rift_pattern_engine_load_image(const char* path) {
+    if (!path) return NULL;
+    
+    struct RiftRuleImage* image = (struct RiftRuleImage*)rift_malloc(sizeof(struct RiftRuleImage));
+    if (!image) return NULL;
+    if (!rift_rule_image_open(image, path) ||
+        !rift_rule_image_validate((const uint8_t*)image->data, image->size)) {
+        rift_rule_image_release(image);
+        return NULL;
+    }
+    
+    const uint8_t* data = (const uint8_t*)image->data;
+    RiftRuleImageHeader header;
+    memcpy(&header, data, sizeof(header));
+    
+    RiftPatternEngine* engine = rift_pattern_engine_create((RiftExecutionMode)header.mode);
+    if (!engine || !engine->lock_ctx) {
+        rift_pattern_engine_destroy(engine);
+        rift_rule_image_release(image);
+        return NULL;
+    }
+    engine->image = image;
+    
+    uint32_t count = header.pair_count;
+    image->regex_state = (_Atomic uint8_t*)rift_malloc(count ? count : 1);
+    engine->pairs = (RiftBipartitePair**)rift_malloc((count ? count : 1) * sizeof(RiftBipartitePair*));
+    if (!image->regex_state || !engine->pairs) {
+        rift_pattern_engine_destroy(engine);
+        return NULL;
+    }
+    engine->capacity = count;
+    
+    /* Pairs as add_pair would build them, minus regcomp(): left regexes
+     * compile lazily, right templates are only ever expanded textually */
+    const char* strings = (const char*)data + header.strings_off;
+    for (uint32_t i = 0; i < count; i++) {
+        RiftRuleImageEntry entry;
+        memcpy(&entry, data + header.pairs_off + (size_t)i * sizeof(entry), sizeof(entry));
         
-        /* Simple substitution: copy template as-is for literals */
-        /* In production: support $1, $2 capture group substitution */
-        if (matched_pair->right->is_literal) {
-            output = (char*)rift_malloc(template_len + 1);
-            if (output) {
-                strcpy(output, template);
-                *output_len = template_len;
-            }
+        RiftBipartitePair* pair = (RiftBipartitePair*)rift_malloc(sizeof(RiftBipartitePair));
+        RiftPattern* left = (RiftPattern*)rift_malloc(sizeof(RiftPattern));
+        RiftPattern* right = (RiftPattern*)rift_malloc(sizeof(RiftPattern));
+        if (pair) {
+            pair->left = left;
+            pair->right = right;
+            pair->transform_id = i + 1;
+            engine->pairs[engine->pair_count++] = pair;
         } else {
-            /* For regex patterns, we might need to process matches */
-            /* Simplified: just copy for now */
-            output = (char*)rift_malloc(template_len + 1);
-            if (output) {
-                strcpy(output, template);
-                *output_len = template_len;
+            rift_free(left);
+            rift_free(right);
+        }
+        if (!pair || !left || !right) {
+            rift_pattern_engine_destroy(engine);
+            return NULL;
+        }
+        
+        left->pattern_str = strdup(strings + entry.left_off);
+        left->polarity = RIFT_PATTERN_LEFT;
+        left->priority = entry.priority;
+        left->anchored = (left->pattern_str && left->pattern_str[0] == '^');
+        
+        right->pattern_str = strdup(strings + entry.right_off);
+        right->polarity = RIFT_PATTERN_RIGHT;
+        right->priority = entry.priority;
+        right->is_literal = (entry.flags & RIFT_IMAGE_RIGHT_LITERAL) != 0;
+        if (!left->pattern_str || !right->pattern_str) {
+            rift_pattern_engine_destroy(engine);
+            return NULL;
+        }
+        right->capture_refs = rift_template_refs(right->pattern_str);
+    }
+    
+#ifndef RIFT_USE_SIMPLE_MATCH
+    /* The DFA was built for a single-byte locale; otherwise regexec() decides */
+    if ((header.flags & RIFT_IMAGE_HAS_AUTOMATON) && MB_CUR_MAX == 1) {
+        engine->automaton = rift_automaton_from_image(data + header.automaton_off,
+                                                      header.automaton_size, count);
+        if (!engine->automaton) {
+            rift_pattern_engine_destroy(engine);
+            return NULL;
+        }
+    }
+#endif
+    
+    if (!rift_pattern_engine_seal(engine)) {
+        rift_pattern_engine_destroy(engine);
+        return NULL;
+    }
+    return engine;
+}
+
+/**
+ * Left regex of pair `index`, compiling it on first use for image-loaded
+ * engines. Returns NULL if the pattern does not compile.
+ */
+static regex_t* rift_pattern_left_regex(RiftPatternEngine* engine, uint32_t index) {
+    RiftPattern* left = engine->pairs[index]->left;
+    struct RiftRuleImage* image = engine->image;
+    if (!image) return &left->compiled_regex;
+    
+    uint8_t state = atomic_load_explicit(&image->regex_state[index], memory_order_acquire);
+    if (state == RIFT_IMAGE_REGEX_PENDING) {
+        pthread_mutex_lock(&engine->lock_ctx->mutex);
+        state = atomic_load_explicit(&image->regex_state[index], memory_order_relaxed);
+        if (state == RIFT_IMAGE_REGEX_PENDING) {
+            state = rift_regex_compile(&left->compiled_regex, left->pattern_str, left->anchored, true)
+                  ? RIFT_IMAGE_REGEX_READY : RIFT_IMAGE_REGEX_FAILED;
+            atomic_store_explicit(&image->regex_state[index], state, memory_order_release);
+        }
+        pthread_mutex_unlock(&engine->lock_ctx->mutex);
+    }
+    return (state == RIFT_IMAGE_REGEX_READY) ? &left->compiled_regex : NULL;
+}
+
+/**
+ * True if pair index `a` beats pair index `b` (UINT32_MAX = none):
+ * lower priority number wins, later pair wins ties.
+ */
+static bool rift_pair_beats(RiftPatternEngine* engine, uint32_t a, uint32_t b) {
+    if (b == UINT32_MAX) return true;
+    uint32_t pa = engine->pairs[a]->left->priority;
+    uint32_t pb = engine->pairs[b]->left->priority;
+    return pa < pb || (pa == pb && a > b);
+}
+
+/**
+ * Capture offsets of an already-selected pair (one regexec)
+ */
+static void rift_pattern_capture(
+    RiftPatternEngine* engine,
+    uint32_t index,
+    const char* input,
+    regmatch_t* captures,
+    size_t max_captures
+) {
+    if (!rift_regex_match(rift_pattern_left_regex(engine, index), input, captures, max_captures)) {
+        for (size_t k = 0; k < max_captures; k++) {
+            captures[k].rm_so = captures[k].rm_eo = -1;
+        }
+    }
+}
+
+/**
+ * Select the best-priority pair for input. Caller holds the read lock.
+ * Returns the pair index or UINT32_MAX. Captures, when requested, come
+ * from a single regexec() of the winning pair.
+ */
+static uint32_t rift_pattern_engine_select(
+    RiftPatternEngine* engine,
+    const char* input,
+    regmatch_t* captures,
+    size_t max_captures
+) {
+    uint32_t best = UINT32_MAX;
+    
+    if (engine->automaton) {
+        /* One DFA pass decides every covered pair ... */
+        best = rift_automaton_best(engine->automaton, input);
+        if (best == RIFT_AUTOMATON_NO_MATCH) best = UINT32_MAX;
+        
+        /* ... pairs outside the DFA subset are tried only if they could win */
+        uint32_t fallback_count = 0;
+        const uint32_t* fallbacks = rift_automaton_fallbacks(engine->automaton, &fallback_count);
+        for (uint32_t k = 0; k < fallback_count; k++) {
+            uint32_t i = fallbacks[k];
+            if (rift_pair_beats(engine, i, best) &&
+                rift_regex_match_simple(rift_pattern_left_regex(engine, i), input)) {
+                best = i;
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < engine->pair_count; i++) {
+            RiftBipartitePair* pair = engine->pairs[i];
+            if (!pair || !pair->left) continue;
+            
+            /* Check priority - lower number = higher priority */
+            if (!rift_pair_beats(engine, i, best)) continue;
+            
+            if (rift_regex_match_simple(rift_pattern_left_regex(engine, i), input)) {
+                best = i;
             }
         }
     }
     
-    /* Update metrics */
-    double elapsed = rift_get_time_ms() - start_time;
+    if (best != UINT32_MAX && captures && max_captures > 0) {
+        rift_pattern_capture(engine, best, input, captures, max_captures);
+    }
+    return best;
+}
+
+RIFT_API RiftBipartitePair* rift_pattern_engine_find(
+    RiftPatternEngine* engine,
+    const char* input,
+    regmatch_t* captures,
+    size_t max_captures
+) {
+    if (!engine || !input) return NULL;
+    
+    bool locked = rift_pattern_engine_read_lock(engine);
+    
+    uint32_t best = rift_pattern_engine_select(engine, input, captures, max_captures);
+    RiftBipartitePair* pair = (best == UINT32_MAX) ? NULL : engine->pairs[best];
+    
+    rift_pattern_engine_read_unlock(engine, locked);
+    
+    return pair;
+}
+
+/**
+ * Shared match path: select the best pair, capture groups only when its
+ * template references them, and record metrics. Returns NULL on no match.
+ */
+static RiftBipartitePair* rift_pattern_engine_match_pair(
+    RiftPatternEngine* engine,
+    const char* input,
+    regmatch_t* captures,           /* RIFT_MAX_CAPTURES entries */
+    uint32_t* matched_priority
+) {
+    double start_time = rift_get_time_ms();
+    
+    /* Lock engine for thread-safe matching (no-op once sealed) */
+    bool locked = rift_pattern_engine_read_lock(engine);
+    
+    /* Search for matching pattern (respecting priority) */
+    uint32_t best = rift_pattern_engine_select(engine, input, NULL, 0);
+    RiftBipartitePair* matched_pair = (best == UINT32_MAX) ? NULL : engine->pairs[best];
     if (matched_pair) {
-        engine->total_matches++;
-    } else {
-        engine->total_failures++;
+        if (matched_priority) {
+            *matched_priority = matched_pair->left->priority;
+        }
+        if (matched_pair->right && matched_pair->right->capture_refs) {
+            rift_pattern_capture(engine, best, input, captures, RIFT_MAX_CAPTURES);
+        }
     }
-    /* Running average */
-    double total_time = engine->average_match_time_ms * (engine->total_matches + engine->total_failures - 1) + elapsed;
-    engine->average_match_time_ms = total_time / (engine->total_matches + engine->total_failures);
     
-    if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_unlock(&engine->lock_ctx->mutex);
+    /* Update metrics */
+    rift_pattern_engine_record(engine, matched_pair != NULL, rift_get_time_ms() - start_time);
+    
+    rift_pattern_engine_read_unlock(engine, locked);
+    
+    /* Pairs are never removed before destroy: safe to use unlocked */
+    return (matched_pair && matched_pair->right) ? matched_pair : NULL;
+}
+
+RIFT_API char* rift_pattern_engine_match(
+    RiftPatternEngine* engine,
+    const char* input,
+    size_t* output_len,
+    uint32_t* matched_priority
+) {
+    if (!engine || !input || !output_len) {
+        if (output_len) *output_len = 0;
+        return NULL;
+    }
+    
+    regmatch_t captures[RIFT_MAX_CAPTURES];
+    RiftBipartitePair* pair = rift_pattern_engine_match_pair(engine, input, captures, matched_priority);
+    if (!pair) return NULL;
+    
+    /* Generate output from right pattern with $N substitution */
+    const char* template = pair->right->pattern_str;
+    size_t len = rift_template_expand(template, input, captures, NULL, 0);
+    char* output = (char*)rift_malloc(len + 1);
+    if (output) {
+        rift_template_expand(template, input, captures, output, len + 1);
+        *output_len = len;
     }
     
     return output;
 }
 
+RIFT_API bool rift_pattern_engine_match_into(
+    RiftPatternEngine* engine,
+    const char* input,
+    char* buffer,
+    size_t buffer_size,
+    size_t* output_len,
+    uint32_t* matched_priority
+) {
+    if (output_len) *output_len = 0;
+    if (!engine || !input) return false;
+    
+    regmatch_t captures[RIFT_MAX_CAPTURES];
+    RiftBipartitePair* pair = rift_pattern_engine_match_pair(engine, input, captures, matched_priority);
+    if (!pair) return false;
+    
+    size_t len = rift_template_expand(pair->right->pattern_str, input, captures,
+                                      buffer, buffer ? buffer_size : 0);
+    if (output_len) *output_len = len;
+    return true;
+}
+
+/* Per-thread expansion buffer for rift_pattern_engine_match_scratch */
+static _Thread_local char* t_rift_scratch = NULL;
+static _Thread_local size_t t_rift_scratch_size = 0;
+
+RIFT_API const char* rift_pattern_engine_match_scratch(
+    RiftPatternEngine* engine,
+    const char* input,
+    size_t* output_len,
+    uint32_t* matched_priority
+) {
+    if (output_len) *output_len = 0;
+    if (!engine || !input) return NULL;
+    
+    regmatch_t captures[RIFT_MAX_CAPTURES];
+    RiftBipartitePair* pair = rift_pattern_engine_match_pair(engine, input, captures, matched_priority);
+    if (!pair) return NULL;
+    
+    const char* template = pair->right->pattern_str;
+    size_t len = rift_template_expand(template, input, captures,
+                                      t_rift_scratch, t_rift_scratch_size);
+    if (len + 1 > t_rift_scratch_size) {
+        /* Grow geometrically; later lines reuse the buffer */
+        size_t new_size = t_rift_scratch_size ? t_rift_scratch_size : 256;
+        while (new_size < len + 1) new_size *= 2;
+        char* grown = (char*)realloc(t_rift_scratch, new_size);
+        if (!grown) return NULL;
+        t_rift_scratch = grown;
+        t_rift_scratch_size = new_size;
+        rift_template_expand(template, input, captures, t_rift_scratch, t_rift_scratch_size);
+    }
+    
+    if (output_len) *output_len = len;
+    return t_rift_scratch;
+}
+
+RIFT_API void rift_pattern_engine_release_scratch(void) {
+    free(t_rift_scratch);
+    t_rift_scratch = NULL;
+    t_rift_scratch_size = 0;
+}
+
 RIFT_API bool rift_pattern_engine_match_all(
     RiftPatternEngine* engine,
     const char* input,
@@ -757,8 +1535,17 @@ RIFT_API bool rift_pattern_engine_match_all(
 ) {
     if (!engine || !input || !match_count) return false;
     
-    if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_lock(&engine->lock_ctx->mutex);
+    bool locked = rift_pattern_engine_read_lock(engine);
+    
+    /* One automaton pass marks every matching pair */
+    uint64_t stack_bits[4] = {0};
+    uint64_t* bits = NULL;
+    size_t words = ((size_t)engine->pair_count + 63) / 64;
+    if (engine->automaton) {
+        bits = (words <= 4) ? stack_bits : (uint64_t*)rift_malloc(words * sizeof(uint64_t));
+        if (bits) {
+            rift_automaton_collect(engine->automaton, input, bits);
+        }
     }
     
     uint32_t count = 0;
@@ -766,7 +1553,13 @@ RIFT_API bool rift_pattern_engine_match_all(
         RiftBipartitePair* pair = engine->pairs[i];
         if (!pair || !pair->left) continue;
         
-        if (rift_regex_match_simple(&pair->left->compiled_regex, input)) {
+        bool matched;
+        if (bits && rift_automaton_covers(engine->automaton, i)) {
+            matched = (bits[i >> 6] >> (i & 63)) & 1;
+        } else {
+            matched = rift_regex_match_simple(rift_pattern_left_regex(engine, i), input);
+        }
+        if (matched) {
             if (matches) {
                 matches[count] = pair;
             }
@@ -776,9 +1569,9 @@ RIFT_API bool rift_pattern_engine_match_all(
     
     *match_count = count;
     
-    if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_unlock(&engine->lock_ctx->mutex);
-    }
+    if (bits != stack_bits) rift_free(bits);
+    
+    rift_pattern_engine_read_unlock(engine, locked);
     
     return true;
 }
@@ -791,17 +1584,29 @@ RIFT_API void rift_pattern_engine_get_metrics(
 ) {
     if (!engine) return;
     
-    if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_lock(&engine->lock_ctx->mutex);
-    }
+    bool locked = rift_pattern_engine_read_lock(engine);
     
-    if (total_matches) *total_matches = engine->total_matches;
-    if (total_failures) *total_failures = engine->total_failures;
-    if (avg_time_ms) *avg_time_ms = engine->average_match_time_ms;
+    uint64_t matches = engine->total_matches;
+    uint64_t failures = engine->total_failures;
+    double avg = engine->average_match_time_ms;
     
-    if (engine->lock_ctx && engine->lock_ctx->initialized) {
-        pthread_mutex_unlock(&engine->lock_ctx->mutex);
+    /* Sealed: merge per-thread slots on top of the pre-seal totals */
+    if (engine->sealed) {
+        double total_ms = avg * (double)(matches + failures);
+        for (uint32_t i = 0; i < RIFT_COUNTER_SLOTS; i++) {
+            RiftCounterSlot* slot = &engine->counters->slots[i];
+            matches += atomic_load_explicit(&slot->matches, memory_order_relaxed);
+            failures += atomic_load_explicit(&slot->failures, memory_order_relaxed);
+            total_ms += (double)atomic_load_explicit(&slot->elapsed_ns, memory_order_relaxed) / 1000000.0;
+        }
+        avg = (matches + failures) ? total_ms / (double)(matches + failures) : 0.0;
     }
+    
+    if (total_matches) *total_matches = matches;
+    if (total_failures) *total_failures = failures;
+    if (avg_time_ms) *avg_time_ms = avg;
+    
+    rift_pattern_engine_read_unlock(engine, locked);
 }
 
 /* ============================================================================
@@ -1209,6 +2014,285 @@ RIFT_API void rift_ast_print(RiftAstNode* root, int indent) {
     }
 }
 
+/* ============================================================================
+ * Source Files
+ * ============================================================================ */
+
+/**
+ * Read a stream to EOF into a NUL-terminated heap block; size_hint sizes the first try
+ */
+static bool rift_source_file_read(RiftSourceFile* file, FILE* stream, size_t size_hint) {
+    size_t capacity = (size_hint ? size_hint : 64 * 1024) + 1;
+    size_t size = 0;
+    char* buffer = (char*)malloc(capacity);
+    if (!buffer) return false;
+    
+    for (;;) {
+        if (size + 1 == capacity) {
+            char* grown = (char*)realloc(buffer, capacity * 2);
+            if (!grown) {
+                free(buffer);
+                return false;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        size_t n = fread(buffer + size, 1, capacity - 1 - size, stream);
+        size += n;
+        if (n == 0) break;
+    }
+    if (ferror(stream)) {
+        free(buffer);
+        return false;
+    }
+    buffer[size] = '\0';
+    
+    file->data = buffer;
+    file->size = size;
+    file->base = buffer;
+    file->mapped_size = 0;
+    return true;
+}
+
+#ifndef _WIN32
+/**
+ * Map the file into an anonymous reservation one page longer than needed:
+ * the byte after the contents is zero-fill, so no copy is needed to
+ * NUL-terminate it.
+ */
+static bool rift_source_file_map(RiftSourceFile* file, int fd, size_t size) {
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) return false;
+    size_t reserve = (size / (size_t)page + 1) * (size_t)page;
+    
+    void* base = mmap(NULL, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return false;
+    if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, reserve);
+        return false;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+    
+    file->data = (const char*)base;
+    file->size = size;
+    file->base = base;
+    file->mapped_size = reserve;
+    return true;
+}
+#endif
+
+RIFT_API bool rift_source_file_open(RiftSourceFile* file, const char* path) {
+    if (!file || !path) return false;
+    memset(file, 0, sizeof(*file));
+    
+    bool is_stdin = strcmp(path, "-") == 0;
+    size_t size_hint = 0;
+    
+#ifndef _WIN32
+    if (!is_stdin) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        bool mapped = false;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+            (uint64_t)st.st_size < (uint64_t)SIZE_MAX) {
+            size_hint = (size_t)st.st_size;
+            mapped = rift_source_file_map(file, fd, size_hint);
+        }
+        close(fd);
+        if (mapped) return true;
+    }
+#endif
+    
+    /* Pipes, empty or special files, and platforms without mmap */
+    FILE* stream = is_stdin ? stdin : fopen(path, "rb");
+    if (!stream) return false;
+    bool ok = rift_source_file_read(file, stream, size_hint);
+    int saved = errno;
+    if (!is_stdin) fclose(stream);
+    errno = saved;
+    return ok;
+}
+
+RIFT_API void rift_source_file_close(RiftSourceFile* file) {
+    if (!file) return;
+#ifndef _WIN32
+    if (file->mapped_size) {
+        munmap(file->base, file->mapped_size);
+    } else
+#endif
+    {
+        free(file->base);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+/* ============================================================================
+ * String Set
+ * ============================================================================ */
+
+/**
+ * FNV-1a, never 0 (0 marks an empty slot)
+ */
+RIFT_API uint32_t rift_string_hash(const char* s, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+/**
+ * Slot holding the key, or the empty slot where it would go
+ */
+static RiftStringSlot* rift_string_set_probe(const RiftStringSet* set, const char* s,
+                                             size_t len, uint32_t hash) {
+    uint32_t mask = set->capacity - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        RiftStringSlot* slot = &set->slots[i];
+        if (slot->hash == 0) return slot;
+        if (slot->hash == hash && slot->len == len &&
+            memcmp(set->arena + slot->off, s, len) == 0) {
+            return slot;
+        }
+    }
+}
+
+static bool rift_string_set_grow(RiftStringSet* set) {
+    uint32_t capacity = set->capacity ? set->capacity * 2 : 64;
+    if (capacity < set->capacity) return false;
+    RiftStringSlot* slots = (RiftStringSlot*)calloc(capacity, sizeof(RiftStringSlot));
+    if (!slots) return false;
+    
+    /* Rehash from the stored hashes; keys are never compared here */
+    for (uint32_t i = 0; i < set->capacity; i++) {
+        RiftStringSlot* old = &set->slots[i];
+        if (old->hash == 0) continue;
+        uint32_t j = old->hash & (capacity - 1);
+        while (slots[j].hash != 0) j = (j + 1) & (capacity - 1);
+        slots[j] = *old;
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->capacity = capacity;
+    return true;
+}
+
+RIFT_API int rift_string_set_insert(RiftStringSet* set, const char* s, size_t len) {
+    if (!set || (!s && len) || len > UINT32_MAX) return -1;
+    
+    /* Keep the load factor under 3/4 */
+    if ((uint64_t)(set->count + 1) * 4 > (uint64_t)set->capacity * 3 &&
+        !rift_string_set_grow(set)) {
+        return -1;
+    }
+    
+    uint32_t hash = rift_string_hash(s, len);
+    RiftStringSlot* slot = rift_string_set_probe(set, s, len, hash);
+    if (slot->hash != 0) return 0;
+    
+    if (set->arena_size > UINT32_MAX - len) return -1;
+    if (set->arena_size + len > set->arena_capacity || !set->arena) {
+        size_t capacity = set->arena_capacity ? set->arena_capacity : 1024;
+        while (capacity < set->arena_size + len) capacity *= 2;
+        char* arena = (char*)realloc(set->arena, capacity);
+        if (!arena) return -1;
+        set->arena = arena;
+        set->arena_capacity = capacity;
+    }
+    if (len) memcpy(set->arena + set->arena_size, s, len);
+    
+    slot->hash = hash;
+    slot->len = (uint32_t)len;
+    slot->off = (uint32_t)set->arena_size;
+    set->arena_size += len;
+    set->count++;
+    return 1;
+}
+
+RIFT_API bool rift_string_set_contains(const RiftStringSet* set, const char* s, size_t len) {
+    if (!set || set->count == 0 || (!s && len)) return false;
+    return rift_string_set_probe(set, s, len, rift_string_hash(s, len))->hash != 0;
+}
+
+RIFT_API void rift_string_set_free(RiftStringSet* set) {
+    if (!set) return;
+    free(set->slots);
+    free(set->arena);
+    memset(set, 0, sizeof(*set));
+}
+
+/* ============================================================================
+ * Source Line Index
+ * ============================================================================ */
+
+RIFT_API bool riftlang_line_index_build(RiftLineIndex* index, const char* source, size_t length) {
+    if (!index || !source) return false;
+    memset(index, 0, sizeof(*index));
+    if (length > UINT32_MAX) return false;
+
+    /* Guess ~32 bytes per line; grows if the guess is short */
+    size_t capacity = length / 32 + 1;
+    uint32_t* starts = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    if (!starts) return false;
+
+    /* memchr is vectorized by libc; a trailing '\n' opens no new line */
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < length) {
+        if (count == capacity) {
+            uint32_t* grown = (uint32_t*)realloc(starts, capacity * 2 * sizeof(uint32_t));
+            if (!grown) {
+                free(starts);
+                return false;
+            }
+            starts = grown;
+            capacity *= 2;
+        }
+        starts[count++] = (uint32_t)pos;
+        const char* nl = (const char*)memchr(source + pos, '\n', length - pos);
+        if (!nl) break;
+        pos = (size_t)(nl - source) + 1;
+    }
+
+    index->source = source;
+    index->length = length;
+    index->starts = starts;
+    index->count = (uint32_t)count;
+    return true;
+}
+
+RIFT_API void riftlang_line_index_free(RiftLineIndex* index) {
+    if (!index) return;
+    free(index->starts);
+    memset(index, 0, sizeof(*index));
+}
+
+RIFT_API uint32_t riftlang_line_index_line_of(const RiftLineIndex* index, size_t offset) {
+    if (!index || index->count == 0) return 1;
+
+    /* Last line start <= offset */
+    uint32_t lo = 0, hi = index->count;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->starts[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+    return lo + 1;
+}
+
+RIFT_API const char* riftlang_line_index_get(const RiftLineIndex* index, uint32_t line, size_t* length) {
+    if (!index || line == 0 || line > index->count) return NULL;
+
+    size_t start = index->starts[line - 1];
+    size_t end = (line < index->count) ? index->starts[line] - 1 : index->length;
+    /* The last line may still end in '\n' */
+    if (line == index->count && end > start && index->source[end - 1] == '\n') end--;
+    if (length) *length = end - start;
+    return index->source + start;
+}
+
 /* ============================================================================
  * Serialization Implementation (Stubs - Full implementation in Phase 2)
  * ============================================================================ */
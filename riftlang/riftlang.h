@@ -94,6 +94,31 @@ extern "C" {
     static inline pthread_t pthread_self(void) {
         return GetCurrentThread();
     }
+    /* Worker threads (parallel codec emit): start routine via a trampoline */
+    typedef struct { void* (*fn)(void*); void* arg; } RiftThreadStart;
+    static inline DWORD WINAPI rift_thread_trampoline(LPVOID param) {
+        RiftThreadStart start = *(RiftThreadStart*)param;
+        free(param);
+        start.fn(start.arg);
+        return 0;
+    }
+    static inline int  pthread_create(pthread_t* thread, void* attr,
+                                      void* (*fn)(void*), void* arg) {
+        (void)attr;
+        RiftThreadStart* start = (RiftThreadStart*)malloc(sizeof(RiftThreadStart));
+        if (!start) return -1;
+        start->fn  = fn;
+        start->arg = arg;
+        *thread = CreateThread(NULL, 0, rift_thread_trampoline, start, 0, NULL);
+        if (!*thread) { free(start); return -1; }
+        return 0;
+    }
+    static inline int  pthread_join(pthread_t thread, void** result) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+        if (result) *result = NULL;
+        return 0;
+    }
 #else
     #include <regex.h>
     #include <pthread.h>
@@ -134,6 +159,8 @@ extern "C" {
 #define RIFT_TOKEN_BITFIELD_SIZE    32      /* Validation bits per token */
 #define RIFT_DEFAULT_THRESHOLD      0.85    /* 85% policy validation threshold */
 #define RIFT_DEFAULT_ENTROPY        0.25    /* Quantum entropy threshold */
+#define RIFT_MAX_CAPTURES           10      /* $0 (whole match) .. $9 */
+#define RIFT_RULE_IMAGE_VERSION     1       /* Rule image format revision */
 
 /* Validation bit flags for token->validation_bits */
 #define RIFT_TOKEN_ALLOCATED        0x01    /* Memory allocated */
@@ -312,6 +339,7 @@ typedef struct {
     uint32_t priority;          /* Match priority (lower = higher) */
     bool anchored;              /* ^...$ anchored matching */
     bool is_literal;            /* True if pattern is literal string, not regex */
+    uint32_t capture_refs;      /* RIGHT: bitmask of $N / \N references (N = 0-9) */
 } RiftPattern;
 
 /**
@@ -340,13 +368,24 @@ typedef struct {
     char** cache_patterns;          /* Original patterns for cache */
     uint32_t cache_size;            /* Cache entry count */
     
+    /* Multi-pattern DFA over all left patterns (built by compile) */
+    struct RiftAutomaton* automaton;
+    
     /* Execution context */
     RiftExecutionMode mode;           /* Current execution mode */
     
     /* Thread safety */
     RiftLockContext* lock_ctx;      /* Engine-level locking */
     
-    /* Metrics */
+    /* Frozen state: once sealed the pair table is immutable and the
+     * read paths (match, match_all, find, get_metrics) take no locks */
+    bool sealed;
+    struct RiftMatchCounters* counters; /* Per-thread metric slots (sealed only) */
+    
+    /* Backing rule image when loaded with rift_pattern_engine_load_image */
+    struct RiftRuleImage* image;
+    
+    /* Metrics (totals up to sealing; use get_metrics for live values) */
     uint64_t total_matches;
     uint64_t total_failures;
     double average_match_time_ms;
@@ -517,6 +556,72 @@ typedef struct {
     uint32_t version;           /* Schema version */
 } RiftSerialOptions;
 
+/* ============================================================================
+ * Source Files
+ * ============================================================================ */
+
+/**
+ * Source File
+ * Read-only contents of an input file. Regular files are mmap'd with
+ * MADV_SEQUENTIAL instead of copied; pipes, "-" (stdin) and files mmap
+ * refuses are read into the heap. data[size] is always '\0'.
+ */
+typedef struct {
+    const char* data;
+    size_t size;                /* 64-bit clean; no ftell */
+    void* base;                 /* mapping or heap block */
+    size_t mapped_size;         /* bytes to munmap; 0 for a heap block */
+} RiftSourceFile;
+
+/* ============================================================================
+ * String Set
+ * ============================================================================ */
+
+/**
+ * String Set
+ * Open-addressing hash set of byte strings, looked up by (pointer, length)
+ * slice so callers need not NUL-terminate or copy. Inserted keys are
+ * copied into the set's own arena. A zeroed struct is an empty set.
+ */
+typedef struct {
+    uint32_t hash;              /* 0 marks an empty slot */
+    uint32_t len;
+    uint32_t off;               /* key bytes in the arena */
+} RiftStringSlot;
+
+typedef struct {
+    RiftStringSlot* slots;
+    uint32_t capacity;          /* power of two */
+    uint32_t count;
+    char* arena;
+    size_t arena_size;
+    size_t arena_capacity;
+} RiftStringSet;
+
+/* ============================================================================
+ * Source Line Index
+ * ============================================================================ */
+
+/**
+ * Source Line Index
+ * Byte offset of every line start, built in one memchr pass and shared by
+ * the transform, binding and link stages. Stages keep byte offsets and
+ * resolve a line number by binary search only when one is reported.
+ * The index does not own the source.
+ *
+ * A line is the bytes up to and including a '\n', or the bytes after the
+ * last '\n'. A trailing '\n' ends the last line and opens no new one, so
+ * "" has no lines, "a\n" and "a" have one, and "a\n\n" has two. '\r' is
+ * ordinary text: CRLF lines keep their '\r'. librift's rift_line_index_t
+ * follows the same rule.
+ */
+typedef struct {
+    const char* source;
+    size_t length;
+    uint32_t* starts;           /* starts[i] = offset of line i + 1 */
+    uint32_t count;             /* lines holding at least one byte */
+} RiftLineIndex;
+
 /* ============================================================================
  * API Function Declarations
  * ============================================================================ */
@@ -596,15 +701,46 @@ RIFT_API void RIFT_CALL rift_pattern_engine_destroy(
 RIFT_API bool RIFT_CALL rift_pattern_engine_add_pair(
     RiftPatternEngine* engine, 
     const char* left_pattern,       /* POSIX regex for input matching */
-    const char* right_pattern,      /* Output template or regex */
+    const char* right_pattern,      /* Output template ($N / \N expand captures) */
     uint32_t priority,              /* Lower = higher priority */
     bool right_is_literal           /* true if right is literal string */
 );
 
+/* The is_literal flag add_pair stores for a right template: literal when
+ * requested, when the template has no regex syntax, or when it fails to
+ * compile. Lets callers compare loaded pairs against their rule tables. */
+RIFT_API bool RIFT_CALL rift_pattern_right_is_literal(
+    const char* right_pattern,
+    bool right_is_literal
+);
+
 RIFT_API bool RIFT_CALL rift_pattern_engine_compile(
     RiftPatternEngine* engine
 );
 
+/* Freeze after compile: add_pair fails, read paths become lock-free.
+ * Seal before sharing the engine with other threads. */
+RIFT_API bool RIFT_CALL rift_pattern_engine_seal(
+    RiftPatternEngine* engine
+);
+
+RIFT_API bool RIFT_CALL rift_pattern_engine_is_sealed(
+    const RiftPatternEngine* engine
+);
+
+/* Rule images: a sealed engine's pair table and automaton in one
+ * versioned file. Loading maps the file and starts matching without
+ * regcomp() or DFA construction; left regexes used for captures and
+ * non-automaton pairs are compiled on first use. */
+RIFT_API bool RIFT_CALL rift_pattern_engine_save_image(
+    RiftPatternEngine* engine,      /* Compiled engine */
+    const char* path                /* Written via path.tmp + rename */
+);
+
+RIFT_API RiftPatternEngine* RIFT_CALL rift_pattern_engine_load_image(
+    const char* path                /* Image from rift_pattern_engine_save_image */
+);
+
 RIFT_API char* RIFT_CALL rift_pattern_engine_match(
     RiftPatternEngine* engine, 
     const char* input,
@@ -612,6 +748,36 @@ RIFT_API char* RIFT_CALL rift_pattern_engine_match(
     uint32_t* matched_priority      /* OUT: priority of matched pattern */
 );
 
+/* Expand the matched template into buffer (snprintf-style: truncated to
+ * buffer_size, *output_len is always the full length). NULL/0 = size query. */
+RIFT_API bool RIFT_CALL rift_pattern_engine_match_into(
+    RiftPatternEngine* engine,
+    const char* input,
+    char* buffer,                   /* OUT: expanded template, NUL-terminated */
+    size_t buffer_size,             /* Capacity of buffer including NUL */
+    size_t* output_len,             /* OUT: full expanded length */
+    uint32_t* matched_priority      /* OUT: priority of matched pattern */
+);
+
+/* Expand into a per-thread scratch buffer, valid until the calling
+ * thread's next match_scratch call. Returns NULL when nothing matched. */
+RIFT_API const char* RIFT_CALL rift_pattern_engine_match_scratch(
+    RiftPatternEngine* engine,
+    const char* input,
+    size_t* output_len,
+    uint32_t* matched_priority      /* OUT: priority of matched pattern */
+);
+
+/* Free the calling thread's scratch buffer (call before thread exit) */
+RIFT_API void RIFT_CALL rift_pattern_engine_release_scratch(void);
+
+RIFT_API RiftBipartitePair* RIFT_CALL rift_pattern_engine_find(
+    RiftPatternEngine* engine,
+    const char* input,
+    regmatch_t* captures,           /* OUT: capture offsets of best pair (may be NULL) */
+    size_t max_captures             /* Capacity of captures */
+);
+
 RIFT_API bool RIFT_CALL rift_pattern_engine_match_all(
     RiftPatternEngine* engine,
     const char* input,
@@ -836,6 +1002,73 @@ RIFT_API bool RIFT_CALL rift_context_is_valid_switch(
     RiftExecutionMode target_mode
 );
 
+/* ---------------------------------------------------------------------------
+ * Source Files
+ * --------------------------------------------------------------------------- */
+
+RIFT_API bool RIFT_CALL rift_source_file_open(
+    RiftSourceFile* file,
+    const char* path                /* "-" reads standard input */
+);
+
+RIFT_API void RIFT_CALL rift_source_file_close(
+    RiftSourceFile* file
+);
+
+/* ---------------------------------------------------------------------------
+ * String Set
+ * --------------------------------------------------------------------------- */
+
+RIFT_API uint32_t RIFT_CALL rift_string_hash(
+    const char* s,
+    size_t len
+);
+
+/* 1 if added, 0 if already present, -1 on allocation failure */
+RIFT_API int RIFT_CALL rift_string_set_insert(
+    RiftStringSet* set,
+    const char* s,
+    size_t len
+);
+
+RIFT_API bool RIFT_CALL rift_string_set_contains(
+    const RiftStringSet* set,
+    const char* s,
+    size_t len
+);
+
+RIFT_API void RIFT_CALL rift_string_set_free(
+    RiftStringSet* set
+);
+
+/* ---------------------------------------------------------------------------
+ * Source Line Index
+ *
+ * riftlang_ prefix: librift exports its own rift_line_index_* with a
+ * different layout, and a program may link both libraries.
+ * --------------------------------------------------------------------------- */
+
+RIFT_API bool RIFT_CALL riftlang_line_index_build(
+    RiftLineIndex* index,
+    const char* source,
+    size_t length                   /* sources over 4 GiB are rejected */
+);
+
+RIFT_API void RIFT_CALL riftlang_line_index_free(
+    RiftLineIndex* index
+);
+
+RIFT_API uint32_t RIFT_CALL riftlang_line_index_line_of(
+    const RiftLineIndex* index,
+    size_t offset                   /* 1-based line holding this byte */
+);
+
+RIFT_API const char* RIFT_CALL riftlang_line_index_get(
+    const RiftLineIndex* index,
+    uint32_t line,                  /* 1-based; NULL past the last line */
+    size_t* length                  /* OUT: bytes before the '\n' */
+);
+
 /* ---------------------------------------------------------------------------
  * Utility & Diagnostics
  * --------------------------------------------------------------------------- */
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "riftlang.h"
+#include "rift_automaton.h"
+#include "rift_rules.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+enum { CAPTURES = 10 };
+
+/* Anchors, alternation, classes, overlapping literal prefixes and ties */
+static RiftTransformRule g_edge_rules[] = {
+    { "abc",        "abc",              "abc",     50, true, RIFT_MODE_CLASSICAL },
+    { "abcd",       "abcd",             "abcd",    40, true, RIFT_MODE_CLASSICAL },
+    { "ab_class",   "ab[cd]+e",         "ab[cd]e", 30, true, RIFT_MODE_CLASSICAL },
+    { "anchored",   "^ab",              "^ab",     60, true, RIFT_MODE_CLASSICAL },
+    { "end",        "cd$",              "cd$",     45, true, RIFT_MODE_CLASSICAL },
+    { "whole",      "^(abc|xyz)$",      "whole",   20, true, RIFT_MODE_CLASSICAL },
+    { "alt",        "(foo|fo+|f)bar",   "\\1",     35, true, RIFT_MODE_CLASSICAL },
+    { "tie_a",      "tie[0-9]",         "tie_a",   70, true, RIFT_MODE_CLASSICAL },
+    { "tie_b",      "tie[[:digit:]]+",  "tie_b",   70, true, RIFT_MODE_CLASSICAL },
+    { "negated",    "^[^a-z ]+$",       "neg",     80, true, RIFT_MODE_CLASSICAL },
+    { "repeat",     "x{2,3}y",          "rep",     25, true, RIFT_MODE_CLASSICAL },
+    { "optional",   "colou?r",          "col",     90, true, RIFT_MODE_CLASSICAL },
+    { NULL, NULL, NULL, 0, false, RIFT_MODE_CLASSICAL }
+};
+
+static const struct {
+    const char* name;
+    RiftTransformRule* rules;
+} k_rule_sets[] = {
+    { "c",    g_transform_rules },
+    { "js",   g_js_rules },
+    { "py",   g_py_rules },
+    { "go",   g_go_rules },
+    { "lua",  g_lua_rules },
+    { "wat",  g_wat_rules },
+    { "edge", g_edge_rules },
+};
+
+/* Every rule set runs over every line */
+static const char* const k_corpus[] = {
+    /* RIFT source as the targets see it */
+    "!govern classical",
+    "  !govern quantum",
+    "!govern",
+    "align span<fixed> {",
+    "align span<row> {",
+    "  bytes: 64",
+    "  type: continuous",
+    "type: x",
+    "type Q = {",
+    "  type   Pair_2 = { a: INT }",
+    "  a: INT",
+    "  name: STRING",
+    "x := 1",
+    "counter := counter + 1;",
+    "  y:=x*2",
+    "policy_fn on access {",
+    "  default_access: deny",
+    "  reassert_lock: true",
+    "validate(x > 0)",
+    "validate()",
+    "while (x < 3) {",
+    "while(x){",
+    "if (x) {",
+    "if x {",
+    "for (i := 0; i < 3; i := i + 1) {",
+    "{",
+    "   }",
+    "// comment with := inside",
+    "/* open",
+    "close */",
+    "/* one line */",
+    "x := 1 // trailing",
+    /* Edge rules */
+    "abc", "abcd", "abcde", "abdce", "ab", "xabc", "xyz", "abcxyz",
+    "foobar", "fooobar", "fbar", "bar", "abcd$",
+    "tie1", "tie12", "tie", "TIE1",
+    "ABC-123", "ABC 123", "xxy", "xxxxy", "xy",
+    "color", "colour", "colouur",
+    /* Anchored patterns see later lines of a multi-line input */
+    "x := 1\n}",
+    "text\n!govern classical",
+    "abc\nxyz",
+    "zz\ncd",
+    /* No match anywhere */
+    "",
+    " ",
+    "\t\t",
+    "plain words only",
+    "12345",
+    "@@@",
+};
+
+static RiftPatternEngine* build_engine(RiftTransformRule* rules, bool automaton) {
+    RiftPatternEngine* engine = rift_pattern_engine_create(RIFT_MODE_HYBRID);
+    assert(engine != NULL);
+    for (int i = 0; rules[i].name != NULL; i++) {
+        assert(rift_pattern_engine_add_pair(engine, rules[i].left_pattern,
+            rules[i].right_template, rules[i].priority, rules[i].right_is_literal));
+    }
+    if (automaton) {
+        assert(rift_pattern_engine_compile(engine));
+        assert(rift_pattern_engine_seal(engine));
+        assert(engine->automaton != NULL);
+    } else {
+        /* Never compiled: every lookup is a per-pair regexec() */
+        assert(engine->automaton == NULL);
+    }
+    return engine;
+}
+
+static uint32_t pair_index(RiftPatternEngine* engine, RiftBipartitePair* pair) {
+    for (uint32_t i = 0; i < engine->pair_count; i++) {
+        if (engine->pairs[i] == pair) return i;
+    }
+    return UINT32_MAX;
+}
+
+/* The regex path's winner, recomputed here from regexec() alone */
+static uint32_t reference_best(RiftTransformRule* rules, const char* line) {
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = 0; rules[i].name != NULL; i++) {
+        regex_t re;
+        int flags = REG_EXTENDED | (rules[i].left_pattern[0] == '^' ? REG_NEWLINE : 0);
+        assert(regcomp(&re, rules[i].left_pattern, flags) == 0);
+        bool matched = regexec(&re, line, 0, NULL, 0) == 0;
+        regfree(&re);
+        if (matched && (best == UINT32_MAX || rules[i].priority <= rules[best].priority)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void check_line(RiftPatternEngine* dfa, RiftPatternEngine* re,
+                       RiftTransformRule* rules, const char* line) {
+    regmatch_t dfa_caps[CAPTURES];
+    regmatch_t re_caps[CAPTURES];
+    uint32_t d = pair_index(dfa, rift_pattern_engine_find(dfa, line, dfa_caps, CAPTURES));
+    uint32_t r = pair_index(re, rift_pattern_engine_find(re, line, re_caps, CAPTURES));
+    if (d != r || r != reference_best(rules, line)) {
+        fprintf(stderr, "\n    line \"%s\": dfa %d, regex %d\n", line, (int)d, (int)r);
+        assert(0);
+    }
+    if (r == UINT32_MAX) {
+        assert(rift_pattern_engine_match_scratch(dfa, line, NULL, NULL) == NULL);
+        return;
+    }
+    assert(dfa->pairs[d]->left->priority == re->pairs[r]->left->priority);
+    for (int k = 0; k < CAPTURES; k++) {
+        assert(dfa_caps[k].rm_so == re_caps[k].rm_so);
+        assert(dfa_caps[k].rm_eo == re_caps[k].rm_eo);
+    }
+
+    /* Expanded templates agree too */
+    uint32_t dfa_priority = 0, re_priority = 0;
+    size_t dfa_len = 0, re_len = 0;
+    char* dfa_out = rift_pattern_engine_match(dfa, line, &dfa_len, &dfa_priority);
+    char* re_out = rift_pattern_engine_match(re, line, &re_len, &re_priority);
+    assert(dfa_out != NULL && re_out != NULL);
+    assert(dfa_priority == re_priority && dfa_priority == rules[r].priority);
+    assert(dfa_len == re_len && memcmp(dfa_out, re_out, re_len) == 0);
+    free(dfa_out);
+    free(re_out);
+}
+
+/* Best pair, its priority and its captures: DFA path == regexec path */
+TEST(test_rule_sets_select_like_regex) {
+    for (size_t s = 0; s < sizeof(k_rule_sets) / sizeof(k_rule_sets[0]); s++) {
+        RiftTransformRule* rules = k_rule_sets[s].rules;
+        RiftPatternEngine* dfa = build_engine(rules, true);
+        RiftPatternEngine* re = build_engine(rules, false);
+        for (size_t i = 0; i < sizeof(k_corpus) / sizeof(k_corpus[0]); i++) {
+            check_line(dfa, re, rules, k_corpus[i]);
+        }
+        rift_pattern_engine_destroy(dfa);
+        rift_pattern_engine_destroy(re);
+    }
+    rift_pattern_engine_release_scratch();
+}
+
+/* The DFA decides the built-in rules itself rather than falling back
+ * (the edge set keeps ^(abc|xyz)$, which the DFA leaves to regexec) */
+TEST(test_rule_sets_covered) {
+    for (size_t s = 0; k_rule_sets[s].rules != g_edge_rules; s++) {
+        RiftPatternEngine* dfa = build_engine(k_rule_sets[s].rules, true);
+        uint32_t fallback_count = 0;
+        rift_automaton_fallbacks(dfa->automaton, &fallback_count);
+        if (fallback_count != 0) {
+            fprintf(stderr, "\n    %s: %u rules outside the DFA\n",
+                k_rule_sets[s].name, fallback_count);
+            assert(0);
+        }
+        rift_pattern_engine_destroy(dfa);
+    }
+}
+
+/* Every matching pair, not just the best: collect() == regexec() */
+TEST(test_rule_sets_match_all_like_regex) {
+    for (size_t s = 0; s < sizeof(k_rule_sets) / sizeof(k_rule_sets[0]); s++) {
+        RiftTransformRule* rules = k_rule_sets[s].rules;
+        RiftPatternEngine* dfa = build_engine(rules, true);
+        RiftPatternEngine* re = build_engine(rules, false);
+        for (size_t i = 0; i < sizeof(k_corpus) / sizeof(k_corpus[0]); i++) {
+            RiftBipartitePair* dfa_pairs[64];
+            RiftBipartitePair* re_pairs[64];
+            uint32_t dfa_count = 64, re_count = 64;
+            assert(rift_pattern_engine_match_all(dfa, k_corpus[i], dfa_pairs, &dfa_count));
+            assert(rift_pattern_engine_match_all(re, k_corpus[i], re_pairs, &re_count));
+            assert(dfa_count == re_count);
+            for (uint32_t k = 0; k < dfa_count; k++) {
+                assert(pair_index(dfa, dfa_pairs[k]) == pair_index(re, re_pairs[k]));
+            }
+        }
+        rift_pattern_engine_destroy(dfa);
+        rift_pattern_engine_destroy(re);
+    }
+}
+
+int main(void) {
+    printf("test_automaton:\n");
+    RUN(test_rule_sets_covered);
+    RUN(test_rule_sets_select_like_regex);
+    RUN(test_rule_sets_match_all_like_regex);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "rift_cache.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static const char k_source[] =
+    "align span<fixed> {\n"
+    "  bytes: 64\n"
+    "}\n"
+    "x := 1\n"
+    "y := x + 2\n";
+
+/* A fresh, empty directory for one test */
+static void temp_dir(char dir[64]) {
+    strcpy(dir, "/tmp/riftlang-test-XXXXXX");
+    assert(mkdtemp(dir) != NULL);
+}
+
+/* Entries in dir; with remove_all, delete them and dir as well */
+static int dir_entries(const char* dir, int remove_all) {
+    DIR* handle = opendir(dir);
+    assert(handle != NULL);
+    int count = 0;
+    struct dirent* de;
+    while ((de = readdir(handle)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) continue;
+        if (remove_all) {
+            char path[RIFT_CIR_CACHE_MAX_PATH];
+            snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+            unlink(path);
+        }
+        count++;
+    }
+    closedir(handle);
+    if (remove_all) rmdir(dir);
+    return count;
+}
+
+static int programs_equal(const RiftCIRProgram* a, const RiftCIRProgram* b) {
+    if (a->count != b->count || a->mode != b->mode) return 0;
+    for (uint32_t i = 0; i < a->count; i++) {
+        const RiftCIRNode* x = &a->nodes[i];
+        const RiftCIRNode* y = &b->nodes[i];
+        if (x->kind != y->kind || x->is_first_use != y->is_first_use ||
+            x->source_offset != y->source_offset || x->span_bytes != y->span_bytes ||
+            strcmp(rift_cir_str(a, x->var_name), rift_cir_str(b, y->var_name)) != 0 ||
+            strcmp(rift_cir_str(a, x->expr), rift_cir_str(b, y->expr)) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+TEST(test_cir_cache_miss_then_hit) {
+    char dir[64];
+    temp_dir(dir);
+    RiftCIRCache cache;
+    assert(rift_cir_cache_open(&cache, dir, 0));
+
+    RiftLineIndex lines;
+    assert(riftlang_line_index_build(&lines, k_source, sizeof(k_source) - 1));
+    bool hit = true;
+    RiftCIRProgram* linked = rift_cir_cache_link(&cache, &lines, RIFT_MODE_CLASSICAL, &hit);
+    assert(linked != NULL && linked->consensus_ok && !hit);
+    assert(dir_entries(dir, 0) == 1);
+
+    RiftCIRProgram* cached = rift_cir_cache_link(&cache, &lines, RIFT_MODE_CLASSICAL, &hit);
+    assert(cached != NULL && cached->consensus_ok && hit);
+    assert(cached->image != NULL);
+    assert(programs_equal(linked, cached));
+    rift_cir_program_free(cached);
+
+    /* Another mode is another key */
+    assert(rift_cir_cache_load(&cache, &lines, RIFT_MODE_QUANTUM) == NULL);
+
+    rift_cir_program_free(linked);
+    riftlang_line_index_free(&lines);
+    dir_entries(dir, 1);
+}
+
+TEST(test_cir_cache_source_change_misses) {
+    char dir[64];
+    temp_dir(dir);
+    RiftCIRCache cache;
+    assert(rift_cir_cache_open(&cache, dir, 0));
+
+    RiftLineIndex lines;
+    assert(riftlang_line_index_build(&lines, k_source, sizeof(k_source) - 1));
+    RiftCIRProgram* prog = rift_cir_cache_link(&cache, &lines, RIFT_MODE_CLASSICAL, NULL);
+    assert(prog != NULL);
+    rift_cir_program_free(prog);
+    riftlang_line_index_free(&lines);
+
+    char edited[sizeof(k_source)];
+    memcpy(edited, k_source, sizeof(k_source));
+    edited[sizeof(k_source) - 3] = '3';     /* y := x + 3 */
+    assert(riftlang_line_index_build(&lines, edited, sizeof(edited) - 1));
+    bool hit = true;
+    prog = rift_cir_cache_link(&cache, &lines, RIFT_MODE_CLASSICAL, &hit);
+    assert(prog != NULL && !hit);
+    rift_cir_program_free(prog);
+    riftlang_line_index_free(&lines);
+    dir_entries(dir, 1);
+}
+
+typedef struct {
+    const RiftCIRCache* cache;
+    const RiftLineIndex* lines;
+    const RiftCIRProgram* prog;
+    int failures;
+} StoreJob;
+
+static void* store_repeatedly(void* arg) {
+    StoreJob* job = (StoreJob*)arg;
+    for (int i = 0; i < 50; i++) {
+        if (!rift_cir_cache_store(job->cache, job->lines, RIFT_MODE_CLASSICAL, job->prog)) {
+            job->failures++;
+        }
+    }
+    return NULL;
+}
+
+/* Threads of one process storing one key must not share a temporary */
+TEST(test_cir_cache_concurrent_store) {
+    char dir[64];
+    temp_dir(dir);
+    RiftCIRCache cache;
+    assert(rift_cir_cache_open(&cache, dir, 0));
+
+    RiftLineIndex lines;
+    assert(riftlang_line_index_build(&lines, k_source, sizeof(k_source) - 1));
+    RiftCIRProgram* prog = rift_link_lines(&lines, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+
+    enum { THREADS = 4 };
+    pthread_t threads[THREADS];
+    StoreJob jobs[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        jobs[t] = (StoreJob){ &cache, &lines, prog, 0 };
+        assert(pthread_create(&threads[t], NULL, store_repeatedly, &jobs[t]) == 0);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        assert(jobs[t].failures == 0);
+    }
+
+    /* One entry, no stray temporaries, and it loads */
+    assert(dir_entries(dir, 0) == 1);
+    RiftCIRProgram* cached = rift_cir_cache_load(&cache, &lines, RIFT_MODE_CLASSICAL);
+    assert(cached != NULL && programs_equal(prog, cached));
+    rift_cir_program_free(cached);
+
+    rift_cir_program_free(prog);
+    riftlang_line_index_free(&lines);
+    dir_entries(dir, 1);
+}
+
+static void read_file(const char* path, char* buf, size_t size) {
+    FILE* f = fopen(path, "rb");
+    assert(f != NULL);
+    size_t n = fread(buf, 1, size - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+}
+
+/* Backdate path so a rewrite would be visible in its mtime */
+static void set_old_mtime(const char* path) {
+    struct timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+    assert(utimensat(AT_FDCWD, path, times, 0) == 0);
+}
+
+TEST(test_write_if_changed_keeps_mtime) {
+    char dir[64], path[128], buf[64];
+    temp_dir(dir);
+    snprintf(path, sizeof(path), "%s/out.c", dir);
+    struct stat st;
+
+    assert(rift_write_if_changed(path, "int x;\n", 7, false) == 0);
+    set_old_mtime(path);
+    assert(rift_write_if_changed(path, "int x;\n", 7, false) == 0);
+    assert(stat(path, &st) == 0 && st.st_mtim.tv_sec == 1000000000);
+
+    /* Same length, different bytes: rewritten */
+    assert(rift_write_if_changed(path, "int y;\n", 7, false) == 0);
+    assert(stat(path, &st) == 0 && st.st_mtim.tv_sec != 1000000000);
+    read_file(path, buf, sizeof(buf));
+    assert(strcmp(buf, "int y;\n") == 0);
+
+    /* Segments are compared as the bytes they join to */
+    RiftEmitSegment parts[2] = { { "int ", 4 }, { "y;\n", 3 } };
+    set_old_mtime(path);
+    assert(rift_write_segments_if_changed(path, parts, 2, false) == 0);
+    assert(stat(path, &st) == 0 && st.st_mtim.tv_sec == 1000000000);
+
+    dir_entries(dir, 1);
+}
+
+TEST(test_write_if_changed_executable) {
+    char dir[64], path[128];
+    temp_dir(dir);
+    snprintf(path, sizeof(path), "%s/prog", dir);
+    struct stat st;
+
+    assert(rift_write_if_changed(path, "\x7f" "ELF", 4, true) == 0);
+    assert(stat(path, &st) == 0 && (st.st_mode & 0100));
+    set_old_mtime(path);
+    assert(rift_write_if_changed(path, "\x7f" "ELF", 4, true) == 0);
+    assert(stat(path, &st) == 0 && st.st_mtim.tv_sec == 1000000000);
+
+    /* Replaced by rename: no temporary is left beside it */
+    assert(rift_write_if_changed(path, "\x7f" "ELF2", 5, true) == 0);
+    assert(stat(path, &st) == 0 && st.st_size == 5);
+    assert(dir_entries(dir, 0) == 1);
+    dir_entries(dir, 1);
+}
+
+TEST(test_build_cache_fetch) {
+    char dir[64], artifact[128], dest[128], buf[64];
+    temp_dir(dir);
+    RiftBuildCache cache;
+    assert(rift_build_cache_open(&cache, dir, 0));
+    snprintf(artifact, sizeof(artifact), "%s/built", dir);
+    snprintf(dest, sizeof(dest), "%s/fetched", dir);
+    const char* c_source = "int main(void) { return 0; }\n";
+    size_t c_len = strlen(c_source);
+
+    assert(!rift_build_cache_fetch(&cache, c_source, c_len, "cc=gcc -O1", dest));
+    assert(rift_write_if_changed(artifact, "binary", 6, true) == 0);
+    assert(rift_build_cache_store(&cache, c_source, c_len, "cc=gcc -O1", artifact));
+
+    assert(rift_build_cache_fetch(&cache, c_source, c_len, "cc=gcc -O1", dest));
+    read_file(dest, buf, sizeof(buf));
+    assert(strcmp(buf, "binary") == 0);
+    /* Other flags or other source: a different build */
+    assert(!rift_build_cache_fetch(&cache, c_source, c_len, "cc=gcc -O2", dest));
+    assert(!rift_build_cache_fetch(&cache, c_source, c_len - 1, "cc=gcc -O1", dest));
+    dir_entries(dir, 1);
+}
+
+typedef struct {
+    const RiftBuildCache* cache;
+    const char* artifact;
+    int failures;
+} BuildStoreJob;
+
+static void* build_store_repeatedly(void* arg) {
+    BuildStoreJob* job = (BuildStoreJob*)arg;
+    for (int i = 0; i < 50; i++) {
+        if (!rift_build_cache_store(job->cache, "int x;", 6, "cc", job->artifact)) {
+            job->failures++;
+        }
+    }
+    return NULL;
+}
+
+TEST(test_build_cache_concurrent_store) {
+    char dir[64], artifact[128];
+    temp_dir(dir);
+    RiftBuildCache cache;
+    assert(rift_build_cache_open(&cache, dir, 0));
+    snprintf(artifact, sizeof(artifact), "%s/built", dir);
+    assert(rift_write_if_changed(artifact, "binary", 6, true) == 0);
+
+    enum { THREADS = 4 };
+    pthread_t threads[THREADS];
+    BuildStoreJob jobs[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        jobs[t] = (BuildStoreJob){ &cache, artifact, 0 };
+        assert(pthread_create(&threads[t], NULL, build_store_repeatedly, &jobs[t]) == 0);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        assert(jobs[t].failures == 0);
+    }
+    /* The artifact and one entry */
+    assert(dir_entries(dir, 0) == 2);
+    dir_entries(dir, 1);
+}
+
+int main(void) {
+    printf("test_cache:\n");
+    RUN(test_cir_cache_miss_then_hit);
+    RUN(test_cir_cache_source_change_misses);
+    RUN(test_cir_cache_concurrent_store);
+    RUN(test_write_if_changed_keeps_mtime);
+    RUN(test_write_if_changed_executable);
+    RUN(test_build_cache_fetch);
+    RUN(test_build_cache_concurrent_store);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
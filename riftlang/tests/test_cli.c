@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static char g_cli[PATH_MAX];       /* absolute path of the riftlang under test */
+static char g_dir[64];             /* scratch directory the CLI runs in */
+
+/* Run the CLI in g_dir with args, output discarded; its exit status */
+static int run_cli(const char* args) {
+    char cmd[PATH_MAX + 512];
+    snprintf(cmd, sizeof(cmd), "cd '%s' && '%s' %s >/dev/null 2>&1", g_dir, g_cli, args);
+    int status = system(cmd);
+    return (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
+static void write_file(const char* name, const char* text) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    FILE* f = fopen(path, "w");
+    assert(f != NULL);
+    fputs(text, f);
+    fclose(f);
+}
+
+static int file_exists(const char* name) {
+    char path[256];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    return stat(path, &st) == 0;
+}
+
+static void remove_file(const char* name) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    remove(path);
+}
+
+/* Whole file as a NUL-terminated heap string, or NULL if missing */
+static char* read_file(const char* name, size_t* size) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = malloc((size_t)len + 1);
+    assert(data && fread(data, 1, (size_t)len, f) == (size_t)len);
+    data[len] = '\0';
+    fclose(f);
+    *size = (size_t)len;
+    return data;
+}
+
+static void rename_file(const char* from, const char* to) {
+    char a[256], b[256];
+    snprintf(a, sizeof(a), "%s/%s", g_dir, from);
+    snprintf(b, sizeof(b), "%s/%s", g_dir, to);
+    assert(rename(a, b) == 0);
+}
+
+static const char k_program[] =
+    "align span<fixed> {\n"
+    "  bytes: 64\n"
+    "}\n"
+    "x := 1\n";
+
+/* a/x.rift and b/x.rift would both link ./x: refused, nothing written */
+TEST(test_batch_same_executable_refused) {
+    assert(run_cli("--batch a/x.rift b/x.rift") != 0);
+    assert(!file_exists("a/x.c") && !file_exists("b/x.c") && !file_exists("x"));
+}
+
+/* Without linking, their outputs sit beside each input and differ */
+TEST(test_batch_compile_only_distinct) {
+    assert(run_cli("--batch -c a/x.rift b/x.rift") == 0);
+    assert(file_exists("a/x.c") && file_exists("b/x.c"));
+    remove_file("a/x.c");
+    remove_file("b/x.c");
+}
+
+/* x.rift and x.txt both write x.c, and both write x.js under --targets */
+TEST(test_batch_same_stem_refused) {
+    assert(run_cli("--batch -c a/x.rift a/x.txt") != 0);
+    assert(run_cli("--batch --targets js a/x.rift a/x.txt") != 0);
+    assert(!file_exists("a/x.c") && !file_exists("a/x.js"));
+}
+
+/* One file named twice is one input, not a collision */
+TEST(test_batch_repeated_input) {
+    assert(run_cli("--batch -c a/x.rift ./a/x.rift a") == 0);
+    assert(file_exists("a/x.c"));
+    remove_file("a/x.c");
+}
+
+static const char* const k_target_exts[] = { "js", "py", "go", "lua", "wat" };
+
+/* One --targets run writes what five single-target runs write */
+TEST(test_targets_match_single_runs) {
+    enum { TARGETS = sizeof(k_target_exts) / sizeof(k_target_exts[0]) };
+    assert(run_cli("a/x.rift --targets js,py,go,lua,wat") == 0);
+    char name[64], multi[64];
+    for (int i = 0; i < TARGETS; i++) {
+        snprintf(name, sizeof(name), "a/x.%s", k_target_exts[i]);
+        snprintf(multi, sizeof(multi), "a/multi.%s", k_target_exts[i]);
+        rename_file(name, multi);
+    }
+    for (int i = 0; i < TARGETS; i++) {
+        char args[128];
+        snprintf(name, sizeof(name), "a/x.%s", k_target_exts[i]);
+        snprintf(multi, sizeof(multi), "a/multi.%s", k_target_exts[i]);
+        snprintf(args, sizeof(args), "a/x.rift -o %s", name);
+        assert(run_cli(args) == 0);
+
+        size_t single_size = 0, multi_size = 0;
+        char* single_text = read_file(name, &single_size);
+        char* multi_text = read_file(multi, &multi_size);
+        assert(single_text && multi_text && single_size > 0);
+        assert(single_size == multi_size && memcmp(single_text, multi_text, single_size) == 0);
+        free(single_text);
+        free(multi_text);
+        remove_file(name);
+        remove_file(multi);
+    }
+}
+
+/* Outputs are written concurrently, so a repeated output is refused */
+TEST(test_duplicate_outputs_refused) {
+    assert(run_cli("a/x.rift -o a/y.js -o a/y.js") != 0);
+    /* However it is spelled */
+    assert(run_cli("a/x.rift -o a/y.js -o a/z.py -o ./a/../a/y.js") != 0);
+    assert(!file_exists("a/y.js") && !file_exists("a/z.py"));
+    assert(run_cli("a/x.rift --targets js,py,js") != 0);
+    assert(!file_exists("a/y.js") && !file_exists("a/x.js") && !file_exists("a/x.py"));
+}
+
+/* Nine outputs is one more than RIFT_MAX_OUTPUTS (8) */
+TEST(test_too_many_outputs_refused) {
+    assert(run_cli("a/x.rift --targets js,py,go,lua,wat,js,py,go,lua") != 0);
+    assert(run_cli("a/x.rift -o a/o1.js -o a/o2.js -o a/o3.js -o a/o4.js -o a/o5.js "
+                   "-o a/o6.js -o a/o7.js -o a/o8.js -o a/o9.js") != 0);
+    assert(!file_exists("a/x.js") && !file_exists("a/o1.js") && !file_exists("a/o9.js"));
+
+    /* Eight is allowed */
+    assert(run_cli("a/x.rift -o a/o1.js -o a/o2.js -o a/o3.js -o a/o4.js -o a/o5.js "
+                   "-o a/o6.js -o a/o7.js -o a/o8.js") == 0);
+    char name[32];
+    for (int i = 1; i <= 8; i++) {
+        snprintf(name, sizeof(name), "a/o%d.js", i);
+        assert(file_exists(name));
+        remove_file(name);
+    }
+}
+
+/* No daemon listening: --connect and RIFTLANG_DAEMON compile locally */
+TEST(test_connect_missing_daemon_falls_back) {
+    assert(run_cli("a/x.rift -o a/local.js") == 0);
+    size_t local_size = 0;
+    char* local = read_file("a/local.js", &local_size);
+    assert(local != NULL);
+
+    char args[256];
+    snprintf(args, sizeof(args), "--connect '%s/none.sock' a/x.rift -o a/fallback.js", g_dir);
+    assert(run_cli(args) == 0);
+    size_t size = 0;
+    char* fallback = read_file("a/fallback.js", &size);
+    assert(fallback && size == local_size && memcmp(fallback, local, size) == 0);
+    free(fallback);
+    remove_file("a/fallback.js");
+
+    /* A path that exists but is no socket */
+    snprintf(args, sizeof(args), "--connect '%s/a/x.rift' a/x.rift -o a/fallback.js", g_dir);
+    assert(run_cli(args) == 0);
+    assert(file_exists("a/fallback.js"));
+    remove_file("a/fallback.js");
+
+    assert(setenv("RIFTLANG_DAEMON", "/nonexistent/riftlang.sock", 1) == 0);
+    assert(run_cli("a/x.rift -o a/fallback.js") == 0);
+    unsetenv("RIFTLANG_DAEMON");
+    assert(file_exists("a/fallback.js"));
+    remove_file("a/fallback.js");
+
+    remove_file("a/local.js");
+    free(local);
+}
+
+/* Poll for up to five seconds until name exists and holds text (or just exists) */
+static int wait_for_text(const char* name, const char* text) {
+    for (int i = 0; i < 500; i++) {
+        size_t size = 0;
+        char* data = read_file(name, &size);
+        int found = data && (!text || strstr(data, text) != NULL);
+        free(data);
+        if (found) return 1;
+        struct timespec pause = { 0, 10 * 1000 * 1000 };
+        nanosleep(&pause, NULL);
+    }
+    return 0;
+}
+
+/* Start the CLI in g_dir with argv, stdout and stderr into log */
+static pid_t spawn_cli(char* const argv[], const char* log) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, log);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || chdir(g_dir) != 0) _exit(127);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+        execv(g_cli, argv);
+        _exit(127);
+    }
+    return pid;
+}
+
+static const char k_program_changed[] =
+    "align span<fixed> {\n"
+    "  bytes: 64\n"
+    "}\n"
+    "x := 2\n";
+
+/* Saving one input rebuilds that input only; a new file in the directory is built */
+TEST(test_watch_rebuilds_changed_input) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/w", g_dir);
+    assert(mkdir(path, 0777) == 0);
+    write_file("w/p.rift", k_program);
+    write_file("w/q.rift", k_program);
+
+    char* argv[] = { g_cli, "--watch", "--batch", "-c", "w", "--targets", "js", NULL };
+    pid_t pid = spawn_cli(argv, "watch.log");
+    assert(wait_for_text("watch.log", "Watching 2 files"));
+    assert(file_exists("w/p.js") && file_exists("w/q.js"));
+
+    struct stat q_before, q_after;
+    snprintf(path, sizeof(path), "%s/w/q.js", g_dir);
+    assert(stat(path, &q_before) == 0);
+    size_t q_size = 0;
+    char* q_text = read_file("w/q.js", &q_size);
+    assert(q_text && strstr(q_text, "let x = 1"));
+
+    write_file("w/p.rift", k_program_changed);
+    assert(wait_for_text("w/p.js", "let x = 2"));
+    assert(wait_for_text("watch.log", "Rebuilt w/p.rift"));
+
+    /* A .rift file created after the start joins the watched set */
+    write_file("w/r.rift", k_program_changed);
+    assert(wait_for_text("w/r.js", "let x = 2"));
+
+    assert(kill(pid, SIGTERM) == 0);
+    int status = 0;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    size_t log_size = 0;
+    char* log = read_file("watch.log", &log_size);
+    assert(log && !strstr(log, "Rebuilt w/q.rift") && strstr(log, "Watch stopped"));
+    free(log);
+
+    /* q.js was never touched */
+    assert(stat(path, &q_after) == 0);
+    assert(q_after.st_ino == q_before.st_ino);
+    assert(q_after.st_mtim.tv_sec == q_before.st_mtim.tv_sec &&
+           q_after.st_mtim.tv_nsec == q_before.st_mtim.tv_nsec);
+    size_t size = 0;
+    char* text = read_file("w/q.js", &size);
+    assert(text && size == q_size && memcmp(text, q_text, size) == 0);
+    free(text);
+    free(q_text);
+
+    const char* const created[] = { "w/p.rift", "w/q.rift", "w/r.rift",
+                                    "w/p.js", "w/q.js", "w/r.js", "watch.log" };
+    for (size_t i = 0; i < sizeof(created) / sizeof(created[0]); i++) {
+        remove_file(created[i]);
+    }
+    snprintf(path, sizeof(path), "%s/w", g_dir);
+    assert(rmdir(path) == 0);
+}
+
+/* The build-cache identity -v prints for a/x.rift, with env in front of the CLI */
+static char* build_identity(const char* env) {
+    char cmd[PATH_MAX + 512];
+    snprintf(cmd, sizeof(cmd), "cd '%s' && %s CC=true '%s' -v --build-cache cache a/x.rift "
+        ">identity.log 2>&1", g_dir, env, g_cli);
+    assert(system(cmd) != -1);
+    size_t size = 0;
+    char* log = read_file("identity.log", &size);
+    assert(log != NULL);
+    const char* line = strstr(log, "Build cache miss: ");
+    assert(line != NULL);
+    line += strlen("Build cache miss: ");
+    char* identity = strndup(line, strcspn(line, "\n"));
+    assert(identity != NULL);
+    free(log);
+    remove_file("identity.log");
+    return identity;
+}
+
+/* Include and library paths, and the headers they resolve to, key the build cache */
+TEST(test_build_identity_inputs) {
+    char* plain = build_identity("");
+    assert(strstr(plain, " riftlang.h=-") && strstr(plain, " stdio.h="));
+    assert(!strstr(plain, "CPATH="));
+
+    char* paths = build_identity("CPATH=/nonexistent/inc C_INCLUDE_PATH= LIBRARY_PATH=/opt/lib");
+    assert(strstr(paths, " CPATH=/nonexistent/inc "));
+    assert(strstr(paths, " C_INCLUDE_PATH= "));
+    assert(strstr(paths, " LIBRARY_PATH=/opt/lib "));
+
+    /* riftlang.h beside the generated C is the one gcc would open */
+    write_file("a/riftlang.h", "/* stand-in */\n");
+    char* beside = build_identity("");
+    assert(!strstr(beside, " riftlang.h=-") && strcmp(beside, plain) != 0);
+    remove_file("a/riftlang.h");
+
+    /* A stdio.h earlier on the search path shadows the system one */
+    write_file("stdio.h", "/* shadow */\n");
+    char* shadowed = build_identity("");
+    const char* system_stdio = strstr(plain, " stdio.h=");
+    const char* shadow_stdio = strstr(shadowed, " stdio.h=");
+    assert(system_stdio && shadow_stdio);
+    size_t system_len = strcspn(system_stdio + 1, " ");
+    assert(system_len != strcspn(shadow_stdio + 1, " ") ||
+           memcmp(system_stdio, shadow_stdio, system_len + 1) != 0);
+    remove_file("stdio.h");
+
+    char* again = build_identity("");
+    assert(strcmp(again, plain) == 0);
+
+    free(plain);
+    free(paths);
+    free(beside);
+    free(shadowed);
+    free(again);
+    remove_file("a/x.c");
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s/cache'", g_dir);
+    assert(system(cmd) == 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !realpath(argv[1], g_cli)) {
+        fprintf(stderr, "usage: test_cli <path to riftlang>\n");
+        return 1;
+    }
+    strcpy(g_dir, "/tmp/riftlang-test-XXXXXX");
+    assert(mkdtemp(g_dir) != NULL);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/a", g_dir);
+    assert(mkdir(path, 0777) == 0);
+    snprintf(path, sizeof(path), "%s/b", g_dir);
+    assert(mkdir(path, 0777) == 0);
+    write_file("a/x.rift", k_program);
+    write_file("b/x.rift", k_program);
+    write_file("a/x.txt", k_program);
+
+    printf("test_cli:\n");
+    RUN(test_batch_same_executable_refused);
+    RUN(test_batch_compile_only_distinct);
+    RUN(test_batch_same_stem_refused);
+    RUN(test_batch_repeated_input);
+    RUN(test_targets_match_single_runs);
+    RUN(test_duplicate_outputs_refused);
+    RUN(test_too_many_outputs_refused);
+    RUN(test_connect_missing_daemon_falls_back);
+    RUN(test_watch_rebuilds_changed_input);
+    RUN(test_build_identity_inputs);
+
+    remove_file("a/x.rift");
+    remove_file("a/x.txt");
+    remove_file("b/x.rift");
+    snprintf(path, sizeof(path), "%s/a", g_dir);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/b", g_dir);
+    rmdir(path);
+    rmdir(g_dir);
+
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
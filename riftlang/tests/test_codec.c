@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <unistd.h>
+#include "rift_codec.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static RiftLineKind classify(const char* line, RiftLineClass* c) {
+    return rift_line_classify(line, strlen(line), c);
+}
+
+static int slice_is(RiftLineSlice s, const char* expected) {
+    return s.len == strlen(expected) && memcmp(s.ptr, expected, s.len) == 0;
+}
+
+TEST(test_classify_type_whitespace) {
+    static const char* const lines[] = {
+        "type Q = {",
+        "type  Q = {",
+        "type Q={",
+        "  type   Q   =   {  ",
+        "\ttype Q\t= {",
+    };
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        RiftLineClass c;
+        assert(classify(lines[i], &c) == RIFT_LINE_TYPE);
+        assert(slice_is(c.name, "Q"));
+        assert(!c.closes);
+    }
+
+    RiftLineClass c;
+    assert(classify("type  Q = { a: int }", &c) == RIFT_LINE_TYPE);
+    assert(slice_is(c.name, "Q") && c.closes);
+    /* Without '=' it is not a type declaration */
+    assert(classify("type Q {", &c) == RIFT_LINE_OTHER);
+}
+
+TEST(test_classify_surrounding_whitespace) {
+    RiftLineClass c;
+    assert(classify("", &c) == RIFT_LINE_EMPTY);
+    assert(classify(" \t \r", &c) == RIFT_LINE_EMPTY);
+
+    assert(classify("  x := 1 + 2  ", &c) == RIFT_LINE_ASSIGN);
+    assert(slice_is(c.line, "x := 1 + 2"));
+    assert(slice_is(c.name, "x") && slice_is(c.text, "1 + 2"));
+    assert(classify("x:=1", &c) == RIFT_LINE_ASSIGN);
+    assert(slice_is(c.name, "x") && slice_is(c.text, "1"));
+
+    assert(classify("\t}\t", &c) == RIFT_LINE_BLOCK_CLOSE);
+    assert(classify("   {", &c) == RIFT_LINE_BLOCK_OPEN);
+    assert(classify("  while (x < 3) {", &c) == RIFT_LINE_WHILE);
+    assert(slice_is(c.text, "x < 3"));
+    assert(classify("if(x){", &c) == RIFT_LINE_IF);
+    assert(slice_is(c.text, "x"));
+    assert(classify("  // note", &c) == RIFT_LINE_COMMENT);
+}
+
+/* The linked CIR and the C transform read the same name */
+TEST(test_link_type_name_trimmed) {
+    const char* src =
+        "align span<fixed> {\n"
+        "  bytes: 64\n"
+        "}\n"
+        "type  Q = {\n"
+        "  a: int\n"
+        "}\n";
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    int found = 0;
+    for (uint32_t i = 0; i < prog->count; i++) {
+        if (prog->nodes[i].kind == CIR_TYPE_DEF) {
+            assert(strcmp(rift_cir_str(prog, prog->nodes[i].type_name), "Q") == 0);
+            found++;
+        }
+    }
+    assert(found == 1);
+    rift_cir_program_free(prog);
+}
+
+/* Stored strings are as long as the source: nothing is clipped */
+TEST(test_link_long_lines) {
+    enum { TERMS = 900 };
+    static char src[20480];
+    static char expr[16384];
+    size_t n = 0;
+    for (int i = 0; i < TERMS; i++) {
+        n += (size_t)snprintf(expr + n, sizeof(expr) - n, "%sw%d", i ? " + " : "", i);
+    }
+    assert(n > 4096);
+    snprintf(src, sizeof(src),
+        "align span<fixed> {\n"
+        "  bytes: 64\n"
+        "}\n"
+        "x := %.*s\n"
+        "y := %s\n"
+        "if (%.*s) {\n"
+        "}\n",
+        299, expr, expr, 299, expr);
+
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    assert(prog->count == 5);
+    const RiftCIRNode* x = &prog->nodes[1];
+    const RiftCIRNode* y = &prog->nodes[2];
+    const RiftCIRNode* cond = &prog->nodes[3];
+    assert(x->kind == CIR_ASSIGN && y->kind == CIR_ASSIGN && cond->kind == CIR_IF);
+    assert(strlen(rift_cir_str(prog, x->expr)) == 299);
+    assert(strncmp(rift_cir_str(prog, x->expr), expr, 299) == 0);
+    assert(strcmp(rift_cir_str(prog, y->expr), expr) == 0);
+    assert(strlen(rift_cir_str(prog, cond->condition)) == 299);
+    rift_cir_program_free(prog);
+}
+
+/* Past the old 1024-node and 64-variable ceilings: nothing dropped,
+ * and only the first assignment of each name declares it */
+TEST(test_link_many_nodes_and_vars) {
+    enum { VARS = 150, ROUNDS = 8 };
+    static char src[65536];
+    size_t n = (size_t)snprintf(src, sizeof(src), "align span<fixed> {\n  bytes: 64\n}\n");
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int v = 0; v < VARS; v++) {
+            n += (size_t)snprintf(src + n, sizeof(src) - n, "v%d := %d\n", v, round);
+        }
+    }
+    assert(n < sizeof(src) - 1);
+
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    assert(prog->count == 1 + VARS * ROUNDS);
+    assert(prog->count > 1024);
+    assert(prog->nodes[0].kind == CIR_SPAN);
+    for (uint32_t i = 1; i < prog->count; i++) {
+        const RiftCIRNode* node = &prog->nodes[i];
+        char name[16];
+        snprintf(name, sizeof(name), "v%u", (i - 1) % VARS);
+        assert(node->kind == CIR_ASSIGN);
+        assert(strcmp(rift_cir_str(prog, node->var_name), name) == 0);
+        assert(node->is_first_use == (i <= VARS));
+    }
+    rift_cir_program_free(prog);
+}
+
+static int node_str_is(const RiftCIRProgram* prog, RiftCIRStr str, const char* expected) {
+    return strcmp(rift_cir_str(prog, str), expected) == 0;
+}
+
+/* Every string field reads back through rift_cir_str as written */
+TEST(test_cir_str_fields_round_trip) {
+    const char* src =
+        "!govern hybrid\n"
+        "// a note\n"
+        "align span<row> {\n"
+        "  bytes: 128\n"
+        "}\n"
+        "type Pt = {\n"
+        "  x: INT,\n"
+        "  y: FLOAT\n"
+        "}\n"
+        "policy_fn on access {\n"
+        "  default_access: deny\n"
+        "}\n"
+        "count := count + 1\n"
+        "while (count < 3) {\n"
+        "}\n"
+        "if (count == 2) {\n"
+        "}\n"
+        "validate(count)\n"
+        "frobnicate the thing\n";
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    assert(prog->count == 14);
+    const RiftCIRNode* n = prog->nodes;
+
+    assert(n[0].kind == CIR_GOVERN && node_str_is(prog, n[0].mode, "hybrid"));
+    assert(n[1].kind == CIR_COMMENT && node_str_is(prog, n[1].text, "a note"));
+    assert(n[2].kind == CIR_SPAN && node_str_is(prog, n[2].span_kind, "row"));
+    assert(n[2].span_bytes == 128);
+    assert(n[3].kind == CIR_TYPE_DEF && node_str_is(prog, n[3].type_name, "Pt"));
+    assert(n[4].kind == CIR_TYPE_FIELD && node_str_is(prog, n[4].field_name, "x"));
+    assert(node_str_is(prog, n[4].field_type, "INT") && !n[4].is_last_field);
+    assert(n[5].kind == CIR_TYPE_FIELD && node_str_is(prog, n[5].field_name, "y"));
+    assert(node_str_is(prog, n[5].field_type, "FLOAT") && n[5].is_last_field);
+    assert(n[6].kind == CIR_POLICY && node_str_is(prog, n[6].policy_name, "access"));
+    assert(n[7].kind == CIR_ASSIGN && node_str_is(prog, n[7].var_name, "count"));
+    assert(node_str_is(prog, n[7].expr, "count + 1") && n[7].is_first_use);
+    assert(n[8].kind == CIR_WHILE && node_str_is(prog, n[8].condition, "count < 3"));
+    assert(n[9].kind == CIR_BLOCK_CLOSE);
+    assert(n[10].kind == CIR_IF && node_str_is(prog, n[10].condition, "count == 2"));
+    assert(n[11].kind == CIR_BLOCK_CLOSE);
+    assert(n[12].kind == CIR_VALIDATE && node_str_is(prog, n[12].validate_arg, "count"));
+    assert(n[13].kind == CIR_UNKNOWN && node_str_is(prog, n[13].text, "frobnicate the thing"));
+
+    /* Unused slots are offset 0, the empty string */
+    assert(n[0].expr == 0 && node_str_is(prog, n[0].expr, ""));
+    assert(n[9].text == 0 && node_str_is(prog, n[9].text, ""));
+
+    /* Offsets past the arena read as "" rather than out of bounds */
+    assert(node_str_is(prog, prog->strings_size, ""));
+    assert(node_str_is(prog, prog->strings_size + 100, ""));
+    assert(node_str_is(prog, UINT32_MAX, ""));
+    rift_cir_program_free(prog);
+
+    RiftCIRProgram empty;
+    memset(&empty, 0, sizeof(empty));
+    assert(node_str_is(&empty, 0, "") && node_str_is(&empty, 7, ""));
+}
+
+static const RiftTargetLanguage k_sink_targets[] = {
+    RIFT_TARGET_JS, RIFT_TARGET_PYTHON, RIFT_TARGET_GO, RIFT_TARGET_LUA, RIFT_TARGET_WAT,
+};
+
+/* Emit prog through an fd sink and a memory sink; the bytes must match.
+ * Returns the memory sink's text (caller frees). */
+static char* emit_both_sinks(const RiftCIRProgram* prog, RiftTargetLanguage target) {
+    RiftEmitSink memory;
+    assert(rift_emit_sink_init_memory(&memory));
+    assert(rift_codec_emit_sink(prog, &memory, target));
+    size_t size = 0;
+    char* text = rift_emit_sink_detach(&memory, &size);
+    assert(text != NULL);
+    rift_emit_sink_free(&memory);
+
+    char path[] = "/tmp/riftlang-test-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    RiftEmitSink file;
+    assert(rift_emit_sink_init_fd(&file, fd));
+    assert(rift_codec_emit_sink(prog, &file, target));
+    assert(rift_emit_sink_flush(&file));
+    rift_emit_sink_free(&file);
+
+    char* written = malloc(size + 1);
+    assert(written != NULL);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    size_t got = 0;
+    ssize_t n;
+    while ((n = read(fd, written + got, size + 1 - got)) > 0) got += (size_t)n;
+    assert(got == size && memcmp(written, text, size) == 0);
+    free(written);
+    close(fd);
+    unlink(path);
+    return text;
+}
+
+/* Leading whitespace of the first line containing needle */
+static size_t indent_of(const char* text, const char* needle) {
+    const char* hit = strstr(text, needle);
+    assert(hit != NULL);
+    const char* line = hit;
+    while (line > text && line[-1] != '\n') line--;
+    return strspn(line, " \t");
+}
+
+/* Numbers are formatted without printf: negatives and the extremes */
+TEST(test_emit_sinks_numbers) {
+    char src[512];
+    snprintf(src, sizeof(src),
+        "align span<fixed> {\n"
+        "  bytes: -128\n"
+        "}\n"
+        "a := -42\n"
+        "b := 0\n"
+        "c := %ld\n"
+        "d := %ld\n",
+        LONG_MIN, LONG_MAX);
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    for (size_t i = 0; i < sizeof(k_sink_targets) / sizeof(k_sink_targets[0]); i++) {
+        char* text = emit_both_sinks(prog, k_sink_targets[i]);
+        assert(strstr(text, "(fixed, -128 bytes)") != NULL);
+        if (k_sink_targets[i] == RIFT_TARGET_WAT) {
+            char expected[64];
+            assert(strstr(text, "(i32.const -42)") && strstr(text, "(i32.const 0)"));
+            snprintf(expected, sizeof(expected), "(i32.const %ld)", LONG_MIN);
+            assert(strstr(text, expected) != NULL);
+            snprintf(expected, sizeof(expected), "(i32.const %ld)", LONG_MAX);
+            assert(strstr(text, expected) != NULL);
+        }
+        free(text);
+    }
+    rift_cir_program_free(prog);
+}
+
+/* Deeper than the indent tables: Go stops at 15 tabs, the rest at 63 spaces */
+TEST(test_emit_sinks_deep_nesting) {
+    enum { DEPTH = 20 };
+    static char src[4096];
+    size_t n = (size_t)snprintf(src, sizeof(src), "align span<fixed> {\n  bytes: 64\n}\nx := 0\n");
+    for (int d = 0; d < DEPTH; d++) {
+        n += (size_t)snprintf(src + n, sizeof(src) - n, "while (x < %d) {\n  v%d := x\n", d + 1, d);
+    }
+    for (int d = 0; d < DEPTH; d++) {
+        n += (size_t)snprintf(src + n, sizeof(src) - n, "}\n");
+    }
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    for (size_t i = 0; i < sizeof(k_sink_targets) / sizeof(k_sink_targets[0]); i++) {
+        RiftTargetLanguage target = k_sink_targets[i];
+        char* text = emit_both_sinks(prog, target);
+        if (target == RIFT_TARGET_GO) {
+            assert(indent_of(text, "v0 := x") == 2);
+            assert(indent_of(text, "v14 := x") == 15);
+            assert(indent_of(text, "v19 := x") == 15);
+        } else if (target != RIFT_TARGET_WAT) {
+            assert(indent_of(text, "v14 = x") == 60);
+            assert(indent_of(text, "v15 = x") == 63);
+            assert(indent_of(text, "v19 = x") == 63);
+        }
+        free(text);
+    }
+    rift_cir_program_free(prog);
+}
+
+/* Output past the fd sink's buffer, with one line longer than the buffer */
+TEST(test_emit_sinks_large_output) {
+    enum { LINES = 4000, LONG_TERMS = 12000 };
+    size_t cap = (size_t)LINES * 32 + (size_t)LONG_TERMS * 8 + 256;
+    char* src = malloc(cap);
+    assert(src != NULL);
+    size_t n = (size_t)snprintf(src, cap, "align span<fixed> {\n  bytes: 64\n}\n");
+    for (int i = 0; i < LINES; i++) {
+        n += (size_t)snprintf(src + n, cap - n, "v%d := %d\n", i, i);
+    }
+    n += (size_t)snprintf(src + n, cap - n, "big := 0");
+    for (int i = 0; i < LONG_TERMS; i++) {
+        n += (size_t)snprintf(src + n, cap - n, " + v%d", i % LINES);
+    }
+    n += (size_t)snprintf(src + n, cap - n, "\n");
+    assert(n < cap - 1);
+
+    RiftCIRProgram* prog = rift_codec_link(src, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    for (size_t i = 0; i < sizeof(k_sink_targets) / sizeof(k_sink_targets[0]); i++) {
+        char* text = emit_both_sinks(prog, k_sink_targets[i]);
+        assert(strlen(text) > 2 * RIFT_EMIT_SINK_BUFFER);
+        free(text);
+    }
+    rift_cir_program_free(prog);
+    free(src);
+}
+
+int main(void) {
+    printf("test_codec:\n");
+    RUN(test_classify_type_whitespace);
+    RUN(test_classify_surrounding_whitespace);
+    RUN(test_link_type_name_trimmed);
+    RUN(test_link_long_lines);
+    RUN(test_link_many_nodes_and_vars);
+    RUN(test_cir_str_fields_round_trip);
+    RUN(test_emit_sinks_numbers);
+    RUN(test_emit_sinks_deep_nesting);
+    RUN(test_emit_sinks_large_output);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "rift_compile.h"
+#include "rift_codec.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static const char k_program[] =
+    "align span<fixed> {\n"
+    "  bytes: 64\n"
+    "}\n"
+    "type Pt = {\n"
+    "  x: INT\n"
+    "}\n"
+    "x := 1\n"
+    "while (x < 3) {\n"
+    "  x := x + 1\n"
+    "}\n";
+
+static const struct {
+    RiftTargetLanguage target;
+    const char* marker;             /* something only this target writes */
+} k_targets[] = {
+    { RIFT_TARGET_JS,     "let x = 1" },
+    { RIFT_TARGET_PYTHON, "x = 1" },
+    { RIFT_TARGET_GO,     "x := 1" },
+    { RIFT_TARGET_LUA,    "local x = 1" },
+    { RIFT_TARGET_WAT,    "(module" },
+};
+
+/* The same program through rift_codec_link and a fresh memory sink */
+static char* reference_output(const char* source, RiftTargetLanguage target, size_t* size) {
+    RiftCIRProgram* prog = rift_codec_link(source, RIFT_MODE_CLASSICAL);
+    assert(prog != NULL && prog->consensus_ok);
+    RiftEmitSink sink;
+    assert(rift_emit_sink_init_memory(&sink));
+    assert(rift_codec_emit_sink(prog, &sink, target));
+    char* data = rift_emit_sink_detach(&sink, size);
+    assert(data != NULL);
+    rift_emit_sink_free(&sink);
+    rift_cir_program_free(prog);
+    return data;
+}
+
+/* Each target emits what the file pipeline emits for it */
+TEST(test_compile_each_target) {
+    RiftCompiler* compiler = rift_compiler_create();
+    assert(compiler != NULL);
+    for (size_t i = 0; i < sizeof(k_targets) / sizeof(k_targets[0]); i++) {
+        RiftCompileOutput out;
+        assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+            RIFT_MODE_CLASSICAL, k_targets[i].target, 0, &out) == RIFT_COMPILE_OK);
+        assert(strcmp(rift_compiler_error(compiler), "") == 0);
+        assert(out.node_count == 7 && out.mode == RIFT_MODE_CLASSICAL);
+        assert(out.data[out.size] == '\0' && strlen(out.data) == out.size);
+        assert(strstr(out.data, k_targets[i].marker) != NULL);
+
+        size_t size = 0;
+        char* expected = reference_output(k_program, k_targets[i].target, &size);
+        assert(out.size == size && memcmp(out.data, expected, size) == 0);
+        free(expected);
+    }
+    rift_compiler_destroy(compiler);
+}
+
+/* Compiler-owned output is one reused buffer; CALLER_OWNS hands it over */
+TEST(test_compile_output_ownership) {
+    RiftCompiler* compiler = rift_compiler_create();
+    assert(compiler != NULL);
+    RiftCompileOutput first, second, owned, after;
+
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &first) == RIFT_COMPILE_OK);
+    char* js = strdup(first.data);
+    assert(js != NULL);
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_LUA, 0, &second) == RIFT_COMPILE_OK);
+    assert(second.data == first.data);          /* warm compiler: same buffer */
+    assert(strcmp(second.data, js) != 0);       /* first result overwritten */
+
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, RIFT_COMPILE_CALLER_OWNS, &owned) == RIFT_COMPILE_OK);
+    assert(owned.size == strlen(js) && strcmp(owned.data, js) == 0);
+
+    /* The handed-over buffer survives later compiles and the compiler */
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_GO, 0, &after) == RIFT_COMPILE_OK);
+    assert(after.data != owned.data);
+    rift_compiler_destroy(compiler);
+    assert(strcmp(owned.data, js) == 0);
+    free((char*)owned.data);
+    free(js);
+}
+
+/* Only source[0..length) is read: no NUL needed, nothing past the end */
+TEST(test_compile_unterminated_source) {
+    size_t length = strlen(k_program);
+    char* source = malloc(length);              /* exactly length bytes, no NUL */
+    assert(source != NULL);
+    memcpy(source, k_program, length);
+
+    RiftCompiler* compiler = rift_compiler_create();
+    assert(compiler != NULL);
+    RiftCompileOutput out;
+    assert(rift_compile_buffer(compiler, source, length,
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_PYTHON, RIFT_COMPILE_CALLER_OWNS, &out) == RIFT_COMPILE_OK);
+    size_t size = 0;
+    char* expected = reference_output(k_program, RIFT_TARGET_PYTHON, &size);
+    assert(out.size == size && memcmp(out.data, expected, size) == 0);
+    free((char*)out.data);
+    free(expected);
+
+    /* A prefix of a longer buffer compiles as that prefix alone */
+    static const char with_tail[] = "align span<fixed> {\n}\nx := 1\ny := 2\n";
+    size_t cut = (size_t)(strstr(with_tail, "y :=") - with_tail);
+    assert(rift_compile_buffer(compiler, with_tail, cut,
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_OK);
+    assert(out.node_count == 2);
+    assert(strstr(out.data, "let x = 1") && !strstr(out.data, "let y"));
+
+    rift_compiler_destroy(compiler);
+    free(source);
+}
+
+/* Linker rejections carry the status name and the linker's message */
+TEST(test_compile_consensus_failure) {
+    static const char source[] = "x := 1\n";
+    RiftCompiler* compiler = rift_compiler_create();
+    assert(compiler != NULL);
+    RiftCompileOutput out;
+    assert(rift_compile_buffer(compiler, source, strlen(source),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_CONSENSUS_FAILED);
+    assert(out.data == NULL && out.size == 0 && out.node_count == 0);
+    assert(strcmp(rift_compiler_error(compiler),
+        "consensus failed: line 1: assignment before span declaration "
+        "(violates memory-first ordering)") == 0);
+
+    /* The next success clears the message */
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_OK);
+    assert(strcmp(rift_compiler_error(compiler), "") == 0);
+    rift_compiler_destroy(compiler);
+}
+
+/* C output belongs to the transform pipeline; bad arguments are refused */
+TEST(test_compile_rejects) {
+    RiftCompiler* compiler = rift_compiler_create();
+    assert(compiler != NULL);
+    RiftCompileOutput out;
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_C, 0, &out) == RIFT_COMPILE_UNSUPPORTED_TARGET);
+    assert(out.data == NULL);
+    assert(strncmp(rift_compiler_error(compiler), "unsupported target: ", 20) == 0);
+
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, (RiftTargetLanguage)99, 0, &out) == RIFT_COMPILE_INVALID_ARGUMENT);
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        (RiftExecutionMode)99, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_INVALID_ARGUMENT);
+    assert(rift_compile_buffer(compiler, NULL, 4,
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_INVALID_ARGUMENT);
+    assert(rift_compile_buffer(compiler, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, NULL) == RIFT_COMPILE_INVALID_ARGUMENT);
+    assert(rift_compile_buffer(NULL, k_program, strlen(k_program),
+        RIFT_MODE_CLASSICAL, RIFT_TARGET_JS, 0, &out) == RIFT_COMPILE_INVALID_ARGUMENT);
+    rift_compiler_destroy(compiler);
+}
+
+int main(void) {
+    printf("test_compile:\n");
+    RUN(test_compile_each_target);
+    RUN(test_compile_output_ownership);
+    RUN(test_compile_unterminated_source);
+    RUN(test_compile_consensus_failure);
+    RUN(test_compile_rejects);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "rift_daemon.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+/* A connected pair standing in for client and daemon */
+static void socket_pair(int sv[2]) {
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+}
+
+/* Write a raw frame header and payload, bypassing the senders' checks */
+static void send_frame(int sock, const char* magic, uint16_t version, uint16_t kind,
+                       uint32_t size, const void* payload, size_t payload_len) {
+    RiftDaemonFrame frame;
+    memcpy(frame.magic, magic, sizeof(frame.magic));
+    frame.version = version;
+    frame.kind = kind;
+    frame.size = size;
+    assert(write(sock, &frame, sizeof(frame)) == (ssize_t)sizeof(frame));
+    if (payload_len) {
+        assert(write(sock, payload, payload_len) == (ssize_t)payload_len);
+    }
+}
+
+/* Request and status frames decode to what was encoded, fds included */
+TEST(test_frames_round_trip) {
+    int sv[2], out[2], err[2];
+    socket_pair(sv);
+    assert(pipe(out) == 0 && pipe(err) == 0);
+
+    char* argv[] = { "riftlang", "x.rift", "-o", "x.js", NULL };
+    char* env[] = { "RIFTLANG_CACHE=/tmp/c", "EMPTY=", NULL };
+    assert(rift_daemon_send_request(sv[0], "/work dir", 4, argv, 2, env, out[1], err[1]));
+
+    RiftDaemonRequest req;
+    assert(rift_daemon_recv_request(sv[1], &req));
+    assert(strcmp(req.cwd, "/work dir") == 0);
+    assert(req.argc == 4 && req.argv[4] == NULL);
+    for (int i = 0; i < 4; i++) assert(strcmp(req.argv[i], argv[i]) == 0);
+    assert(req.envc == 2);
+    assert(strcmp(req.env[0], env[0]) == 0 && strcmp(req.env[1], env[1]) == 0);
+
+    /* The passed descriptors are the client's pipes */
+    assert(req.out_fd >= 0 && req.err_fd >= 0);
+    char buf[8];
+    assert(write(req.out_fd, "out", 3) == 3 && read(out[0], buf, sizeof(buf)) == 3);
+    assert(memcmp(buf, "out", 3) == 0);
+    assert(write(req.err_fd, "err", 3) == 3 && read(err[0], buf, sizeof(buf)) == 3);
+    assert(memcmp(buf, "err", 3) == 0);
+    rift_daemon_request_free(&req);
+    assert(req.out_fd == -1 && req.payload == NULL);
+
+    const int codes[] = { 0, 1, -1, 255, -2147483647 - 1 };
+    for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++) {
+        int status = 12345;
+        assert(rift_daemon_send_status(sv[1], codes[i]));
+        assert(rift_daemon_recv_status(sv[0], &status));
+        assert(status == codes[i]);
+    }
+
+    close(out[0]); close(out[1]); close(err[0]); close(err[1]);
+    close(sv[0]); close(sv[1]);
+}
+
+/* Wrong magic or protocol version: refused with EPROTO */
+TEST(test_frames_bad_header_rejected) {
+    const struct {
+        const char* magic;
+        uint16_t version;
+    } bad[] = {
+        { "XFTD", RIFT_DAEMON_PROTOCOL },
+        { "rftd", RIFT_DAEMON_PROTOCOL },
+        { RIFT_DAEMON_MAGIC, 0 },
+        { RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL + 1 },
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        int sv[2];
+        socket_pair(sv);
+        send_frame(sv[0], bad[i].magic, bad[i].version, RIFT_DAEMON_REQUEST, 0, NULL, 0);
+        RiftDaemonRequest req;
+        errno = 0;
+        assert(!rift_daemon_recv_request(sv[1], &req));
+        assert(errno == EPROTO);
+
+        int32_t code = 0;
+        send_frame(sv[1], bad[i].magic, bad[i].version, RIFT_DAEMON_STATUS,
+                   sizeof(code), &code, sizeof(code));
+        int status = 0;
+        errno = 0;
+        assert(!rift_daemon_recv_status(sv[0], &status));
+        assert(errno == EPROTO);
+        close(sv[0]);
+        close(sv[1]);
+    }
+
+    /* A STATUS frame where a REQUEST is expected, and the reverse */
+    int sv[2];
+    socket_pair(sv);
+    int32_t code = 0;
+    send_frame(sv[0], RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL, RIFT_DAEMON_STATUS,
+               sizeof(code), &code, sizeof(code));
+    RiftDaemonRequest req;
+    assert(!rift_daemon_recv_request(sv[1], &req));
+    send_frame(sv[1], RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL, RIFT_DAEMON_REQUEST,
+               sizeof(code), &code, sizeof(code));
+    int status = 0;
+    assert(!rift_daemon_recv_status(sv[0], &status));
+    close(sv[0]);
+    close(sv[1]);
+}
+
+/* Payloads over RIFT_DAEMON_MAX_PAYLOAD are refused at both ends */
+TEST(test_frames_oversize_rejected) {
+    int sv[2];
+    socket_pair(sv);
+
+    /* Receiver: the header alone is enough to refuse, nothing is allocated */
+    send_frame(sv[0], RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL, RIFT_DAEMON_REQUEST,
+               RIFT_DAEMON_MAX_PAYLOAD + 1, NULL, 0);
+    RiftDaemonRequest req;
+    errno = 0;
+    assert(!rift_daemon_recv_request(sv[1], &req));
+    assert(errno == EPROTO);
+
+    /* Sender: an argument list past the limit never leaves the client */
+    size_t len = RIFT_DAEMON_MAX_PAYLOAD + 16;
+    char* huge = malloc(len + 1);
+    assert(huge != NULL);
+    memset(huge, 'a', len);
+    huge[len] = '\0';
+    char* argv[] = { "riftlang", huge, NULL };
+    errno = 0;
+    assert(!rift_daemon_send_request(sv[0], "/", 2, argv, 0, NULL, 1, 2));
+    assert(errno == E2BIG);
+    free(huge);
+
+    /* A STATUS frame must carry exactly one int32 */
+    int64_t wide = 0;
+    send_frame(sv[1], RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL, RIFT_DAEMON_STATUS,
+               sizeof(wide), &wide, sizeof(wide));
+    int status = 0;
+    errno = 0;
+    assert(!rift_daemon_recv_status(sv[0], &status));
+    assert(errno == EPROTO);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+/* Payloads that do not parse as argc | envc | strings are refused */
+TEST(test_frames_malformed_payload_rejected) {
+    struct {
+        uint32_t counts[2];
+        char strings[16];
+    } payload;
+    const struct {
+        uint32_t argc, envc;
+        const char* strings;
+        size_t len;
+    } bad[] = {
+        { 0, 0, "/\0", 2 },                 /* no argv[0] */
+        { 1, 0, "/\0riftlang", 10 },        /* last string unterminated */
+        { 2, 0, "/\0riftlang\0", 11 },      /* fewer strings than counted */
+        { 1, 0, "/\0riftlang\0x\0", 13 },   /* trailing bytes */
+        { 1, 0xffffffffu, "/\0riftlang\0", 11 },
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        int sv[2];
+        socket_pair(sv);
+        payload.counts[0] = bad[i].argc;
+        payload.counts[1] = bad[i].envc;
+        memcpy(payload.strings, bad[i].strings, bad[i].len);
+        size_t size = sizeof(payload.counts) + bad[i].len;
+        send_frame(sv[0], RIFT_DAEMON_MAGIC, RIFT_DAEMON_PROTOCOL, RIFT_DAEMON_REQUEST,
+                   (uint32_t)size, &payload, size);
+        RiftDaemonRequest req;
+        errno = 0;
+        assert(!rift_daemon_recv_request(sv[1], &req));
+        assert(errno == EPROTO);
+        close(sv[0]);
+        close(sv[1]);
+    }
+
+    /* The peer hanging up mid-header */
+    int sv[2];
+    socket_pair(sv);
+    assert(write(sv[0], RIFT_DAEMON_MAGIC, 4) == 4);
+    close(sv[0]);
+    RiftDaemonRequest req;
+    errno = 0;
+    assert(!rift_daemon_recv_request(sv[1], &req));
+    assert(errno == ECONNRESET);
+    close(sv[1]);
+}
+
+int main(void) {
+    printf("test_daemon:\n");
+    RUN(test_frames_round_trip);
+    RUN(test_frames_bad_header_rejected);
+    RUN(test_frames_oversize_rejected);
+    RUN(test_frames_malformed_payload_rejected);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
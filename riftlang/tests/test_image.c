@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "riftlang.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static char g_dir[64];
+static char g_image[128];           /* image saved by main() */
+static char g_scratch[128];         /* damaged copies */
+
+static const struct {
+    const char* left;
+    const char* right;
+    uint32_t priority;
+    bool literal;
+} k_rules[] = {
+    { "^[[:space:]]*!govern[[:space:]]+[a-z]+", "// govern", 1, true },
+    { "^[[:space:]]*type[[:space:]]+([A-Za-z_]+)[[:space:]]*=", "type \\1", 20, true },
+    { "([a-z_]+)[[:space:]]*:=[[:space:]]*([^;]+)", "let \\1 = \\2;", 30, true },
+    { "^[[:space:]]*\\}", "}", 200, true },
+    { "^[[:space:]]*//(.*)$", "//\\1", 1000, true },
+    /* Requested non-literal: one stays a regex, one has no regex syntax */
+    { "^x{2,3}y", "(x|y)+", 40, false },
+    { "^zz", "plain", 40, false },
+};
+
+static const char* const k_lines[] = {
+    "!govern classical", "type Q = {", "x := 1", "  }", "// note",
+    "xxy", "zz top", "type Q = { x := 2 }", "", "no rule here",
+};
+
+static RiftPatternEngine* build_engine(void) {
+    RiftPatternEngine* engine = rift_pattern_engine_create(RIFT_MODE_CLASSICAL);
+    assert(engine != NULL);
+    for (size_t i = 0; i < sizeof(k_rules) / sizeof(k_rules[0]); i++) {
+        assert(rift_pattern_engine_add_pair(engine, k_rules[i].left, k_rules[i].right,
+            k_rules[i].priority, k_rules[i].literal));
+    }
+    assert(rift_pattern_engine_compile(engine));
+    assert(rift_pattern_engine_seal(engine));
+    return engine;
+}
+
+static unsigned char* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    assert(f != NULL);
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char* data = malloc(*size ? *size : 1);
+    assert(data && fread(data, 1, *size, f) == *size);
+    fclose(f);
+    return data;
+}
+
+static void write_bytes(const char* path, const unsigned char* data, size_t size) {
+    FILE* f = fopen(path, "wb");
+    assert(f != NULL);
+    assert(fwrite(data, 1, size, f) == size);
+    fclose(f);
+}
+
+/* Same pairs in the same order, and the same answer for every line */
+TEST(test_image_round_trip) {
+    RiftPatternEngine* built = build_engine();
+    RiftPatternEngine* loaded = rift_pattern_engine_load_image(g_image);
+    assert(loaded != NULL);
+    assert(rift_pattern_engine_is_sealed(loaded));
+    assert(loaded->mode == RIFT_MODE_CLASSICAL);
+    assert(loaded->pair_count == built->pair_count);
+    assert((loaded->automaton != NULL) == (built->automaton != NULL));
+
+    for (uint32_t i = 0; i < built->pair_count; i++) {
+        RiftBipartitePair* a = built->pairs[i];
+        RiftBipartitePair* b = loaded->pairs[i];
+        assert(a->left->priority == b->left->priority);
+        assert(strcmp(a->left->pattern_str, b->left->pattern_str) == 0);
+        assert(strcmp(a->right->pattern_str, b->right->pattern_str) == 0);
+        assert(a->right->is_literal == b->right->is_literal);
+        assert(a->right->capture_refs == b->right->capture_refs);
+    }
+
+    for (size_t i = 0; i < sizeof(k_lines) / sizeof(k_lines[0]); i++) {
+        regmatch_t built_caps[10];
+        regmatch_t loaded_caps[10];
+        RiftBipartitePair* a = rift_pattern_engine_find(built, k_lines[i], built_caps, 10);
+        RiftBipartitePair* b = rift_pattern_engine_find(loaded, k_lines[i], loaded_caps, 10);
+        assert((a == NULL) == (b == NULL));
+        if (!a) continue;
+        assert(a->transform_id == b->transform_id);
+        assert(memcmp(built_caps, loaded_caps, sizeof(built_caps)) == 0);
+
+        size_t built_len = 0, loaded_len = 0;
+        uint32_t built_priority = 0, loaded_priority = 0;
+        char* built_out = rift_pattern_engine_match(built, k_lines[i], &built_len, &built_priority);
+        char* loaded_out = rift_pattern_engine_match(loaded, k_lines[i], &loaded_len, &loaded_priority);
+        assert(built_out && loaded_out);
+        assert(built_priority == loaded_priority);
+        assert(built_len == loaded_len && memcmp(built_out, loaded_out, built_len) == 0);
+        free(built_out);
+        free(loaded_out);
+    }
+    rift_pattern_engine_destroy(built);
+    rift_pattern_engine_destroy(loaded);
+}
+
+/* The literal flag add_pair stores, which callers compare images against */
+TEST(test_right_is_literal) {
+    assert(rift_pattern_right_is_literal("(x|y)+", true));
+    assert(!rift_pattern_right_is_literal("(x|y)+", false));
+    assert(rift_pattern_right_is_literal("plain", false));
+    assert(rift_pattern_right_is_literal("(unclosed", false));
+
+    RiftPatternEngine* loaded = rift_pattern_engine_load_image(g_image);
+    assert(loaded != NULL);
+    for (uint32_t i = 0; i < loaded->pair_count; i++) {
+        assert(loaded->pairs[i]->right->is_literal ==
+               rift_pattern_right_is_literal(k_rules[i].right, k_rules[i].literal));
+    }
+    rift_pattern_engine_destroy(loaded);
+}
+
+/* Every prefix of a valid image is refused, as is trailing garbage */
+TEST(test_image_truncated_rejected) {
+    size_t size = 0;
+    unsigned char* data = read_file(g_image, &size);
+    assert(size > 64);
+    const size_t cuts[] = { 0, 1, 8, 63, 64, 65, size / 2, size - 4, size - 1 };
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+        write_bytes(g_scratch, data, cuts[i]);
+        assert(rift_pattern_engine_load_image(g_scratch) == NULL);
+    }
+
+    unsigned char* longer = malloc(size + 1);
+    assert(longer != NULL);
+    memcpy(longer, data, size);
+    longer[size] = 0;
+    write_bytes(g_scratch, longer, size + 1);
+    assert(rift_pattern_engine_load_image(g_scratch) == NULL);
+    free(longer);
+
+    /* The untouched bytes still load */
+    write_bytes(g_scratch, data, size);
+    RiftPatternEngine* engine = rift_pattern_engine_load_image(g_scratch);
+    assert(engine != NULL);
+    rift_pattern_engine_destroy(engine);
+    free(data);
+}
+
+/* Wrong magic, wrong version and flipped payload bytes are refused */
+TEST(test_image_bad_header_rejected) {
+    size_t size = 0;
+    unsigned char* data = read_file(g_image, &size);
+
+    data[0] ^= 0xff;
+    write_bytes(g_scratch, data, size);
+    assert(rift_pattern_engine_load_image(g_scratch) == NULL);
+    data[0] ^= 0xff;
+
+    /* The version follows the 8-byte magic */
+    uint32_t version = 0;
+    memcpy(&version, data + 8, sizeof(version));
+    assert(version == RIFT_RULE_IMAGE_VERSION);
+    const uint32_t bad_versions[] = { 0, RIFT_RULE_IMAGE_VERSION + 1, UINT32_MAX };
+    for (size_t i = 0; i < sizeof(bad_versions) / sizeof(bad_versions[0]); i++) {
+        memcpy(data + 8, &bad_versions[i], sizeof(uint32_t));
+        write_bytes(g_scratch, data, size);
+        assert(rift_pattern_engine_load_image(g_scratch) == NULL);
+    }
+    memcpy(data + 8, &version, sizeof(version));
+
+    /* Checksum covers everything after the header */
+    data[size - 1] ^= 0x01;
+    write_bytes(g_scratch, data, size);
+    assert(rift_pattern_engine_load_image(g_scratch) == NULL);
+
+    assert(rift_pattern_engine_load_image("/nonexistent/rules.rimg") == NULL);
+    free(data);
+}
+
+int main(void) {
+    strcpy(g_dir, "/tmp/riftlang-test-XXXXXX");
+    assert(mkdtemp(g_dir) != NULL);
+    snprintf(g_image, sizeof(g_image), "%s/rules.rimg", g_dir);
+    snprintf(g_scratch, sizeof(g_scratch), "%s/damaged.rimg", g_dir);
+
+    RiftPatternEngine* engine = build_engine();
+    assert(rift_pattern_engine_save_image(engine, g_image));
+    rift_pattern_engine_destroy(engine);
+
+    printf("test_image:\n");
+    RUN(test_image_round_trip);
+    RUN(test_right_is_literal);
+    RUN(test_image_truncated_rejected);
+    RUN(test_image_bad_header_rejected);
+
+    remove(g_image);
+    remove(g_scratch);
+    rmdir(g_dir);
+
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "riftlang.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+/* Line `line` of the index reads as `text` */
+static void check_line(const RiftLineIndex* index, uint32_t line, const char* text) {
+    size_t len = 0;
+    const char* p = riftlang_line_index_get(index, line, &len);
+    assert(p != NULL);
+    assert(len == strlen(text) && memcmp(p, text, len) == 0);
+}
+
+/* Empty input has no lines; every offset still resolves to line 1 */
+TEST(test_lines_empty) {
+    RiftLineIndex index;
+    assert(riftlang_line_index_build(&index, "", 0));
+    assert(index.count == 0);
+    assert(riftlang_line_index_get(&index, 1, NULL) == NULL);
+    assert(riftlang_line_index_line_of(&index, 0) == 1);
+    riftlang_line_index_free(&index);
+    assert(index.starts == NULL);
+}
+
+/* A trailing '\n' ends the last line and opens no new one */
+TEST(test_lines_trailing_newline) {
+    const char* src = "x := 1\ny := 2\n";
+    RiftLineIndex index;
+    assert(riftlang_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 2);
+    check_line(&index, 1, "x := 1");
+    check_line(&index, 2, "y := 2");
+    assert(riftlang_line_index_get(&index, 3, NULL) == NULL);
+    assert(riftlang_line_index_line_of(&index, 6) == 1);    /* the first '\n' */
+    assert(riftlang_line_index_line_of(&index, 7) == 2);
+    assert(riftlang_line_index_line_of(&index, strlen(src)) == 2);
+    riftlang_line_index_free(&index);
+
+    /* Only the last '\n' is absorbed: a blank line before it still counts */
+    src = "a\n\n";
+    assert(riftlang_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 2);
+    check_line(&index, 1, "a");
+    check_line(&index, 2, "");
+    riftlang_line_index_free(&index);
+
+    src = "\n";
+    assert(riftlang_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 1);
+    check_line(&index, 1, "");
+    riftlang_line_index_free(&index);
+}
+
+/* '\r' is ordinary text: CRLF lines keep it */
+TEST(test_lines_crlf) {
+    const char* src = "ab\r\ncd\r\n";
+    RiftLineIndex index;
+    assert(riftlang_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 2);
+    check_line(&index, 1, "ab\r");
+    check_line(&index, 2, "cd\r");
+    assert(riftlang_line_index_line_of(&index, 3) == 1);    /* '\n' after '\r' */
+    assert(riftlang_line_index_line_of(&index, 4) == 2);
+    riftlang_line_index_free(&index);
+}
+
+/* The bytes after the last '\n' form a line of their own */
+TEST(test_lines_no_final_newline) {
+    const char* src = "ab\n\ncdef\ng";
+    RiftLineIndex index;
+    assert(riftlang_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 4);
+    check_line(&index, 1, "ab");
+    check_line(&index, 2, "");
+    check_line(&index, 3, "cdef");
+    check_line(&index, 4, "g");
+    assert(riftlang_line_index_get(&index, 0, NULL) == NULL);
+    assert(riftlang_line_index_get(&index, 5, NULL) == NULL);
+    assert(riftlang_line_index_line_of(&index, 8) == 3);    /* the last '\n' */
+    assert(riftlang_line_index_line_of(&index, 9) == 4);
+    assert(riftlang_line_index_line_of(&index, 100) == 4);  /* past the end */
+    riftlang_line_index_free(&index);
+
+    /* More lines than the initial 32-bytes-per-line guess */
+    char many[256];
+    memset(many, '\n', sizeof(many));
+    many[sizeof(many) - 1] = 'z';
+    assert(riftlang_line_index_build(&index, many, sizeof(many)));
+    assert(index.count == sizeof(many));
+    check_line(&index, 100, "");
+    check_line(&index, (uint32_t)sizeof(many), "z");
+    riftlang_line_index_free(&index);
+}
+
+int main(void) {
+    printf("test_lines:\n");
+    RUN(test_lines_empty);
+    RUN(test_lines_trailing_newline);
+    RUN(test_lines_crlf);
+    RUN(test_lines_no_final_newline);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "rift_transform_output.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static char g_dir[64];
+
+/* Every chunk accounted for, in order, and the join of them equals expected */
+static void check_output(const TransformOutput* out, const char* expected, size_t size) {
+    assert(!out->failed);
+    assert(out->size == size);
+    size_t total = 0;
+    int chunks = 0;
+    for (const TransformChunk* chunk = out->head; chunk; chunk = chunk->next) {
+        assert(chunk->len <= chunk->capacity);
+        assert(memcmp(chunk->data, expected + total, chunk->len) == 0);
+        total += chunk->len;
+        chunks++;
+        if (!chunk->next) assert(chunk == out->tail);
+    }
+    assert(total == size && chunks == out->chunk_count);
+
+    char* joined = transform_output_join(out);
+    assert(joined != NULL);
+    assert(memcmp(joined, expected, size) == 0 && joined[size] == '\0');
+    free(joined);
+}
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    assert(f != NULL);
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = malloc(*size + 1);
+    assert(data && fread(data, 1, *size, f) == *size);
+    data[*size] = '\0';
+    fclose(f);
+    return data;
+}
+
+/* Several chunks' worth of appends, mirrored into one flat buffer */
+TEST(test_output_spans_chunks) {
+    size_t cap = 4 * RIFT_TRANSFORM_CHUNK;
+    char* expected = malloc(cap);
+    assert(expected != NULL);
+    size_t size = 0;
+
+    TransformResult result;
+    memset(&result, 0, sizeof(result));
+    for (int i = 0; size < 3 * RIFT_TRANSFORM_CHUNK; i++) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "    int v%d = %d;\n", i, i * 7);
+        transform_appendf(&result, "    int v%d = %d;\n", i, i * 7);
+        memcpy(expected + size, line, (size_t)n);
+        size += (size_t)n;
+        TRANSFORM_APPEND_LITERAL(&result, "// x\n");
+        memcpy(expected + size, "// x\n", 5);
+        size += 5;
+    }
+    assert(result.output.chunk_count >= 3);
+    check_output(&result.output, expected, size);
+
+    transform_output_free(&result.output);
+    assert(result.output.head == NULL && result.output.size == 0);
+    free(expected);
+}
+
+/* A formatted line larger than the room left: written whole into a new chunk */
+TEST(test_appendf_overflows_chunk) {
+    TransformResult result;
+    memset(&result, 0, sizeof(result));
+
+    /* Leave 10 bytes of room in the first chunk */
+    size_t fill = RIFT_TRANSFORM_CHUNK - 10;
+    char* filler = malloc(fill);
+    assert(filler != NULL);
+    memset(filler, 'f', fill);
+    transform_append(&result, filler, fill);
+    assert(result.output.chunk_count == 1);
+
+    transform_appendf(&result, "%s-%d", "overflow", 12345);     /* 14 bytes */
+    assert(result.output.chunk_count == 2);
+    assert(result.output.head->len == fill);                   /* untouched */
+    assert(result.output.tail->len == 14);
+    assert(memcmp(result.output.tail->data, "overflow-12345", 14) == 0);
+
+    /* Exactly filling the room fits; the NUL byte forces the next chunk */
+    transform_output_free(&result.output);
+    transform_append(&result, filler, fill);
+    transform_appendf(&result, "%09d", 7);                      /* 9 bytes */
+    assert(result.output.chunk_count == 1);
+    transform_appendf(&result, "%s", "z");                      /* 1 byte, no room for NUL */
+    assert(result.output.chunk_count == 2);
+    assert(result.output.head->len == fill + 9);
+    assert(result.output.tail->len == 1 && result.output.tail->data[0] == 'z');
+
+    /* One line bigger than a whole chunk gets a chunk of its own size */
+    size_t big = RIFT_TRANSFORM_CHUNK * 2 + 3;
+    char* huge = malloc(big + 1);
+    assert(huge != NULL);
+    memset(huge, 'h', big);
+    huge[big] = '\0';
+    transform_appendf(&result, "<%s>", huge);
+    assert(result.output.chunk_count == 3);
+    assert(result.output.tail->len == big + 2);
+    assert(result.output.tail->capacity == big + 3);
+    assert(result.output.size == fill + 9 + 1 + big + 2);
+
+    char* expected = malloc(result.output.size);
+    assert(expected != NULL);
+    memcpy(expected, filler, fill);
+    memcpy(expected + fill, "000000007z<", 11);
+    memcpy(expected + fill + 11, huge, big);
+    expected[fill + 11 + big] = '>';
+    check_output(&result.output, expected, result.output.size);
+
+    transform_output_free(&result.output);
+    free(expected);
+    free(huge);
+    free(filler);
+}
+
+/* Once a reservation fails, the output is frozen and never written */
+TEST(test_failed_output_is_frozen) {
+    TransformResult result;
+    memset(&result, 0, sizeof(result));
+    TRANSFORM_APPEND_LITERAL(&result, "kept\n");
+
+    /* Too large to allocate at all: refused before malloc */
+    assert(!transform_reserve(&result.output, SIZE_MAX - 4));
+    assert(result.output.failed);
+
+    TRANSFORM_APPEND_LITERAL(&result, "dropped\n");
+    transform_appendf(&result, "%s\n", "dropped");
+    assert(!transform_reserve(&result.output, 1));
+    assert(result.output.size == 5 && result.output.chunk_count == 1);
+    assert(memcmp(result.output.head->data, "kept\n", 5) == 0);
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/failed.c", g_dir);
+    assert(transform_output_write(path, &result.output) == ENOMEM);
+    assert(access(path, F_OK) != 0);
+
+    transform_output_free(&result.output);
+    assert(!result.output.failed);
+}
+
+/* The file holds the chunks back to back; an identical rewrite leaves it be */
+TEST(test_output_written_byte_for_byte) {
+    TransformResult result;
+    memset(&result, 0, sizeof(result));
+    size_t size = 0;
+    char* expected = malloc(3 * RIFT_TRANSFORM_CHUNK);
+    assert(expected != NULL);
+    for (int i = 0; size < 2 * RIFT_TRANSFORM_CHUNK + 100; i++) {
+        int n = snprintf(expected + size, 64, "rift_span_%d();\n", i);
+        transform_appendf(&result, "rift_span_%d();\n", i);
+        size += (size_t)n;
+    }
+    assert(result.output.chunk_count >= 3);
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/out.c", g_dir);
+    assert(transform_output_write(path, &result.output) == 0);
+    size_t written = 0;
+    char* data = read_file(path, &written);
+    assert(written == size && memcmp(data, expected, size) == 0);
+    free(data);
+
+    struct stat before, after;
+    assert(stat(path, &before) == 0);
+    assert(transform_output_write(path, &result.output) == 0);
+    assert(stat(path, &after) == 0);
+    assert(before.st_ino == after.st_ino);
+    assert(before.st_mtim.tv_sec == after.st_mtim.tv_sec &&
+           before.st_mtim.tv_nsec == after.st_mtim.tv_nsec);
+
+    /* A changed byte is written out */
+    result.output.tail->data[0] = '#';
+    expected[size - result.output.tail->len] = '#';
+    assert(transform_output_write(path, &result.output) == 0);
+    data = read_file(path, &written);
+    assert(written == size && memcmp(data, expected, size) == 0);
+    free(data);
+
+    remove(path);
+    transform_output_free(&result.output);
+    free(expected);
+}
+
+int main(void) {
+    strcpy(g_dir, "/tmp/riftlang-test-XXXXXX");
+    assert(mkdtemp(g_dir) != NULL);
+
+    printf("test_transform_output:\n");
+    RUN(test_output_spans_chunks);
+    RUN(test_appendf_overflows_chunk);
+    RUN(test_failed_output_is_frozen);
+    RUN(test_output_written_byte_for_byte);
+
+    rmdir(g_dir);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
@@ -1,8 +1,40 @@
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include "rift/cli.h"
 #include "rift/lexer.h"
 
+typedef enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV } tokenize_format_t;
+
+static void print_json_string(const char *s, size_t len) {
+    putchar('"');
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            putchar('\\');
+            putchar(c);
+        } else if (c == '\n') {
+            fputs("\\n", stdout);
+        } else if (c == '\t') {
+            fputs("\\t", stdout);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+static void print_csv_field(const char *s, size_t len) {
+    putchar('"');
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '"') putchar('"');
+        putchar(s[i]);
+    }
+    putchar('"');
+}
+
 int rift_cmd_tokenize(int argc, char **argv) {
     if (argc < 2 || strcmp(argv[1], "--help") == 0) {
         printf("Usage: rift tokenize [options] <input-file>\n\n");
@@ -10,9 +42,83 @@ int rift_cmd_tokenize(int argc, char **argv) {
         printf("Options:\n");
         printf("  --format <f>  Output format (text, json, csv)\n");
         printf("  --help        Show this help message\n");
+        printf("\nUse '-' as the input file to read standard input.\n");
         return 0;
     }
 
-    printf("rift tokenize: tokenizer ready for '%s'\n", argv[1]);
+    const char *input = NULL;
+    tokenize_format_t format = FORMAT_TEXT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char *f = argv[++i];
+            if (strcmp(f, "text") == 0) {
+                format = FORMAT_TEXT;
+            } else if (strcmp(f, "json") == 0) {
+                format = FORMAT_JSON;
+            } else if (strcmp(f, "csv") == 0) {
+                format = FORMAT_CSV;
+            } else {
+                fprintf(stderr, "rift tokenize: unknown format '%s'\n", f);
+                return 1;
+            }
+        } else if (!input) {
+            input = argv[i];
+        }
+    }
+
+    if (!input) {
+        fprintf(stderr, "rift tokenize: no input file specified\n");
+        return 1;
+    }
+
+    rift_file_map_t file;
+    if (rift_file_map(input, &file) != 0) {
+        fprintf(stderr, "rift tokenize: cannot read '%s': %s\n", input, strerror(errno));
+        return 1;
+    }
+
+    rift_lexer_t *lexer = rift_lexer_create_ex(file.data, file.size, RIFT_LEXER_ZERO_COPY);
+    rift_token_buffer_t tokens;
+    if (!lexer || !rift_lexer_tokenize_all(lexer, &tokens)) {
+        fprintf(stderr, "rift tokenize: cannot tokenize '%s'\n", input);
+        rift_lexer_destroy(lexer);
+        rift_file_unmap(&file);
+        return 1;
+    }
+
+    if (format == FORMAT_JSON) printf("[\n");
+    if (format == FORMAT_CSV) printf("line,column,type,value\n");
+
+    for (size_t i = 0; i < tokens.count; i++) {
+        uint32_t line, column;
+        rift_token_buffer_locate(&tokens, i, &line, &column);
+        const char *type = rift_token_type_name((rift_token_type_t)tokens.types[i]);
+        const char *value = tokens.source + tokens.offsets[i];
+        size_t len = tokens.lengths[i];
+
+        switch (format) {
+        case FORMAT_TEXT:
+            printf("%u:%u\t%s\t%.*s\n", line, column, type, (int)len, value);
+            break;
+        case FORMAT_JSON:
+            printf("  {\"line\": %u, \"column\": %u, \"type\": \"%s\", \"value\": ",
+                   line, column, type);
+            print_json_string(value, len);
+            printf("}%s\n", i + 1 < tokens.count ? "," : "");
+            break;
+        case FORMAT_CSV:
+            printf("%u,%u,%s,", line, column, type);
+            print_csv_field(value, len);
+            putchar('\n');
+            break;
+        }
+    }
+
+    if (format == FORMAT_JSON) printf("]\n");
+
+    rift_token_buffer_free(&tokens);
+    rift_lexer_destroy(lexer);
+    rift_file_unmap(&file);
     return 0;
 }
@@ -14,6 +14,28 @@ int rift_link(const char *source, size_t length, rift_cir_program_t *out) {
     return 0;
 }
 
+int rift_cir_program_append(rift_cir_program_t *program, const rift_cir_node_t *node) {
+    if (!program || !node) return -1;
+
+    if (program->node_count == program->node_capacity) {
+        int capacity = program->node_capacity ? program->node_capacity * 2 : 64;
+        rift_cir_node_t *nodes = realloc(program->nodes, (size_t)capacity * sizeof(*nodes));
+        if (!nodes) return -1;
+        program->nodes = nodes;
+        program->node_capacity = capacity;
+    }
+    program->nodes[program->node_count++] = *node;
+    return 0;
+}
+
+void rift_cir_program_free(rift_cir_program_t *program) {
+    if (!program) return;
+    free(program->nodes);
+    program->nodes = NULL;
+    program->node_count = 0;
+    program->node_capacity = 0;
+}
+
 int rift_codec_emit(const rift_cir_program_t *program, const char *target,
                      const char *output_path) {
     if (!program || !target) return -1;
@@ -0,0 +1,76 @@
+#include "rift/lines.h"
+#include <stdlib.h>
+#include <string.h>
+
+int rift_line_index_build(rift_line_index_t *index, const char *source, size_t length) {
+    if (!index || !source) return 0;
+    memset(index, 0, sizeof(*index));
+    if (length > UINT32_MAX) return 0;   /* starts are 32-bit */
+
+    /* Guess ~32 bytes per line; grows if the guess is short */
+    size_t capacity = length / 32 + 1;
+    uint32_t *starts = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+    if (!starts) return 0;
+
+    /* memchr is vectorized in every libc we build against; a trailing
+     * '\n' ends the last line and opens no new one */
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < length) {
+        if (count == capacity) {
+            uint32_t *grown = (uint32_t *)realloc(starts, capacity * 2 * sizeof(uint32_t));
+            if (!grown) {
+                free(starts);
+                return 0;
+            }
+            starts = grown;
+            capacity *= 2;
+        }
+        starts[count++] = (uint32_t)pos;
+        const char *nl = (const char *)memchr(source + pos, '\n', length - pos);
+        if (!nl) break;
+        pos = (size_t)(nl - source) + 1;
+    }
+
+    index->source = source;
+    index->length = length;
+    index->starts = starts;
+    index->count = count;
+    return 1;
+}
+
+void rift_line_index_free(rift_line_index_t *index) {
+    if (!index) return;
+    free(index->starts);
+    memset(index, 0, sizeof(*index));
+}
+
+void rift_line_index_locate(const rift_line_index_t *index, size_t offset,
+                            uint32_t *line, uint32_t *column) {
+    uint32_t l = 1, c = 1;
+    if (index && index->count) {
+        if (offset > index->length) offset = index->length;
+        /* Last line start <= offset */
+        size_t lo = 0, hi = index->count;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (index->starts[mid] <= offset) lo = mid;
+            else hi = mid;
+        }
+        l = (uint32_t)(lo + 1);
+        c = (uint32_t)(offset - index->starts[lo] + 1);
+    }
+    if (line) *line = l;
+    if (column) *column = c;
+}
+
+const char *rift_line_index_line(const rift_line_index_t *index, uint32_t line,
+                                 size_t *length) {
+    if (!index || line == 0 || line > index->count) return NULL;
+    size_t start = index->starts[line - 1];
+    size_t end = (line < index->count) ? index->starts[line] - 1 : index->length;
+    /* The last line may still end in '\n' */
+    if (line == index->count && end > start && index->source[end - 1] == '\n') end--;
+    if (length) *length = end - start;
+    return index->source + start;
+}
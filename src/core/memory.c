@@ -44,7 +44,7 @@ rift_memory_span_t rift_memory_alloc(size_t size, uint32_t alignment) {
 
 void rift_memory_free(rift_memory_span_t *span) {
     if (!span || !span->ptr) return;
-    if (span->flags & RIFT_MEM_STATIC) return;
+    if (span->flags & (RIFT_MEM_STATIC | RIFT_MEM_ARENA)) return;
 
     RIFT_ALIGNED_FREE(span->ptr);
 
@@ -59,3 +59,114 @@ int rift_memory_validate(const rift_memory_span_t *span) {
     if (span->ptr && ((uintptr_t)span->ptr % span->alignment != 0)) return 0;
     return 1;
 }
+
+/* --- Arena --- */
+
+struct rift_memory_chunk {
+    rift_memory_chunk_t *next;
+    size_t               size;      /* usable bytes after the header */
+    size_t               used;
+};
+
+/* Header rounded up so chunk data starts cache-line aligned */
+#define RIFT_ARENA_HEADER \
+    ((sizeof(rift_memory_chunk_t) + RIFT_MEMORY_ALIGN_CACHE - 1) & ~(size_t)(RIFT_MEMORY_ALIGN_CACHE - 1))
+
+static char *arena_chunk_data(rift_memory_chunk_t *chunk) {
+    return (char *)chunk + RIFT_ARENA_HEADER;
+}
+
+/* Offset of the next `alignment`-aligned byte at or after chunk->used */
+static size_t arena_chunk_offset(rift_memory_chunk_t *chunk, uint32_t alignment) {
+    uintptr_t next = (uintptr_t)(arena_chunk_data(chunk) + chunk->used);
+    uintptr_t aligned = (next + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return chunk->used + (size_t)(aligned - next);
+}
+
+static rift_memory_chunk_t *arena_chunk_create(size_t size) {
+    if (size > SIZE_MAX - RIFT_ARENA_HEADER) return NULL;
+    rift_memory_chunk_t *chunk =
+        (rift_memory_chunk_t *)RIFT_ALIGNED_ALLOC(RIFT_ARENA_HEADER + size, RIFT_MEMORY_ALIGN_CACHE);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+/* A chunk that fits size bytes at alignment. Regular chunks become the one
+ * being filled; an oversized request gets its own chunk behind it, so the
+ * space left in the current chunk is not given up. */
+static rift_memory_chunk_t *arena_grow(rift_memory_arena_t *arena, size_t size, uint32_t alignment) {
+    size_t slack = alignment > RIFT_MEMORY_ALIGN_CACHE ? alignment - RIFT_MEMORY_ALIGN_CACHE : 0;
+    if (size > SIZE_MAX - slack) return NULL;
+    size_t need = size + slack;
+
+    int oversized = need > arena->chunk_size;
+    rift_memory_chunk_t *chunk = arena_chunk_create(oversized ? need : arena->chunk_size);
+    if (!chunk) return NULL;
+
+    if (oversized && arena->chunks) {
+        chunk->next = arena->chunks->next;
+        arena->chunks->next = chunk;
+    } else {
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    return chunk;
+}
+
+void rift_memory_arena_init(rift_memory_arena_t *arena, size_t chunk_size) {
+    if (!arena) return;
+    arena->chunks = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : RIFT_MEMORY_ARENA_CHUNK;
+}
+
+rift_memory_span_t rift_memory_arena_alloc(rift_memory_arena_t *arena, size_t size, uint32_t alignment) {
+    rift_memory_span_t span;
+    memset(&span, 0, sizeof(span));
+
+    if (!arena || size == 0) return span;
+    if (alignment == 0) alignment = RIFT_MEMORY_ALIGN_DEFAULT;
+    if (alignment & (alignment - 1)) return span;
+
+    rift_memory_chunk_t *chunk = arena->chunks;
+    size_t offset = chunk ? arena_chunk_offset(chunk, alignment) : 0;
+    if (!chunk || offset > chunk->size || size > chunk->size - offset) {
+        chunk = arena_grow(arena, size, alignment);
+        if (!chunk) return span;
+        offset = arena_chunk_offset(chunk, alignment);
+    }
+    chunk->used = offset + size;
+
+    span.ptr = arena_chunk_data(chunk) + offset;
+    span.size = size;
+    span.alignment = alignment;
+    span.flags = RIFT_MEM_ARENA;
+    memset(span.ptr, 0, size);
+    return span;
+}
+
+void rift_memory_arena_reset(rift_memory_arena_t *arena) {
+    if (!arena || !arena->chunks) return;
+    rift_memory_chunk_t *keep = arena->chunks;
+    rift_memory_chunk_t *chunk = keep->next;
+    while (chunk) {
+        rift_memory_chunk_t *next = chunk->next;
+        RIFT_ALIGNED_FREE(chunk);
+        chunk = next;
+    }
+    keep->next = NULL;
+    keep->used = 0;
+}
+
+void rift_memory_arena_release(rift_memory_arena_t *arena) {
+    if (!arena) return;
+    rift_memory_chunk_t *chunk = arena->chunks;
+    while (chunk) {
+        rift_memory_chunk_t *next = chunk->next;
+        RIFT_ALIGNED_FREE(chunk);
+        chunk = next;
+    }
+    arena->chunks = NULL;
+}
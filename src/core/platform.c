@@ -1,7 +1,21 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#  define _DEFAULT_SOURCE   /* mmap flags, madvise under -std=c11 */
+#endif
 #include "rift/platform.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
-#if !defined(RIFT_PLATFORM_WINDOWS)
+#if defined(RIFT_PLATFORM_WINDOWS)
+#  include <fcntl.h>
+#  include <io.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
 #  include <time.h>
+#  include <unistd.h>
 #endif
 
 /* Mutex implementation */
@@ -94,3 +108,126 @@ double rift_time_ms(void) {
     return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
 #endif
 }
+
+/* File mapping */
+
+#if defined(RIFT_PLATFORM_WINDOWS)
+#  define RIFT_READ(fd, buf, n) _read((fd), (buf), (unsigned)((n) > INT_MAX ? INT_MAX : (n)))
+#  define RIFT_CLOSE(fd)        _close(fd)
+#else
+#  define RIFT_READ(fd, buf, n) read((fd), (buf), (n))
+#  define RIFT_CLOSE(fd)        close(fd)
+#endif
+
+/* Read fd to EOF into a NUL-terminated heap block; `hint` sizes the first try */
+static int file_read_all(int fd, size_t hint, rift_file_map_t *map) {
+    size_t capacity = (hint ? hint : 64 * 1024) + 1;
+    size_t size = 0;
+    char *buf = (char *)malloc(capacity);
+    if (!buf) return -1;
+
+    for (;;) {
+        if (size + 1 == capacity) {
+            char *grown = (char *)realloc(buf, capacity * 2);
+            if (!grown) {
+                free(buf);
+                errno = ENOMEM;
+                return -1;
+            }
+            buf = grown;
+            capacity *= 2;
+        }
+        long n = (long)RIFT_READ(fd, buf + size, capacity - 1 - size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(buf);
+            return -1;
+        }
+        if (n == 0) break;
+        size += (size_t)n;
+    }
+    buf[size] = '\0';
+
+    map->data = buf;
+    map->size = size;
+    map->base = buf;
+    map->base_size = 0;
+    return 0;
+}
+
+#if !defined(RIFT_PLATFORM_WINDOWS)
+/*
+ * Map `size` bytes of fd into a reservation one page longer than needed,
+ * so the byte after the file lands in zeroed anonymous memory and the
+ * contents stay NUL-terminated without a copy.
+ */
+static int file_map_fd(int fd, size_t size, rift_file_map_t *map) {
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) return -1;
+    size_t reserve = (size / (size_t)page + 1) * (size_t)page;
+
+    void *base = mmap(NULL, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return -1;
+    if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, reserve);
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    map->data = (const char *)base;
+    map->size = size;
+    map->base = base;
+    map->base_size = reserve;
+    return 0;
+}
+#endif
+
+int rift_file_map(const char *path, rift_file_map_t *map) {
+    if (!path || !map) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(map, 0, sizeof(*map));
+
+    int is_stdin = strcmp(path, "-") == 0;
+#if defined(RIFT_PLATFORM_WINDOWS)
+    int fd = is_stdin ? 0 : _open(path, _O_RDONLY | _O_BINARY);
+#else
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0) return -1;
+
+    size_t hint = 0;
+    int rc = -1;
+#if !defined(RIFT_PLATFORM_WINDOWS)
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        if ((unsigned long long)st.st_size >= (unsigned long long)SIZE_MAX) {
+            if (!is_stdin) RIFT_CLOSE(fd);
+            errno = EFBIG;
+            return -1;
+        }
+        hint = (size_t)st.st_size;
+        rc = file_map_fd(fd, hint, map);
+    }
+#endif
+    if (rc != 0) rc = file_read_all(fd, hint, map);
+
+    int saved = errno;
+    if (!is_stdin) RIFT_CLOSE(fd);
+    errno = saved;
+    return rc;
+}
+
+void rift_file_unmap(rift_file_map_t *map) {
+    if (!map) return;
+#if !defined(RIFT_PLATFORM_WINDOWS)
+    if (map->base_size) {
+        munmap(map->base, map->base_size);
+    } else
+#endif
+    {
+        free(map->base);
+    }
+    memset(map, 0, sizeof(*map));
+}
@@ -7,6 +7,7 @@ rift_context_t *rift_init(void) {
     rift_context_t *ctx = (rift_context_t *)calloc(1, sizeof(rift_context_t));
     if (!ctx) return NULL;
 
+    rift_memory_arena_init(&ctx->arena, 0);
     ctx->last_error = RIFT_SUCCESS;
     return ctx;
 }
@@ -22,6 +23,7 @@ void rift_cleanup(rift_context_t *ctx) {
     if (ctx->bridge)   rift_bridge_destroy(ctx->bridge);
     if (ctx->pattern)  rift_pattern_destroy(ctx->pattern);
 
+    rift_memory_arena_release(&ctx->arena);
     free(ctx);
 }
 
@@ -36,9 +38,52 @@ rift_error_t rift_compile(rift_context_t *ctx,
         printf("rift: compiling %s\n", input_path);
     }
 
-    /* TODO: wire full Z->Y->X internal pipeline */
-    ctx->last_error = RIFT_SUCCESS;
-    return RIFT_SUCCESS;
+    /* Source is mapped, not copied; the lexer reads it in place */
+    rift_file_map_t source;
+    if (rift_file_map(input_path, &source) != 0) {
+        ctx->last_error = RIFT_ERROR_FILE_ACCESS;
+        return ctx->last_error;
+    }
+
+    if (ctx->verbose) {
+        printf("rift: %zu bytes (%s)\n", source.size, source.base_size ? "mapped" : "read");
+    }
+
+    /* Tokens view the mapping, so it stays until the stages are done */
+    rift_error_t err = RIFT_SUCCESS;
+    rift_token_buffer_t tokens;
+    memset(&tokens, 0, sizeof(tokens));
+    rift_lexer_t *lexer = rift_lexer_create_ex(source.data, source.size, RIFT_LEXER_ZERO_COPY);
+    rift_parser_t *parser = NULL;
+    if (!lexer || !rift_lexer_tokenize_all(lexer, &tokens)) {
+        err = RIFT_ERROR_MEMORY_ALLOCATION;
+    } else if (!(parser = rift_parser_create_from_buffer(&tokens))) {
+        err = RIFT_ERROR_MEMORY_ALLOCATION;
+    } else {
+        if (ctx->verbose) {
+            printf("rift: %zu tokens\n", tokens.count);
+        }
+        rift_parser_set_arena(parser, &ctx->arena);
+        rift_ast_node_t *ast = rift_parser_parse(parser);
+        if (!ast) {
+            err = RIFT_ERROR_PARSE_FAILURE;
+        }
+
+        /* TODO: wire full Z->Y->X internal pipeline */
+
+        rift_ast_free(ast);
+    }
+
+    rift_parser_destroy(parser);
+    rift_token_buffer_free(&tokens);
+    rift_lexer_destroy(lexer);
+
+    /* The AST was carved from ctx->arena (tokens are views, so they need
+     * none); it dies with this compile, one chunk stays for the next */
+    rift_memory_arena_reset(&ctx->arena);
+    rift_file_unmap(&source);
+    ctx->last_error = err;
+    return err;
 }
 
 static const char *error_strings[] = {
@@ -20,6 +20,88 @@ rift_token_t rift_token_create(rift_token_type_t type, const char *value) {
     return token;
 }
 
+rift_token_t rift_token_create_n(rift_token_type_t type, const char *value, size_t length) {
+    rift_token_t token;
+    memset(&token, 0, sizeof(token));
+    token.type = type;
+
+    if (value) {
+        token.memory.ptr = (void *)value;
+        token.memory.size = length;
+        token.memory.alignment = 1;
+        token.memory.flags = RIFT_MEM_STATIC | RIFT_MEM_READONLY;
+        token.value.str = (char *)value;
+    }
+
+    token.validation_bits = 0x07;
+    return token;
+}
+
+int rift_token_is_view(const rift_token_t *token) {
+    return token && token->memory.ptr && (token->memory.flags & RIFT_MEM_STATIC);
+}
+
+const char *rift_token_view(const rift_token_t *token, size_t *length) {
+    if (!token || !token->memory.ptr) {
+        if (length) *length = 0;
+        return NULL;
+    }
+    if (length) {
+        /* Owned spans carry the terminating NUL, views do not */
+        *length = rift_token_is_view(token) ? token->memory.size : token->memory.size - 1;
+    }
+    return (const char *)token->memory.ptr;
+}
+
+int rift_token_materialize(rift_token_t *token) {
+    return rift_token_materialize_in(token, NULL);
+}
+
+int rift_token_materialize_in(rift_token_t *token, rift_memory_arena_t *arena) {
+    if (!token) return 0;
+    if (!rift_token_is_view(token)) return 1;
+
+    size_t len = token->memory.size;
+    rift_memory_span_t span = arena
+        ? rift_memory_arena_alloc(arena, len + 1, RIFT_MEMORY_ALIGN_DEFAULT)
+        : rift_memory_alloc(len + 1, RIFT_MEMORY_ALIGN_DEFAULT);
+    if (!span.ptr) return 0;
+
+    memcpy(span.ptr, token->memory.ptr, len);   /* alloc zeroes the NUL */
+    token->memory = span;
+    token->value.str = (char *)span.ptr;
+    return 1;
+}
+
+rift_token_t rift_token_buffer_get(const rift_token_buffer_t *buffer, size_t index) {
+    if (!buffer || index >= buffer->count) {
+        return rift_token_create(RIFT_TOKEN_EOF, NULL);
+    }
+    rift_token_t token = rift_token_create_n((rift_token_type_t)buffer->types[index],
+                                             buffer->source + buffer->offsets[index],
+                                             buffer->lengths[index]);
+    rift_token_buffer_locate(buffer, index, &token.line, &token.column);
+    return token;
+}
+
+void rift_token_buffer_locate(const rift_token_buffer_t *buffer, size_t index,
+                              uint32_t *line, uint32_t *column) {
+    size_t offset = (buffer && index < buffer->count)
+        ? (size_t)buffer->offsets[index] - buffer->leads[index]
+        : (buffer ? buffer->lines.length : 0);
+    rift_line_index_locate(buffer ? &buffer->lines : NULL, offset, line, column);
+}
+
+void rift_token_buffer_free(rift_token_buffer_t *buffer) {
+    if (!buffer) return;
+    free(buffer->types);
+    free(buffer->offsets);
+    free(buffer->lengths);
+    free(buffer->leads);
+    rift_line_index_free(&buffer->lines);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
 void rift_token_destroy(rift_token_t *token) {
     if (!token) return;
     rift_memory_free(&token->memory);
@@ -28,7 +110,7 @@ void rift_token_destroy(rift_token_t *token) {
 
 int rift_token_validate(const rift_token_t *token) {
     if (!token) return 0;
-    if (token->type == RIFT_TOKEN_UNKNOWN) return 0;
+    if (token->type == RIFT_TOKEN_UNKNOWN || token->type == RIFT_TOKEN_ERROR) return 0;
     if ((token->validation_bits & 0x07) != 0x07) return 0;
     return rift_memory_validate(&token->memory);
 }
@@ -37,10 +119,10 @@ static const char *token_type_names[] = {
     "EOF", "KEYWORD", "IDENTIFIER",
     "LITERAL_INT", "LITERAL_FLOAT", "LITERAL_STRING", "LITERAL_CHAR",
     "OPERATOR", "DELIMITER", "COMMENT", "WHITESPACE",
-    "PATTERN_STATIC", "PATTERN_DYNAMIC", "HEXDUMP", "UNKNOWN"
+    "PATTERN_STATIC", "PATTERN_DYNAMIC", "HEXDUMP", "UNKNOWN", "ERROR"
 };
 
 const char *rift_token_type_name(rift_token_type_t type) {
-    if (type < 0 || type > RIFT_TOKEN_UNKNOWN) return "INVALID";
+    if (type < 0 || type > RIFT_TOKEN_ERROR) return "INVALID";
     return token_type_names[type];
 }
@@ -1,4 +1,5 @@
 #include "rift/lexer.h"
+#include "rift/scan.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -7,11 +8,20 @@ struct rift_lexer {
     const char *source;
     size_t      length;
     size_t      pos;
-    uint32_t    line;
-    uint32_t    column;
+    size_t      line_pos;       /* newlines are counted up to here... */
+    size_t      line_start;     /* ...giving the start of its line... */
+    uint32_t    line;           /* ...and that line's number */
+    uint32_t    flags;
+    const char *const *keywords;    /* extra keywords, caller-owned */
+    size_t      keyword_count;
+    rift_memory_arena_t *arena;     /* copy-mode values, caller-owned */
 };
 
 rift_lexer_t *rift_lexer_create(const char *source, size_t length) {
+    return rift_lexer_create_ex(source, length, 0);
+}
+
+rift_lexer_t *rift_lexer_create_ex(const char *source, size_t length, uint32_t flags) {
     if (!source) return NULL;
 
     rift_lexer_t *lexer = (rift_lexer_t *)calloc(1, sizeof(rift_lexer_t));
@@ -21,7 +31,7 @@ rift_lexer_t *rift_lexer_create(const char *source, size_t length) {
     lexer->length = length;
     lexer->pos = 0;
     lexer->line = 1;
-    lexer->column = 1;
+    lexer->flags = flags;
 
     return lexer;
 }
@@ -30,39 +40,172 @@ void rift_lexer_destroy(rift_lexer_t *lexer) {
     free(lexer);
 }
 
+int rift_lexer_set_keywords(rift_lexer_t *lexer, const char *const *keywords, size_t count) {
+    if (!lexer || (!keywords && count)) return 0;
+    lexer->keywords = keywords;
+    lexer->keyword_count = count;
+    return 1;
+}
+
+int rift_lexer_set_arena(rift_lexer_t *lexer, rift_memory_arena_t *arena) {
+    if (!lexer) return 0;
+    lexer->arena = arena;
+    return 1;
+}
+
+#define KW(word) (len == sizeof(word) - 1 && memcmp(p, word, sizeof(word) - 1) == 0)
+
+/* Built-in keywords: dispatch on length, then first byte */
+static int lexer_is_core_keyword(const char *p, size_t len) {
+    switch (len) {
+    case 2:
+        return p[0] == 'f' ? KW("fn") : p[0] == 'i' ? KW("if") : 0;
+    case 3:
+        switch (p[0]) {
+        case 'l': return KW("let");
+        case 'f': return KW("for");
+        case 'd': return KW("def");
+        }
+        return 0;
+    case 4:
+        return p[0] == 'e' ? KW("else") : p[0] == 't' ? KW("true") : 0;
+    case 5:
+        switch (p[0]) {
+        case 'w': return KW("while");
+        case 'b': return KW("break");
+        case 'p': return KW("print");
+        case 'f': return KW("false");
+        }
+        return 0;
+    case 6:
+        return p[0] == 'r' && KW("return");
+    case 8:
+        return p[0] == 'c' && KW("continue");
+    }
+    return 0;
+}
+
+#undef KW
+
+static int lexer_is_keyword(const rift_lexer_t *lexer, const char *p, size_t len) {
+    if (lexer_is_core_keyword(p, len)) return 1;
+    for (size_t i = 0; i < lexer->keyword_count; i++) {
+        const char *kw = lexer->keywords[i];
+        if (kw[0] == p[0] && strncmp(kw, p, len) == 0 && kw[len] == '\0') return 1;
+    }
+    return 0;
+}
+
 static char lexer_current(const rift_lexer_t *lexer) {
     if (lexer->pos >= lexer->length) return '\0';
     return lexer->source[lexer->pos];
 }
 
-static char lexer_advance(rift_lexer_t *lexer) {
-    char c = lexer_current(lexer);
-    if (c == '\n') {
-        lexer->line++;
-        lexer->column = 1;
+static void lexer_advance(rift_lexer_t *lexer) {
+    lexer->pos++;
+}
+
+/* ASCII classes matching the scan kernels (and <ctype.h> in the C locale) */
+static inline int lexer_is_space(int c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline int lexer_is_ident(int c) {
+    return (unsigned)((c | 0x20) - 'a') < 26 || (unsigned)(c - '0') < 10 || c == '_';
+}
+static inline int lexer_is_digit(int c) { return (unsigned)(c - '0') < 10 || c == '.'; }
+
+/*
+ * End of the character-class run starting at `start`. Most runs in real
+ * sources are a few bytes long, so the first LEXER_SHORT_RUN bytes are
+ * tested inline and only longer runs go to the vector scan kernel.
+ */
+#define LEXER_SHORT_RUN 8
+
+static inline size_t lexer_run_end(const rift_lexer_t *lexer, size_t start,
+                                   int (*is_class)(int),
+                                   size_t (*kernel)(const char *, size_t, size_t)) {
+    size_t end = start;
+    size_t stop = (lexer->length - start > LEXER_SHORT_RUN) ? start + LEXER_SHORT_RUN : lexer->length;
+    while (end < stop && is_class((unsigned char)lexer->source[end])) end++;
+    if (end == stop && end < lexer->length) {
+        end = kernel(lexer->source, end, lexer->length);
+    }
+    return end;
+}
+
+/*
+ * Line and column are not tracked while scanning: a token's position is
+ * resolved from its offset by counting newlines since the last resolved
+ * offset, so rift_lexer_next pays once per token rather than once per
+ * byte and rift_lexer_tokenize_all not at all.
+ */
+static void lexer_locate(rift_lexer_t *lexer, size_t offset, uint32_t *line, uint32_t *column) {
+    if (offset < lexer->line_pos) {
+        lexer->line_pos = lexer->line_start = 0;
+        lexer->line = 1;
+    }
+    size_t span = offset - lexer->line_pos;
+    size_t newlines = 0;
+    if (span < 16) {
+        /* Short spans (the common case) are cheaper to count inline */
+        for (size_t i = lexer->line_pos; i < offset; i++) newlines += (lexer->source[i] == '\n');
     } else {
-        lexer->column++;
+        newlines = rift_scan_count_newlines(lexer->source + lexer->line_pos, span);
     }
-    lexer->pos++;
-    return c;
+    if (newlines) {
+        size_t last = offset - 1;
+        while (lexer->source[last] != '\n') last--;
+        lexer->line += (uint32_t)newlines;
+        lexer->line_start = last + 1;
+    }
+    lexer->line_pos = offset;
+    *line = lexer->line;
+    *column = (uint32_t)(offset - lexer->line_start + 1);
 }
 
-rift_token_t rift_lexer_next(rift_lexer_t *lexer) {
-    if (!lexer || lexer->pos >= lexer->length) {
-        return rift_token_create(RIFT_TOKEN_EOF, NULL);
+/*
+ * Whitespace runs are usually a newline plus indentation: walk the first
+ * LEXER_SHORT_RUN bytes directly and hand longer runs to the kernels.
+ */
+static void lexer_skip_whitespace(rift_lexer_t *lexer) {
+    size_t stop = (lexer->length - lexer->pos > LEXER_SHORT_RUN)
+        ? lexer->pos + LEXER_SHORT_RUN : lexer->length;
+    while (lexer->pos < stop && lexer_is_space((unsigned char)lexer->source[lexer->pos])) {
+        lexer->pos++;
+    }
+    if (lexer->pos == stop && lexer->pos < lexer->length) {
+        lexer->pos = rift_scan_whitespace(lexer->source, lexer->pos, lexer->length);
     }
+}
 
-    /* Skip whitespace */
-    while (lexer->pos < lexer->length && isspace(lexer_current(lexer))) {
-        lexer_advance(lexer);
+/* One scanned token: source[start, start + len) */
+typedef struct lexer_span {
+    rift_token_type_t type;
+    size_t            start;
+    size_t            len;
+    size_t            offset;       /* where the token begins, delimiters included */
+} lexer_span_t;
+
+static int lexer_span(lexer_span_t *span, rift_token_type_t type,
+                      size_t start, size_t len, size_t offset) {
+    span->type = type;
+    span->start = start;
+    span->len = len;
+    span->offset = offset;
+    return 1;
+}
+
+/* Scan the next token without materializing it; 0 at end of input */
+static int lexer_scan(rift_lexer_t *lexer, lexer_span_t *span) {
+    if (lexer->pos >= lexer->length) {
+        return 0;
     }
 
+    lexer_skip_whitespace(lexer);
+
     if (lexer->pos >= lexer->length) {
-        return rift_token_create(RIFT_TOKEN_EOF, NULL);
+        return 0;
     }
 
-    uint32_t start_line = lexer->line;
-    uint32_t start_col = lexer->column;
+    size_t offset = lexer->pos;
     char c = lexer_current(lexer);
 
     /* R"" static pattern or R'' dynamic pattern */
@@ -94,11 +237,6 @@ rift_token_t rift_lexer_next(rift_lexer_t *lexer) {
             }
 
             size_t len = lexer->pos - start;
-            char *buf = (char *)malloc(len + 1);
-            if (buf) {
-                memcpy(buf, lexer->source + start, len);
-                buf[len] = '\0';
-            }
 
             /* Skip closing delimiters */
             if (lexer->pos < lexer->length) lexer_advance(lexer);
@@ -106,96 +244,51 @@ rift_token_t rift_lexer_next(rift_lexer_t *lexer) {
                 lexer_advance(lexer);
             }
 
-            rift_token_t token = rift_token_create(type, buf);
-            token.line = start_line;
-            token.column = start_col;
-            free(buf);
-            return token;
+            return lexer_span(span, type, start, len, offset);
         }
     }
 
     /* Identifier or keyword */
-    if (isalpha(c) || c == '_') {
+    if (isalpha((unsigned char)c) || c == '_') {
         size_t start = lexer->pos;
-        while (lexer->pos < lexer->length &&
-               (isalnum(lexer_current(lexer)) || lexer_current(lexer) == '_')) {
-            lexer_advance(lexer);
-        }
+        lexer->pos = lexer_run_end(lexer, start, lexer_is_ident, rift_scan_ident);
         size_t len = lexer->pos - start;
-        char *buf = (char *)malloc(len + 1);
-        if (buf) {
-            memcpy(buf, lexer->source + start, len);
-            buf[len] = '\0';
-        }
 
-        /* Check keywords */
-        rift_token_type_t type = RIFT_TOKEN_IDENTIFIER;
-        const char *keywords[] = {
-            "let", "fn", "if", "else", "while", "for", "return",
-            "break", "continue", "def", "print", "true", "false", NULL
-        };
-        for (int i = 0; keywords[i]; i++) {
-            if (strcmp(buf, keywords[i]) == 0) {
-                type = RIFT_TOKEN_KEYWORD;
-                break;
-            }
-        }
+        rift_token_type_t type = lexer_is_keyword(lexer, lexer->source + start, len)
+            ? RIFT_TOKEN_KEYWORD
+            : RIFT_TOKEN_IDENTIFIER;
 
-        rift_token_t token = rift_token_create(type, buf);
-        token.line = start_line;
-        token.column = start_col;
-        free(buf);
-        return token;
+        return lexer_span(span, type, start, len, offset);
     }
 
     /* Number */
-    if (isdigit(c)) {
+    if (isdigit((unsigned char)c)) {
         size_t start = lexer->pos;
-        int is_float = 0;
-        while (lexer->pos < lexer->length &&
-               (isdigit(lexer_current(lexer)) || lexer_current(lexer) == '.')) {
-            if (lexer_current(lexer) == '.') is_float = 1;
-            lexer_advance(lexer);
-        }
+        lexer->pos = lexer_run_end(lexer, start, lexer_is_digit, rift_scan_digits);
         size_t len = lexer->pos - start;
-        char *buf = (char *)malloc(len + 1);
-        if (buf) {
-            memcpy(buf, lexer->source + start, len);
-            buf[len] = '\0';
-        }
+        int is_float = memchr(lexer->source + start, '.', len) != NULL;
         rift_token_type_t type = is_float ? RIFT_TOKEN_LITERAL_FLOAT : RIFT_TOKEN_LITERAL_INT;
-        rift_token_t token = rift_token_create(type, buf);
-        token.line = start_line;
-        token.column = start_col;
-        free(buf);
-        return token;
+        return lexer_span(span, type, start, len, offset);
     }
 
     /* String literal */
     if (c == '"') {
         lexer_advance(lexer);
         size_t start = lexer->pos;
-        while (lexer->pos < lexer->length && lexer_current(lexer) != '"') {
-            if (lexer_current(lexer) == '\\') lexer_advance(lexer);
-            lexer_advance(lexer);
+        for (;;) {
+            lexer->pos = rift_scan_string(lexer->source, lexer->pos, lexer->length);
+            if (lexer->pos >= lexer->length || lexer_current(lexer) == '"') break;
+            /* Backslash: take it and the escaped byte */
+            lexer->pos = lexer->pos + 2 <= lexer->length ? lexer->pos + 2 : lexer->length;
         }
         size_t len = lexer->pos - start;
-        char *buf = (char *)malloc(len + 1);
-        if (buf) {
-            memcpy(buf, lexer->source + start, len);
-            buf[len] = '\0';
-        }
         if (lexer->pos < lexer->length) lexer_advance(lexer);
-        rift_token_t token = rift_token_create(RIFT_TOKEN_LITERAL_STRING, buf);
-        token.line = start_line;
-        token.column = start_col;
-        free(buf);
-        return token;
+        return lexer_span(span, RIFT_TOKEN_LITERAL_STRING, start, len, offset);
     }
 
     /* Operators and delimiters */
+    size_t start = lexer->pos;
     lexer_advance(lexer);
-    char buf[2] = { c, '\0' };
 
     rift_token_type_t type = RIFT_TOKEN_UNKNOWN;
     if (strchr("+-*/%=<>!&|^~", c)) {
@@ -204,12 +297,77 @@ rift_token_t rift_lexer_next(rift_lexer_t *lexer) {
         type = RIFT_TOKEN_DELIMITER;
     }
 
-    rift_token_t token = rift_token_create(type, buf);
-    token.line = start_line;
-    token.column = start_col;
+    return lexer_span(span, type, start, 1, offset);
+}
+
+rift_token_t rift_lexer_next(rift_lexer_t *lexer) {
+    lexer_span_t span;
+    size_t pos = lexer ? lexer->pos : 0;
+    if (!lexer || !lexer_scan(lexer, &span)) {
+        return rift_token_create(RIFT_TOKEN_EOF, NULL);
+    }
+
+    /* A view in zero-copy mode, otherwise a single owned copy */
+    rift_token_t token = rift_token_create_n(span.type, lexer->source + span.start, span.len);
+    if (!(lexer->flags & RIFT_LEXER_ZERO_COPY) &&
+        !rift_token_materialize_in(&token, lexer->arena)) {
+        /* No copy to hand out: report it where the token starts and leave
+         * the token unread, so a later call can try again */
+        lexer->pos = pos;
+        token = rift_token_create(RIFT_TOKEN_ERROR, NULL);
+    }
+    lexer_locate(lexer, span.offset, &token.line, &token.column);
     return token;
 }
 
+static int token_buffer_reserve(rift_token_buffer_t *buffer, size_t capacity) {
+    if (capacity <= buffer->capacity) return 1;
+
+    uint8_t  *types   = (uint8_t *)realloc(buffer->types, capacity * sizeof(uint8_t));
+    if (types) buffer->types = types;
+    uint32_t *offsets = (uint32_t *)realloc(buffer->offsets, capacity * sizeof(uint32_t));
+    if (offsets) buffer->offsets = offsets;
+    uint32_t *lengths = (uint32_t *)realloc(buffer->lengths, capacity * sizeof(uint32_t));
+    if (lengths) buffer->lengths = lengths;
+    uint8_t  *leads   = (uint8_t *)realloc(buffer->leads, capacity * sizeof(uint8_t));
+    if (leads) buffer->leads = leads;
+
+    if (!types || !offsets || !lengths || !leads) return 0;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+int rift_lexer_tokenize_all(rift_lexer_t *lexer, rift_token_buffer_t *buffer) {
+    if (!lexer || !buffer) return 0;
+    if (lexer->length > UINT32_MAX) return 0;   /* offsets are 32-bit */
+
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->source = lexer->source;
+
+    /* Positions are not stored per token; the buffer resolves them from
+     * this index on demand. Roughly one token per four source bytes. */
+    if (!rift_line_index_build(&buffer->lines, lexer->source, lexer->length) ||
+        !token_buffer_reserve(buffer, (lexer->length - lexer->pos) / 4 + 16)) {
+        rift_token_buffer_free(buffer);
+        return 0;
+    }
+
+    lexer_span_t span;
+    while (lexer_scan(lexer, &span)) {
+        if (buffer->count == buffer->capacity &&
+            !token_buffer_reserve(buffer, buffer->capacity * 2)) {
+            rift_token_buffer_free(buffer);
+            return 0;
+        }
+        size_t i = buffer->count++;
+        buffer->types[i] = (uint8_t)span.type;
+        buffer->offsets[i] = (uint32_t)span.start;
+        buffer->lengths[i] = (uint32_t)span.len;
+        buffer->leads[i] = (uint8_t)(span.start - span.offset);
+    }
+    return 1;
+}
+
 rift_token_t rift_lexer_peek(const rift_lexer_t *lexer) {
     rift_lexer_t copy = *lexer;
     return rift_lexer_next(&copy);
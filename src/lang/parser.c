@@ -3,9 +3,11 @@
 #include <string.h>
 
 struct rift_parser {
-    const rift_token_t *tokens;
-    size_t              count;
-    size_t              pos;
+    const rift_token_t        *tokens;
+    const rift_token_buffer_t *buffer;  /* SoA stream; tokens is NULL when set */
+    size_t                     count;
+    size_t                     pos;
+    rift_memory_arena_t       *arena;   /* AST nodes, caller-owned */
 };
 
 rift_parser_t *rift_parser_create(const rift_token_t *tokens, size_t count) {
@@ -21,12 +23,39 @@ rift_parser_t *rift_parser_create(const rift_token_t *tokens, size_t count) {
     return parser;
 }
 
+rift_parser_t *rift_parser_create_from_buffer(const rift_token_buffer_t *buffer) {
+    if (!buffer) return NULL;
+
+    rift_parser_t *parser = (rift_parser_t *)calloc(1, sizeof(rift_parser_t));
+    if (!parser) return NULL;
+
+    parser->buffer = buffer;
+    parser->count = buffer->count;
+    parser->pos = 0;
+
+    return parser;
+}
+
 void rift_parser_destroy(rift_parser_t *parser) {
     free(parser);
 }
 
-static rift_ast_node_t *ast_node_create(rift_ast_type_t type) {
-    rift_ast_node_t *node = (rift_ast_node_t *)calloc(1, sizeof(rift_ast_node_t));
+int rift_parser_set_arena(rift_parser_t *parser, rift_memory_arena_t *arena) {
+    if (!parser) return 0;
+    parser->arena = arena;
+    return 1;
+}
+
+static rift_ast_node_t *ast_node_create(rift_parser_t *parser, rift_ast_type_t type) {
+    rift_ast_node_t *node;
+    if (parser->arena) {
+        rift_memory_span_t span = rift_memory_arena_alloc(parser->arena, sizeof(rift_ast_node_t),
+                                                          (uint32_t)sizeof(void *));
+        node = (rift_ast_node_t *)span.ptr;
+        if (node) node->memory_flags = RIFT_MEM_ARENA;
+    } else {
+        node = (rift_ast_node_t *)calloc(1, sizeof(rift_ast_node_t));
+    }
     if (node) {
         node->type = type;
     }
@@ -36,7 +65,7 @@ static rift_ast_node_t *ast_node_create(rift_ast_type_t type) {
 rift_ast_node_t *rift_parser_parse(rift_parser_t *parser) {
     if (!parser) return NULL;
 
-    rift_ast_node_t *program = ast_node_create(RIFT_AST_PROGRAM);
+    rift_ast_node_t *program = ast_node_create(parser, RIFT_AST_PROGRAM);
     if (!program) return NULL;
 
     /* TODO: recursive descent parsing */
@@ -45,7 +74,7 @@ rift_ast_node_t *rift_parser_parse(rift_parser_t *parser) {
 }
 
 void rift_ast_free(rift_ast_node_t *node) {
-    if (!node) return;
+    if (!node || (node->memory_flags & RIFT_MEM_ARENA)) return;
     rift_ast_free(node->children);
     rift_ast_free(node->next);
     free(node);
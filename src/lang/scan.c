@@ -0,0 +1,265 @@
+#include "rift/scan.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RIFT_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+typedef struct rift_scan_kernels {
+    const char *name;
+    size_t (*whitespace)(const char *s, size_t pos, size_t len);
+    size_t (*ident)(const char *s, size_t pos, size_t len);
+    size_t (*digits)(const char *s, size_t pos, size_t len);
+    size_t (*string)(const char *s, size_t pos, size_t len);
+    size_t (*newlines)(const char *s, size_t len);
+} rift_scan_kernels_t;
+
+/* --- Scalar kernels (also finish the tails of the vector kernels) --- */
+
+static int is_ws(unsigned char c)    { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static int is_ident(unsigned char c) {
+    return (unsigned char)((c | 0x20) - 'a') < 26 || (unsigned char)(c - '0') < 10 || c == '_';
+}
+static int is_digit(unsigned char c) { return (unsigned char)(c - '0') < 10 || c == '.'; }
+
+static size_t scalar_whitespace(const char *s, size_t pos, size_t len) {
+    while (pos < len && is_ws((unsigned char)s[pos])) pos++;
+    return pos;
+}
+
+static size_t scalar_ident(const char *s, size_t pos, size_t len) {
+    while (pos < len && is_ident((unsigned char)s[pos])) pos++;
+    return pos;
+}
+
+static size_t scalar_digits(const char *s, size_t pos, size_t len) {
+    while (pos < len && is_digit((unsigned char)s[pos])) pos++;
+    return pos;
+}
+
+static size_t scalar_string(const char *s, size_t pos, size_t len) {
+    while (pos < len && s[pos] != '"' && s[pos] != '\\') pos++;
+    return pos;
+}
+
+static size_t scalar_newlines(const char *s, size_t len) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++) count += (s[i] == '\n');
+    return count;
+}
+
+static const rift_scan_kernels_t scan_scalar = {
+    "scalar", scalar_whitespace, scalar_ident, scalar_digits, scalar_string, scalar_newlines
+};
+
+#ifdef RIFT_SCAN_X86
+
+/* --- SSE2: 16 bytes per step. x <= k unsigned  <=>  min(x, k) == x --- */
+
+static __m128i sse2_le(__m128i x, char k) {
+    return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(k)), x);
+}
+
+static unsigned sse2_ws_mask(__m128i v) {
+    __m128i ctl = sse2_le(_mm_sub_epi8(v, _mm_set1_epi8('\t')), '\r' - '\t');
+    __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(ctl, sp));
+}
+
+static unsigned sse2_ident_mask(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = sse2_le(_mm_sub_epi8(lower, _mm_set1_epi8('a')), 25);
+    __m128i digit = sse2_le(_mm_sub_epi8(v, _mm_set1_epi8('0')), 9);
+    __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), under));
+}
+
+static unsigned sse2_digit_mask(__m128i v) {
+    __m128i digit = sse2_le(_mm_sub_epi8(v, _mm_set1_epi8('0')), 9);
+    __m128i dot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(digit, dot));
+}
+
+static unsigned sse2_string_mask(__m128i v) {
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(quote, slash));
+}
+
+/* Run of bytes whose class mask is set: stop at the first clear bit */
+#define SSE2_RUN(name, mask_fn, tail_fn)                                      \
+    static size_t name(const char *s, size_t pos, size_t len) {               \
+        while (pos + 16 <= len) {                                             \
+            unsigned stop = ~mask_fn(_mm_loadu_si128((const __m128i *)(s + pos))) & 0xFFFFu; \
+            if (stop) return pos + (size_t)__builtin_ctz(stop);               \
+            pos += 16;                                                        \
+        }                                                                     \
+        return tail_fn(s, pos, len);                                          \
+    }
+
+SSE2_RUN(sse2_whitespace, sse2_ws_mask, scalar_whitespace)
+SSE2_RUN(sse2_ident, sse2_ident_mask, scalar_ident)
+SSE2_RUN(sse2_digits, sse2_digit_mask, scalar_digits)
+
+static size_t sse2_string(const char *s, size_t pos, size_t len) {
+    while (pos + 16 <= len) {
+        unsigned hit = sse2_string_mask(_mm_loadu_si128((const __m128i *)(s + pos)));
+        if (hit) return pos + (size_t)__builtin_ctz(hit);
+        pos += 16;
+    }
+    return scalar_string(s, pos, len);
+}
+
+static size_t sse2_newlines(const char *s, size_t len) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t count = 0, i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+    }
+    return count + scalar_newlines(s + i, len - i);
+}
+
+static const rift_scan_kernels_t scan_sse2 = {
+    "sse2", sse2_whitespace, sse2_ident, sse2_digits, sse2_string, sse2_newlines
+};
+
+/* --- AVX2: 32 bytes per step, same class logic --- */
+
+#define RIFT_AVX2 __attribute__((target("avx2")))
+
+static RIFT_AVX2 __m256i avx2_le(__m256i x, char k) {
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(k)), x);
+}
+
+static RIFT_AVX2 uint32_t avx2_ws_mask(__m256i v) {
+    __m256i ctl = avx2_le(_mm256_sub_epi8(v, _mm256_set1_epi8('\t')), '\r' - '\t');
+    __m256i sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(ctl, sp));
+}
+
+static RIFT_AVX2 uint32_t avx2_ident_mask(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i alpha = avx2_le(_mm256_sub_epi8(lower, _mm256_set1_epi8('a')), 25);
+    __m256i digit = avx2_le(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+    __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), under));
+}
+
+static RIFT_AVX2 uint32_t avx2_digit_mask(__m256i v) {
+    __m256i digit = avx2_le(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+    __m256i dot = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(digit, dot));
+}
+
+static RIFT_AVX2 uint32_t avx2_string_mask(__m256i v) {
+    __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    __m256i slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(quote, slash));
+}
+
+/* Tails under 32 bytes drop to SSE2, then scalar */
+#define AVX2_RUN(name, mask_fn, tail_fn)                                      \
+    static RIFT_AVX2 size_t name(const char *s, size_t pos, size_t len) {     \
+        while (pos + 32 <= len) {                                             \
+            uint32_t stop = ~mask_fn(_mm256_loadu_si256((const __m256i *)(s + pos))); \
+            if (stop) return pos + (size_t)__builtin_ctz(stop);               \
+            pos += 32;                                                        \
+        }                                                                     \
+        return tail_fn(s, pos, len);                                          \
+    }
+
+AVX2_RUN(avx2_whitespace, avx2_ws_mask, sse2_whitespace)
+AVX2_RUN(avx2_ident, avx2_ident_mask, sse2_ident)
+AVX2_RUN(avx2_digits, avx2_digit_mask, sse2_digits)
+
+static RIFT_AVX2 size_t avx2_string(const char *s, size_t pos, size_t len) {
+    while (pos + 32 <= len) {
+        uint32_t hit = avx2_string_mask(_mm256_loadu_si256((const __m256i *)(s + pos)));
+        if (hit) return pos + (size_t)__builtin_ctz(hit);
+        pos += 32;
+    }
+    return sse2_string(s, pos, len);
+}
+
+static RIFT_AVX2 size_t avx2_newlines(const char *s, size_t len) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    size_t count = 0, i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        count += (size_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+    }
+    return count + sse2_newlines(s + i, len - i);
+}
+
+static const rift_scan_kernels_t scan_avx2 = {
+    "avx2", avx2_whitespace, avx2_ident, avx2_digits, avx2_string, avx2_newlines
+};
+
+#endif /* RIFT_SCAN_X86 */
+
+/* --- Dispatch --- */
+
+static _Atomic(const rift_scan_kernels_t *) g_scan_kernels = NULL;
+
+static const rift_scan_kernels_t *scan_detect(void) {
+#ifdef RIFT_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &scan_avx2;
+    return &scan_sse2;   /* baseline on x86-64 */
+#else
+    return &scan_scalar;
+#endif
+}
+
+static const rift_scan_kernels_t *scan_kernels(void) {
+    const rift_scan_kernels_t *k = atomic_load_explicit(&g_scan_kernels, memory_order_acquire);
+    if (!k) {
+        k = scan_detect();
+        atomic_store_explicit(&g_scan_kernels, k, memory_order_release);
+    }
+    return k;
+}
+
+size_t rift_scan_whitespace(const char *s, size_t pos, size_t len) {
+    return scan_kernels()->whitespace(s, pos, len);
+}
+
+size_t rift_scan_ident(const char *s, size_t pos, size_t len) {
+    return scan_kernels()->ident(s, pos, len);
+}
+
+size_t rift_scan_digits(const char *s, size_t pos, size_t len) {
+    return scan_kernels()->digits(s, pos, len);
+}
+
+size_t rift_scan_string(const char *s, size_t pos, size_t len) {
+    return scan_kernels()->string(s, pos, len);
+}
+
+size_t rift_scan_count_newlines(const char *s, size_t len) {
+    return scan_kernels()->newlines(s, len);
+}
+
+const char *rift_scan_kernel_name(void) {
+    return scan_kernels()->name;
+}
+
+int rift_scan_select(const char *name) {
+    const rift_scan_kernels_t *k = NULL;
+    if (!name) return 0;
+    if (strcmp(name, "scalar") == 0) k = &scan_scalar;
+#ifdef RIFT_SCAN_X86
+    if (strcmp(name, "sse2") == 0) k = &scan_sse2;
+    if (strcmp(name, "avx2") == 0) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) k = &scan_avx2;
+    }
+#endif
+    if (!k) return 0;
+    atomic_store_explicit(&g_scan_kernels, k, memory_order_release);
+    return 1;
+}
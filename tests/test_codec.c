@@ -26,6 +26,25 @@ TEST(test_link_basic) {
     int result = rift_link(src, strlen(src), &prog);
     assert(result == 0);
     assert(prog.node_count == 0); /* stub returns empty */
+    rift_cir_program_free(&prog);
+}
+
+TEST(test_program_grows_past_1024_nodes) {
+    rift_cir_program_t prog;
+    memset(&prog, 0, sizeof(prog));
+    for (int i = 0; i < 1500; i++) {
+        rift_cir_node_t node;
+        memset(&node, 0, sizeof(node));
+        node.kind = RIFT_CIR_ASSIGN;
+        snprintf(node.name, sizeof(node.name), "v%d", i);
+        assert(rift_cir_program_append(&prog, &node) == 0);
+    }
+    assert(prog.node_count == 1500);
+    assert(prog.node_capacity >= prog.node_count);
+    assert(strcmp(prog.nodes[0].name, "v0") == 0);
+    assert(strcmp(prog.nodes[1499].name, "v1499") == 0);
+    rift_cir_program_free(&prog);
+    assert(prog.nodes == NULL && prog.node_count == 0);
 }
 
 TEST(test_codec_emit_unknown_target) {
@@ -39,6 +58,7 @@ int main(void) {
     printf("test_codec:\n");
     RUN(test_link_empty);
     RUN(test_link_basic);
+    RUN(test_program_grows_past_1024_nodes);
     RUN(test_codec_emit_unknown_target);
     printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
     return tests_failed;
@@ -2,6 +2,8 @@
 #include <string.h>
 #include <assert.h>
 #include "rift/lexer.h"
+#include "rift/parser.h"
+#include "rift/rift.h"
 
 static int tests_passed = 0;
 static int tests_failed = 0;
@@ -58,11 +60,230 @@ TEST(test_lexer_eof) {
     rift_lexer_destroy(lex);
 }
 
+TEST(test_lexer_zero_copy) {
+    const char *src = "let name = \"hi\" + 3.5";
+    rift_lexer_t *lex = rift_lexer_create_ex(src, strlen(src), RIFT_LEXER_ZERO_COPY);
+    assert(lex != NULL);
+
+    const char *expect[] = { "let", "name", "=", "hi", "+", "3.5" };
+    rift_token_type_t types[] = {
+        RIFT_TOKEN_KEYWORD, RIFT_TOKEN_IDENTIFIER, RIFT_TOKEN_OPERATOR,
+        RIFT_TOKEN_LITERAL_STRING, RIFT_TOKEN_OPERATOR, RIFT_TOKEN_LITERAL_FLOAT
+    };
+    for (size_t i = 0; i < sizeof(expect) / sizeof(expect[0]); i++) {
+        rift_token_t t = rift_lexer_next(lex);
+        size_t len = 0;
+        const char *view = rift_token_view(&t, &len);
+        assert(t.type == types[i]);
+        assert(rift_token_is_view(&t));
+        assert(view >= src && view + len <= src + strlen(src));
+        assert(len == strlen(expect[i]) && memcmp(view, expect[i], len) == 0);
+        rift_token_destroy(&t);
+    }
+
+    rift_token_t t = rift_lexer_next(lex);
+    assert(t.type == RIFT_TOKEN_EOF);
+    rift_lexer_destroy(lex);
+}
+
+TEST(test_lexer_copy_mode_owns_values) {
+    const char *src = "fn main";
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    rift_token_t t = rift_lexer_next(lex);
+    assert(!rift_token_is_view(&t));
+    assert(strcmp(t.value.str, "fn") == 0);
+    rift_token_destroy(&t);
+    rift_lexer_destroy(lex);
+}
+
+TEST(test_lexer_arena_values) {
+    const char *src = "let total = count + 1";
+    rift_memory_arena_t arena;
+    rift_memory_arena_init(&arena, 0);
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    assert(rift_lexer_set_arena(lex, &arena));
+
+    const char *expect[] = { "let", "total", "=", "count", "+", "1" };
+    rift_token_t tokens[6];
+    for (size_t i = 0; i < 6; i++) {
+        tokens[i] = rift_lexer_next(lex);
+        assert(!rift_token_is_view(&tokens[i]));
+        assert(tokens[i].memory.flags & RIFT_MEM_ARENA);
+    }
+    rift_lexer_destroy(lex);
+
+    /* Values outlive the lexer; destroying a token frees nothing */
+    for (size_t i = 0; i < 6; i++) {
+        assert(strcmp(tokens[i].value.str, expect[i]) == 0);
+        rift_token_destroy(&tokens[i]);
+    }
+    rift_memory_arena_release(&arena);
+}
+
+/* An arena that cannot grow: the value is reported, not silently lost */
+TEST(test_lexer_arena_exhausted) {
+    const char *src = "let  total";
+    rift_memory_arena_t arena;
+    rift_memory_arena_init(&arena, SIZE_MAX);   /* every chunk too large */
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    assert(rift_lexer_set_arena(lex, &arena));
+
+    rift_token_t t = rift_lexer_next(lex);
+    assert(t.type == RIFT_TOKEN_ERROR && t.value.str == NULL);
+    assert(t.line == 1 && t.column == 1);
+    assert(!rift_token_validate(&t));
+    assert(!rift_lexer_eof(lex));
+
+    /* Nothing was consumed: with memory back, the same token comes out */
+    assert(rift_lexer_set_arena(lex, NULL));
+    t = rift_lexer_next(lex);
+    assert(t.type == RIFT_TOKEN_KEYWORD && strcmp(t.value.str, "let") == 0);
+    rift_token_destroy(&t);
+    t = rift_lexer_next(lex);
+    assert(t.type == RIFT_TOKEN_IDENTIFIER && t.column == 6);
+    rift_token_destroy(&t);
+
+    rift_lexer_destroy(lex);
+    rift_memory_arena_release(&arena);
+}
+
+static rift_token_type_t first_token_type(rift_lexer_t *lex) {
+    rift_token_t t = rift_lexer_next(lex);
+    rift_token_type_t type = t.type;
+    rift_token_destroy(&t);
+    return type;
+}
+
+TEST(test_lexer_keyword_table) {
+    const char *src = "let fn if else while for return break continue def print true false "
+                      "lets f iff elsewhere fo returns define printf falsey macro_rules";
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    for (int i = 0; i < 13; i++) {
+        assert(first_token_type(lex) == RIFT_TOKEN_KEYWORD);
+    }
+    for (int i = 0; i < 10; i++) {
+        assert(first_token_type(lex) == RIFT_TOKEN_IDENTIFIER);
+    }
+    rift_lexer_destroy(lex);
+}
+
+TEST(test_lexer_extra_keywords) {
+    static const char *const macro_keywords[] = { "macro_rules", "expr" };
+    const char *src = "macro_rules expr exprs macro";
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    assert(rift_lexer_set_keywords(lex, macro_keywords, 2));
+    assert(first_token_type(lex) == RIFT_TOKEN_KEYWORD);
+    assert(first_token_type(lex) == RIFT_TOKEN_KEYWORD);
+    assert(first_token_type(lex) == RIFT_TOKEN_IDENTIFIER);
+    assert(first_token_type(lex) == RIFT_TOKEN_IDENTIFIER);
+    rift_lexer_destroy(lex);
+}
+
+TEST(test_lexer_tokenize_all) {
+    const char *src = "fn add(a, b) {\n  return a + b;\n}\nlet s = R\"\"x\"\" ;\n";
+    rift_lexer_t *bulk = rift_lexer_create(src, strlen(src));
+    rift_token_buffer_t buffer;
+    assert(rift_lexer_tokenize_all(bulk, &buffer));
+    assert(rift_lexer_eof(bulk));
+    assert(buffer.source == src);
+
+    /* Same stream as pulling tokens one at a time */
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    size_t i = 0;
+    for (;; i++) {
+        rift_token_t t = rift_lexer_next(lex);
+        if (t.type == RIFT_TOKEN_EOF) {
+            rift_token_destroy(&t);
+            break;
+        }
+        assert(i < buffer.count);
+        rift_token_t v = rift_token_buffer_get(&buffer, i);
+        size_t len = 0;
+        const char *view = rift_token_view(&v, &len);
+        assert(v.type == t.type);
+        assert(v.line == t.line && v.column == t.column);
+        assert(len == strlen(t.value.str) && memcmp(view, t.value.str, len) == 0);
+        rift_token_destroy(&t);
+    }
+    assert(i == buffer.count);
+    assert(rift_token_buffer_get(&buffer, buffer.count).type == RIFT_TOKEN_EOF);
+
+    rift_parser_t *parser = rift_parser_create_from_buffer(&buffer);
+    assert(parser != NULL);
+    rift_ast_node_t *ast = rift_parser_parse(parser);
+    assert(ast != NULL && ast->type == RIFT_AST_PROGRAM);
+    rift_ast_free(ast);
+    rift_parser_destroy(parser);
+
+    rift_token_buffer_free(&buffer);
+    rift_lexer_destroy(lex);
+    rift_lexer_destroy(bulk);
+}
+
+/* Mapped sources are NUL-terminated even when the size is a page multiple */
+TEST(test_lexer_mapped_file) {
+    static const size_t sizes[] = { 1, 100, 4096, 8192 + 7 };
+    char path[] = "test_lexer_mapped.rift";
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        FILE *f = fopen(path, "wb");
+        assert(f != NULL);
+        for (size_t i = 0; i < sizes[k]; i++) fputc((i % 10 == 9) ? '\n' : 'a', f);
+        fclose(f);
+
+        rift_file_map_t map;
+        assert(rift_file_map(path, &map) == 0);
+        assert(map.size == sizes[k]);
+        assert(map.data[map.size] == '\0');
+        assert(strlen(map.data) == map.size);
+
+        rift_lexer_t *lex = rift_lexer_create_ex(map.data, map.size, RIFT_LEXER_ZERO_COPY);
+        rift_token_buffer_t buffer;
+        assert(rift_lexer_tokenize_all(lex, &buffer));
+        assert(buffer.count == (sizes[k] + 9) / 10);
+        rift_token_buffer_free(&buffer);
+        rift_lexer_destroy(lex);
+        rift_file_unmap(&map);
+        assert(map.data == NULL);
+    }
+    remove(path);
+
+    rift_file_map_t missing;
+    assert(rift_file_map("no/such/file.rift", &missing) != 0);
+}
+
+/* rift_compile parses into the context arena and keeps a chunk between runs */
+TEST(test_compile_context_arena) {
+    char path[] = "test_compile_arena.rift";
+    FILE *f = fopen(path, "wb");
+    assert(f != NULL);
+    fputs("let x = 1\nfn main() { return x }\n", f);
+    fclose(f);
+
+    rift_context_t *ctx = rift_init();
+    assert(ctx != NULL && ctx->arena.chunks == NULL);
+    assert(rift_compile(ctx, path, NULL) == RIFT_SUCCESS);
+    rift_memory_chunk_t *kept = ctx->arena.chunks;
+    assert(kept != NULL);
+    assert(rift_compile(ctx, path, NULL) == RIFT_SUCCESS);
+    assert(ctx->arena.chunks == kept);
+    rift_cleanup(ctx);
+    remove(path);
+}
+
 int main(void) {
     printf("test_lexer:\n");
     RUN(test_lexer_keywords);
     RUN(test_lexer_string_literal);
     RUN(test_lexer_eof);
+    RUN(test_lexer_zero_copy);
+    RUN(test_lexer_copy_mode_owns_values);
+    RUN(test_lexer_arena_values);
+    RUN(test_lexer_arena_exhausted);
+    RUN(test_lexer_keyword_table);
+    RUN(test_lexer_extra_keywords);
+    RUN(test_lexer_tokenize_all);
+    RUN(test_lexer_mapped_file);
+    RUN(test_compile_context_arena);
     printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
     return tests_failed;
 }
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "rift/scan.h"
+#include "rift/lexer.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-40s", #name); \
+    name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+static const char *kernels[] = { "scalar", "sse2", "avx2" };
+
+TEST(test_scan_runs) {
+    const char *src = "   \t\n\r\v\fname_42 + 3.14 \"str\\\"x\"";
+    size_t len = strlen(src);
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!rift_scan_select(kernels[k])) continue;
+        assert(rift_scan_whitespace(src, 0, len) == 8);
+        assert(rift_scan_ident(src, 8, len) == 15);
+        assert(rift_scan_digits(src, 18, len) == 22);
+        assert(rift_scan_string(src, 24, len) == 27);
+        assert(rift_scan_count_newlines(src, len) == 1);
+        assert(rift_scan_whitespace(src, len, len) == len);
+    }
+    assert(rift_scan_select("scalar"));
+    assert(!rift_scan_select("no-such-kernel"));
+}
+
+/* Every kernel agrees with scalar at every offset of random buffers,
+ * including runs that straddle 16/32-byte blocks and the buffer end */
+TEST(test_scan_kernels_agree) {
+    static const char alphabet[] = "  \t\n_aZ09.\"\\+\x80\xff";
+    char buf[301];
+    srand(7);
+    for (int round = 0; round < 40; round++) {
+        size_t len = (size_t)(rand() % 300) + 1;
+        int bias = rand() % 4;
+        for (size_t i = 0; i < len; i++) {
+            /* long single-class runs exercise the vector loops */
+            buf[i] = (rand() % 8) ? alphabet[bias * 2 + (rand() % 2)]
+                                  : alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+        buf[len] = '\0';
+        for (size_t pos = 0; pos <= len; pos++) {
+            assert(rift_scan_select("scalar"));
+            size_t ws = rift_scan_whitespace(buf, pos, len);
+            size_t id = rift_scan_ident(buf, pos, len);
+            size_t dg = rift_scan_digits(buf, pos, len);
+            size_t st = rift_scan_string(buf, pos, len);
+            size_t nl = rift_scan_count_newlines(buf + pos, len - pos);
+            for (size_t k = 1; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+                if (!rift_scan_select(kernels[k])) continue;
+                assert(rift_scan_whitespace(buf, pos, len) == ws);
+                assert(rift_scan_ident(buf, pos, len) == id);
+                assert(rift_scan_digits(buf, pos, len) == dg);
+                assert(rift_scan_string(buf, pos, len) == st);
+                assert(rift_scan_count_newlines(buf + pos, len - pos) == nl);
+            }
+        }
+    }
+    rift_scan_select("scalar");
+}
+
+TEST(test_scan_lexer_positions) {
+    const char *src = "let   a =\n\n    \"multi\nline\\\"\" b_long_identifier_that_spans_blocks\n  42";
+    rift_lexer_t *lex = rift_lexer_create(src, strlen(src));
+    uint32_t lines[] = { 1, 1, 1, 3, 4, 5 };
+    uint32_t cols[]  = { 1, 7, 9, 5, 9, 3 };
+    for (int i = 0; i < 6; i++) {
+        rift_token_t t = rift_lexer_next(lex);
+        assert(t.line == lines[i]);
+        assert(t.column == cols[i]);
+        rift_token_destroy(&t);
+    }
+    rift_lexer_destroy(lex);
+}
+
+int main(void) {
+    printf("test_scan (%s):\n", rift_scan_kernel_name());
+    RUN(test_scan_runs);
+    RUN(test_scan_kernels_agree);
+    RUN(test_scan_lexer_positions);
+    printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed;
+}
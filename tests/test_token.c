@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 #include "rift/token.h"
 
 static int tests_passed = 0;
@@ -33,6 +34,7 @@ TEST(test_token_type_name) {
     assert(strcmp(rift_token_type_name(RIFT_TOKEN_KEYWORD), "KEYWORD") == 0);
     assert(strcmp(rift_token_type_name(RIFT_TOKEN_PATTERN_STATIC), "PATTERN_STATIC") == 0);
     assert(strcmp(rift_token_type_name(RIFT_TOKEN_HEXDUMP), "HEXDUMP") == 0);
+    assert(strcmp(rift_token_type_name(RIFT_TOKEN_ERROR), "ERROR") == 0);
 }
 
 TEST(test_token_triplet_validation) {
@@ -46,12 +48,187 @@ TEST(test_token_triplet_validation) {
     assert(rift_token_validate(&invalid) == 0);
 }
 
+TEST(test_token_create_n_view) {
+    const char *src = "alpha beta";
+    rift_token_t t = rift_token_create_n(RIFT_TOKEN_IDENTIFIER, src + 6, 4);
+    assert(rift_token_is_view(&t));
+    assert(t.memory.flags == (RIFT_MEM_STATIC | RIFT_MEM_READONLY));
+
+    size_t len = 0;
+    const char *view = rift_token_view(&t, &len);
+    assert(view == src + 6);
+    assert(len == 4);
+    assert(rift_token_validate(&t));
+
+    rift_token_destroy(&t);   /* must not free the source */
+    assert(strcmp(src, "alpha beta") == 0);
+}
+
+TEST(test_token_materialize) {
+    const char *src = "alpha beta";
+    rift_token_t t = rift_token_create_n(RIFT_TOKEN_IDENTIFIER, src, 5);
+    assert(rift_token_materialize(&t));
+    assert(!rift_token_is_view(&t));
+    assert(t.memory.flags & RIFT_MEM_DYNAMIC);
+    assert(t.value.str != src);
+    assert(strcmp(t.value.str, "alpha") == 0);
+
+    size_t len = 0;
+    assert(strcmp(rift_token_view(&t, &len), "alpha") == 0);
+    assert(len == 5);
+    assert(rift_token_materialize(&t));   /* already owned: no-op */
+    rift_token_destroy(&t);
+
+    rift_token_t empty = rift_token_create_n(RIFT_TOKEN_LITERAL_STRING, src, 0);
+    assert(rift_token_materialize(&empty));
+    assert(strcmp(empty.value.str, "") == 0);
+    rift_token_destroy(&empty);
+}
+
+TEST(test_memory_arena) {
+    rift_memory_arena_t arena;
+    rift_memory_arena_init(&arena, 256);
+
+    rift_memory_span_t a = rift_memory_arena_alloc(&arena, 3, 0);
+    rift_memory_span_t b = rift_memory_arena_alloc(&arena, 16, 16);
+    assert(a.ptr && b.ptr);
+    assert(a.flags == RIFT_MEM_ARENA && a.alignment == RIFT_MEMORY_ALIGN_DEFAULT);
+    assert((uintptr_t)b.ptr % 16 == 0);
+    assert((char *)b.ptr >= (char *)a.ptr + 3);
+    assert(rift_memory_validate(&a) && rift_memory_validate(&b));
+    assert(((char *)b.ptr)[0] == 0 && ((char *)b.ptr)[15] == 0);
+
+    /* Larger than a chunk: its own chunk; the current one keeps filling */
+    rift_memory_span_t big = rift_memory_arena_alloc(&arena, 1000, 128);
+    assert(big.ptr && (uintptr_t)big.ptr % 128 == 0);
+    memset(big.ptr, 0xAB, 1000);
+    rift_memory_span_t c = rift_memory_arena_alloc(&arena, 8, 8);
+    assert((char *)c.ptr > (char *)b.ptr && (char *)c.ptr < (char *)b.ptr + 256);
+
+    /* Spills into a fresh chunk once the current one is full */
+    for (int i = 0; i < 64; i++) {
+        rift_memory_span_t s = rift_memory_arena_alloc(&arena, 24, 8);
+        assert(s.ptr && ((char *)s.ptr)[23] == 0);
+        memset(s.ptr, 0xCD, 24);
+    }
+
+    rift_memory_free(&a);             /* arena spans: no-op */
+    assert(a.ptr != NULL);
+    assert(rift_memory_arena_alloc(&arena, 8, 3).ptr == NULL);   /* not a power of two */
+    assert(rift_memory_arena_alloc(&arena, 0, 8).ptr == NULL);
+
+    /* Reset keeps one chunk and hands it out again, zeroed */
+    rift_memory_arena_reset(&arena);
+    rift_memory_span_t first = rift_memory_arena_alloc(&arena, 24, 8);
+    assert(first.ptr && ((char *)first.ptr)[23] == 0);
+    rift_memory_arena_reset(&arena);
+    rift_memory_span_t again = rift_memory_arena_alloc(&arena, 24, 8);
+    assert(again.ptr == first.ptr);
+
+    rift_memory_arena_release(&arena);
+    assert(arena.chunks == NULL);
+    assert(rift_memory_arena_alloc(&arena, 8, 8).ptr != NULL);   /* usable again */
+    rift_memory_arena_release(&arena);
+}
+
+TEST(test_token_materialize_in_arena) {
+    const char *src = "alpha beta";
+    rift_memory_arena_t arena;
+    rift_memory_arena_init(&arena, 0);
+
+    rift_token_t t = rift_token_create_n(RIFT_TOKEN_IDENTIFIER, src + 6, 4);
+    assert(rift_token_materialize_in(&t, &arena));
+    assert(!rift_token_is_view(&t));
+    assert(t.memory.flags & RIFT_MEM_ARENA);
+    assert(strcmp(t.value.str, "beta") == 0);
+
+    size_t len = 0;
+    assert(strcmp(rift_token_view(&t, &len), "beta") == 0 && len == 4);
+    assert(rift_token_validate(&t));
+    rift_token_destroy(&t);           /* the copy stays with the arena */
+
+    rift_memory_arena_release(&arena);
+}
+
+TEST(test_token_line_index) {
+    const char *src = "ab\n\ncdef\ng";
+    rift_line_index_t index;
+    assert(rift_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 4);
+
+    uint32_t line = 0, col = 0;
+    rift_line_index_locate(&index, 0, &line, &col);
+    assert(line == 1 && col == 1);
+    rift_line_index_locate(&index, 2, &line, &col);   /* the '\n' ends line 1 */
+    assert(line == 1 && col == 3);
+    rift_line_index_locate(&index, 3, &line, &col);
+    assert(line == 2 && col == 1);
+    rift_line_index_locate(&index, 6, &line, &col);
+    assert(line == 3 && col == 3);
+    rift_line_index_locate(&index, 100, &line, &col);  /* clamped to the end */
+    assert(line == 4 && col == 2);
+
+    size_t len = 0;
+    const char *text = rift_line_index_line(&index, 3, &len);
+    assert(len == 4 && memcmp(text, "cdef", 4) == 0);
+    assert(rift_line_index_line(&index, 2, &len) != NULL && len == 0);
+    assert(rift_line_index_line(&index, 4, &len)[0] == 'g' && len == 1);
+    assert(rift_line_index_line(&index, 5, &len) == NULL);
+
+    rift_line_index_free(&index);
+    assert(index.starts == NULL);
+}
+
+/* A trailing '\n' opens no line; '\r' stays in the text */
+TEST(test_token_line_index_endings) {
+    rift_line_index_t index;
+    uint32_t line = 0, col = 0;
+    size_t len = 0;
+
+    assert(rift_line_index_build(&index, "", 0));
+    assert(index.count == 0);
+    assert(rift_line_index_line(&index, 1, &len) == NULL);
+    rift_line_index_locate(&index, 0, &line, &col);
+    assert(line == 1 && col == 1);
+    rift_line_index_free(&index);
+
+    const char *src = "ab\ncd\n";
+    assert(rift_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 2);
+    assert(memcmp(rift_line_index_line(&index, 2, &len), "cd", 2) == 0 && len == 2);
+    assert(rift_line_index_line(&index, 3, &len) == NULL);
+    rift_line_index_locate(&index, strlen(src), &line, &col);  /* end of source */
+    assert(line == 2 && col == 4);
+    rift_line_index_free(&index);
+
+    src = "a\n\n";
+    assert(rift_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 2);
+    assert(rift_line_index_line(&index, 2, &len) != NULL && len == 0);
+    rift_line_index_free(&index);
+
+    src = "ab\r\ncd\r\nef";
+    assert(rift_line_index_build(&index, src, strlen(src)));
+    assert(index.count == 3);
+    assert(memcmp(rift_line_index_line(&index, 1, &len), "ab\r", 3) == 0 && len == 3);
+    assert(memcmp(rift_line_index_line(&index, 3, &len), "ef", 2) == 0 && len == 2);
+    rift_line_index_locate(&index, 4, &line, &col);
+    assert(line == 2 && col == 1);
+    rift_line_index_free(&index);
+}
+
 int main(void) {
     printf("test_token:\n");
     RUN(test_token_create);
     RUN(test_token_create_null_value);
     RUN(test_token_type_name);
     RUN(test_token_triplet_validation);
+    RUN(test_token_create_n_view);
+    RUN(test_token_materialize);
+    RUN(test_memory_arena);
+    RUN(test_token_materialize_in_arena);
+    RUN(test_token_line_index);
+    RUN(test_token_line_index_endings);
     printf("\n%d passed, %d failed\n", tests_passed, tests_failed);
     return tests_failed;
 }